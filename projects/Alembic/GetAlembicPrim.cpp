@@ -405,6 +405,10 @@ ZENDEFNODE(GetAlembicCamera, {
 });
 
 struct ImportAlembicPrim : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     Alembic::Abc::v12::IArchive archive;
     std::string usedPath;
     virtual void apply() override {
@@ -1146,6 +1146,10 @@ Alembic::AbcGeom::IArchive readABC(std::string const &path) {
 }
 
 struct ReadAlembic : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     Alembic::Abc::v12::IArchive archive;
     std::string usedPath;
     bool read_done = false;
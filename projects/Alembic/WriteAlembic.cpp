@@ -44,6 +44,10 @@ static void write_normal(std::shared_ptr<PrimitiveObject> prim, OPolyMeshSchema:
 }
 
 struct WriteAlembic : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     OArchive archive;
     OPolyMesh meshyObj;
     virtual void apply() override {
@@ -545,6 +549,10 @@ void prim_to_poly_if_only_vertex(PrimitiveObject* p) {
 }
 
 struct WriteAlembic2 : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     OArchive archive;
     OPolyMesh meshyObj;
     OPoints pointsObj;
@@ -738,6 +746,10 @@ ZENDEFNODE(WriteAlembic2, {
 });
 
 struct WriteAlembicPrims : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     OArchive archive;
     std::string usedPath;
     std::map<std::string, OPolyMesh> meshyObjs;
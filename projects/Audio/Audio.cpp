@@ -167,6 +167,7 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
 
     struct AudioBeats : zeno::INode {
         std::deque<double> H;
+        std::shared_ptr<Aquila::Fft> fft;
         virtual void apply() override {
             auto wave = get_input<PrimitiveObject>("wave");
             float threshold = get_input<NumericObject>("threshold")->get<float>();
@@ -174,7 +175,8 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
             int start_index = int(sampleFrequency * start_time);
             int duration_count = 1024;
-            auto fft = Aquila::FftFactory::getFft(duration_count);
+            if (!fft)
+                fft = Aquila::FftFactory::getFft(duration_count);
             std::vector<double> samples;
             samples.resize(duration_count);
             for (auto i = 0; i < duration_count; i++) {
@@ -258,31 +260,36 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
         double minE = std::numeric_limits<double>::max();
         double maxE = std::numeric_limits<double>::min();
         std::vector<double> init;
+        std::shared_ptr<Aquila::Fft> fft;
         virtual void apply() override {
             auto wave = get_input<PrimitiveObject>("wave");
             int duration_count = 1024;
             if (init.empty()) {
-                auto fft = Aquila::FftFactory::getFft(duration_count);
                 int clip_count = wave->size() / duration_count;
-                init.reserve(clip_count);
-                for (auto i = 0; i < clip_count; i++) {
+                auto &value = wave->attr<float>("value");
+                init.resize(clip_count);
+                #pragma omp parallel
+                {
+                    auto fft = Aquila::FftFactory::getFft(duration_count);
                     std::vector<double> samples;
                     samples.resize(duration_count);
-                    for (auto j = 0; j < duration_count; j++) {
-                        samples[j] = wave->attr<float>("value")[min(duration_count * i + j, wave->size()-1)];
-                    }
-                    Aquila::SpectrumType spectrums = fft->fft(samples.data());
-                    {
+                    #pragma omp for
+                    for (int i = 0; i < clip_count; i++) {
+                        for (auto j = 0; j < duration_count; j++) {
+                            samples[j] = value[min(duration_count * i + j, wave->size()-1)];
+                        }
+                        Aquila::SpectrumType spectrums = fft->fft(samples.data());
                         double E = 0;
                         for (const auto& spectrum: spectrums) {
                             E += spectrum.real() * spectrum.real() + spectrum.imag() * spectrum.imag();
                         }
-                        E /= duration_count;
-                        minE = min(minE, E);
-                        maxE = max(maxE, E);
-                        init.push_back(E);
+                        init[i] = E / duration_count;
                     }
                 }
+                for (const auto& E: init) {
+                    minE = min(minE, E);
+                    maxE = max(maxE, E);
+                }
     //            for (auto i = 0; i < clip_count; i++) {
     //                init[i] = init[i] / maxE;
     //            }
@@ -304,7 +311,8 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
             auto start_time = get_input2<float>("time");
             float sampleFrequency = wave->userData().get<zeno::NumericObject>("SampleRate")->get<float>();
             int start_index = int(sampleFrequency * start_time);
-            auto fft = Aquila::FftFactory::getFft(duration_count);
+            if (!fft)
+                fft = Aquila::FftFactory::getFft(duration_count);
             std::vector<double> samples;
             samples.resize(duration_count);
             for (auto i = 0; i < duration_count; i++) {
@@ -368,6 +376,8 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
     });
 
     struct AudioFFT : zeno::INode {
+        std::shared_ptr<Aquila::Fft> fft;
+        int fft_size = 0;
         virtual void apply() override {
             auto wave = get_input<PrimitiveObject>("wave");
             int duration_count = get_input2<int>("duration_count");;
@@ -395,7 +405,10 @@ static std::shared_ptr<PrimitiveObject> readMp3(std::string path) {
                 }
             }
 
-            auto fft = Aquila::FftFactory::getFft(duration_count);
+            if (!fft || fft_size != duration_count) {
+                fft = Aquila::FftFactory::getFft(duration_count);
+                fft_size = duration_count;
+            }
             Aquila::SpectrumType spectrums = fft->fft(samples.data());
 
             auto fft_prim = std::make_shared<PrimitiveObject>();
@@ -0,0 +1,290 @@
+#include <zeno/zeno.h>
+#include <zeno/utils/log.h>
+#include <zeno/utils/format.h>
+#include <zeno/utils/Error.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/UserData.h>
+#include "aquila/aquila/aquila.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace zeno {
+namespace {
+
+// whole-track short-time spectrum, computed once and sampled per frame
+struct AudioSpectrumObject : IObjectClone<AudioSpectrumObject> {
+    float sampleRate = 44100;
+    int windowSize = 1024;
+    int hopSize = 512;
+    int numFrames = 0;
+    int numBins = 0;
+    int numMels = 0;
+    std::vector<float> power;     // numFrames * numBins, |X|^2 / windowSize
+    std::vector<float> mel;       // numFrames * numMels, log filter bank energies
+    std::vector<double> energy;   // numFrames, sum of power
+    std::vector<double> uniSum;   // numFrames + 1, prefix sum of normalized energy
+    std::vector<double> uniSqrSum;
+    double minE = 0, maxE = 0;
+
+    int frameAt(float time) const {
+        int f = (int)std::floor(time * sampleRate / hopSize);
+        return std::clamp(f, 0, numFrames - 1);
+    }
+
+    double uniEnergy(int f) const {
+        return maxE > minE ? (energy[f] - minE) / (maxE - minE) : 0.0;
+    }
+};
+
+static std::vector<double> makeWindow(std::string const &type, int n) {
+    std::vector<double> w(n, 1.0);
+    if (n < 2)
+        return w;
+    if (type == "hamming") {
+        for (int i = 0; i < n; i++)
+            w[i] = 0.54 - 0.46 * std::cos(2.0 * M_PI * i / (n - 1));
+    } else if (type == "hann") {
+        for (int i = 0; i < n; i++)
+            w[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / (n - 1));
+    }
+    return w;
+}
+
+struct MelBand {
+    int s, m, e;
+};
+
+// same triangular filters as MelFilter, but with bins derived from the actual window size
+static std::vector<MelBand> makeMelBands(int count, float sampleRate, int windowSize, float rangePerFilter) {
+    float halfFreq = sampleRate / 2;
+    float mel_fh = 2595.0 * std::log10(1 + halfFreq / 700.0);
+    std::vector<int> bin;
+    for (int i = 0; i <= count + 1; i++) {
+        float mel = mel_fh * i / (count + 1);
+        float hz = 700.0 * (std::pow(10.0, mel / 2595.0) - 1);
+        bin.push_back((int)((windowSize + 1.0) * hz / sampleRate));
+    }
+    int maxBin = windowSize / 2 + 1;
+    std::vector<MelBand> bands(count);
+    for (int i = 1; i <= count; i++) {
+        int m = bin[i];
+        int s = (int)(m + (bin[i - 1] - m) * rangePerFilter);
+        int e = (int)(m + (bin[i + 1] - m) * rangePerFilter);
+        bands[i - 1] = {std::clamp(s, 0, maxBin), std::clamp(m, 0, maxBin), std::clamp(e, 0, maxBin)};
+    }
+    return bands;
+}
+
+static std::shared_ptr<AudioSpectrumObject> computeSpectrum(
+        PrimitiveObject *wave, int windowSize, int hopSize, std::string const &windowType,
+        bool preEmphasis, float preEmphasisAlpha, int melCount, float rangePerFilter) {
+    auto spec = std::make_shared<AudioSpectrumObject>();
+    auto const &value = wave->attr<float>("value");
+    int n = (int)value.size();
+    spec->sampleRate = wave->userData().get2<float>("SampleRate");
+    spec->windowSize = windowSize;
+    spec->hopSize = hopSize;
+    spec->numFrames = std::max(1, (n + hopSize - 1) / hopSize);
+    spec->numBins = windowSize / 2 + 1;
+    spec->numMels = melCount;
+
+    // pre-emphasis is a per-sample filter, so apply it once to the whole track
+    std::vector<double> signal(n);
+    for (int i = 0; i < n; i++) {
+        signal[i] = preEmphasis && i + 1 < n ? value[i + 1] - preEmphasisAlpha * value[i] : value[i];
+    }
+
+    auto window = makeWindow(windowType, windowSize);
+    auto bands = makeMelBands(melCount, spec->sampleRate, windowSize, rangePerFilter);
+    int numFrames = spec->numFrames, numBins = spec->numBins;
+    spec->power.resize((size_t)numFrames * numBins);
+    spec->mel.resize((size_t)numFrames * melCount);
+    spec->energy.resize(numFrames);
+
+#pragma omp parallel
+    {
+        // FFT plans keep work areas, one per thread is reused over all frames
+        auto fft = Aquila::FftFactory::getFft(windowSize);
+        std::vector<double> samples(windowSize);
+
+#pragma omp for schedule(static)
+        for (int f = 0; f < numFrames; f++) {
+            int start = f * hopSize;
+            for (int i = 0; i < windowSize; i++) {
+                samples[i] = n ? signal[std::min(start + i, n - 1)] * window[i] : 0.0;
+            }
+            Aquila::SpectrumType spectrums = fft->fft(samples.data());
+
+            float *pw = spec->power.data() + (size_t)f * numBins;
+            double E = 0;
+            for (int i = 0; i < windowSize; i++) {
+                double sq = std::norm(spectrums[i]);
+                E += sq;
+                if (i < numBins)
+                    pw[i] = (float)(sq / windowSize);
+            }
+            spec->energy[f] = E / windowSize;
+
+            float *mf = spec->mel.data() + (size_t)f * melCount;
+            for (int b = 0; b < melCount; b++) {
+                auto [s, m, e] = bands[b];
+                float total = 0;
+                for (int i = s; i < m; i++)
+                    total += pw[i] * (float)(m - i) / (float)(m - s);
+                for (int i = m; i < e; i++)
+                    total += pw[i] * (1 - (float)(m - i) / (float)(e - m));
+                mf[b] = total == 0 ? std::numeric_limits<float>::min() : std::log(total);
+            }
+        }
+    }
+
+    auto [minIt, maxIt] = std::minmax_element(spec->energy.begin(), spec->energy.end());
+    spec->minE = *minIt;
+    spec->maxE = *maxIt;
+    spec->uniSum.resize(numFrames + 1);
+    spec->uniSqrSum.resize(numFrames + 1);
+    for (int f = 0; f < numFrames; f++) {
+        double e = spec->uniEnergy(f);
+        spec->uniSum[f + 1] = spec->uniSum[f] + e;
+        spec->uniSqrSum[f + 1] = spec->uniSqrSum[f] + e * e;
+    }
+    return spec;
+}
+
+struct AudioSpectrogram : zeno::INode {
+    size_t cachedHash = 0;
+    std::string cachedKey;
+    std::shared_ptr<AudioSpectrumObject> cached;
+
+    virtual void apply() override {
+        auto wave = get_input<PrimitiveObject>("wave");
+        auto windowSize = get_input2<int>("windowSize");
+        auto hopSize = get_input2<int>("hopSize");
+        auto windowType = get_input2<std::string>("window");
+        auto preEmphasis = get_input2<bool>("preEmphasis");
+        auto preEmphasisAlpha = get_input2<float>("preEmphasisAlpha");
+        auto melCount = get_input2<int>("melCount");
+        auto rangePerFilter = get_input2<float>("rangePerFilter");
+        if (windowSize <= 0 || hopSize <= 0)
+            throw makeError("windowSize and hopSize must be positive");
+        // the FFT is radix-2, other lengths would read past its tables
+        if (windowSize & (windowSize - 1))
+            throw makeError(zeno::format("windowSize must be a power of two, got {}", windowSize));
+
+        // recompute only when the samples or a parameter changed, a wave edited in place counts too
+        auto const &value = wave->attr<float>("value");
+        auto hash = std::hash<std::string_view>{}(std::string_view(
+            reinterpret_cast<const char *>(value.data()), value.size() * sizeof(float)));
+        auto key = zeno::format("{}:{}:{}:{}:{}:{}:{}:{}", wave->userData().get2<float>("SampleRate"),
+                                windowSize, hopSize, windowType, preEmphasis, preEmphasisAlpha,
+                                melCount, rangePerFilter);
+        if (!cached || cachedHash != hash || cachedKey != key) {
+            cached = computeSpectrum(wave.get(), windowSize, hopSize, windowType,
+                                     preEmphasis, preEmphasisAlpha, melCount, rangePerFilter);
+            cachedHash = hash;
+            cachedKey = key;
+            log_debug("AudioSpectrogram: {} frames x {} bins", cached->numFrames, cached->numBins);
+        }
+        set_output("spectrum", cached);
+    }
+};
+
+ZENDEFNODE(AudioSpectrogram, {
+    {
+        "wave",
+        {"int", "windowSize", "1024"},
+        {"int", "hopSize", "1024"},
+        {"enum hamming hann rect", "window", "hamming"},
+        {"bool", "preEmphasis", "0"},
+        {"float", "preEmphasisAlpha", "0.97"},
+        {"int", "melCount", "15"},
+        {"float", "rangePerFilter", "1"},
+    },
+    {
+        "spectrum",
+    },
+    {},
+    {
+        "audio"
+    },
+});
+
+struct AudioSpectrumAt : zeno::INode {
+    virtual void apply() override {
+        auto spec = get_input<AudioSpectrumObject>("spectrum");
+        auto time = get_input2<float>("time");
+        int f = spec->frameAt(time);
+
+        auto fft_prim = std::make_shared<PrimitiveObject>();
+        fft_prim->resize(spec->numBins);
+        auto &freq = fft_prim->add_attr<float>("freq");
+        auto &square = fft_prim->add_attr<float>("square");
+        auto &power = fft_prim->add_attr<float>("power");
+        float const *pw = spec->power.data() + (size_t)f * spec->numBins;
+        for (int i = 0; i < spec->numBins; i++) {
+            freq[i] = float(i);
+            power[i] = pw[i];
+            square[i] = pw[i] * spec->windowSize;
+        }
+        set_output("FFTPrim", std::move(fft_prim));
+
+        auto fbank = std::make_shared<PrimitiveObject>();
+        fbank->resize(spec->numMels);
+        auto &fbank_v = fbank->add_attr<float>("fbank");
+        auto &index = fbank->add_attr<float>("i");
+        float const *mf = spec->mel.data() + (size_t)f * spec->numMels;
+        for (int i = 0; i < spec->numMels; i++) {
+            fbank_v[i] = mf[i];
+            index[i] = (float)i;
+        }
+        set_output("FilterBank", std::move(fbank));
+
+        // same beat criterion as AudioEnergy, with history statistics from prefix sums
+        double uniE = spec->uniEnergy(f);
+        int history = std::max(get_input2<int>("historyFrames"), 1);
+        int s = std::max(f - history, 0);
+        int beat = 0;
+        if (f > s) {
+            double cnt = f - s;
+            double avg_H = (spec->uniSum[f] - spec->uniSum[s]) / cnt;
+            double var_H = std::max((spec->uniSqrSum[f] - spec->uniSqrSum[s]) / cnt - avg_H * avg_H, 0.0);
+            beat = uniE > avg_H + std::sqrt(var_H) * get_input2<float>("threshold");
+        }
+        set_output("beat", std::make_shared<NumericObject>(beat));
+        set_output("E", std::make_shared<NumericObject>((float)spec->energy[f]));
+        set_output("uniE", std::make_shared<NumericObject>((float)uniE));
+        set_output("minE", std::make_shared<NumericObject>((float)spec->minE));
+        set_output("maxE", std::make_shared<NumericObject>((float)spec->maxE));
+        set_output("frame", std::make_shared<NumericObject>(f));
+    }
+};
+
+ZENDEFNODE(AudioSpectrumAt, {
+    {
+        "spectrum",
+        {"float", "time", "0"},
+        {"int", "historyFrames", "43"},
+        {"float", "threshold", "1"},
+    },
+    {
+        "FFTPrim",
+        "FilterBank",
+        "beat",
+        "E",
+        "uniE",
+        "minE",
+        "maxE",
+        "frame",
+    },
+    {},
+    {
+        "audio"
+    },
+});
+
+}
+}
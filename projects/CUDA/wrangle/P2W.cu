@@ -27,6 +27,10 @@ static zfx::Compiler compiler;
 static zfx::cuda::Assembler assembler;
 
 struct ZSParticlesTwoWrangler : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     ~ZSParticlesTwoWrangler() {
         if (this->_cuModule)
             cuModuleUnload((CUmodule)this->_cuModule);
@@ -29,6 +29,10 @@ static zfx::Compiler compiler;
 static zfx::cuda::Assembler assembler;
 
 struct ZSParticleParticleWrangler : INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     ~ZSParticleParticleWrangler() {
         if (this->_cuModule)
             cuModuleUnload((CUmodule)this->_cuModule);
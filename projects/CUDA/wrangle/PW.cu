@@ -27,6 +27,10 @@ static zfx::Compiler compiler;
 static zfx::cuda::Assembler assembler;
 
 struct ZSParticlesWrangler : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     ~ZSParticlesWrangler() {
         if (this->_cuModule)
             cuModuleUnload((CUmodule)this->_cuModule);
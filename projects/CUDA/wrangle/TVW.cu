@@ -26,6 +26,10 @@ static zfx::Compiler compiler;
 static zfx::cuda::Assembler assembler;
 
 struct ZSTileVectorWrangler : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     ~ZSTileVectorWrangler() {
         if (this->_cuModule)
             cuModuleUnload((CUmodule)this->_cuModule);
@@ -26,6 +26,10 @@ static zfx::Compiler compiler;
 static zfx::cuda::Assembler assembler;
 
 struct ZSVolumeWrangler : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     ~ZSVolumeWrangler() {
         if (this->_cuModule)
             cuModuleUnload((CUmodule)this->_cuModule);
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace zeno {
+
+// In-place 2D complex FFT of a power-of-two square grid, kept as separate real and imaginary
+// planes in row-major order. Rows are transformed one at a time; columns are transformed in
+// stripes, where every butterfly combines two whole row segments. Both passes stream through
+// contiguous memory and vectorize without a transpose. Like cufft, the inverse is not normalized.
+struct CPUFFT2D {
+    explicit CPUFFT2D(int n) : n(n) {
+        if (n < 2 || (n & (n - 1)))
+            throw std::runtime_error("CPUFFT2D: size must be a power of two");
+        int logn = 0;
+        while ((1 << logn) < n)
+            logn++;
+        bitrev.resize(n);
+        for (int i = 0; i < n; i++) {
+            int r = 0;
+            for (int b = 0; b < logn; b++)
+                r |= ((i >> b) & 1) << (logn - 1 - b);
+            bitrev[i] = r;
+        }
+        // twiddles e^{-i pi j / half} of the stage with half-length `half` start at half - 1
+        twRe.resize(n - 1);
+        twIm.resize(n - 1);
+        for (int half = 1; half < n; half <<= 1) {
+            for (int j = 0; j < half; j++) {
+                double a = -M_PI * j / half;
+                twRe[half - 1 + j] = (float)std::cos(a);
+                twIm[half - 1 + j] = (float)std::sin(a);
+            }
+        }
+    }
+
+    int size() const {
+        return n;
+    }
+
+    void forward(float *re, float *im) const {
+        transform<false>(re, im);
+    }
+
+    // exponent sign +1, same as CUFFT_INVERSE
+    void inverse(float *re, float *im) const {
+        transform<true>(re, im);
+    }
+
+  private:
+    static constexpr int stripe = 32;
+
+    int n;
+    std::vector<int> bitrev;
+    std::vector<float> twRe, twIm;
+
+    template <bool Inverse>
+    void transform(float *re, float *im) const {
+#pragma omp parallel
+        {
+#pragma omp for schedule(static)
+            for (int y = 0; y < n; y++)
+                transformRow<Inverse>(re + (size_t)y * n, im + (size_t)y * n);
+#pragma omp for schedule(static)
+            for (int x0 = 0; x0 < n; x0 += stripe)
+                transformColumns<Inverse>(re, im, x0, std::min(x0 + stripe, n));
+        }
+    }
+
+    template <bool Inverse>
+    void transformRow(float *re, float *im) const {
+        for (int i = 0; i < n; i++) {
+            int j = bitrev[i];
+            if (i < j) {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+        for (int half = 1; half < n; half <<= 1) {
+            float const *wr = twRe.data() + half - 1;
+            float const *wi = twIm.data() + half - 1;
+            for (int i = 0; i < n; i += 2 * half) {
+                float *ar = re + i, *ai = im + i;
+                float *br = ar + half, *bi = ai + half;
+#pragma omp simd
+                for (int j = 0; j < half; j++) {
+                    float c = wr[j], s = Inverse ? -wi[j] : wi[j];
+                    float tr = br[j] * c - bi[j] * s;
+                    float ti = br[j] * s + bi[j] * c;
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+        }
+    }
+
+    template <bool Inverse>
+    void transformColumns(float *re, float *im, int x0, int x1) const {
+        const int w = x1 - x0;
+        for (int i = 0; i < n; i++) {
+            int j = bitrev[i];
+            if (i < j) {
+                std::swap_ranges(re + (size_t)i * n + x0, re + (size_t)i * n + x1, re + (size_t)j * n + x0);
+                std::swap_ranges(im + (size_t)i * n + x0, im + (size_t)i * n + x1, im + (size_t)j * n + x0);
+            }
+        }
+        for (int half = 1; half < n; half <<= 1) {
+            for (int i = 0; i < n; i += 2 * half) {
+                for (int j = 0; j < half; j++) {
+                    float c = twRe[half - 1 + j], s = Inverse ? -twIm[half - 1 + j] : twIm[half - 1 + j];
+                    float *ar = re + (size_t)(i + j) * n + x0, *ai = im + (size_t)(i + j) * n + x0;
+                    float *br = ar + (size_t)half * n, *bi = ai + (size_t)half * n;
+#pragma omp simd
+                    for (int x = 0; x < w; x++) {
+                        float tr = br[x] * c - bi[x] * s;
+                        float ti = br[x] * s + bi[x] * c;
+                        br[x] = ar[x] - tr;
+                        bi[x] = ai[x] - ti;
+                        ar[x] += tr;
+                        ai[x] += ti;
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace zeno
@@ -0,0 +1,534 @@
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/UserData.h>
+#include <zeno/utils/log.h>
+#include <zeno/zeno.h>
+#include "CPUFFT.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// CPU counterpart of the cufft ocean in Ocean.cu, for machines without a GPU. It takes the
+// same parameters and writes the same attributes as MakeCuOcean / OceanCompute, and adds
+// surface normals and the Jacobian of the horizontal displacement (foam where it folds).
+
+namespace zeno {
+namespace {
+
+constexpr float kPi = 3.14159265358979323846f;
+
+float urand() {
+    return rand() / (float)RAND_MAX;
+}
+
+// same random sequence as the gpu ocean, so one seed gives the same sea on both
+float gauss() {
+    float u1 = urand();
+    float u2 = urand();
+
+    if (u1 < 1e-6f) {
+        u1 = 1e-6f;
+    }
+
+    return sqrtf(-2 * logf(u1)) * cosf(2 * kPi * u2);
+}
+
+float phillips(float Kx, float Ky, float Vdir, float V, float A, float dir_depend, float g) {
+    float k_squared = Kx * Kx + Ky * Ky;
+
+    if (k_squared == 0.0f) {
+        return 0.0f;
+    }
+    float phil = 0;
+    float L = V * V / g;
+    if (1.0 / sqrt(k_squared) <= 15) {
+        float k_x = Kx / sqrtf(k_squared);
+        float k_y = Ky / sqrtf(k_squared);
+        float w_dot_k = k_x * cosf(Vdir) + k_y * sinf(Vdir);
+
+        phil = A * expf(-1.0f / (k_squared * L * L)) / (k_squared * k_squared) * w_dot_k * w_dot_k;
+
+        // filter out waves moving opposite to wind
+        if (w_dot_k < 0.0f) {
+            phil *= dir_depend;
+        }
+    }
+    return phil;
+}
+
+// sin and cos that vectorize: the quadrant is taken out in double so large w * t keeps
+// its phase, the rest is the cephes single precision polynomial on [-pi/4, pi/4]
+inline void sincosPhase(double theta, float &s, float &c) {
+    // round to nearest without a libm call
+    double q = (theta * (2.0 / M_PI) + 0x1.8p52) - 0x1.8p52;
+    float r = (float)(theta - q * (M_PI / 2));
+    int quadrant = (int)q;
+    float r2 = r * r;
+    float ps = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    float pc = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+    float sv = (quadrant & 1) ? pc : ps;
+    float cv = (quadrant & 1) ? ps : pc;
+    s = (quadrant & 2) ? -sv : sv;
+    c = ((quadrant + 1) & 2) ? -cv : cv;
+}
+
+struct OceanTexel {
+    float h, dx, dz;          // at time t
+    float dhdt, dxdt, dzdt;   // change until t + dt
+};
+
+struct CPUOcean : IObject {
+    // simulation parameters, same meaning as in OceanFFT
+    float L_scale = 1.0f;
+    float g;
+    float amplitude;
+    float A{1e-4f};
+    float patchSize;
+    float windDir;
+    float dir_depend{0.07f};
+    float depth{5000};
+    float timeScale;
+    float timeShift;
+    float speed;
+    float choppyness;
+    int WaveExponent = 8;
+    int meshSize;
+    int spectrumW;
+    int spectrumH;
+
+    std::vector<float> h0re, h0im; // spectrumH rows of spectrumW
+
+    // per wave vector: dispersion, direction, and h0(k), conj(h0(-k)) with the depth
+    // decay applied, summed and subtracted; rebuilt when the depth changes
+    float cachedDepth = NAN;
+    std::vector<float> omega, nkx, nky, sumRe, sumIm, difRe, difIm;
+
+    std::unique_ptr<CPUFFT2D> fft;
+    // three packed spectra, each carrying two real fields: h(t) + i h(t2),
+    // Dx(t) + i Dz(t), Dx(t2) + i Dz(t2)
+    std::vector<float> planes[6];
+
+    std::vector<OceanTexel> texels;
+    std::vector<vec4f> surface; // normal, jacobian
+
+    void generateH0() {
+        h0re.assign((size_t)spectrumW * spectrumH, 0);
+        h0im.assign((size_t)spectrumW * spectrumH, 0);
+        for (int y = 0; y <= meshSize; y++) {
+            for (int x = 0; x <= meshSize; x++) {
+                float kx = (-meshSize / 2.0f + x) * (2.0f * kPi / patchSize);
+                float ky = (-meshSize / 2.0f + y) * (2.0f * kPi / patchSize);
+
+                float P = sqrtf(phillips(kx, ky, windDir, speed, A, dir_depend, g));
+                if (kx == 0.0f && ky == 0.0f) {
+                    P = 0.0f;
+                }
+
+                float Er = gauss();
+                float Ei = gauss();
+
+                float theta = urand() * 2.0 * 3.1415926;
+                size_t i = (size_t)y * spectrumW + x;
+                h0re[i] = Er * P * cosf(theta) * (float)M_SQRT1_2;
+                h0im[i] = Ei * P * sinf(theta) * (float)M_SQRT1_2;
+            }
+        }
+    }
+
+    void prepareSpectrum(float decayDepth) {
+        if (decayDepth == cachedDepth)
+            return;
+        const int N = meshSize;
+        const size_t n2 = (size_t)N * N;
+        for (auto *v : {&omega, &nkx, &nky, &sumRe, &sumIm, &difRe, &difIm})
+            v->resize(n2);
+#pragma omp parallel for
+        for (int y = 0; y < N; y++) {
+            for (int x = 0; x < N; x++) {
+                size_t i = (size_t)y * N + x;
+                size_t ik = (size_t)y * spectrumW + x;
+                size_t imk = (size_t)(N - y) * spectrumW + (N - x); // mirrored
+                float kx = (-N / 2.0f + x) * (2.0f * kPi / patchSize);
+                float ky = (-N / 2.0f + y) * (2.0f * kPi / patchSize);
+                float klen = sqrtf(kx * kx + ky * ky);
+                float decay = sqrtf(expf(klen * decayDepth));
+                float len = klen + 0.0000001f;
+                omega[i] = sqrtf(g * klen);
+                nkx[i] = kx / len;
+                nky[i] = ky / len;
+                float aRe = h0re[ik] * decay, aIm = h0im[ik] * decay;
+                float bRe = h0re[imk] * decay, bIm = -h0im[imk] * decay;
+                sumRe[i] = aRe + bRe;
+                sumIm[i] = aIm + bIm;
+                difRe[i] = aRe - bRe;
+                difIm[i] = aIm - bIm;
+            }
+        }
+        cachedDepth = decayDepth;
+    }
+
+    // h~(k, t) = h0(k) e^{iwt} + conj(h0(-k)) e^{-iwt}, Dx~ = -i k.x/|k| h~, Dz~ = -i k.y/|k| h~
+    void spectrumAt(size_t i, double t, float out[6]) const {
+        float s, c;
+        sincosPhase(omega[i] * t, s, c);
+        float hr = c * sumRe[i] - s * difIm[i];
+        float hi = s * difRe[i] + c * sumIm[i];
+        out[0] = hr;
+        out[1] = hi;
+        out[2] = hi * nkx[i];
+        out[3] = -hr * nkx[i];
+        out[4] = hi * nky[i];
+        out[5] = -hr * nky[i];
+    }
+
+    // Only the real part of each inverse transform is used, which is the transform of the
+    // hermitian part of its spectrum. That lets two real fields share one complex transform
+    // as A + iB. Inside the grid the spectra are hermitian already, only the first row and
+    // column pair up with a mirrored bin that isn't the one h0(-k) was read from.
+    void evolve(double t1, double t2) {
+        const int N = meshSize;
+        const size_t n2 = (size_t)N * N;
+        for (auto &p : planes)
+            p.resize(n2);
+        float *hRe = planes[0].data(), *hIm = planes[1].data();
+        float *aRe = planes[2].data(), *aIm = planes[3].data();
+        float *bRe = planes[4].data(), *bIm = planes[5].data();
+
+#pragma omp parallel for
+        for (int y = 0; y < N; y++) {
+            size_t row = (size_t)y * N;
+#pragma omp simd
+            for (int x = 0; x < N; x++) {
+                size_t i = row + x;
+                float s1, c1, s2, c2;
+                sincosPhase(omega[i] * t1, s1, c1);
+                sincosPhase(omega[i] * t2, s2, c2);
+                float h1r = c1 * sumRe[i] - s1 * difIm[i], h1i = s1 * difRe[i] + c1 * sumIm[i];
+                float h2r = c2 * sumRe[i] - s2 * difIm[i], h2i = s2 * difRe[i] + c2 * sumIm[i];
+                hRe[i] = h1r - h2i;
+                hIm[i] = h1i + h2r;
+                // Dx + i Dz
+                aRe[i] = h1i * nkx[i] + h1r * nky[i];
+                aIm[i] = h1i * nky[i] - h1r * nkx[i];
+                bRe[i] = h2i * nkx[i] + h2r * nky[i];
+                bIm[i] = h2i * nky[i] - h2r * nkx[i];
+            }
+        }
+
+        auto fixup = [&](int x, int y) {
+            size_t i = (size_t)y * N + x;
+            size_t m = (size_t)((N - y) % N) * N + (N - x) % N;
+            float p1[6], p2[6], m1[6], m2[6], r[12];
+            spectrumAt(i, t1, p1);
+            spectrumAt(i, t2, p2);
+            spectrumAt(m, t1, m1);
+            spectrumAt(m, t2, m2);
+            // hermitian parts, as (re, im) pairs: h1 h2 dx1 dz1 dx2 dz2
+            float const *src[6][2] = {{p1, m1}, {p2, m2}, {p1 + 2, m1 + 2}, {p1 + 4, m1 + 4}, {p2 + 2, m2 + 2}, {p2 + 4, m2 + 4}};
+            for (int f = 0; f < 6; f++) {
+                r[2 * f] = 0.5f * (src[f][0][0] + src[f][1][0]);
+                r[2 * f + 1] = 0.5f * (src[f][0][1] - src[f][1][1]);
+            }
+            hRe[i] = r[0] - r[3];
+            hIm[i] = r[1] + r[2];
+            aRe[i] = r[4] - r[7];
+            aIm[i] = r[5] + r[6];
+            bRe[i] = r[8] - r[11];
+            bIm[i] = r[9] + r[10];
+        };
+        for (int x = 0; x < N; x++)
+            fixup(x, 0);
+        for (int y = 1; y < N; y++)
+            fixup(0, y);
+
+        fft->inverse(hRe, hIm);
+        fft->inverse(aRe, aIm);
+        fft->inverse(bRe, bIm);
+
+        texels.resize(n2);
+#pragma omp parallel for
+        for (int y = 0; y < N; y++) {
+            for (int x = 0; x < N; x++) {
+                size_t i = (size_t)y * N + x;
+                // cos(pi * (m1 + m2)), undoes the centered wave numbers
+                float sign = ((x + y) & 1) ? -1.0f : 1.0f;
+                OceanTexel &o = texels[i];
+                o.h = sign * hRe[i];
+                o.dx = sign * aRe[i];
+                o.dz = sign * aIm[i];
+                o.dhdt = sign * hIm[i] - o.h;
+                o.dxdt = sign * bRe[i] - o.dx;
+                o.dzdt = sign * bIm[i] - o.dz;
+            }
+        }
+    }
+
+    // normals and the jacobian of the displaced surface at time t, by central differences,
+    // in tiles so the three row stencil stays in cache
+    void evaluateSurface() {
+        constexpr int tile = 32;
+        const int N = meshSize;
+        const int tiles = (N + tile - 1) / tile;
+        const float cell = L_scale * patchSize / N;
+        const float dD = -choppyness * L_scale / (2 * cell);
+        const float dH = L_scale / (2 * cell);
+        surface.resize((size_t)N * N);
+#pragma omp parallel for collapse(2) schedule(static)
+        for (int ty = 0; ty < tiles; ty++) {
+            for (int tx = 0; tx < tiles; tx++) {
+                for (int y = ty * tile; y < std::min(N, (ty + 1) * tile); y++) {
+                    const OceanTexel *row = texels.data() + (size_t)y * N;
+                    const OceanTexel *up = texels.data() + (size_t)((y + 1) % N) * N;
+                    const OceanTexel *down = texels.data() + (size_t)((y + N - 1) % N) * N;
+                    for (int x = tx * tile; x < std::min(N, (tx + 1) * tile); x++) {
+                        const OceanTexel &r = row[(x + 1) % N], &l = row[(x + N - 1) % N];
+                        float dxdu = dD * (r.dx - l.dx), dzdu = dD * (r.dz - l.dz), dhdu = dH * (r.h - l.h);
+                        float dxdv = dD * (up[x].dx - down[x].dx), dzdv = dD * (up[x].dz - down[x].dz);
+                        float dhdv = dH * (up[x].h - down[x].h);
+                        vec3f tu(1 + dxdu, dhdu, dzdu);
+                        vec3f tv(dxdv, dhdv, 1 + dzdv);
+                        vec3f nrm = normalizeSafe(cross(tv, tu));
+                        float jacobian = (1 + dxdu) * (1 + dzdv) - dxdv * dzdu;
+                        surface[(size_t)y * N + x] = vec4f(nrm[0], nrm[1], nrm[2], jacobian);
+                    }
+                }
+            }
+        }
+    }
+};
+
+// bilinear weights of a periodic map of size x size texels of width h, one lookup serves
+// every field sampled at the same point
+struct OceanSample {
+    size_t idx[4];
+    float w[4];
+
+    OceanSample(int size, float h, float u, float v) {
+        float uu = u / h, vv = v / h;
+        float fu = std::floor(uu), fv = std::floor(vv);
+        float cx = uu - fu, cy = vv - fv;
+        // size is a power of two, masking wraps negative texels too
+        const int mask = size - 1;
+        int tu = (int)fu & mask, tv = (int)fv & mask;
+        int tu1 = (tu + 1) & mask, tv1 = (tv + 1) & mask;
+        idx[0] = (size_t)tv * size + tu;
+        idx[1] = (size_t)tv * size + tu1;
+        idx[2] = (size_t)tv1 * size + tu;
+        idx[3] = (size_t)tv1 * size + tu1;
+        w[0] = (1 - cx) * (1 - cy);
+        w[1] = cx * (1 - cy);
+        w[2] = (1 - cx) * cy;
+        w[3] = cx * cy;
+    }
+
+    template <class T, class F>
+    auto operator()(T const *data, F &&field) const {
+        return field(data[idx[0]]) * w[0] + field(data[idx[1]]) * w[1] + field(data[idx[2]]) * w[2] +
+               field(data[idx[3]]) * w[3];
+    }
+};
+
+struct MakeCPUOcean : INode {
+    void apply() override {
+        auto ocean = std::make_shared<CPUOcean>();
+
+        ocean->amplitude = get_input<NumericObject>("amp")->get<float>();
+        ocean->WaveExponent = get_input<NumericObject>("WaveExponent")->get<int>();
+        ocean->choppyness = get_input<NumericObject>("chop")->get<float>();
+        ocean->meshSize = 1 << ocean->WaveExponent;
+        ocean->spectrumH = ocean->meshSize + 1;
+        ocean->spectrumW = ocean->meshSize + 4;
+        ocean->L_scale = get_input<NumericObject>("patchSize")->get<float>() / 100.0;
+        ocean->g = get_input<NumericObject>("gravity")->get<float>() / ocean->L_scale;
+        ocean->patchSize = 100;
+        ocean->windDir = get_input<NumericObject>("windDir")->get<float>() / 360.0 * 2.0 * kPi;
+        ocean->timeScale = get_input<NumericObject>("timeScale")->get<float>();
+        ocean->timeShift = get_input<NumericObject>("timeshift")->get<float>();
+        ocean->speed = get_input<NumericObject>("speed")->get<float>() / ocean->L_scale;
+        ocean->depth = get_input<NumericObject>("depth")->get<float>();
+        ocean->A *= ocean->amplitude;
+
+        ocean->fft = std::make_unique<CPUFFT2D>(ocean->meshSize);
+
+        unsigned int seed = get_input<NumericObject>("seed")->get<int>();
+        srand(seed);
+        ocean->generateH0();
+
+        set_output("cpuOcean", ocean);
+    }
+};
+
+ZENDEFNODE(MakeCPUOcean, {/* inputs:  */ {{"int", "WaveExponent", "8"},
+                                          {"float", "depth", "5000"},
+                                          {"float", "chop", "0.5"},
+                                          {"float", "gravity", "9.81"},
+                                          {"float", "windDir", "0"},
+                                          {"float", "timeScale", "1.0"},
+                                          {"float", "patchSize", "100.0"},
+                                          {"float", "speed", "100.0"},
+                                          {"float", "timeshift", "0.0"},
+                                          {"float", "amp", "1.0"},
+                                          {"int", "seed", "0"}},
+                          /* outputs: */
+                          {
+                              "cpuOcean",
+                          },
+                          /* params: */ {},
+                          /* category: */
+                          {
+                              "Ocean",
+                          }});
+
+void computeOcean(CPUOcean &ocean, PrimitiveObject const &ingrid, PrimitiveObject &grid, float time, float depth,
+                  float dt, float foamThreshold) {
+    float t = ocean.timeScale * time;
+    float t2 = t;
+    float dt_inv = 0;
+    if (dt != 0) {
+        t2 = t + ocean.timeScale * dt;
+        dt_inv = 1.0 / (ocean.timeScale * dt);
+    }
+
+    ocean.prepareSpectrum(-depth / ocean.L_scale);
+    ocean.evolve(ocean.timeShift + t, ocean.timeShift + t2);
+    ocean.evaluateSurface();
+
+    auto &inpos = ingrid.verts;
+    auto &pos = grid.attr<vec3f>("pos");
+    auto &fftpos = grid.add_attr<vec3f>("fftpos");
+    auto &vel = grid.add_attr<vec3f>("vel");
+    auto &Dpos = grid.add_attr<vec3f>("Dpos");
+    auto &mapx = grid.add_attr<vec3f>("mapx");
+    auto &repos = grid.add_attr<vec3f>("mapPos");
+    auto &revel = grid.add_attr<vec3f>("mapVel");
+    auto &nrm = grid.add_attr<vec3f>("nrm");
+    auto &jacobian = grid.add_attr<float>("jacobian");
+    auto &foam = grid.add_attr<float>("foam");
+    grid.resize(ingrid.size());
+
+    const float L_scale = ocean.L_scale, chop = ocean.choppyness;
+    const float L = L_scale * (float)ocean.patchSize;
+    const float h = L / (float)ocean.meshSize;
+    const int size = ocean.meshSize;
+    const OceanTexel *texels = ocean.texels.data();
+    const vec4f *surface = ocean.surface.data();
+    auto disp = [](OceanTexel const &o) { return vec3f(o.h, o.dx, o.dz); };
+    auto rate = [](OceanTexel const &o) { return vec3f(o.dhdt, o.dxdt, o.dzdt); };
+
+#pragma omp parallel for schedule(static, 4096)
+    for (intptr_t i = 0; i < (intptr_t)pos.size(); i++) {
+        vec3f opos = pos[i];
+        OceanSample at(size, h, opos[0] + 0.5f * L, opos[2] + 0.5f * L);
+        vec3f d = at(texels, disp);
+        vec3f r = at(texels, rate);
+        float hh = d[0];
+        Dpos[i] = L_scale * vec3f(-chop * d[1], hh - depth / L_scale, -chop * d[2]);
+        fftpos[i] = inpos[i] + L_scale * vec3f(0, hh - depth / L_scale, 0);
+        pos[i] = inpos[i] + Dpos[i];
+        vel[i] = L_scale * vec3f(-chop * r[1], r[0], -chop * r[2]) * dt_inv;
+
+        vec4f s = at(surface, [](vec4f const &o) { return o; });
+        nrm[i] = normalizeSafe(vec3f(s[0], s[1], s[2]));
+        jacobian[i] = s[3];
+        foam[i] = std::max(0.0f, foamThreshold - s[3]);
+
+        mapx[i] = opos - vec3f(Dpos[i][0], 0, Dpos[i][2]);
+        OceanSample back(size, h, mapx[i][0] + 0.5f * L, mapx[i][2] + 0.5f * L);
+        float h2 = L_scale * back(texels, [](OceanTexel const &o) { return o.h; });
+        vec3f r2 = back(texels, rate);
+        repos[i] = vec3f(opos[0], h2 - depth, opos[2]);
+        revel[i] = L_scale * vec3f(-chop * r2[1], r2[0], -chop * r2[2]) * dt_inv;
+    }
+
+    grid.userData().set("dt", std::make_shared<NumericObject>((float)(t2 - t)));
+}
+
+struct OceanCPUCompute : INode {
+    void apply() override {
+        auto ocean = get_input<CPUOcean>("ocean_FFT");
+        auto ingrid = get_input<PrimitiveObject>("grid");
+        auto depth = get_input<NumericObject>("depth")->get<float>();
+        auto time = get_input<NumericObject>("time")->get<float>();
+        float dt = has_input("dt") ? get_input<NumericObject>("dt")->get<float>() : 0.0f;
+        auto foamThreshold = get_input2<float>("foamThreshold");
+
+        auto grid = std::make_shared<PrimitiveObject>(*ingrid);
+        computeOcean(*ocean, *ingrid, *grid, time, depth, dt, foamThreshold);
+        set_output("OceanData", grid);
+    }
+};
+
+ZENDEFNODE(OceanCPUCompute, {/* inputs:  */ {
+                                 "grid",
+                                 {"float", "time", "0"},
+                                 {"float", "depth", "0"},
+                                 {"float", "dt", "0.04"},
+                                 {"float", "foamThreshold", "0.5"},
+                                 "ocean_FFT",
+                             },
+                             /* outputs: */
+                             {
+                                 "OceanData",
+                             },
+                             /* params: */ {},
+                             /* category: */
+                             {
+                                 "Ocean",
+                             }});
+
+struct BenchmarkCPUOcean : INode {
+    void apply() override {
+        auto ocean = get_input<CPUOcean>("ocean_FFT");
+        auto ingrid = get_input<PrimitiveObject>("grid");
+        auto frames = std::max(get_input2<int>("frames"), 1);
+
+        auto seconds = [](auto t0) {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+        auto t0 = std::chrono::steady_clock::now();
+        ocean->prepareSpectrum(0);
+        double setupTime = seconds(t0);
+
+        double evolveTime = 0, surfaceTime = 0, totalTime = 0;
+        for (int f = 0; f < frames; f++) {
+            auto grid = std::make_shared<PrimitiveObject>(*ingrid);
+            t0 = std::chrono::steady_clock::now();
+            computeOcean(*ocean, *ingrid, *grid, f * 0.04f, 0, 0.04f, 0.5f);
+            totalTime += seconds(t0);
+
+            t0 = std::chrono::steady_clock::now();
+            ocean->evolve(f * 0.04, f * 0.04 + 0.04);
+            evolveTime += seconds(t0);
+            t0 = std::chrono::steady_clock::now();
+            ocean->evaluateSurface();
+            surfaceTime += seconds(t0);
+        }
+        log_info("BenchmarkCPUOcean: {}^2 spectrum, {} verts, setup {}s, per frame {}s "
+                 "(spectrum and fft {}s, normals and jacobian {}s)",
+                 ocean->meshSize, ingrid->verts.size(), setupTime, totalTime / frames, evolveTime / frames,
+                 surfaceTime / frames);
+        set_output("frameTime", std::make_shared<NumericObject>((float)(totalTime / frames)));
+        set_output("fftTime", std::make_shared<NumericObject>((float)(evolveTime / frames)));
+    }
+};
+
+ZENDEFNODE(BenchmarkCPUOcean, {
+    {
+    "grid",
+    "ocean_FFT",
+    {"int", "frames", "10"},
+    },
+    {
+    {"float", "frameTime"},
+    {"float", "fftTime"},
+    },
+    {
+    },
+    {"Ocean"},
+});
+
+} // namespace
+} // namespace zeno
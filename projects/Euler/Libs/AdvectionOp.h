@@ -148,6 +148,9 @@ public:
     const T& lowest_int_e_by_rho;
 
     Array<T, dim + 2, dim> eps;
+    // tiled sweeps and the vectorized gas-gas flux kernel, off runs the
+    // reference per-cell path
+    bool dense_fast_path = true;
 
     // Helper Functions:
 
@@ -168,59 +171,120 @@ public:
             }
         };
 
+        // flux through the lower face of I along d, zero if neither side is gas
+        auto interface_flux = [&](const Vector<int, dim>& I, int d) -> Array<T, dim + 2, 1> {
+            Vector<int, dim> pos1 = I;
+            pos1(d) = pos1(d) - 2;
+            Vector<int, dim> pos2 = I;
+            pos2(d) = pos2(d) - 1;
+            Vector<int, dim> pos3 = I;
+            Vector<int, dim> pos4 = I;
+            pos4(d) = pos4(d) + 1;
+
+            // prevent sampling pos outof bbox
+            bool active_interface = field_helper.cell_type[field_helper.grid[pos2].idx] == CellType::GAS || field_helper.cell_type[field_helper.grid[pos3].idx] == CellType::GAS;
+            if (!active_interface)
+                return Array<T, dim + 2, 1>::Zero();
+
+            std::array<int, 4> IDX{
+                { field_helper.grid[pos1].idx, field_helper.grid[pos2].idx,
+                    field_helper.grid[pos3].idx, field_helper.grid[pos4].idx }
+            };
+            // q value is all obtained from gas field
+            std::array<Array<T, dim + 2, 1>, 4> Q{
+                { field_helper.q[IDX[0]], field_helper.q[IDX[1]],
+                    field_helper.q[IDX[2]], field_helper.q[IDX[3]] }
+            };
+            std::array<int, 4> cell_types{
+                { field_helper.cell_type[IDX[0]], field_helper.cell_type[IDX[1]],
+                    field_helper.cell_type[IDX[2]], field_helper.cell_type[IDX[3]] }
+            };
+            // U is obtained from two phases respectively
+            std::array<T, 4> U;
+            for (int i = 0; i < 4; i++) {
+                if (cell_types[i] == CellType::GAS || cell_types[i] == CellType::FREE || cell_types[i] == CellType::INLET)
+                    U[i] = field_helper.uf[IDX[i]](d);
+                else if (cell_types[i] == CellType::SOLID)
+                    U[i] = field_helper.us[IDX[i]](d);
+                else if (cell_types[i] == CellType::BOUND)
+                    U[i] = 0;
+                else
+                    U[i] = 0;
+            }
+            T i_frac = 0;
+            // apply stencil
+            return mixed_bc_flux(Q, U, cell_types, eps.col(d), i_frac);
+        };
+
         auto get_flux = [&](const Vector<int, dim>& I) {
             if (field_helper.grid[I].iduf >= 0) {
                 int idx = field_helper.grid[I].idx;
                 Array<T, dim + 2, dim> temp_flux = Array<T, dim + 2, dim>::Zero();
-                for (int d = 0; d < dim; d++) {
-                    Vector<int, dim> pos1 = I;
-                    pos1(d) = pos1(d) - 2;
-                    Vector<int, dim> pos2 = I;
-                    pos2(d) = pos2(d) - 1;
-                    Vector<int, dim> pos3 = I;
-                    Vector<int, dim> pos4 = I;
-                    pos4(d) = pos4(d) + 1;
-
-                    // prevent sampling pos outof bbox
-                    int IT = field_helper.interface_type(I)(d);
-                    bool active_interface = field_helper.cell_type[field_helper.grid[pos2].idx] == CellType::GAS || field_helper.cell_type[field_helper.grid[pos3].idx] == CellType::GAS;
-                    if (!active_interface)
-                        continue;
+                for (int d = 0; d < dim; d++)
+                    temp_flux.col(d) = interface_flux(I, d);
+                field_helper.flux[idx] = temp_flux;
+            }
+        };
 
-                    std::array<int, 4> IDX{
-                        { field_helper.grid[pos1].idx, field_helper.grid[pos2].idx,
-                            field_helper.grid[pos3].idx, field_helper.grid[pos4].idx }
-                    };
-                    // q value is all obtained from gas field
-                    std::array<Array<T, dim + 2, 1>, 4> Q{
-                        { field_helper.q[IDX[0]], field_helper.q[IDX[1]],
-                            field_helper.q[IDX[2]], field_helper.q[IDX[3]] }
-                    };
-                    std::array<int, 4> cell_types{
-                        { field_helper.cell_type[IDX[0]], field_helper.cell_type[IDX[1]],
-                            field_helper.cell_type[IDX[2]], field_helper.cell_type[IDX[3]] }
-                    };
-                    // U is obtained from two phases respectively
-                    std::array<T, 4> U;
-                    // std::cout << "hello" << std::endl;
-                    for (int i = 0; i < 4; i++) {
-                        if (cell_types[i] == CellType::GAS || cell_types[i] == CellType::FREE || cell_types[i] == CellType::INLET)
-                            U[i] = field_helper.uf[IDX[i]](d);
-                        else if (cell_types[i] == CellType::SOLID) {
-                            // std::cout << "correctly got interface vel ";
-                            U[i] = field_helper.us[IDX[i]](d);
-                            // std::cout << U[i] << std::endl;
+        // dense fast path: interfaces whose whole stencil is gas (the bulk of the
+        // domain) are gathered per row into component-wise buffers and go
+        // through the vectorized kernel, everything else falls back to
+        // interface_flux
+        constexpr int fast = XFastestSweep ? 0 : dim - 1;
+        constexpr int row_max = 64;
+        auto get_flux_row = [&](Vector<int, dim> I0, int n) {
+            alignas(64) T U[4][row_max];
+            alignas(64) T Q[4][dim + 2][row_max];
+            alignas(64) T F[dim + 2][row_max];
+            StorageIndex idx[row_max];
+            bool active[row_max], dense[row_max];
+            for (int begin = 0; begin < n; begin += row_max, I0(fast) += row_max) {
+                int len = std::min(row_max, n - begin);
+                Vector<int, dim> I = I0;
+                for (int c = 0; c < len; c++, I(fast)++) {
+                    idx[c] = field_helper.grid[I].idx;
+                    active[c] = field_helper.grid[I].iduf >= 0;
+                }
+                for (int d = 0; d < dim; d++) {
+                    I = I0;
+                    for (int c = 0; c < len; c++, I(fast)++) {
+                        dense[c] = active[c];
+                        // inner cells first, the outer ones are only inside the
+                        // ghost layer when those are gas
+                        for (int s : { 2, 1, 0, 3 }) {
+                            if (!dense[c])
+                                break;
+                            Vector<int, dim> pos = I;
+                            pos(d) += s - 2;
+                            StorageIndex sidx = field_helper.grid[pos].idx;
+                            dense[c] = field_helper.cell_type[sidx] == CellType::GAS;
+                            U[s][c] = field_helper.uf[sidx](d);
+                            for (int k = 0; k < dim + 2; k++)
+                                Q[s][k][c] = field_helper.q[sidx](k);
                         }
-                        else if (cell_types[i] == CellType::BOUND)
-                            U[i] = 0;
+                        if (!dense[c])
+                            for (int s = 0; s < 4; s++) {
+                                U[s][c] = 0;
+                                for (int k = 0; k < dim + 2; k++)
+                                    Q[s][k][c] = 0;
+                            }
+                    }
+                    const T* Us[4] = { U[0], U[1], U[2], U[3] };
+                    for (int k = 0; k < dim + 2; k++) {
+                        const T* Qs[4] = { Q[0][k], Q[1][k], Q[2][k], Q[3][k] };
+                        ZenEulerGas::Math::RPSolver::WENO2_LLF_Row(len, Us, Qs, eps(k, d), F[k]);
+                    }
+                    I = I0;
+                    for (int c = 0; c < len; c++, I(fast)++) {
+                        if (!active[c])
+                            continue;
+                        if (dense[c])
+                            for (int k = 0; k < dim + 2; k++)
+                                field_helper.flux[idx[c]](k, d) = F[k][c];
                         else
-                            U[i] = 0;
+                            field_helper.flux[idx[c]].col(d) = interface_flux(I, d);
                     }
-                    T i_frac = 0;
-                    // apply stencil
-                    temp_flux.col(d) = mixed_bc_flux(Q, U, cell_types, eps.col(d), i_frac);
                 }
-                field_helper.flux[idx] = temp_flux;
             }
         };
 
@@ -262,8 +326,28 @@ public:
             }
         };
 
-        field_helper.iterateGridSerial(get_eps);
-        field_helper.iterateGridParallel(get_flux, 1);
+        if (dense_fast_path) {
+            // eps is a max over the gas cells, reduce it per thread
+            tbb::combinable<Array<T, dim + 2, dim>> local_eps([&] { return eps; });
+            field_helper.iterateRowsTiled([&](Vector<int, dim> I, int n) {
+                auto& e = local_eps.local();
+                for (int c = 0; c < n; c++, I(fast)++) {
+                    int idx = field_helper.grid[I].idx;
+                    if (field_helper.cell_type[idx] == CellType::GAS) {
+                        Vector<T, dim> u = field_helper.uf[idx];
+                        Array<T, dim + 2, 1> q = field_helper.q[idx];
+                        for (int d = 0; d < dim; d++)
+                            e.col(d) = e.col(d).max(1e-6 * u(d) * u(d) * q * q);
+                    }
+                }
+            });
+            local_eps.combine_each([&](const Array<T, dim + 2, dim>& e) { eps = eps.max(e); });
+            field_helper.iterateRowsTiled(get_flux_row, 1, 16, row_max);
+        }
+        else {
+            field_helper.iterateGridSerial(get_eps);
+            field_helper.iterateGridParallel(get_flux, 1);
+        }
         {
             // calculate flux for moving bound
             for (const auto& it_mark : field_helper.moving_Yf_interfaces_override) {
@@ -332,7 +416,10 @@ public:
                 field_helper.flux[idx].col(d) = temp_flux;
             }
         }
-        field_helper.iterateGridParallel(flux_based_update);
+        if (dense_fast_path)
+            field_helper.iterateGridTiled(flux_based_update);
+        else
+            field_helper.iterateGridParallel(flux_based_update);
     };
 };
 } // namespace ZenEulerGas
@@ -240,6 +240,66 @@ public:
             }
         }
     };
+    // cache-blocked parallel sweep: every task owns a tile of the grid and walks
+    // it in memory order, row_op(I, n) receives the first cell of a contiguous
+    // row of n (<= row_tile) cells along the fastest axis
+    template <typename OP>
+    void iterateRowsTiled(const OP& row_op, int extend = 0, int tile = 16,
+        int row_tile = 64)
+    {
+        constexpr int fast = XFastestSweep ? 0 : dim - 1;
+        IA lo = grid.bbmin - extend;
+        IA hi = grid.bbmax + extend;
+        if constexpr (dim == 1)
+            tbb::parallel_for(tbb::blocked_range<int>(lo(0), hi(0), row_tile),
+                [&](const tbb::blocked_range<int>& r) {
+                    row_op(IV{ r.begin() }, (int)r.size());
+                });
+        else if constexpr (dim == 2) {
+            constexpr int slow = 1 - fast;
+            tbb::parallel_for(
+                tbb::blocked_range2d<int>(lo(slow), hi(slow), tile, lo(fast), hi(fast), row_tile),
+                [&](const tbb::blocked_range2d<int>& r) {
+                    for (int s = r.rows().begin(); s < r.rows().end(); s++) {
+                        IV I;
+                        I(slow) = s;
+                        I(fast) = r.cols().begin();
+                        row_op(I, (int)r.cols().size());
+                    }
+                });
+        }
+        else if constexpr (dim == 3) {
+            constexpr int slow = XFastestSweep ? 2 : 0;
+            tbb::parallel_for(
+                tbb::blocked_range3d<int>(lo(slow), hi(slow), tile, lo(1), hi(1), tile,
+                    lo(fast), hi(fast), row_tile),
+                [&](const tbb::blocked_range3d<int>& r) {
+                    for (int s = r.pages().begin(); s < r.pages().end(); s++)
+                        for (int m = r.rows().begin(); m < r.rows().end(); m++) {
+                            IV I;
+                            I(slow) = s;
+                            I(1) = m;
+                            I(fast) = r.cols().begin();
+                            row_op(I, (int)r.cols().size());
+                        }
+                });
+        }
+        else {
+            std::cout << "not implemented" << std::endl;
+            exit(1);
+        }
+    };
+    template <typename OP>
+    void iterateGridTiled(const OP& operation, int extend = 0)
+    {
+        constexpr int fast = XFastestSweep ? 0 : dim - 1;
+        iterateRowsTiled(
+            [&](IV I, int n) {
+                for (int c = 0; c < n; c++, I(fast)++)
+                    operation(I);
+            },
+            extend);
+    };
     template <typename OP>
     void iterateGridColoredParallel(const OP& operation, int nColor = 1,
         int extend = 0)
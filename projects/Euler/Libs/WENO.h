@@ -82,6 +82,22 @@ DerivedV WENO2_LLF(const std::array<T, 4>& U, const std::array<DerivedV, 4>& Q,
     return 0.5 * (WENO2<T, DerivedV, DerivedE>((u1 + alpha) * q1, (u2 + alpha) * q2, (u3 + alpha) * q3, eps) + WENO2<T, DerivedV, DerivedE>((u4 - alpha) * q4, (u3 - alpha) * q3, (u2 - alpha) * q2, eps));
 };
 
+/**
+   WENO2-LLF over a row of n independent interfaces of one conserved component,
+   stencils stored as separate contiguous arrays so the loop vectorizes.
+   Same arithmetic as WENO2_LLF.
+*/
+template <class T>
+void WENO2_LLF_Row(int n, const T* const U[4], const T* const Q[4], T eps,
+    T* flux)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+        T alpha = std::max(std::abs(U[1][i]), std::abs(U[2][i]));
+        flux[i] = 0.5 * (WENO2<T, T, T>((U[0][i] + alpha) * Q[0][i], (U[1][i] + alpha) * Q[1][i], (U[2][i] + alpha) * Q[2][i], eps) + WENO2<T, T, T>((U[3][i] - alpha) * Q[3][i], (U[2][i] - alpha) * Q[2][i], (U[1][i] - alpha) * Q[1][i], eps));
+    }
+}
+
 template <class T, class DerivedV, class DerivedE>
 DerivedV WENO3_LLF(const std::array<T, 5>& U, const std::array<DerivedV, 5>& Q,
     const DerivedE& eps)
@@ -475,6 +475,10 @@ ZENDEFNODE(EvalBlenderFile,
            });
 
 struct EvalFBXAnim : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
 
     virtual void apply() override {
         int frameid;
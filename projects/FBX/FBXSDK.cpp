@@ -734,6 +734,10 @@ ZENDEFNODE(NewFBXImportSkeleton, {
 });
 
 struct NewFBXImportAnimation : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     virtual void apply() override {
         int frameid;
         if (has_input("frameid")) {
@@ -916,6 +920,10 @@ ZENDEFNODE(NewFBXImportAnimation, {
 });
 
 struct NewFBXImportCamera : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     virtual void apply() override {
         int frameid;
         if (has_input("frameid")) {
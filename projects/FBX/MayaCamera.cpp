@@ -141,6 +141,9 @@ ZENO_DEFNODE(CameraNode)({
 });
 
 struct CameraEval: zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
 
     glm::quat to_quat(zeno::vec3f up, zeno::vec3f view){
         auto glm_view = -1.0f * glm::normalize(glm::vec3(view[0], view[1], view[2]));
@@ -347,6 +350,10 @@ ZENO_DEFNODE(DirtyTBN)({
 });
 
 struct LiveMeshNode : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     typedef std::vector<std::vector<float>> UVS;
     typedef std::vector<std::vector<float>> VERTICES;
     typedef std::vector<int> VERTEX_COUNT;
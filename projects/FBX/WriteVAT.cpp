@@ -314,6 +314,10 @@ static vector<vector<vec3f>> read_vat(const std::string &path) {
 }
 
 struct WriteCustomVAT : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     std::vector<std::shared_ptr<PrimitiveObject>> prims;
     virtual void apply() override {
         int frameid;
@@ -464,6 +468,10 @@ ZENDEFNODE(WriteCustomVAT, {
 });
 
 struct ReadCustomVAT : INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
     vector<vector<vec3f>> v;
     virtual void apply() override {
         if (v.empty()) {
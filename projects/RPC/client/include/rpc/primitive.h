@@ -0,0 +1,30 @@
+#pragma once
+
+#include <event/event_bus.pb.h>
+#include <event/event_bus.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+
+#include <string>
+
+#include "zeno/types/PrimitiveObject.h"
+
+/**
+ * @brief Convert a native PrimitiveObject to Protobuf.
+ *
+ * @param Primitive Primitive to convert.
+ * @param OutObject Protobuf object receiving the attributes.
+ * @param bPacked Write every attribute as a single PackedNumeric blob instead of one GenericNumeric per element.
+ *                The per element encoding has no vec4f, such attributes are left out of it.
+ */
+void ToProtobuf(const zeno::PrimitiveObject& Primitive, zeno::event::PrimitiveObject* OutObject, bool bPacked = true);
+
+/**
+ * @brief Send a primitive through PushPrimitiveStream.
+ *
+ * The packed attribute bytes are sliced straight out of the primitive into chunks of at most ChunkBytes,
+ * so no message ever holds the whole primitive and no size limit is hit.
+ *
+ * @return Status of the call, Response holds the server status when it is ok.
+ */
+grpc::Status StreamPrimitive(zeno::event::EventBus::Stub& Stub, grpc::ClientContext* Context, const std::string& Channel, const std::string& Name,
+                             const zeno::PrimitiveObject& Primitive, zeno::event::PutPrimitiveObjectResponse* Response, size_t ChunkBytes = 1 << 20);
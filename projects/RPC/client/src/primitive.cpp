@@ -0,0 +1,169 @@
+#include "rpc/primitive.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace {
+
+template <typename ValueType>
+constexpr zeno::common::NumericType NumericTypeOf() {
+    if constexpr (std::is_same_v<ValueType, float>) return zeno::common::NUMERIC_FLOAT;
+    else if constexpr (std::is_same_v<ValueType, int>) return zeno::common::NUMERIC_INT32;
+    else if constexpr (std::is_same_v<ValueType, zeno::vec2f>) return zeno::common::NUMERIC_VECTOR2F;
+    else if constexpr (std::is_same_v<ValueType, zeno::vec3f>) return zeno::common::NUMERIC_VECTOR3F;
+    else if constexpr (std::is_same_v<ValueType, zeno::vec4f>) return zeno::common::NUMERIC_VECTOR4F;
+    else if constexpr (std::is_same_v<ValueType, zeno::vec2i>) return zeno::common::NUMERIC_POINT2I;
+    else if constexpr (std::is_same_v<ValueType, zeno::vec3i>) return zeno::common::NUMERIC_POINT3I;
+    else return zeno::common::NUMERIC_POINT4I;
+}
+
+/**
+ * @brief Set one element of the per element encoding, returns false for types it cannot carry.
+ */
+template <typename ValueType>
+bool SetGenericNumeric(zeno::common::GenericNumeric* Numeric, const ValueType& Value) {
+    if constexpr (std::is_same_v<ValueType, float>) {
+        Numeric->set_floatvalue(Value);
+    } else if constexpr (std::is_same_v<ValueType, int>) {
+        Numeric->set_int32value(Value);
+    } else if constexpr (std::is_same_v<ValueType, zeno::vec2f>) {
+        auto* V = Numeric->mutable_vector2fvalue();
+        V->set_x(Value[0]); V->set_y(Value[1]);
+    } else if constexpr (std::is_same_v<ValueType, zeno::vec3f>) {
+        auto* V = Numeric->mutable_vector3fvalue();
+        V->set_x(Value[0]); V->set_y(Value[1]); V->set_z(Value[2]);
+    } else if constexpr (std::is_same_v<ValueType, zeno::vec2i>) {
+        auto* V = Numeric->mutable_point2ivalue();
+        V->set_x(Value[0]); V->set_y(Value[1]);
+    } else if constexpr (std::is_same_v<ValueType, zeno::vec3i>) {
+        auto* V = Numeric->mutable_point3ivalue();
+        V->set_x(Value[0]); V->set_y(Value[1]); V->set_z(Value[2]);
+    } else if constexpr (std::is_same_v<ValueType, zeno::vec4i>) {
+        auto* V = Numeric->mutable_point4ivalue();
+        V->set_x(Value[0]); V->set_y(Value[1]); V->set_z(Value[2]); V->set_w(Value[3]);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template <typename ValueType>
+void PackHelper(const std::vector<ValueType>& Values, zeno::event::AttributeList& OutList, bool bPacked) {
+    if (bPacked) {
+        zeno::common::PackedNumeric* Packed = OutList.mutable_packed();
+        Packed->set_type(NumericTypeOf<ValueType>());
+        Packed->mutable_data()->assign(reinterpret_cast<const char*>(Values.data()), Values.size() * sizeof(ValueType));
+        return;
+    }
+    OutList.mutable_numericpack()->Reserve(Values.size());
+    for (const ValueType& Value : Values) {
+        if (!SetGenericNumeric(OutList.add_numericpack(), Value)) return;
+    }
+}
+
+/**
+ * @brief Visit "pos" and every attribute of a container as (name, values).
+ */
+template <typename ContainerType, typename Func>
+void ForEachAttr(const ContainerType& Container, Func&& Callback) {
+    Callback(std::string("pos"), Container.values);
+    Container.template foreach_attr<zeno::AttrAcceptAll>([&] (const std::string& AttrName, const auto& Values) {
+        Callback(AttrName, Values);
+    });
+}
+
+template <typename ContainerType>
+void PackGroup(const ContainerType& Container, zeno::event::AttributeGroup* OutGroup, bool bPacked) {
+    if (Container.size() == 0) return;
+    ForEachAttr(Container, [&] (const std::string& AttrName, const auto& Values) {
+        using ValueType = typename std::decay_t<decltype(Values)>::value_type;
+        if (!bPacked && std::is_same_v<ValueType, zeno::vec4f>) return;
+        PackHelper(Values, (*OutGroup->mutable_attributes())[AttrName], bPacked);
+    });
+}
+
+/**
+ * @brief Slices the packed attributes of a primitive into stream chunks without building the whole message.
+ */
+class ChunkWriter {
+public:
+    ChunkWriter(grpc::ClientWriter<zeno::event::PrimitiveObjectChunk>& InWriter, const std::string& Channel, const std::string& Name, size_t InChunkBytes)
+        : Writer(InWriter), ChunkBytes(std::max<size_t>(InChunkBytes, 1)) {
+        Chunk.set_channel(Channel);
+        Chunk.set_name(Name);
+    }
+
+    template <typename ContainerType>
+    void WriteGroup(const ContainerType& Container, zeno::event::AttributeGroup* (zeno::event::PrimitiveObject::*GetGroup)()) {
+        if (Container.size() == 0) return;
+        ForEachAttr(Container, [&] (const std::string& AttrName, const auto& Values) {
+            if (bFailed) return;
+            using ValueType = typename std::decay_t<decltype(Values)>::value_type;
+            const char* Bytes = reinterpret_cast<const char*>(Values.data());
+            const size_t Size = Values.size() * sizeof(ValueType);
+            for (size_t Offset = 0; Offset < Size;) {
+                const size_t Length = std::min(Size - Offset, ChunkBytes - Pending);
+                zeno::common::PackedNumeric* Packed = (*(Chunk.mutable_part()->*GetGroup)()->mutable_attributes())[AttrName].mutable_packed();
+                Packed->set_type(NumericTypeOf<ValueType>());
+                Packed->mutable_data()->append(Bytes + Offset, Length);
+                Offset += Length;
+                Pending += Length;
+                if (Pending == ChunkBytes && !Flush()) return;
+            }
+        });
+    }
+
+    /**
+     * @brief Send what is pending. An empty primitive still sends one chunk so the server learns its name.
+     */
+    bool Flush() {
+        if (Pending == 0 && bWritten) return !bFailed;
+        Pending = 0;
+        bWritten = true;
+        bFailed = bFailed || !Writer.Write(Chunk);
+        Chunk.mutable_part()->Clear();
+        return !bFailed;
+    }
+
+private:
+    grpc::ClientWriter<zeno::event::PrimitiveObjectChunk>& Writer;
+    zeno::event::PrimitiveObjectChunk Chunk;
+    const size_t ChunkBytes;
+    size_t Pending = 0;
+    bool bWritten = false;
+    bool bFailed = false;
+};
+
+}
+
+void ToProtobuf(const zeno::PrimitiveObject& Primitive, zeno::event::PrimitiveObject* OutObject, bool bPacked) {
+    PackGroup(Primitive.verts, OutObject->mutable_vertices(), bPacked);
+    PackGroup(Primitive.points, OutObject->mutable_points(), bPacked);
+    PackGroup(Primitive.lines, OutObject->mutable_lines(), bPacked);
+    PackGroup(Primitive.tris, OutObject->mutable_triangles(), bPacked);
+    PackGroup(Primitive.quads, OutObject->mutable_quadratics(), bPacked);
+    PackGroup(Primitive.loops, OutObject->mutable_loops(), bPacked);
+    PackGroup(Primitive.polys, OutObject->mutable_polys(), bPacked);
+    PackGroup(Primitive.edges, OutObject->mutable_edges(), bPacked);
+    PackGroup(Primitive.uvs, OutObject->mutable_texturecoords(), bPacked);
+}
+
+grpc::Status StreamPrimitive(zeno::event::EventBus::Stub& Stub, grpc::ClientContext* Context, const std::string& Channel, const std::string& Name,
+                             const zeno::PrimitiveObject& Primitive, zeno::event::PutPrimitiveObjectResponse* Response, size_t ChunkBytes) {
+    using zeno::event::PrimitiveObject;
+    std::unique_ptr<grpc::ClientWriter<zeno::event::PrimitiveObjectChunk>> Writer = Stub.PushPrimitiveStream(Context, Response);
+
+    ChunkWriter Chunks(*Writer, Channel, Name, ChunkBytes);
+    Chunks.WriteGroup(Primitive.verts, &PrimitiveObject::mutable_vertices);
+    Chunks.WriteGroup(Primitive.points, &PrimitiveObject::mutable_points);
+    Chunks.WriteGroup(Primitive.lines, &PrimitiveObject::mutable_lines);
+    Chunks.WriteGroup(Primitive.tris, &PrimitiveObject::mutable_triangles);
+    Chunks.WriteGroup(Primitive.quads, &PrimitiveObject::mutable_quadratics);
+    Chunks.WriteGroup(Primitive.loops, &PrimitiveObject::mutable_loops);
+    Chunks.WriteGroup(Primitive.polys, &PrimitiveObject::mutable_polys);
+    Chunks.WriteGroup(Primitive.edges, &PrimitiveObject::mutable_edges);
+    Chunks.WriteGroup(Primitive.uvs, &PrimitiveObject::mutable_texturecoords);
+    Chunks.Flush();
+
+    Writer->WritesDone();
+    return Writer->Finish();
+}
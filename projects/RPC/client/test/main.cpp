@@ -7,7 +7,115 @@
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/create_channel.h>
 
+#include <rpc/primitive.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(Clock::time_point Start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+    }
+
+    /**
+     * @brief A Side x Side grid with positions, normals, uvs and triangles, close to what a DCC pushes.
+     */
+    zeno::PrimitiveObject MakeGrid(int Side) {
+        zeno::PrimitiveObject Prim;
+        Prim.verts.resize(size_t(Side) * Side);
+        auto& Normals = Prim.verts.add_attr<zeno::vec3f>("nrm");
+        auto& UVs = Prim.verts.add_attr<zeno::vec3f>("uv");
+        for (int Y = 0; Y < Side; ++Y) {
+            for (int X = 0; X < Side; ++X) {
+                const size_t Index = size_t(Y) * Side + X;
+                Prim.verts[Index] = zeno::vec3f(float(X), std::sin(X * 0.1f) * std::cos(Y * 0.1f), float(Y));
+                Normals[Index] = zeno::vec3f(0, 1, 0);
+                UVs[Index] = zeno::vec3f(float(X) / Side, float(Y) / Side, 0);
+            }
+        }
+        for (int Y = 0; Y + 1 < Side; ++Y) {
+            for (int X = 0; X + 1 < Side; ++X) {
+                const int Index = Y * Side + X;
+                Prim.tris.emplace_back(Index, Index + 1, Index + Side);
+                Prim.tris.emplace_back(Index + 1, Index + Side + 1, Index + Side);
+            }
+        }
+        return Prim;
+    }
+
+    bool PushUnary(zeno::event::EventBus::Stub& Stub, const zeno::PrimitiveObject& Prim, bool bPacked) {
+        zeno::event::PutPrimitiveObjectQuery Query;
+        zeno::event::PutPrimitiveObjectResponse Response;
+        Query.set_channel("storage");
+
+        auto Start = Clock::now();
+        ToProtobuf(Prim, &(*Query.mutable_primitives())["bench"], bPacked);
+        const double EncodeTime = MillisecondsSince(Start);
+        const size_t Bytes = Query.ByteSizeLong();
+
+        Start = Clock::now();
+        grpc::ClientContext Context;
+        grpc::Status Status = Stub.PushPrimitiveNotify(&Context, Query, &Response);
+        const double CallTime = MillisecondsSince(Start);
+
+        std::cout << (bPacked ? "packed unary " : "legacy unary ") << "encode " << EncodeTime << "ms, " << Bytes << " bytes, rpc " << CallTime << "ms";
+        if (!Status.ok()) {
+            std::cout << ", failed: " << Status.error_message() << std::endl;
+            return false;
+        }
+        std::cout << ", status " << Response.status() << std::endl;
+        return true;
+    }
+
+    bool PushStream(zeno::event::EventBus::Stub& Stub, const zeno::PrimitiveObject& Prim) {
+        zeno::event::PutPrimitiveObjectResponse Response;
+
+        auto Start = Clock::now();
+        grpc::ClientContext Context;
+        grpc::Status Status = StreamPrimitive(Stub, &Context, "storage", "bench", Prim, &Response);
+        const double CallTime = MillisecondsSince(Start);
+
+        std::cout << "packed stream rpc " << CallTime << "ms";
+        if (!Status.ok()) {
+            std::cout << ", failed: " << Status.error_message() << std::endl;
+            return false;
+        }
+        std::cout << ", status " << Response.status() << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief Push the same mesh with every encoding to a running editor, "RPCTest bench [verts]".
+     */
+    int RunBenchmark(int Argc, char* Argv[]) {
+        const int Verts = Argc > 2 ? std::stoi(Argv[2]) : 1000000;
+        const int Side = std::max(2, int(std::sqrt(double(Verts))));
+        zeno::PrimitiveObject Prim = MakeGrid(Side);
+        std::cout << "Mesh: " << Prim.verts.size() << " verts, " << Prim.tris.size() << " tris" << std::endl;
+
+        grpc::ChannelArguments Args;
+        Args.SetMaxSendMessageSize(-1);
+        auto Channel = grpc::CreateCustomChannel("localhost:25561", grpc::InsecureChannelCredentials(), Args);
+        std::unique_ptr<zeno::event::EventBus::Stub> Stub = zeno::event::EventBus::NewStub(Channel);
+
+        bool bOk = PushUnary(*Stub, Prim, false);
+        bOk = PushUnary(*Stub, Prim, true) && bOk;
+        bOk = PushStream(*Stub, Prim) && bOk;
+        return bOk ? 0 : 1;
+    }
+
+}
+
 int main(int Argc, char* Argv[]) {
+    if (Argc > 1 && std::strcmp(Argv[1], "bench") == 0) {
+        return RunBenchmark(Argc, Argv);
+    }
+
     zeno::event::PutPrimitiveObjectQuery Query;
     zeno::event::PutPrimitiveObjectResponse Response;
 
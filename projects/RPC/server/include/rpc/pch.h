@@ -7,6 +7,17 @@
 
 std::vector<std::shared_ptr<grpc::Service>>& GetRPCServiceList();
 
+/**
+ * Largest single message the server receives, ZENO_RPC_MAX_MESSAGE_MB megabytes, 64 by default.
+ * Primitives bigger than that are sent through PushPrimitiveStream.
+ */
+int GetRPCMaxMessageBytes();
+
+/**
+ * Largest total one PushPrimitiveStream call may send, ZENO_RPC_MAX_STREAM_MB megabytes, 4096 by default.
+ */
+size_t GetRPCMaxStreamBytes();
+
 /**
  * Example:
  *
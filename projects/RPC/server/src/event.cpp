@@ -3,6 +3,8 @@
 #include <zeno/extra/EventCallbacks.h>
 #include <zeno/zeno.h>
 #include <cassert>
+#include <cstring>
+#include <map>
 
 static char* NAME_RPC_INCOMING_PRIMITIVE = "rpcIncomingPrimitive";
 
@@ -32,6 +34,39 @@ static char* NAME_RPC_INCOMING_PRIMITIVE = "rpcIncomingPrimitive";
     return grpc::Status::OK;
 }
 
+::grpc::Status EventBusService::PushPrimitiveStream(::grpc::ServerContext *context, ::grpc::ServerReader<::zeno::event::PrimitiveObjectChunk> *reader, ::zeno::event::PutPrimitiveObjectResponse *response) {
+    std::map<std::string, std::pair<std::string, zeno::event::PrimitiveObject>> Assembled;
+    try {
+        zeno::event::PrimitiveObjectChunk Chunk;
+        const size_t MaxBytes = GetRPCMaxStreamBytes();
+        size_t ReceivedBytes = 0;
+        while (reader->Read(&Chunk)) {
+            ReceivedBytes += Chunk.ByteSizeLong();
+            if (ReceivedBytes > MaxBytes) {
+                std::cout << "[RPC] Primitive stream exceeds " << (MaxBytes >> 20) << "MB, rejected." << std::endl;
+                response->set_status(zeno::common::BAD_REQUEST_BODY);
+                return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "primitive stream exceeds the server limit");
+            }
+            auto& [Channel, Object] = Assembled[Chunk.name()];
+            Channel = Chunk.channel();
+            AppendPrimitiveChunk(Object, Chunk.mutable_part());
+        }
+        for (auto& [Name, Value] : Assembled) {
+            std::shared_ptr<zeno::PrimitiveObject> Primitive = FromProtobuf(&Value.second);
+            // the received bytes are copied into the primitive, drop them before the next one
+            Value.second.Clear();
+            zeno::getSession().eventCallbacks->triggerEvent2(NAME_RPC_INCOMING_PRIMITIVE, std::any(NamedPrimitiveObject { Value.first, Name, Primitive }) );
+        }
+    } catch (const std::runtime_error& Err) {
+        std::cout << Err.what() << std::endl;
+        response->set_status(zeno::common::BAD_REQUEST_BODY);
+        return grpc::Status::CANCELLED;
+    }
+
+    response->set_status(zeno::common::SUCCESS);
+    return grpc::Status::OK;
+}
+
 inline constexpr bool CheckIsSameType(int32_t &Lhs, const int32_t Rhs) {
     if (Lhs == -1) {
         Lhs = Rhs;
@@ -68,8 +103,9 @@ void InsertHelper(const ValueType& Value, ContainerType& Container, const std::s
     if (!CheckIsSameType(InTypeCheck, ValueTypeId)) {
         throw std::runtime_error("It must be same types in an array");
     }
-    if (Container.has_attr(AttrName)) Container.add_attr<ValueType>(AttrName);
-    Container.attr<ValueType>(AttrName).push_back(Value);
+    // start new attributes empty, they grow element by element alongside pos
+    if (!Container.has_attr(AttrName)) Container.attrs[AttrName] = std::vector<ValueType>();
+    Container.template attr<ValueType>(AttrName).push_back(Value);
 }
 
 /**
@@ -83,6 +119,7 @@ template <typename AttrListType, typename ContainerType>
 void UnpackHelper(AttrListType& AttrList, ContainerType& Conatiner) {
     for (const auto &Attr: AttrList) {
         const std::string &AttrName = Attr.first;
+        if (Attr.second.has_packed()) continue;
         if (Attr.second.numericpack_size() > Conatiner.size()) Conatiner.reserve(Attr.second.numericpack_size());
         int32_t Type = -1;
         for (const auto &Data: Attr.second.numericpack()) {
@@ -105,6 +142,66 @@ void UnpackHelper(AttrListType& AttrList, ContainerType& Conatiner) {
     }
 }
 
+/**
+ * @brief Copy one packed attribute into a container in a single memcpy.
+ *
+ * "pos" is the container's own values and sets its size, every other attribute must have
+ * exactly that many elements.
+ */
+template <typename ValueType, typename ContainerType>
+void AssignPacked(const std::string& Bytes, ContainerType& Container, const std::string& AttrName) {
+    if (Bytes.size() % sizeof(ValueType) != 0) {
+        throw std::runtime_error("Packed attribute " + AttrName + " is not a whole number of elements");
+    }
+    const size_t Count = Bytes.size() / sizeof(ValueType);
+    ValueType* Target = nullptr;
+    if (AttrName == "pos") {
+        if constexpr (std::is_same_v<ValueType, typename ContainerType::value_type>) {
+            Container.resize(Count);
+            Target = Container.values.data();
+        } else {
+            throw std::runtime_error("Packed attribute pos has the wrong type");
+        }
+    } else {
+        if (Count != Container.size()) {
+            throw std::runtime_error("Packed attribute " + AttrName + " has " + std::to_string(Count) + " elements, expected " + std::to_string(Container.size()));
+        }
+        Target = Container.template add_attr<ValueType>(AttrName).data();
+    }
+    // both sides are little-endian, the only byte order zeno runs on
+    if (Count) std::memcpy(Target, Bytes.data(), Bytes.size());
+}
+
+template <typename ContainerType>
+void AssignPacked(const zeno::common::PackedNumeric& Packed, ContainerType& Container, const std::string& AttrName) {
+    switch (Packed.type()) {
+        case zeno::common::NUMERIC_FLOAT: AssignPacked<float>(Packed.data(), Container, AttrName); break;
+        case zeno::common::NUMERIC_INT32: AssignPacked<int>(Packed.data(), Container, AttrName); break;
+        case zeno::common::NUMERIC_VECTOR2F: AssignPacked<zeno::vec2f>(Packed.data(), Container, AttrName); break;
+        case zeno::common::NUMERIC_VECTOR3F: AssignPacked<zeno::vec3f>(Packed.data(), Container, AttrName); break;
+        case zeno::common::NUMERIC_VECTOR4F: AssignPacked<zeno::vec4f>(Packed.data(), Container, AttrName); break;
+        case zeno::common::NUMERIC_POINT2I: AssignPacked<zeno::vec2i>(Packed.data(), Container, AttrName); break;
+        case zeno::common::NUMERIC_POINT3I: AssignPacked<zeno::vec3i>(Packed.data(), Container, AttrName); break;
+        case zeno::common::NUMERIC_POINT4I: AssignPacked<zeno::vec4i>(Packed.data(), Container, AttrName); break;
+        default: throw std::runtime_error("Packed attribute " + AttrName + " has an unknown type");
+    }
+}
+
+/**
+ * @brief Decode the packed attributes of a group, "pos" first since it sizes the container.
+ */
+template <typename AttrListType, typename ContainerType>
+void UnpackPackedHelper(AttrListType& AttrList, ContainerType& Container) {
+    auto Pos = AttrList.find("pos");
+    if (Pos != AttrList.end() && Pos->second.has_packed()) {
+        AssignPacked(Pos->second.packed(), Container, Pos->first);
+    }
+    for (const auto &Attr: AttrList) {
+        if (!Attr.second.has_packed() || Attr.first == "pos") continue;
+        AssignPacked(Attr.second.packed(), Container, Attr.first);
+    }
+}
+
 /**
  * @brief Convert a Protobuf PrimitiveObject to native format.
  *
@@ -132,6 +229,16 @@ std::shared_ptr<zeno::PrimitiveObject> FromProtobuf(const zeno::event::Primitive
 
     using namespace zeno::event;
 
+    UnpackPackedHelper(Object->vertices().attributes(), Vertices);
+    UnpackPackedHelper(Object->points().attributes(), Points);
+    UnpackPackedHelper(Object->lines().attributes(), Lines);
+    UnpackPackedHelper(Object->triangles().attributes(), Triangles);
+    UnpackPackedHelper(Object->quadratics().attributes(), Quadratics);
+    UnpackPackedHelper(Object->loops().attributes(), Loops);
+    UnpackPackedHelper(Object->polys().attributes(), Polys);
+    UnpackPackedHelper(Object->edges().attributes(), Edges);
+    UnpackPackedHelper(Object->texturecoords().attributes(), TextureCoords);
+
     UnpackHelper(Object->vertices().attributes(), Vertices);
     UnpackHelper(Object->points().attributes(), Points);
     UnpackHelper(Object->lines().attributes(), Lines);
@@ -145,6 +252,43 @@ std::shared_ptr<zeno::PrimitiveObject> FromProtobuf(const zeno::event::Primitive
     return NewPrimitive;
 }
 
+void AppendAttributeGroup(zeno::event::AttributeGroup* Target, zeno::event::AttributeGroup* Chunk) {
+    for (auto& [Name, List] : *Chunk->mutable_attributes()) {
+        zeno::event::AttributeList& TargetList = (*Target->mutable_attributes())[Name];
+        if (List.has_packed()) {
+            zeno::common::PackedNumeric* Packed = TargetList.mutable_packed();
+            std::string* Data = Packed->mutable_data();
+            if (Data->empty()) {
+                Packed->set_type(List.packed().type());
+                Data->swap(*List.mutable_packed()->mutable_data());
+            } else if (Packed->type() != List.packed().type()) {
+                throw std::runtime_error("Chunks of attribute " + Name + " have different types");
+            } else {
+                Data->append(List.packed().data());
+            }
+        }
+        TargetList.mutable_numericpack()->MergeFrom(List.numericpack());
+    }
+}
+
+/**
+ * @brief Join a chunk of a streamed primitive to what arrived before it.
+ *
+ * Packed data is concatenated byte for byte, so chunks may split an element.
+ * The chunk is left empty.
+ */
+void AppendPrimitiveChunk(zeno::event::PrimitiveObject& Target, zeno::event::PrimitiveObject* Chunk) {
+    AppendAttributeGroup(Target.mutable_vertices(), Chunk->mutable_vertices());
+    AppendAttributeGroup(Target.mutable_points(), Chunk->mutable_points());
+    AppendAttributeGroup(Target.mutable_lines(), Chunk->mutable_lines());
+    AppendAttributeGroup(Target.mutable_triangles(), Chunk->mutable_triangles());
+    AppendAttributeGroup(Target.mutable_quadratics(), Chunk->mutable_quadratics());
+    AppendAttributeGroup(Target.mutable_loops(), Chunk->mutable_loops());
+    AppendAttributeGroup(Target.mutable_polys(), Chunk->mutable_polys());
+    AppendAttributeGroup(Target.mutable_edges(), Chunk->mutable_edges());
+    AppendAttributeGroup(Target.mutable_texturecoords(), Chunk->mutable_texturecoords());
+}
+
 void PrimitiveStorageCallback(std::optional<std::any> Args) {
     if (Args.has_value() && Args->has_value()) {
         if (const NamedPrimitiveObject* Value = std::any_cast<NamedPrimitiveObject>(&Args.value())) {
@@ -13,11 +13,14 @@ class EventBusService final : public zeno::event::EventBus::Service {
 public:
     ::grpc::Status TriggerEvent(::grpc::ServerContext *context, const ::zeno::event::TriggerEventQuery *request, ::zeno::event::TriggerEventResponse *response) override;
     ::grpc::Status PushPrimitiveNotify(::grpc::ServerContext *context, const ::zeno::event::PutPrimitiveObjectQuery *request, ::zeno::event::PutPrimitiveObjectResponse *response) override;
+    ::grpc::Status PushPrimitiveStream(::grpc::ServerContext *context, ::grpc::ServerReader<::zeno::event::PrimitiveObjectChunk> *reader, ::zeno::event::PutPrimitiveObjectResponse *response) override;
 };
 
 
 std::shared_ptr<zeno::PrimitiveObject> FromProtobuf(const zeno::event::PrimitiveObject* Object);
 
+void AppendPrimitiveChunk(zeno::event::PrimitiveObject& Target, zeno::event::PrimitiveObject* Chunk);
+
 struct NamedPrimitiveObject {
     std::string Channel;
     std::string Name;
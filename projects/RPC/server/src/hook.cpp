@@ -1,10 +1,12 @@
 
 #include "rpc/pch.h"
+#include <algorithm>
 #include <chrono>
 #include <grpcpp/server_builder.h>
 #include <optional>
 #include <thread>
 #include <zeno/extra/EventCallbacks.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/zeno.h>
 
 namespace {
@@ -15,6 +17,8 @@ namespace {
     void StartRPCServer(std::vector<std::shared_ptr<grpc::Service>>* Services) {
         grpc::ServerBuilder Builder;
         Builder.AddListeningPort("0.0.0.0:25561", grpc::InsecureServerCredentials());
+        // The port takes any peer, so no message may grow without bound, big meshes are streamed instead
+        Builder.SetMaxReceiveMessageSize(GetRPCMaxMessageBytes());
         // Builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::NUM_CQS, 4);
 
         if (Services->empty()) {
@@ -53,6 +57,16 @@ namespace {
         });
 }
 
+int GetRPCMaxMessageBytes() {
+    static const int MaxBytes = int(std::clamp(zeno::envconfig::getUint64("RPC_MAX_MESSAGE_MB", 64), uint64_t(1), uint64_t(2047)) << 20);
+    return MaxBytes;
+}
+
+size_t GetRPCMaxStreamBytes() {
+    static const size_t MaxBytes = size_t(std::max(zeno::envconfig::getUint64("RPC_MAX_STREAM_MB", 4096), uint64_t(1))) << 20;
+    return MaxBytes;
+}
+
 std::vector<std::shared_ptr<grpc::Service>>& GetRPCServiceList() {
     static std::vector<std::shared_ptr<grpc::Service>> RPCServices {};
     return RPCServices;
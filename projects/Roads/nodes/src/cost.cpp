@@ -46,6 +46,8 @@ namespace zeno::reflect {
 
     struct PathAlgorithmTypeInput : std::string {
         using std::string::string;
+
+        explicit PathAlgorithmTypeInput(std::string In) : std::string(std::move(In)) {}
     };
 
     template<>
@@ -55,7 +57,7 @@ namespace zeno::reflect {
 
     template<>
     struct ValueTypeToString<PathAlgorithmTypeInput> {
-        inline static std::string TypeName = "enum Dijkstra A*";
+        inline static std::string TypeName = "enum A* Dijkstra BidirectionalDijkstra";
     };
 
 }// namespace zeno::reflect
@@ -229,6 +231,13 @@ namespace {
         bool bRemoveTriangles;
         ZENO_DECLARE_INPUT_FIELD(bRemoveTriangles, "Remove Triangles", false, "", "true");
 
+        zeno::reflect::PathAlgorithmTypeInput PathAlgorithm;
+        ZENO_DECLARE_INPUT_FIELD(PathAlgorithm, "Path Algorithm", false, "", "A*");
+
+        // Every line is one more path to solve, from its first vertex to its second, grid coordinates in pos.x and pos.y
+        std::shared_ptr<zeno::PrimitiveObject> ExtraQueries = nullptr;
+        ZENO_DECLARE_INPUT_FIELD(ExtraQueries, "Extra Queries", true);
+
         int Nx = 0;
         ZENO_BINDING_PRIMITIVE_USERDATA(Primitive, Nx, SizeXChannel, false);
 
@@ -246,107 +255,166 @@ namespace {
 
         //std::unordered_map<size_t, float> CurvatureCache;
 
-        void apply() override {
-            RoadsAssert(AutoParameter->Nx * AutoParameter->Ny <= AutoParameter->GradientList.size(), "Bad nx ny.");
-
-            CostPoint GoalPoint{static_cast<size_t>(AutoParameter->Goal[0]), static_cast<size_t>(AutoParameter->Goal[1]), 0};
-            CostPoint StartPoint{static_cast<size_t>(AutoParameter->Start[0]), static_cast<size_t>(AutoParameter->Start[1]), 0};
+        struct CurveCost {
+            const zeno::CurveObject *Curve = nullptr;
+            float Threshold = -1.0f;
 
-            DefaultedHashMap<CostPoint, CostPoint> Predecessor;
-            DefaultedHashMap<CostPoint, float> CostMap;
-
-            size_t Nx = AutoParameter->Nx, Ny = AutoParameter->Ny;
-
-            auto MapFuncGen = [](const std::shared_ptr<zeno::CurveObject> &Curve, float Threshold) -> std::function<float(float)> {
-                if (Curve) {
-                    return [Curve, Threshold](float In) -> float {
-                        if (Threshold > 0 && In > Threshold) {
-                            return 9e06f;
-                        }
-                        return Curve->eval(float(In));
-                    };
-                } else {
-                    zeno::log_warn("[Roads] Invalid Curve !");
-                    return [Threshold](float In) -> float {
-                        if (Threshold > 0 && In > Threshold) {
-                            return 9e06f;
-                        }
-                        return In;
-                    };
+            float operator()(float In) const {
+                if (Threshold > 0 && In > Threshold) {
+                    return 9e06f;
                 }
-            };
-
-            auto HeightCostFunc = MapFuncGen(AutoParameter->HeightCurve, -1.0f);
-            auto GradientCostFunc = MapFuncGen(AutoParameter->GradientCurve, -1.0f);
-            auto CurvatureCostFunc = MapFuncGen(AutoParameter->CurvatureCurve, AutoParameter->CurvatureThreshold);
-
-            DynamicGrid<CostPoint> CostGrid(AutoParameter->Nx, AutoParameter->Ny);
-            CostGrid.resize(AutoParameter->Nx * AutoParameter->Ny);
-            //#pragma omp parallel for
-            for (size_t i = 0; i < AutoParameter->Nx * AutoParameter->Ny; ++i) {
-                size_t x = i % AutoParameter->Nx;
-                size_t y = i / AutoParameter->Ny;
-                CostGrid[i] = (CostPoint{x, y, 0, AutoParameter->PositionList[i].at(1), AutoParameter->GradientList[i]});
+                return Curve ? Curve->eval(In) : In;
             }
 
-            auto CalcCurvature = [&CostGrid, Nx](const CostPoint &A, const CostPoint &B, const CostPoint &C) -> float {
-                float Height_A = float(CostGrid[A[0] + A[1] * Nx].Height);
-                float Height_B = float(CostGrid[B[0] + B[1] * Nx].Height);
-                float Height_C = float(CostGrid[C[0] + C[1] * Nx].Height);
-
-                Eigen::Vector4f BA = {float(A[0] - B[0]), float(A[1] - B[1]), float(Height_A - Height_B), float(A[2] - B[2])};
-                Eigen::Vector4f BC = {float(C[0] - B[0]), float(C[1] - B[1]), float(Height_C - Height_B), float(C[2] - B[2])};
-                float Magnitude_BC = BC.norm();
+            // Least cost over the inputs it gets (In >= 0), from the control points and a dense sampling between them.
+            // Between two samples a bezier segment may dip a little lower, so this is a lower bound up to the sampling.
+            float SampledMin() const {
+                if (!Curve) return 0.f;
+                const auto &Data = Curve->keys.at("x");
+                // A cyclic curve repeats its control range, a period past the last control point covers every value
+                const float Hi = std::max(0.f, Data.cpbases.back()) + (Data.cpbases.back() - Data.cpbases.front());
+                constexpr int NumSamples = 1024;
+                float Min = (*this)(0.f);
+                for (int i = 1; i <= NumSamples; ++i) {
+                    Min = std::min(Min, (*this)(Hi * float(i) / NumSamples));
+                }
+                for (float Base: Data.cpbases) {
+                    if (Base >= 0) Min = std::min(Min, (*this)(Base));
+                }
+                return Min;
+            }
+        };
+
+        // Called concurrently by the batch solver, only reads
+        struct EdgeCost {
+            const float *Height;
+            const float *Gradient;
+            int32_t Nx;
+            int32_t MaskA;
+            CurveCost HeightCost;
+            CurveCost GradientCost;
+            CurveCost CurvatureCost;
+
+            Eigen::Vector4f StateVector(size_t State) const {
+                const size_t Cell = State / MaskA;
+                return {float(Cell % Nx), float(Cell / Nx), Height[Cell], float(State % MaskA)};
+            }
 
-                Eigen::Vector4f BA_Normalized = BA.normalized();
-                Eigen::Vector4f BC_Normalized = BC.normalized();
+            float operator()(size_t Prev, size_t From, size_t To) const {
+                const size_t ia = From / MaskA;
+                const size_t ib = To / MaskA;
+
+                float Cost = HeightCost(std::abs(Height[ia] - Height[ib])) + GradientCost(std::abs(Gradient[ia] - Gradient[ib]));
+
+                // A path's first step has no direction to turn from
+                if (Prev != From) {
+                    const Eigen::Vector4f B = StateVector(From);
+                    const Eigen::Vector4f BA = StateVector(Prev) - B;
+                    const Eigen::Vector4f BC = StateVector(To) - B;
+                    const float Magnitude_BC = BC.norm();
+                    const float Magnitude_Change = (BC.normalized() - BA.normalized()).norm();
+                    const float Curvature = Magnitude_Change / (Magnitude_BC * Magnitude_BC) * BC.z();
+                    Cost += CurvatureCost(std::abs(Curvature));
+                }
 
-                float Magnitude_Change = (BC_Normalized - BA_Normalized).norm();
-                return Magnitude_Change / (Magnitude_BC * Magnitude_BC) * BC.z();
-            };
+                return Cost;
+            }
+        };
 
-            const size_t IndexMax = AutoParameter->Nx * AutoParameter->Ny - 1;
-            std::function<float(const CostPoint &, const CostPoint &)> CostFunc = [&CalcCurvature, &HeightCostFunc, &GradientCostFunc, &CurvatureCostFunc, &CostGrid, &Predecessor, IndexMax, Nx, Ny](const CostPoint &A, const CostPoint &B) mutable -> float {
-                size_t ia = A[0] + A[1] * Nx;
-                size_t ib = B[0] + B[1] * Nx;
+        void apply() override {
+            RoadsAssert(AutoParameter->Nx * AutoParameter->Ny <= AutoParameter->GradientList.size(), "Bad nx ny.");
+            RoadsAssert(AutoParameter->Nx * AutoParameter->Ny <= AutoParameter->PositionList.size(), "Bad nx ny.");
 
-                //constexpr size_t Seed = 12306;
-                //size_t Hash = (ia + 0x9e3779b9 + (Seed << 4) + (Seed >> 2)) ^ (ib * 0x9e3779b9 + (Seed << 2) + (Seed >> 4));
+            const int32_t Nx = AutoParameter->Nx, Ny = AutoParameter->Ny;
+            const size_t NumCells = size_t(Nx) * size_t(Ny);
 
-                // We assume that A already searched and have a predecessor
-                const CostPoint &PrevPoint = Predecessor[A];
+            for (const auto &[Curve, Name]: {std::make_pair(AutoParameter->HeightCurve, "Height"), std::make_pair(AutoParameter->GradientCurve, "Gradient"), std::make_pair(AutoParameter->CurvatureCurve, "Curvature")}) {
+                if (!Curve) {
+                    zeno::log_warn("[Roads] Invalid {} Curve !", Name);
+                }
+            }
 
-                // Calc curvature
-                float Curvature = CalcCurvature(PrevPoint, A, B);
+            // Cost field, flat so the solver reads it without going through the attribute arrays
+            ArrayList<float> Heights(NumCells);
+            ArrayList<float> Gradients(NumCells);
+#pragma omp parallel for
+            for (int64_t i = 0; i < int64_t(NumCells); ++i) {
+                Heights[i] = AutoParameter->PositionList[i].at(1);
+                Gradients[i] = AutoParameter->GradientList[i];
+            }
 
-                float Cost = HeightCostFunc(float(std::abs(CostGrid[ia].Height - CostGrid[ib].Height))) + GradientCostFunc(float(std::abs(CostGrid[ia].Gradient - CostGrid[ib].Gradient))) + CurvatureCostFunc(float(std::abs(Curvature)));
-                return Cost;
+            const EdgeCost CostFunc{
+                Heights.data(),
+                Gradients.data(),
+                Nx,
+                std::max(1, AutoParameter->AngleMask),
+                CurveCost{AutoParameter->HeightCurve.get()},
+                CurveCost{AutoParameter->GradientCurve.get()},
+                CurveCost{AutoParameter->CurvatureCurve.get(), AutoParameter->CurvatureThreshold},
             };
+            // The cheapest step A* may assume, the curves need not be monotone so their minimum need not be at 0
+            const float MinStepCost = std::max(0.f, CostFunc.HeightCost.SampledMin() + CostFunc.GradientCost.SampledMin() + std::min(0.f, CostFunc.CurvatureCost.SampledMin()));
+
+            energy::PathAlgorithm Algorithm = energy::PathAlgorithm::AStar;
+            if (AutoParameter->PathAlgorithm == "Dijkstra") {
+                Algorithm = energy::PathAlgorithm::Dijkstra;
+            } else if (AutoParameter->PathAlgorithm == "BidirectionalDijkstra") {
+                zeno::log_info("[Roads] Bidirectional search ignores the curvature cost.");
+                Algorithm = energy::PathAlgorithm::BidirectionalDijkstra;
+            }
 
-            zeno::log_info("[Roads] Generating trajectory...");
-
-            ROADS_TIMING_PRE_GENERATED;
+            const energy::PathGrid Grid{Nx, Ny, AutoParameter->ConnectiveMask, CostFunc.MaskA};
+
+            ArrayList<energy::PathQuery> Queries;
+            Queries.push_back({{int32_t(AutoParameter->Start[0]), int32_t(AutoParameter->Start[1])}, {int32_t(AutoParameter->Goal[0]), int32_t(AutoParameter->Goal[1])}});
+            if (AutoParameter->ExtraQueries) {
+                const auto &QueryPrim = *AutoParameter->ExtraQueries;
+                const auto IsInside = [&Grid](const std::array<int32_t, 2> &Cell) {
+                    return Cell[0] >= 0 && Cell[0] < Grid.Nx && Cell[1] >= 0 && Cell[1] < Grid.Ny;
+                };
+                // A bad extra query is dropped on its own, SolvePathBatch would throw away every path for it
+                for (size_t LineIdx = 0; LineIdx < QueryPrim.lines.size(); ++LineIdx) {
+                    const auto &Line = QueryPrim.lines[LineIdx];
+                    if (Line[0] < 0 || Line[1] < 0 || size_t(Line[0]) >= QueryPrim.verts.size() || size_t(Line[1]) >= QueryPrim.verts.size()) {
+                        zeno::log_warn("[Roads] Extra query {} refers to a missing point, skipped.", LineIdx);
+                        continue;
+                    }
+                    const vec3f &From = QueryPrim.verts[Line[0]];
+                    const vec3f &To = QueryPrim.verts[Line[1]];
+                    energy::PathQuery Query{{int32_t(From[0]), int32_t(From[1])}, {int32_t(To[0]), int32_t(To[1])}};
+                    if (!IsInside(Query.Start) || !IsInside(Query.Goal)) {
+                        zeno::log_warn("[Roads] Extra query {} starts or ends outside of the grid, skipped.", LineIdx);
+                        continue;
+                    }
+                    Queries.push_back(Query);
+                }
+            }
 
-            ROADS_TIMING_BLOCK("AStar Extended", roads::energy::RoadsShortestPath(StartPoint, GoalPoint, CostPoint{static_cast<size_t>(AutoParameter->Nx), static_cast<size_t>(AutoParameter->Ny)}, AutoParameter->ConnectiveMask, AutoParameter->AngleMask, AutoParameter->WeightHeuristic, Predecessor, CostMap, CostFunc));
+            zeno::log_info("[Roads] Generating trajectory...");
 
-            zeno::log_info("[Roads] Result Predecessor Size: {}; CostMap Size: {}", Predecessor.size(), CostMap.size());
+            ArrayList<energy::PathResult> Results;
 
-            CostPoint Current = GoalPoint;
+            ROADS_TIMING_PRE_GENERATED;
 
-            ArrayList<size_t> Path;
-            while (Current != StartPoint) {
-                Path.push_back(Current[0] + Current[1] * AutoParameter->Nx);
-                Current = Predecessor[Current];
-            }
-            Path.push_back(StartPoint[0] + StartPoint[1] * AutoParameter->Nx);
+            ROADS_TIMING_BLOCK("AStar Extended", Results = energy::SolvePathBatch(Grid, Queries, CostFunc, Algorithm, AutoParameter->WeightHeuristic, MinStepCost));
 
             if (AutoParameter->bRemoveTriangles) {
                 AutoParameter->Primitive->tris.clear();
             }
 
-            AutoParameter->Primitive->lines.resize(Path.size() - 1);
-            for (size_t i = 0; i < Path.size() - 1; ++i) {
-                AutoParameter->Primitive->lines[i] = zeno::vec2i(int(Path[i]), int(Path[i + 1]));
+            auto &Lines = AutoParameter->Primitive->lines;
+            Lines.clear();
+            for (size_t q = 0; q < Results.size(); ++q) {
+                const ArrayList<size_t> &Path = Results[q].Cells;
+                zeno::log_info("[Roads] Path {}: Cost {}; {} states expanded.", q, Results[q].Cost, Results[q].NumExpanded);
+                if (!Results[q].Found()) {
+                    zeno::log_warn("[Roads] Path {} can't reach its goal.", q);
+                    continue;
+                }
+
+                for (size_t i = 0; i + 1 < Path.size(); ++i) {
+                    Lines.push_back(zeno::vec2i(int(Path[i]), int(Path[i + 1])));
+                }
             }
         }
     };
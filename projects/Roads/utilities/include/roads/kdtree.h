@@ -3,40 +3,201 @@
 #include "Eigen/Dense"
 #include "pch.h"
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 
 namespace roads {
     using namespace Eigen;
 
-    struct KDTreeNode : std::enable_shared_from_this<KDTreeNode> {
-        VectorXf Point;
-        std::shared_ptr<KDTreeNode> Left;
-        std::shared_ptr<KDTreeNode> Right;
+    /**
+     * KD-tree stored implicitly in one array of fixed-size points.
+     * The node of the range [Lower, Upper) is the point at its middle, Lower + (Upper - Lower) / 2, split on axis Depth % Dim;
+     * its children are the ranges on either side. There are no node objects and searches don't allocate.
+     */
+    template<int Dim, typename ScalarType = float>
+    class KDTree {
+    public:
+        using PointType = Eigen::Matrix<ScalarType, Dim, 1>;
 
-        explicit KDTreeNode(VectorXf Value);
+        KDTree() = default;
 
-        virtual ~KDTreeNode() = default;
-    };
+        static KDTree BuildKdTree(const ArrayList<PointType> &Data);
 
-    class KDTree {
-        std::shared_ptr<KDTreeNode> Root = nullptr;
+        size_t Size() const { return Points.size(); }
 
-        static KDTreeNode* BuildKdTree_Impl(ArrayList<VectorXf> Data, int64_t Lower, int64_t Upper, uint32_t Depth);
+        /**
+         * Append the indices (into the data the tree was built from) of the points within Radius
+         */
+        void SearchRadius(const PointType &Point, ScalarType Radius, ArrayList<size_t> &OutIndices) const;
 
-        std::shared_ptr<KDTreeNode> Insert_Impl(const std::shared_ptr<KDTreeNode> &Node, VectorXf Point, uint32_t Depth);
+        ArrayList<PointType> SearchRadius(const PointType &Point, ScalarType Radius) const;
 
-        void SearchNode(KDTreeNode* Node, VectorXf Point, float Radius, ArrayList<VectorXf>& OutPoints, uint32_t Depth = 0);
+        /**
+         * @return index of the point closest to Point, -1 if the tree is empty
+         */
+        int64_t FindNearest(const PointType &Point, ScalarType *OutSquaredDistance = nullptr) const;
 
-    public:
-        void Insert(VectorXf Point);
+    private:
+        struct Range {
+            uint32_t Lower;
+            uint32_t Upper;
+            uint32_t Depth;
+            ScalarType MinSquaredDistance;
+        };
+        // A balanced tree over less than 2^32 points is at most 32 levels deep
+        using RangeStack = std::array<Range, 64>;
+
+        template<typename FuncType>
+        void ForEachInRadius(const PointType &Point, ScalarType Radius, FuncType &&Func) const;
 
-        ArrayList<VectorXf> SearchRadius(const VectorXf& Point, float Radius);
+        static void BuildRange(const ArrayList<PointType> &Data, ArrayList<uint32_t> &Order, uint32_t Lower, uint32_t Upper, uint32_t Depth);
 
-        static KDTree* BuildKdTree(const ArrayList<VectorXf>& Data);
+        // Points in tree order and where each one came from
+        ArrayList<PointType> Points;
+        ArrayList<uint32_t> SourceIndices;
     };
 
+    using KDTree2f = KDTree<2>;
+    using KDTree3f = KDTree<3>;
+
+    template<int Dim, typename ScalarType>
+    void KDTree<Dim, ScalarType>::BuildRange(const ArrayList<PointType> &Data, ArrayList<uint32_t> &Order, uint32_t Lower, uint32_t Upper, uint32_t Depth) {
+        while (Upper - Lower > 1) {
+            const uint32_t Axis = Depth % Dim;
+            const uint32_t Middle = Lower + (Upper - Lower) / 2;
+            std::nth_element(Order.begin() + Lower, Order.begin() + Middle, Order.begin() + Upper, [&Data, Axis](uint32_t a, uint32_t b) {
+                return Data[a][Axis] < Data[b][Axis];
+            });
+
+            // Big halves are split in parallel, the rest of the recursion stays on this thread
+            if (Middle - Lower > (1u << 16)) {
+#pragma omp task shared(Data, Order) firstprivate(Lower, Middle, Depth)
+                BuildRange(Data, Order, Lower, Middle, Depth + 1);
+            } else {
+                BuildRange(Data, Order, Lower, Middle, Depth + 1);
+            }
+
+            Lower = Middle + 1;
+            ++Depth;
+        }
+    }
+
+    template<int Dim, typename ScalarType>
+    KDTree<Dim, ScalarType> KDTree<Dim, ScalarType>::BuildKdTree(const ArrayList<PointType> &Data) {
+        if (Data.empty() || Data.size() >= std::numeric_limits<uint32_t>::max()) {
+            throw std::invalid_argument("[Roads] KdTree built with invalid arguments.");
+        }
+
+        ArrayList<uint32_t> Order(Data.size());
+        std::iota(Order.begin(), Order.end(), 0u);
+
+#pragma omp parallel shared(Data, Order)
+#pragma omp single
+        BuildRange(Data, Order, 0, uint32_t(Order.size()), 0);
+
+        KDTree NewTree;
+        NewTree.Points.resize(Order.size());
+        for (size_t i = 0; i < Order.size(); ++i) {
+            NewTree.Points[i] = Data[Order[i]];
+        }
+        NewTree.SourceIndices = std::move(Order);
+
+        return NewTree;
+    }
+
+    template<int Dim, typename ScalarType>
+    template<typename FuncType>
+    void KDTree<Dim, ScalarType>::ForEachInRadius(const PointType &Point, ScalarType Radius, FuncType &&Func) const {
+        const ScalarType SquaredRadius = Radius * Radius;
+
+        RangeStack Stack;
+        size_t Top = 0;
+        Stack[Top++] = Range{0, uint32_t(Points.size()), 0, 0};
+
+        while (Top > 0) {
+            const Range Current = Stack[--Top];
+            if (Current.Lower >= Current.Upper) continue;
+
+            const uint32_t Middle = Current.Lower + (Current.Upper - Current.Lower) / 2;
+            const uint32_t Axis = Current.Depth % Dim;
+            const PointType &Node = Points[Middle];
+
+            if ((Node - Point).squaredNorm() <= SquaredRadius) {
+                Func(Middle);
+            }
+
+            if (Node[Axis] >= Point[Axis] - Radius) {
+                Stack[Top++] = Range{Current.Lower, Middle, Current.Depth + 1, 0};
+            }
+            if (Node[Axis] <= Point[Axis] + Radius) {
+                Stack[Top++] = Range{Middle + 1, Current.Upper, Current.Depth + 1, 0};
+            }
+        }
+    }
+
+    template<int Dim, typename ScalarType>
+    void KDTree<Dim, ScalarType>::SearchRadius(const PointType &Point, ScalarType Radius, ArrayList<size_t> &OutIndices) const {
+        ForEachInRadius(Point, Radius, [this, &OutIndices](uint32_t Slot) {
+            OutIndices.push_back(SourceIndices[Slot]);
+        });
+    }
+
+    template<int Dim, typename ScalarType>
+    ArrayList<typename KDTree<Dim, ScalarType>::PointType> KDTree<Dim, ScalarType>::SearchRadius(const PointType &Point, ScalarType Radius) const {
+        ArrayList<PointType> Result;
+        ForEachInRadius(Point, Radius, [this, &Result](uint32_t Slot) {
+            Result.push_back(Points[Slot]);
+        });
+        return Result;
+    }
+
+    template<int Dim, typename ScalarType>
+    int64_t KDTree<Dim, ScalarType>::FindNearest(const PointType &Point, ScalarType *OutSquaredDistance) const {
+        int64_t Best = -1;
+        ScalarType BestSquaredDistance = std::numeric_limits<ScalarType>::max();
+
+        RangeStack Stack;
+        size_t Top = 0;
+        Stack[Top++] = Range{0, uint32_t(Points.size()), 0, 0};
+
+        while (Top > 0) {
+            const Range Current = Stack[--Top];
+            if (Current.Lower >= Current.Upper || Current.MinSquaredDistance >= BestSquaredDistance) continue;
+
+            const uint32_t Middle = Current.Lower + (Current.Upper - Current.Lower) / 2;
+            const uint32_t Axis = Current.Depth % Dim;
+            const PointType &Node = Points[Middle];
+
+            const ScalarType SquaredDistance = (Node - Point).squaredNorm();
+            if (SquaredDistance < BestSquaredDistance) {
+                BestSquaredDistance = SquaredDistance;
+                Best = Middle;
+            }
+
+            // The far side is pushed first so the near side is searched first and tightens the bound
+            const ScalarType Delta = Point[Axis] - Node[Axis];
+            const Range Left{Current.Lower, Middle, Current.Depth + 1, Delta < 0 ? 0 : Delta * Delta};
+            const Range Right{Middle + 1, Current.Upper, Current.Depth + 1, Delta < 0 ? Delta * Delta : 0};
+            if (Delta < 0) {
+                Stack[Top++] = Right;
+                Stack[Top++] = Left;
+            } else {
+                Stack[Top++] = Left;
+                Stack[Top++] = Right;
+            }
+        }
+
+        if (OutSquaredDistance) {
+            *OutSquaredDistance = BestSquaredDistance;
+        }
+
+        return Best < 0 ? -1 : int64_t(SourceIndices[Best]);
+    }
 
     class Octree {
     public:
@@ -0,0 +1,349 @@
+#pragma once
+
+#include "pch.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace roads::energy {
+
+    enum class PathAlgorithm {
+        AStar,
+        Dijkstra,
+        BidirectionalDijkstra,
+    };
+
+    /**
+     * Search space of the road planner.
+     * Cells are indexed row-major (x + y * Nx). A state is a cell entered at one of MaskA angle layers, indexed Cell * MaskA + Angle.
+     * A state reaches every angle layer of the cells (x + dx, y + dy) with |dx|, |dy| <= MaskK and gcd(|dx|, |dy|) == 1.
+     */
+    struct PathGrid {
+        int32_t Nx = 0;
+        int32_t Ny = 0;
+        int32_t MaskK = 1;
+        int32_t MaskA = 1;
+
+        size_t NumCells() const { return size_t(Nx) * size_t(Ny); }
+        size_t NumStates() const { return NumCells() * size_t(MaskA); }
+    };
+
+    struct PathQuery {
+        std::array<int32_t, 2> Start;
+        std::array<int32_t, 2> Goal;
+    };
+
+    struct PathResult {
+        // Cells from the goal back to the start, empty if the goal can't be reached
+        ArrayList<size_t> Cells;
+        float Cost = std::numeric_limits<float>::infinity();
+        size_t NumExpanded = 0;
+
+        bool Found() const { return !Cells.empty(); }
+    };
+
+    ArrayList<std::array<int32_t, 2>> BuildMaskOffsets(int32_t MaskK);
+
+    /**
+     * Shortest path search over a PathGrid with all bookkeeping in dense arrays.
+     *
+     * EdgeCost is called as EdgeCost(PrevState, FromState, ToState) and must return a non-negative cost. PrevState is
+     * the predecessor FromState was reached from, equal to FromState at the start of a path.
+     * The arrays are allocated on the first query and reused afterwards: a generation stamp tells which entries belong
+     * to the current query, so nothing is cleared between queries. One solver must not be used by two threads at once.
+     */
+    class DensePathSolver {
+    public:
+        explicit DensePathSolver(const PathGrid &InGrid);
+
+        /**
+         * A* from the start cell at angle 0 to any angle of the goal cell.
+         * The heuristic is WeightHeuristic * MinStepCost * (the least number of steps left), it never overestimates
+         * with WeightHeuristic <= 1 if no step costs less than MinStepCost, i.e. MinStepCost is a lower bound of EdgeCost
+         * over all steps. Otherwise the path found may be more expensive than the best one. WeightHeuristic 0 makes this
+         * Dijkstra.
+         */
+        template<typename EdgeCostType>
+        PathResult AStar(const PathQuery &Query, const EdgeCostType &EdgeCost, float WeightHeuristic, float MinStepCost);
+
+        /**
+         * Dijkstra from both ends, meeting in the middle.
+         * The backward search can't know a predecessor, so this runs over cells only: EdgeCost is called with states of
+         * angle 0 and PrevState == FromState. Only use it for costs that don't depend on the predecessor.
+         */
+        template<typename EdgeCostType>
+        PathResult BidirectionalDijkstra(const PathQuery &Query, const EdgeCostType &EdgeCost);
+
+        template<typename EdgeCostType>
+        PathResult Solve(const PathQuery &Query, const EdgeCostType &EdgeCost, PathAlgorithm Algorithm, float WeightHeuristic, float MinStepCost) {
+            switch (Algorithm) {
+                case PathAlgorithm::BidirectionalDijkstra:
+                    return BidirectionalDijkstra(Query, EdgeCost);
+                case PathAlgorithm::Dijkstra:
+                    return AStar(Query, EdgeCost, 0.f, 0.f);
+                case PathAlgorithm::AStar:
+                default:
+                    return AStar(Query, EdgeCost, WeightHeuristic, MinStepCost);
+            }
+        }
+
+        const PathGrid &GetGrid() const { return Grid; }
+
+        /**
+         * Bytes of the dense arrays a solver allocates for its queries on Grid, 12 per state plus 12 per cell for
+         * BidirectionalDijkstra. The open list comes on top and grows with the number of states pushed.
+         */
+        static size_t SearchBytes(const PathGrid &Grid, PathAlgorithm Algorithm) {
+            const size_t BytesPerEntry = sizeof(float) + 2 * sizeof(uint32_t);
+            size_t Entries = Grid.NumStates();
+            if (Algorithm == PathAlgorithm::BidirectionalDijkstra) Entries += Grid.NumCells();
+            return Entries * BytesPerEntry;
+        }
+
+    private:
+        using OpenEntry = std::pair<float, uint32_t>;
+
+        struct SearchArrays {
+            ArrayList<float> CostTo;
+            ArrayList<uint32_t> Predecessor;
+            // Generation when touched, Generation + 1 when closed, anything lower is stale
+            ArrayList<uint32_t> Stamp;
+            ArrayList<OpenEntry> OpenList;
+
+            void Reserve(size_t Size);
+        };
+
+        bool IsInside(const std::array<int32_t, 2> &Cell) const;
+
+        // Validates the query and starts a new generation
+        void BeginQuery(const PathQuery &Query, bool bBidirectional);
+
+        static void Push(ArrayList<OpenEntry> &OpenList, float Key, uint32_t State);
+        static OpenEntry Pop(ArrayList<OpenEntry> &OpenList);
+
+        static float CheckedCost(float Cost);
+
+        PathGrid Grid;
+        ArrayList<std::array<int32_t, 2>> Offsets;
+        SearchArrays Forward;
+        SearchArrays Backward;
+        uint32_t Generation = 0;
+    };
+
+    template<typename EdgeCostType>
+    PathResult DensePathSolver::AStar(const PathQuery &Query, const EdgeCostType &EdgeCost, float WeightHeuristic, float MinStepCost) {
+        BeginQuery(Query, false);
+
+        const uint32_t MaskA = uint32_t(Grid.MaskA);
+        const size_t GoalCell = size_t(Query.Goal[0]) + size_t(Query.Goal[1]) * Grid.Nx;
+        const float StepWeight = WeightHeuristic * MinStepCost;
+        auto Heuristic = [this, &Query, StepWeight](int32_t x, int32_t y) -> float {
+            const int32_t Chebyshev = std::max(std::abs(x - Query.Goal[0]), std::abs(y - Query.Goal[1]));
+            return StepWeight * float((Chebyshev + Grid.MaskK - 1) / Grid.MaskK);
+        };
+
+        auto &[CostTo, Predecessor, Stamp, OpenList] = Forward;
+        const uint32_t Touched = Generation, Closed = Generation + 1;
+
+        const uint32_t StartState = uint32_t((size_t(Query.Start[0]) + size_t(Query.Start[1]) * Grid.Nx) * MaskA);
+        CostTo[StartState] = 0.f;
+        Predecessor[StartState] = StartState;
+        Stamp[StartState] = Touched;
+        Push(OpenList, Heuristic(Query.Start[0], Query.Start[1]), StartState);
+
+        PathResult Result;
+        int64_t GoalState = -1;
+
+        while (!OpenList.empty()) {
+            const uint32_t State = Pop(OpenList).second;
+            if (Stamp[State] == Closed) continue;
+            Stamp[State] = Closed;
+            ++Result.NumExpanded;
+
+            const size_t Cell = State / MaskA;
+            if (Cell == GoalCell) {
+                GoalState = State;
+                break;
+            }
+
+            const int32_t x = int32_t(Cell % Grid.Nx), y = int32_t(Cell / Grid.Nx);
+            const uint32_t Prev = Predecessor[State];
+            const float Cost = CostTo[State];
+
+            for (const auto &[dx, dy]: Offsets) {
+                const int32_t nx = x + dx, ny = y + dy;
+                if (nx < 0 || ny < 0 || nx >= Grid.Nx || ny >= Grid.Ny) continue;
+
+                const uint32_t NeighbourBase = uint32_t((size_t(nx) + size_t(ny) * Grid.Nx) * MaskA);
+                const float H = Heuristic(nx, ny);
+                for (uint32_t Angle = 0; Angle < MaskA; ++Angle) {
+                    const uint32_t Neighbour = NeighbourBase + Angle;
+                    if (Stamp[Neighbour] == Closed) continue;
+
+                    const float NewCost = Cost + CheckedCost(EdgeCost(Prev, State, Neighbour));
+                    if (Stamp[Neighbour] != Touched || NewCost < CostTo[Neighbour]) {
+                        CostTo[Neighbour] = NewCost;
+                        Predecessor[Neighbour] = State;
+                        Stamp[Neighbour] = Touched;
+                        Push(OpenList, NewCost + H, Neighbour);
+                    }
+                }
+            }
+        }
+        OpenList.clear();
+
+        if (GoalState >= 0) {
+            Result.Cost = CostTo[GoalState];
+            uint32_t Current = uint32_t(GoalState);
+            while (Predecessor[Current] != Current) {
+                Result.Cells.push_back(Current / MaskA);
+                Current = Predecessor[Current];
+            }
+            Result.Cells.push_back(Current / MaskA);
+        }
+
+        return Result;
+    }
+
+    template<typename EdgeCostType>
+    PathResult DensePathSolver::BidirectionalDijkstra(const PathQuery &Query, const EdgeCostType &EdgeCost) {
+        BeginQuery(Query, true);
+
+        const uint32_t MaskA = uint32_t(Grid.MaskA);
+        const uint32_t Touched = Generation, Closed = Generation + 1;
+        const uint32_t StartCell = uint32_t(size_t(Query.Start[0]) + size_t(Query.Start[1]) * Grid.Nx);
+        const uint32_t GoalCell = uint32_t(size_t(Query.Goal[0]) + size_t(Query.Goal[1]) * Grid.Nx);
+
+        for (auto [Arrays, Cell]: {std::make_pair(&Forward, StartCell), std::make_pair(&Backward, GoalCell)}) {
+            Arrays->CostTo[Cell] = 0.f;
+            Arrays->Predecessor[Cell] = Cell;
+            Arrays->Stamp[Cell] = Touched;
+            Push(Arrays->OpenList, 0.f, Cell);
+        }
+
+        PathResult Result;
+        float Best = std::numeric_limits<float>::infinity();
+        int64_t Meeting = StartCell == GoalCell ? int64_t(StartCell) : -1;
+        if (Meeting >= 0) Best = 0.f;
+
+        while (!Forward.OpenList.empty() && !Backward.OpenList.empty()) {
+            // Nothing cheaper than the best meeting can be found once the two frontiers add up to it
+            if (Forward.OpenList.front().first + Backward.OpenList.front().first >= Best) break;
+
+            const bool bForward = Forward.OpenList.front().first <= Backward.OpenList.front().first;
+            SearchArrays &This = bForward ? Forward : Backward;
+            SearchArrays &Other = bForward ? Backward : Forward;
+
+            const uint32_t Cell = Pop(This.OpenList).second;
+            if (This.Stamp[Cell] == Closed) continue;
+            This.Stamp[Cell] = Closed;
+            ++Result.NumExpanded;
+
+            const int32_t x = int32_t(Cell % Grid.Nx), y = int32_t(Cell / Grid.Nx);
+            const float Cost = This.CostTo[Cell];
+
+            for (const auto &[dx, dy]: Offsets) {
+                const int32_t nx = x + dx, ny = y + dy;
+                if (nx < 0 || ny < 0 || nx >= Grid.Nx || ny >= Grid.Ny) continue;
+
+                const uint32_t Neighbour = uint32_t(size_t(nx) + size_t(ny) * Grid.Nx);
+                if (This.Stamp[Neighbour] == Closed) continue;
+
+                // The backward search walks edges against their direction
+                const uint32_t From = (bForward ? Cell : Neighbour) * MaskA;
+                const uint32_t To = (bForward ? Neighbour : Cell) * MaskA;
+                const float NewCost = Cost + CheckedCost(EdgeCost(From, From, To));
+                if (This.Stamp[Neighbour] != Touched || NewCost < This.CostTo[Neighbour]) {
+                    This.CostTo[Neighbour] = NewCost;
+                    This.Predecessor[Neighbour] = Cell;
+                    This.Stamp[Neighbour] = Touched;
+                    Push(This.OpenList, NewCost, Neighbour);
+
+                    if (Other.Stamp[Neighbour] >= Touched && NewCost + Other.CostTo[Neighbour] < Best) {
+                        Best = NewCost + Other.CostTo[Neighbour];
+                        Meeting = Neighbour;
+                    }
+                }
+            }
+        }
+        Forward.OpenList.clear();
+        Backward.OpenList.clear();
+
+        if (Meeting >= 0) {
+            Result.Cost = Best;
+
+            uint32_t Current = uint32_t(Meeting);
+            while (Backward.Predecessor[Current] != Current) {
+                Result.Cells.push_back(Current);
+                Current = Backward.Predecessor[Current];
+            }
+            Result.Cells.push_back(Current);
+            std::reverse(Result.Cells.begin(), Result.Cells.end());
+
+            Current = uint32_t(Meeting);
+            while (Forward.Predecessor[Current] != Current) {
+                Current = Forward.Predecessor[Current];
+                Result.Cells.push_back(Current);
+            }
+        }
+
+        return Result;
+    }
+
+    // Memory the workers of SolvePathBatch may take for their search arrays together, unless told otherwise
+    constexpr size_t DefaultPathBatchMemory = size_t(4) << 30;
+
+    /**
+     * Solve independent queries over the same grid and costs in parallel.
+     * Every worker thread owns a DensePathSolver with DensePathSolver::SearchBytes of arrays, so there are only as many
+     * workers as fit in MemoryBudget, and at most MaxWorkers if that is > 0. One worker always runs.
+     * EdgeCost is shared by all workers and must be safe to call concurrently.
+     */
+    template<typename EdgeCostType>
+    ArrayList<PathResult> SolvePathBatch(const PathGrid &Grid, const ArrayList<PathQuery> &Queries, const EdgeCostType &EdgeCost, PathAlgorithm Algorithm, float WeightHeuristic, float MinStepCost, int32_t MaxWorkers = 0, size_t MemoryBudget = DefaultPathBatchMemory) {
+        ArrayList<PathResult> Results(Queries.size());
+        if (Queries.empty()) return Results;
+
+        int32_t NumWorkers = 1;
+#ifdef _OPENMP
+        NumWorkers = MaxWorkers > 0 ? std::min(MaxWorkers, omp_get_max_threads()) : omp_get_max_threads();
+#endif
+        const size_t WorkerBytes = std::max<size_t>(1, DensePathSolver::SearchBytes(Grid, Algorithm));
+        NumWorkers = int32_t(std::min<size_t>(NumWorkers, MemoryBudget / WorkerBytes));
+        NumWorkers = std::max(1, std::min(NumWorkers, int32_t(Queries.size())));
+
+        std::exception_ptr Error = nullptr;
+
+#pragma omp parallel num_threads(NumWorkers)
+        {
+            DensePathSolver Solver(Grid);
+
+#pragma omp for schedule(dynamic, 1)
+            for (int64_t i = 0; i < int64_t(Queries.size()); ++i) {
+                try {
+                    Results[i] = Solver.Solve(Queries[i], EdgeCost, Algorithm, WeightHeuristic, MinStepCost);
+                } catch (...) {
+#pragma omp critical(RoadsSolvePathBatch)
+                    if (!Error) Error = std::current_exception();
+                }
+            }
+        }
+
+        if (Error) {
+            std::rethrow_exception(Error);
+        }
+
+        return Results;
+    }
+
+}// namespace roads::energy
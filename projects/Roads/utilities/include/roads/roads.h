@@ -3,3 +3,4 @@
 #include "pch.h"
 #include "grid.h"
 #include "kdtree.h"
+#include "path.h"
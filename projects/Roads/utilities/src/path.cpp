@@ -0,0 +1,75 @@
+#include "roads/path.h"
+#include "roads/grid.h"
+
+using namespace roads;
+using namespace roads::energy;
+
+ArrayList<std::array<int32_t, 2>> roads::energy::BuildMaskOffsets(int32_t MaskK) {
+    ArrayList<std::array<int32_t, 2>> Offsets;
+    for (int32_t dx = -MaskK; dx <= MaskK; ++dx) {
+        for (int32_t dy = -MaskK; dy <= MaskK; ++dy) {
+            if (GreatestCommonDivisor(std::abs(dx), std::abs(dy)) == 1) {
+                Offsets.push_back({dx, dy});
+            }
+        }
+    }
+    return Offsets;
+}
+
+void DensePathSolver::SearchArrays::Reserve(size_t Size) {
+    if (Stamp.size() >= Size) return;
+
+    CostTo.resize(Size);
+    Predecessor.resize(Size);
+    Stamp.resize(Size, 0);
+}
+
+DensePathSolver::DensePathSolver(const PathGrid &InGrid) : Grid(InGrid), Offsets(BuildMaskOffsets(InGrid.MaskK)) {}
+
+bool DensePathSolver::IsInside(const std::array<int32_t, 2> &Cell) const {
+    return Cell[0] >= 0 && Cell[1] >= 0 && Cell[0] < Grid.Nx && Cell[1] < Grid.Ny;
+}
+
+void DensePathSolver::BeginQuery(const PathQuery &Query, bool bBidirectional) {
+    if (Grid.Nx <= 0 || Grid.Ny <= 0 || Grid.MaskK <= 0 || Grid.MaskA <= 0) {
+        throw std::invalid_argument("[Roads] Path grid built with invalid arguments.");
+    }
+    if (Grid.NumStates() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("[Roads] Path grid has too many states.");
+    }
+    if (!IsInside(Query.Start) || !IsInside(Query.Goal)) {
+        throw std::out_of_range("[Roads] Start or goal point is outside of the grid.");
+    }
+
+    Forward.Reserve(Grid.NumStates());
+    if (bBidirectional) {
+        Backward.Reserve(Grid.NumCells());
+    }
+
+    // Generations step by two, the odd value marks closed states
+    Generation += 2;
+    if (Generation >= std::numeric_limits<uint32_t>::max() - 2) {
+        std::fill(Forward.Stamp.begin(), Forward.Stamp.end(), 0);
+        std::fill(Backward.Stamp.begin(), Backward.Stamp.end(), 0);
+        Generation = 2;
+    }
+}
+
+void DensePathSolver::Push(ArrayList<OpenEntry> &OpenList, float Key, uint32_t State) {
+    OpenList.emplace_back(Key, State);
+    std::push_heap(OpenList.begin(), OpenList.end(), std::greater<>());
+}
+
+DensePathSolver::OpenEntry DensePathSolver::Pop(ArrayList<OpenEntry> &OpenList) {
+    std::pop_heap(OpenList.begin(), OpenList.end(), std::greater<>());
+    OpenEntry Entry = OpenList.back();
+    OpenList.pop_back();
+    return Entry;
+}
+
+float DensePathSolver::CheckedCost(float Cost) {
+    if (Cost < 0) {
+        throw std::runtime_error("[Roads] Graph should not have negative weight. Check your curve !");
+    }
+    return Cost;
+}
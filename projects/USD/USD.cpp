@@ -49,6 +49,10 @@ ZENDEFNODE(USDOpenStage,
 
 
 struct USDSimpleTraverse : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return !has_input("frameid");
+    }
+
 
     void imported_mesh_data_to_prim(std::shared_ptr<zeno::PrimitiveObject> prim, EGeomMeshData& value){
         // Point
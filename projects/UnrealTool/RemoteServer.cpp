@@ -36,6 +36,7 @@
 #include <zeno/extra/GraphException.h>
 #include <zeno/logger.h>
 #include <zeno/types/PrimitiveObject.h>
+#include <zeno/unreal/SubjectTransfer.h>
 #include <zeno/unreal/UnrealTool.h>
 #include <zeno/unreal/ZenoRemoteTypes.h>
 
@@ -131,6 +132,7 @@ namespace zeno {
         httplib::Server Srv;
         std::map<zeno::remote::SessionKeyType, remote::SubjectHistory> History;
         std::vector<std::string> Sessions;
+        remote::SubjectTransferCache TransferCache;
 
     private:
         bool IsValidSession(const std::string &SessionKey) const;
@@ -144,6 +146,7 @@ namespace zeno {
         void FetchDataDiff(const httplib::Request &Req, httplib::Response &Res);
         static void PushData(const httplib::Request &Req, httplib::Response &Res);
         void FetchData(const httplib::Request &Req, httplib::Response &Res);
+        void FetchDataDelta(const httplib::Request &Req, httplib::Response &Res);
 
         static void ParseGraphInfo(const httplib::Request &Req,
                                    httplib::Response &Res);
@@ -184,6 +187,7 @@ namespace zeno {
             Srv.Get("/subject/diff", HANDLER_SESSION_CHECK(FetchDataDiff));
             Srv.Post("/subject/push", HANDLER_SESSION_CHECK(PushData));
             Srv.Get("/subject/fetch", HANDLER_SESSION_CHECK(FetchData));
+            Srv.Get("/subject/delta", HANDLER_SESSION_CHECK(FetchDataDelta));
             Srv.Post("/graph/parse", HANDLER_SESSION_CHECK(ParseGraphInfo));
             Srv.Post("/graph/param/push", HANDLER_SESSION_CHECK(PushParameter));
             Srv.Post("/graph/run", HANDLER_SESSION_CHECK(RunGraph));
@@ -245,7 +249,7 @@ namespace zeno {
 
     void ZenoRemoteServer::IndexPage(const httplib::Request &Req,
                                      httplib::Response &Res) {
-        Res.set_content(R"({"api_version": 1, "protocol": "msgpack"})",
+        Res.set_content(R"({"api_version": 1, "protocol": "msgpack", "delta_version": 1})",
                         "application/json");
     }
 
@@ -386,6 +390,61 @@ namespace zeno {
                         "application/binary");
     }
 
+    /**
+ * GET /subject/delta?key={string}&base_version={int}&topology={uint64}&chunk_size={int}
+ * base_version is the version of the subject the client holds (0 for none), topology the
+ * TopologyHash of the indices it holds. Both come from the last applied SubjectDeltaHeader.
+ * return a chunked stream of frames, see zeno::remote::SubjectDeltaWriter. 404 if the
+ * subject doesn't exist, 415 if it is neither a mesh nor a height field
+ */
+    void ZenoRemoteServer::FetchDataDelta(const httplib::Request &Req,
+                                          httplib::Response &Res) {
+        const std::string SessionKey = ParseSessionKey(Req);
+        const std::string Key = Req.get_param_value("key");
+
+        auto &Elements =
+            zeno::remote::StaticRegistry.GetOrCreateSessionElement(SessionKey);
+        auto &GlobalElements =
+            GetOrCreate(remote::StaticRegistry.SessionalElements, std::string{""});
+        auto Value = Elements.find(Key);
+        if (Value == Elements.end()) {
+            Value = GlobalElements.find(Key);
+            if (Value == GlobalElements.end()) {
+                Res.status = 404;
+                return;
+            }
+        }
+
+        const int32_t BaseVersion =
+            std::atoi(Req.get_param_value("base_version").c_str());
+        const uint64_t ClientTopology =
+            std::strtoull(Req.get_param_value("topology").c_str(), nullptr, 10);
+        const size_t ChunkSize =
+            Req.has_param("chunk_size")
+                ? std::strtoull(Req.get_param_value("chunk_size").c_str(), nullptr, 10)
+                : 1024 * 1024;
+        std::shared_ptr<remote::SubjectDeltaWriter> Writer = TransferCache.MakeDelta(
+            SessionKey, Value->second, BaseVersion, ClientTopology, ChunkSize);
+        if (!Writer) {
+            Res.status = 415;
+            return;
+        }
+
+        Res.set_header("X-Zeno-Subject-Version",
+                       std::to_string(Writer->GetHeader().Version));
+        // Frames are packed one at a time while the previous ones are on the wire
+        Res.set_chunked_content_provider(
+            "application/binary", [Writer](size_t Offset, httplib::DataSink &Sink) {
+                std::vector<uint8_t> Frame;
+                if (!Writer->Next(Frame)) {
+                    Sink.done();
+                    return true;
+                }
+                return Sink.write(reinterpret_cast<const char *>(Frame.data()),
+                                  Frame.size());
+            });
+    }
+
     /**
  * POST /graph/parse
  * BODY a string of zsl file (json).
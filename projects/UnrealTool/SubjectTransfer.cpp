@@ -0,0 +1,356 @@
+#include "zeno/unreal/SubjectTransfer.h"
+#include "msgpack/msgpack.h"
+#include <algorithm>
+#include <cstring>
+
+namespace zeno::remote {
+
+namespace {
+
+    uint64_t Mix64(uint64_t H) {
+        H ^= H >> 33;
+        H *= 0xff51afd7ed558ccdull;
+        H ^= H >> 33;
+        H *= 0xc4ceb9fe1a85ec53ull;
+        H ^= H >> 33;
+        return H;
+    }
+
+    void AppendFrame(std::vector<uint8_t>& Out, const std::vector<uint8_t>& Frame) {
+        const auto Size = static_cast<uint32_t>(Frame.size());
+        const uint8_t Length[4] = {
+            static_cast<uint8_t>(Size), static_cast<uint8_t>(Size >> 8),
+            static_cast<uint8_t>(Size >> 16), static_cast<uint8_t>(Size >> 24),
+        };
+        Out.insert(Out.end(), Length, Length + 4);
+        Out.insert(Out.end(), Frame.begin(), Frame.end());
+    }
+
+    /**
+     * @brief Bytes of an attribute and the size of one element, nullptr for attributes the subject doesn't have
+     */
+    template <typename SnapshotType>
+    auto* AttributeBytes(SnapshotType& Snapshot, EDeltaAttribute Attribute, size_t& ElementBytes) {
+        using ByteType = std::conditional_t<std::is_const_v<SnapshotType>, const uint8_t, uint8_t>;
+        switch (Attribute) {
+            case EDeltaAttribute::Indices:
+                ElementBytes = 3 * sizeof(int32_t);
+                return reinterpret_cast<ByteType*>(Snapshot.Indices.data());
+            case EDeltaAttribute::Positions:
+                ElementBytes = 3 * sizeof(float);
+                return reinterpret_cast<ByteType*>(Snapshot.Positions.data());
+            case EDeltaAttribute::Heights:
+                ElementBytes = sizeof(uint16_t);
+                return reinterpret_cast<ByteType*>(Snapshot.Heights.data());
+        }
+        ElementBytes = 0;
+        return static_cast<ByteType*>(nullptr);
+    }
+
+}
+
+uint64_t HashBytes(const void* Data, size_t Size, uint64_t Seed) {
+    const auto* Bytes = static_cast<const uint8_t*>(Data);
+    uint64_t H = Mix64(Seed ^ Size);
+    size_t Idx = 0;
+    for (; Idx + 8 <= Size; Idx += 8) {
+        uint64_t Word;
+        std::memcpy(&Word, Bytes + Idx, 8);
+        H = (H ^ Mix64(Word)) * 0x100000001b3ull;
+    }
+    uint64_t Tail = 0;
+    std::memcpy(&Tail, Bytes + Idx, Size - Idx);
+    return Mix64(H ^ Tail);
+}
+
+std::shared_ptr<const SubjectSnapshot> SubjectSnapshot::FromContainer(const SubjectContainer& Container) {
+    auto Snapshot = std::make_shared<SubjectSnapshot>();
+    Snapshot->Type = Container.GetType();
+    Snapshot->ContentHash = HashBytes(Container.Data.data(), Container.Data.size());
+    std::error_code Err;
+    if (Snapshot->Type == ESubjectType::Mesh) {
+        Mesh Data = msgpack::unpack<Mesh>(Container.Data, Err);
+        if (Err) return nullptr;
+        Snapshot->Meta = std::move(Data.Meta);
+        Snapshot->Positions.reserve(Data.vertices.size() * 3);
+        for (const auto& Vertex : Data.vertices) {
+            for (const AnyNumeric& Component : Vertex) {
+                Snapshot->Positions.push_back(Component.data());
+            }
+        }
+        Snapshot->Indices.reserve(Data.triangles.size() * 3);
+        for (const auto& Triangle : Data.triangles) {
+            Snapshot->Indices.insert(Snapshot->Indices.end(), Triangle.begin(), Triangle.end());
+        }
+        Snapshot->TopologyHash = HashBytes(Snapshot->Indices.data(), Snapshot->Indices.size() * sizeof(int32_t), Data.vertices.size());
+    } else if (Snapshot->Type == ESubjectType::HeightField) {
+        HeightField Data = msgpack::unpack<HeightField>(Container.Data, Err);
+        if (Err) return nullptr;
+        Snapshot->Meta = std::move(Data.Meta);
+        Snapshot->Nx = Data.Nx;
+        Snapshot->Ny = Data.Ny;
+        Snapshot->Heights = Data.ToFlat();
+        if (Snapshot->Heights.size() != static_cast<size_t>(Data.Nx) * Data.Ny) return nullptr;
+        const int32_t Size[2] = {Data.Nx, Data.Ny};
+        Snapshot->TopologyHash = HashBytes(Size, sizeof(Size));
+    } else {
+        return nullptr;
+    }
+    return Snapshot;
+}
+
+uint32_t SubjectSnapshot::NumElements() const {
+    return static_cast<uint32_t>(Type == ESubjectType::HeightField ? Heights.size() : Positions.size() / 3);
+}
+
+SubjectDeltaWriter::SubjectDeltaWriter(const std::string& Name, std::shared_ptr<const SubjectSnapshot> InTarget, int32_t Version,
+                                       std::shared_ptr<const SubjectSnapshot> InBase, int32_t BaseVersion, uint64_t ClientTopologyHash, size_t ChunkBytes)
+    : Target(std::move(InTarget)) {
+    ChunkBytes = std::max<size_t>(ChunkBytes, 1024);
+    const uint32_t NumElements = Target->NumElements();
+    // Positions diff element by element, so a base only needs the same layout, not the same faces
+    const bool bUseBase = InBase && InBase->Type == Target->Type && InBase->NumElements() == NumElements
+                          && InBase->Nx == Target->Nx && InBase->Ny == Target->Ny;
+
+    Header.Name = Name;
+    Header.Type = static_cast<int16_t>(Target->Type);
+    Header.Version = Version;
+    Header.BaseVersion = bUseBase ? BaseVersion : 0;
+    Header.TopologyHash = Target->TopologyHash;
+    Header.NumElements = NumElements;
+    Header.Nx = Target->Nx;
+    Header.Ny = Target->Ny;
+    Header.Meta = Target->Meta;
+
+    if (Target->Type == ESubjectType::Mesh) {
+        const bool bClientHasTopology = ClientTopologyHash == Target->TopologyHash
+                                        || (bUseBase && InBase->TopologyHash == Target->TopologyHash);
+        Header.bTopologyIncluded = !bClientHasTopology;
+        if (Header.bTopologyIncluded) {
+            AddFull(EDeltaAttribute::Indices, static_cast<uint32_t>(Target->Indices.size() / 3), 3 * sizeof(int32_t), 1, ChunkBytes);
+        }
+        if (bUseBase) {
+            AddRuns(EDeltaAttribute::Positions, reinterpret_cast<const uint8_t*>(InBase->Positions.data()),
+                    reinterpret_cast<const uint8_t*>(Target->Positions.data()), NumElements, 3 * sizeof(float), 1, ChunkBytes);
+        } else {
+            AddFull(EDeltaAttribute::Positions, NumElements, 3 * sizeof(float), 1, ChunkBytes);
+        }
+    } else {
+        // Full height fields go out in whole rows so a client can apply each chunk as a terrain tile
+        const auto RowStride = static_cast<uint32_t>(std::max(Target->Nx, 1));
+        if (bUseBase) {
+            AddRuns(EDeltaAttribute::Heights, reinterpret_cast<const uint8_t*>(InBase->Heights.data()),
+                    reinterpret_cast<const uint8_t*>(Target->Heights.data()), NumElements, sizeof(uint16_t), RowStride, ChunkBytes);
+        } else {
+            AddFull(EDeltaAttribute::Heights, NumElements, sizeof(uint16_t), RowStride, ChunkBytes);
+        }
+    }
+    Header.NumChunks = static_cast<uint32_t>(Slices.size());
+}
+
+void SubjectDeltaWriter::AddFull(EDeltaAttribute Attribute, uint32_t NumElements, size_t ElementBytes, uint32_t Stride, size_t ChunkBytes) {
+    const auto PerChunk = static_cast<uint32_t>(std::max<size_t>(ChunkBytes / ElementBytes / Stride, 1) * Stride);
+    for (uint32_t Offset = 0; Offset < NumElements; Offset += PerChunk) {
+        Slices.push_back({Attribute, EDeltaMode::Full, Offset, std::min(PerChunk, NumElements - Offset), 0});
+    }
+}
+
+void SubjectDeltaWriter::AddRuns(EDeltaAttribute Attribute, const uint8_t* Old, const uint8_t* New, uint32_t NumElements,
+                                 size_t ElementBytes, uint32_t Stride, size_t ChunkBytes) {
+    // Unchanged elements shorter than a run header are sent anyway
+    const size_t MergeGap = 2 * sizeof(uint32_t) / ElementBytes;
+    std::vector<uint32_t> Found;
+    size_t Changed = 0;
+    for (uint32_t Idx = 0; Idx < NumElements;) {
+        if (std::memcmp(Old + Idx * ElementBytes, New + Idx * ElementBytes, ElementBytes) == 0) {
+            ++Idx;
+            continue;
+        }
+        const uint32_t Start = Idx;
+        while (Idx < NumElements && std::memcmp(Old + Idx * ElementBytes, New + Idx * ElementBytes, ElementBytes) != 0) {
+            ++Idx;
+        }
+        if (!Found.empty() && Start - (Found[Found.size() - 2] + Found.back()) <= MergeGap) {
+            Changed += Idx - (Found[Found.size() - 2] + Found.back());
+            Found.back() = Idx - Found[Found.size() - 2];
+        } else {
+            Found.push_back(Start);
+            Found.push_back(Idx - Start);
+            Changed += Idx - Start;
+        }
+    }
+    if (Changed == 0) return;
+    if (Changed * ElementBytes + Found.size() * sizeof(uint32_t) >= NumElements * ElementBytes / 2) {
+        AddFull(Attribute, NumElements, ElementBytes, Stride, ChunkBytes);
+        return;
+    }
+
+    const auto PerChunk = static_cast<uint32_t>(std::max<size_t>(ChunkBytes / ElementBytes, 1));
+    Slice Current {Attribute, EDeltaMode::Runs, 0, 0, static_cast<uint32_t>(Runs.size() / 2)};
+    uint32_t InChunk = 0;
+    for (size_t RunIdx = 0; RunIdx < Found.size(); RunIdx += 2) {
+        uint32_t Start = Found[RunIdx], Count = Found[RunIdx + 1];
+        while (Count > 0) {
+            const uint32_t Take = std::min(Count, PerChunk - InChunk);
+            Runs.push_back(Start);
+            Runs.push_back(Take);
+            ++Current.Count;
+            InChunk += Take;
+            Start += Take;
+            Count -= Take;
+            if (InChunk == PerChunk) {
+                Slices.push_back(Current);
+                Current = {Attribute, EDeltaMode::Runs, 0, 0, static_cast<uint32_t>(Runs.size() / 2)};
+                InChunk = 0;
+            }
+        }
+    }
+    if (Current.Count > 0) Slices.push_back(Current);
+}
+
+bool SubjectDeltaWriter::Next(std::vector<uint8_t>& Out) {
+    if (NextFrame == 0) {
+        AppendFrame(Out, msgpack::pack(Header));
+        ++NextFrame;
+        return true;
+    }
+    if (NextFrame > Slices.size()) return false;
+
+    const Slice& Current = Slices[NextFrame - 1];
+    size_t ElementBytes;
+    const uint8_t* Bytes = AttributeBytes(*Target, Current.Attribute, ElementBytes);
+    SubjectDeltaChunk Chunk;
+    Chunk.Attribute = static_cast<int8_t>(Current.Attribute);
+    Chunk.Mode = static_cast<int8_t>(Current.Mode);
+    if (Current.Mode == EDeltaMode::Full) {
+        Chunk.Offset = Current.Offset;
+        Chunk.Data.assign(Bytes + Current.Offset * ElementBytes, Bytes + (Current.Offset + Current.Count) * ElementBytes);
+    } else {
+        Chunk.Runs.assign(Runs.begin() + Current.RunsBegin * 2, Runs.begin() + (Current.RunsBegin + Current.Count) * 2);
+        for (size_t RunIdx = 0; RunIdx < Chunk.Runs.size(); RunIdx += 2) {
+            const uint8_t* Start = Bytes + Chunk.Runs[RunIdx] * ElementBytes;
+            Chunk.Data.insert(Chunk.Data.end(), Start, Start + Chunk.Runs[RunIdx + 1] * ElementBytes);
+        }
+    }
+    AppendFrame(Out, msgpack::pack(Chunk));
+    ++NextFrame;
+    return true;
+}
+
+std::shared_ptr<SubjectDeltaWriter> SubjectTransferCache::MakeDelta(const std::string& SessionKey, const SubjectContainer& Container,
+                                                                    int32_t BaseVersion, uint64_t ClientTopologyHash, size_t ChunkBytes) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Entry& Subject = Entries[SessionKey][Container.Name];
+
+    auto LatestIter = Subject.Snapshots.find(Subject.LatestVersion);
+    std::shared_ptr<const SubjectSnapshot> Latest = LatestIter != Subject.Snapshots.end() ? LatestIter->second : nullptr;
+    if (!Latest || Latest->ContentHash != HashBytes(Container.Data.data(), Container.Data.size())) {
+        Latest = SubjectSnapshot::FromContainer(Container);
+        if (!Latest) return nullptr;
+        Subject.Snapshots.emplace(++Subject.LatestVersion, Latest);
+    }
+
+    std::shared_ptr<const SubjectSnapshot> Base;
+    auto BaseIter = Subject.Snapshots.find(BaseVersion);
+    if (BaseVersion != 0 && BaseIter != Subject.Snapshots.end()) {
+        Base = BaseIter->second;
+    }
+    // The client named BaseVersion, so it won't ask for anything older
+    for (auto Iter = Subject.Snapshots.begin(); Iter != Subject.Snapshots.end();) {
+        if (Iter->first != Subject.LatestVersion && Iter->first != BaseVersion) {
+            Iter = Subject.Snapshots.erase(Iter);
+        } else {
+            ++Iter;
+        }
+    }
+
+    return std::make_shared<SubjectDeltaWriter>(Container.Name, Latest, Subject.LatestVersion, Base, BaseVersion, ClientTopologyHash, ChunkBytes);
+}
+
+bool SubjectReplica::Consume(const char* Bytes, size_t Size) {
+    Pending.insert(Pending.end(), Bytes, Bytes + Size);
+    size_t Pos = 0;
+    while (Pending.size() - Pos >= 4) {
+        const uint8_t* Length = Pending.data() + Pos;
+        const uint32_t FrameSize = Length[0] | Length[1] << 8 | Length[2] << 16 | static_cast<uint32_t>(Length[3]) << 24;
+        if (Pending.size() - Pos - 4 < FrameSize) break;
+        if (!ApplyFrame(Pending.data() + Pos + 4, FrameSize)) {
+            Pending.clear();
+            bReceiving = false;
+            return false;
+        }
+        Pos += 4 + FrameSize;
+    }
+    Pending.erase(Pending.begin(), Pending.begin() + static_cast<std::ptrdiff_t>(Pos));
+    return true;
+}
+
+bool SubjectReplica::ApplyFrame(const uint8_t* Frame, size_t Size) {
+    std::error_code Err;
+    if (!bReceiving) {
+        Header = msgpack::unpack<SubjectDeltaHeader>(Frame, Size, Err);
+        if (Err) return false;
+        if (Header.BaseVersion != 0 && Header.BaseVersion != Version) return false;
+        const auto Type = static_cast<ESubjectType>(Header.Type);
+        if (Type == ESubjectType::Mesh && !Header.bTopologyIncluded && Header.TopologyHash != TopologyHash) return false;
+
+        if (Header.BaseVersion != 0) {
+            Staging = Data;
+        } else {
+            Staging = SubjectSnapshot{};
+            if (!Header.bTopologyIncluded) Staging.Indices = Data.Indices;
+        }
+        Staging.Type = Type;
+        Staging.Meta = Header.Meta;
+        Staging.TopologyHash = Header.TopologyHash;
+        Staging.Nx = Header.Nx;
+        Staging.Ny = Header.Ny;
+        if (Header.bTopologyIncluded) Staging.Indices.clear();
+        if (Type == ESubjectType::HeightField) {
+            Staging.Heights.resize(Header.NumElements);
+        } else {
+            Staging.Positions.resize(static_cast<size_t>(Header.NumElements) * 3);
+        }
+        ChunksReceived = 0;
+        bReceiving = true;
+    } else {
+        SubjectDeltaChunk Chunk = msgpack::unpack<SubjectDeltaChunk>(Frame, Size, Err);
+        if (Err) return false;
+        const auto Attribute = static_cast<EDeltaAttribute>(Chunk.Attribute);
+        size_t ElementBytes = 0;
+        AttributeBytes(Staging, Attribute, ElementBytes);
+        if (ElementBytes == 0 || Chunk.Data.size() % ElementBytes != 0) return false;
+        const size_t NumData = Chunk.Data.size() / ElementBytes;
+        if (static_cast<EDeltaMode>(Chunk.Mode) == EDeltaMode::Full) {
+            // The triangle count is only known from the index chunks
+            if (Attribute == EDeltaAttribute::Indices && Staging.Indices.size() < (Chunk.Offset + NumData) * 3) {
+                Staging.Indices.resize((Chunk.Offset + NumData) * 3);
+            }
+            uint8_t* Bytes = AttributeBytes(Staging, Attribute, ElementBytes);
+            if (Chunk.Offset + NumData > (Attribute == EDeltaAttribute::Indices ? Staging.Indices.size() / 3 : Staging.NumElements())) return false;
+            if (NumData) std::memcpy(Bytes + Chunk.Offset * ElementBytes, Chunk.Data.data(), Chunk.Data.size());
+        } else {
+            if (Attribute == EDeltaAttribute::Indices || Chunk.Runs.size() % 2 != 0) return false;
+            uint8_t* Bytes = AttributeBytes(Staging, Attribute, ElementBytes);
+            size_t Consumed = 0;
+            for (size_t RunIdx = 0; RunIdx < Chunk.Runs.size(); RunIdx += 2) {
+                const size_t Start = Chunk.Runs[RunIdx], Count = Chunk.Runs[RunIdx + 1];
+                if (Start + Count > Staging.NumElements() || Consumed + Count > NumData) return false;
+                std::memcpy(Bytes + Start * ElementBytes, Chunk.Data.data() + Consumed * ElementBytes, Count * ElementBytes);
+                Consumed += Count;
+            }
+            if (Consumed != NumData) return false;
+        }
+        ++ChunksReceived;
+    }
+
+    if (ChunksReceived == Header.NumChunks) {
+        Data = std::move(Staging);
+        Version = Header.Version;
+        TopologyHash = Header.TopologyHash;
+        bReceiving = false;
+    }
+    return true;
+}
+
+}
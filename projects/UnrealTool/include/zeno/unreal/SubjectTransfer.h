@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ZenoRemoteTypes.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace zeno::remote {
+
+/**
+ * @brief Decoded arrays of a mesh or height field subject, the unit deltas are computed between.
+ */
+struct SubjectSnapshot {
+    ESubjectType Type = ESubjectType::Invalid;
+    std::map<std::string, std::string> Meta;
+    uint64_t ContentHash = 0;
+    uint64_t TopologyHash = 0;
+
+    std::vector<float> Positions;
+    std::vector<int32_t> Indices;
+
+    int32_t Nx = 0, Ny = 0;
+    std::vector<uint16_t> Heights;
+
+    /**
+     * @brief Decode a subject container
+     * @return nullptr if the subject is not a mesh or height field, or can't be unpacked
+     */
+    static std::shared_ptr<const SubjectSnapshot> FromContainer(const SubjectContainer& Container);
+
+    uint32_t NumElements() const;
+};
+
+/**
+ * @brief Produces the frames of one /subject/delta response on demand.
+ *
+ * Every frame is a little-endian uint32 byte count followed by a msgpack object: one SubjectDeltaHeader,
+ * then SubjectDeltaHeader::NumChunks SubjectDeltaChunk.
+ */
+class SubjectDeltaWriter {
+public:
+    SubjectDeltaWriter(const std::string& Name, std::shared_ptr<const SubjectSnapshot> InTarget, int32_t Version,
+                       std::shared_ptr<const SubjectSnapshot> InBase, int32_t BaseVersion, uint64_t ClientTopologyHash, size_t ChunkBytes);
+
+    /**
+     * @brief Append the next frame to Out
+     * @return false when all frames were written
+     */
+    bool Next(std::vector<uint8_t>& Out);
+
+    const SubjectDeltaHeader& GetHeader() const { return Header; }
+
+private:
+    struct Slice {
+        EDeltaAttribute Attribute;
+        EDeltaMode Mode;
+        uint32_t Offset;
+        uint32_t Count;          // elements for Full, runs for Runs
+        uint32_t RunsBegin;      // first run of a Runs slice
+    };
+
+    void AddFull(EDeltaAttribute Attribute, uint32_t NumElements, size_t ElementBytes, uint32_t Stride, size_t ChunkBytes);
+    /**
+     * @brief Send only the elements that differ from the base, or everything when most of them do
+     */
+    void AddRuns(EDeltaAttribute Attribute, const uint8_t* Old, const uint8_t* New, uint32_t NumElements, size_t ElementBytes,
+                 uint32_t Stride, size_t ChunkBytes);
+
+    std::shared_ptr<const SubjectSnapshot> Target;
+    SubjectDeltaHeader Header;
+    std::vector<Slice> Slices;
+    // (start, count) pairs of every Runs slice
+    std::vector<uint32_t> Runs;
+    size_t NextFrame = 0;
+};
+
+/**
+ * @brief Versions of the subjects each session's client has received.
+ *
+ * A version is bumped whenever the content of a subject changes. Only the newest version and the last one
+ * the client acknowledged (by naming it as its base) are kept, any other base gets a full transfer.
+ */
+class SubjectTransferCache {
+public:
+    /**
+     * @param BaseVersion Version the client holds, 0 for none
+     * @param ClientTopologyHash Topology the client holds, lets a full transfer skip the indices
+     * @return nullptr if the subject type has no delta support
+     */
+    std::shared_ptr<SubjectDeltaWriter> MakeDelta(const std::string& SessionKey, const SubjectContainer& Container,
+                                                  int32_t BaseVersion, uint64_t ClientTopologyHash, size_t ChunkBytes);
+
+private:
+    struct Entry {
+        int32_t LatestVersion = 0;
+        std::map<int32_t, std::shared_ptr<const SubjectSnapshot>> Snapshots;
+    };
+
+    std::mutex Mutex;
+    std::map<std::string, std::map<std::string, Entry>> Entries;
+};
+
+/**
+ * @brief Client side of /subject/delta, keeps the arrays of one subject up to date.
+ *
+ * Feed it the response body as it arrives, in pieces of any size. The arrays only change once every chunk
+ * of a response has been applied, a broken response leaves the previous version in place.
+ */
+struct SubjectReplica {
+    int32_t Version = 0;
+    uint64_t TopologyHash = 0;
+    SubjectSnapshot Data;
+
+    /**
+     * @return false if the stream is malformed or doesn't apply to the held version
+     */
+    bool Consume(const char* Bytes, size_t Size);
+
+    /**
+     * @return true when the last response was applied completely
+     */
+    bool IsComplete() const { return !bReceiving; }
+
+private:
+    bool ApplyFrame(const uint8_t* Frame, size_t Size);
+
+    std::vector<uint8_t> Pending;
+    SubjectDeltaHeader Header;
+    SubjectSnapshot Staging;
+    uint32_t ChunksReceived = 0;
+    bool bReceiving = false;
+};
+
+uint64_t HashBytes(const void* Data, size_t Size, uint64_t Seed = 0);
+
+}
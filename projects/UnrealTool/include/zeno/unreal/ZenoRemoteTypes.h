@@ -6,6 +6,7 @@
 #include <set>
 #include <map>
 #include <cassert>
+#include <cstdint>
 
 #if defined(__clang__) || _MSC_VER >= 1900
 #define CONSTEXPR constexpr
@@ -28,10 +29,10 @@ enum class ESubjectType : int16_t {
     Num,
 };
 
-template <ESubjectType SubjectType>
+template <ESubjectType InSubjectType>
 struct ZenoSubject {
 
-    constexpr static ESubjectType SubjectType = SubjectType;
+    constexpr static ESubjectType SubjectType = InSubjectType;
     std::map<std::string, std::string> Meta;
 
     template <typename T>
@@ -344,6 +345,62 @@ struct PointSet : public ZenoSubject<ESubjectType::PointSet> {
     }
 };
 
+/**
+ * @brief Arrays of a subject that can be sent as a delta
+ */
+enum class EDeltaAttribute : int8_t {
+    Indices = 0, // int32 x3 per triangle
+    Positions,   // float x3 per vertex
+    Heights,     // uint16 per sample, row major
+};
+
+enum class EDeltaMode : int8_t {
+    Full = 0, // Data holds the elements starting at Offset
+    Runs,     // Runs holds (start, count) pairs, Data the new values of those elements back to back
+};
+
+/**
+ * @brief SubjectDeltaHeader
+ * @note  First frame of a /subject/delta response. The client applies the chunks that follow to its copy of
+ *        BaseVersion, or to empty arrays if BaseVersion is 0. Indices are only sent when bTopologyIncluded is set,
+ *        otherwise the client keeps the ones it has for TopologyHash.
+ */
+struct SubjectDeltaHeader {
+    std::string Name;
+    int16_t/* ESubjectType */ Type = 0;
+    int32_t Version = 0;
+    int32_t BaseVersion = 0;
+    uint64_t TopologyHash = 0;
+    bool bTopologyIncluded = false;
+    // Vertex count of a mesh, Nx * Ny of a height field
+    uint32_t NumElements = 0;
+    int32_t Nx = 0, Ny = 0;
+    uint32_t NumChunks = 0;
+    std::map<std::string, std::string> Meta;
+
+    template <class T>
+    void pack(T& pack) {
+        pack(Name, Type, Version, BaseVersion, TopologyHash, bTopologyIncluded, NumElements, Nx, Ny, NumChunks, Meta);
+    }
+};
+
+/**
+ * @brief SubjectDeltaChunk
+ * @note  A slice of one attribute. Values are raw little-endian, a full height field is cut at row boundaries.
+ */
+struct SubjectDeltaChunk {
+    int8_t/* EDeltaAttribute */ Attribute = 0;
+    int8_t/* EDeltaMode */ Mode = 0;
+    uint32_t Offset = 0;
+    std::vector<uint32_t> Runs;
+    std::vector<uint8_t> Data;
+
+    template <class T>
+    void pack(T& pack) {
+        pack(Attribute, Mode, Offset, Runs, Data);
+    }
+};
+
 inline const static std::string NAME_LandscapeInfoSimple = "__Internal_Reserved_LandscapeInfo";
 inline const static std::string NAME_SurfaceSample = "__Internal_Reserved_SurfaceSample";
 
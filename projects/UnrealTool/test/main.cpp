@@ -0,0 +1,139 @@
+#include "zeno/unreal/SubjectTransfer.h"
+#include "msgpack/msgpack.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace zeno::remote;
+
+namespace {
+
+    int NumFailed = 0;
+
+    void Check(bool bCondition, const char* What) {
+        if (!bCondition) {
+            std::cout << "FAILED: " << What << std::endl;
+            ++NumFailed;
+        }
+    }
+
+    SubjectContainer MakeMeshContainer(const std::vector<std::array<float, 3>>& Vertices, const std::vector<std::array<int32_t, 3>>& Triangles) {
+        std::vector<std::array<AnyNumeric, 3>> Verts;
+        for (const auto& Vertex : Vertices) {
+            Verts.push_back({Vertex[0], Vertex[1], Vertex[2]});
+        }
+        std::vector<std::array<int32_t, 3>> Trigs = Triangles;
+        Mesh Data(std::move(Verts), std::move(Trigs));
+        return SubjectContainer{"mesh", static_cast<int16_t>(ESubjectType::Mesh), msgpack::pack(Data)};
+    }
+
+    SubjectContainer MakeHeightFieldContainer(int32_t Side, const std::vector<uint16_t>& Heights) {
+        HeightField Data(Side, Side, Heights);
+        return SubjectContainer{"terrain", static_cast<int16_t>(ESubjectType::HeightField), msgpack::pack(Data)};
+    }
+
+    /**
+     * @brief All frames of a response, as the server would stream them
+     */
+    std::vector<uint8_t> Drain(SubjectDeltaWriter& Writer) {
+        std::vector<uint8_t> Stream;
+        while (Writer.Next(Stream)) {}
+        return Stream;
+    }
+
+    /**
+     * @brief Feed a response to a replica in small pieces, like a chunked http body arrives
+     */
+    bool Feed(SubjectReplica& Replica, const std::vector<uint8_t>& Stream, size_t Piece = 7) {
+        for (size_t Pos = 0; Pos < Stream.size(); Pos += Piece) {
+            if (!Replica.Consume(reinterpret_cast<const char*>(Stream.data()) + Pos, std::min(Piece, Stream.size() - Pos))) return false;
+        }
+        return Replica.IsComplete();
+    }
+
+    bool Matches(const SubjectReplica& Replica, const SubjectContainer& Container) {
+        auto Expected = SubjectSnapshot::FromContainer(Container);
+        return Expected && Replica.Data.Positions == Expected->Positions && Replica.Data.Indices == Expected->Indices
+               && Replica.Data.Heights == Expected->Heights && Replica.TopologyHash == Expected->TopologyHash;
+    }
+
+    void TestMesh() {
+        const size_t ChunkBytes = 1024;
+        std::vector<std::array<float, 3>> Vertices;
+        std::vector<std::array<int32_t, 3>> Triangles;
+        for (int32_t Idx = 0; Idx < 1000; ++Idx) {
+            Vertices.push_back({float(Idx), float(Idx % 7), 0.5f});
+            if (Idx >= 2) Triangles.push_back({Idx - 2, Idx - 1, Idx});
+        }
+        SubjectTransferCache Cache;
+        SubjectReplica Replica;
+
+        // Full transfer to a client holding nothing, cut into several chunks
+        auto Container = MakeMeshContainer(Vertices, Triangles);
+        auto Writer = Cache.MakeDelta("session", Container, Replica.Version, Replica.TopologyHash, ChunkBytes);
+        Check(Writer && Writer->GetHeader().BaseVersion == 0 && Writer->GetHeader().bTopologyIncluded, "full transfer has no base and sends indices");
+        Check(Writer && Writer->GetHeader().NumChunks > 2, "full transfer is cut into chunks");
+        Check(Writer && Feed(Replica, Drain(*Writer)) && Replica.Version == 1 && Matches(Replica, Container), "full transfer applies");
+        SubjectReplica Stale = Replica;
+
+        // Moving one vertex sends one run against the base, without the indices
+        Vertices[500][1] = 42.f;
+        Container = MakeMeshContainer(Vertices, Triangles);
+        Writer = Cache.MakeDelta("session", Container, Replica.Version, Replica.TopologyHash, ChunkBytes);
+        std::vector<uint8_t> Stream = Writer ? Drain(*Writer) : std::vector<uint8_t>{};
+        Check(Writer && Writer->GetHeader().BaseVersion == 1 && !Writer->GetHeader().bTopologyIncluded, "delta is against the base and skips indices");
+        Check(Stream.size() < 200, "delta of one vertex is small");
+        Check(Feed(Replica, Stream) && Replica.Version == 2 && Matches(Replica, Container), "delta applies");
+
+        // A delta for another base is refused and the held version stays
+        SubjectReplica Refused = Replica;
+        Check(!Feed(Refused, Stream) && Refused.Version == 2 && Matches(Refused, Container), "delta for another base is refused");
+
+        // New faces over the same vertices resend the indices, positions stay a delta
+        std::reverse(Triangles.begin(), Triangles.end());
+        Container = MakeMeshContainer(Vertices, Triangles);
+        Writer = Cache.MakeDelta("session", Container, Replica.Version, Replica.TopologyHash, ChunkBytes);
+        Check(Writer && Writer->GetHeader().BaseVersion == 2 && Writer->GetHeader().bTopologyIncluded, "topology change resends indices");
+        Check(Writer && Feed(Replica, Drain(*Writer)) && Replica.Version == 3 && Matches(Replica, Container), "topology change applies");
+
+        // Version 1 was dropped once the client named version 2, so a stale client gets everything again
+        Writer = Cache.MakeDelta("session", Container, Stale.Version, Stale.TopologyHash, ChunkBytes);
+        Check(Writer && Writer->GetHeader().BaseVersion == 0 && Writer->GetHeader().Version == 3, "stale base gets a full transfer");
+        Check(Writer && Feed(Stale, Drain(*Writer)) && Stale.Version == 3 && Matches(Stale, Container), "full transfer to a stale client applies");
+
+        // Nothing changed, nothing but the header is sent
+        Writer = Cache.MakeDelta("session", Container, Replica.Version, Replica.TopologyHash, ChunkBytes);
+        Check(Writer && Writer->GetHeader().NumChunks == 0 && Writer->GetHeader().Version == 3, "unchanged subject sends no chunks");
+        Check(Writer && Feed(Replica, Drain(*Writer)) && Replica.Version == 3 && Matches(Replica, Container), "empty delta applies");
+    }
+
+    void TestHeightField() {
+        const int32_t Side = 64;
+        const size_t ChunkBytes = 1024;
+        std::vector<uint16_t> Heights(Side * Side);
+        for (size_t Idx = 0; Idx < Heights.size(); ++Idx) {
+            Heights[Idx] = static_cast<uint16_t>(Idx * 37);
+        }
+        SubjectTransferCache Cache;
+        SubjectReplica Replica;
+
+        auto Container = MakeHeightFieldContainer(Side, Heights);
+        auto Writer = Cache.MakeDelta("session", Container, Replica.Version, Replica.TopologyHash, ChunkBytes);
+        Check(Writer && Writer->GetHeader().NumChunks == Side * Side * sizeof(uint16_t) / ChunkBytes, "full height field goes out in row tiles");
+        Check(Writer && Feed(Replica, Drain(*Writer), 100) && Matches(Replica, Container), "full height field applies");
+
+        Heights[Side * 10 + 3] = 1;
+        Heights[Side * 40 + 60] = 2;
+        Container = MakeHeightFieldContainer(Side, Heights);
+        Writer = Cache.MakeDelta("session", Container, Replica.Version, Replica.TopologyHash, ChunkBytes);
+        Check(Writer && Writer->GetHeader().BaseVersion == 1 && Writer->GetHeader().NumChunks == 1, "height field delta is one chunk of runs");
+        Check(Writer && Feed(Replica, Drain(*Writer), 1) && Replica.Version == 2 && Matches(Replica, Container), "height field delta applies");
+    }
+
+}
+
+int main() {
+    TestMesh();
+    TestHeightField();
+    std::cout << (NumFailed ? "Subject transfer checks failed" : "Subject transfer checks passed") << std::endl;
+    return NumFailed ? 1 : 0;
+}
@@ -40,6 +40,10 @@ static void numeric_eval (zfx::x64::Executable *exec,
     // $T       time elapsed in total (float, GetFrameTime * GetFrameNum + GetFrameTimeElapsed)
     //
 struct NumericEval : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto code = get_input2<std::string>("zfxCode");
         auto type = get_input2<std::string>("resType");
@@ -34,6 +34,10 @@ static void numeric_wrangle
 }
 
 struct NumericWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto code = get_input<zeno::StringObject>("zfxCode")->get();
 
@@ -61,6 +61,10 @@ static void vectors_wrangle
 }
 
 struct ParticlesTwoWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = get_input<zeno::PrimitiveObject>("prim");
         auto prim2 = get_input<zeno::PrimitiveObject>("prim2");
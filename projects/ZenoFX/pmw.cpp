@@ -66,6 +66,10 @@ static void vectors_wrangle
 }
 
 struct ParticlesMaskedWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = get_input<zeno::PrimitiveObject>("prim");
         auto code = get_input<zeno::StringObject>("zfxCode")->get();
@@ -737,6 +737,10 @@ ZENDEFNODE(QueryNearestPrimitiveWithinGroup, {
 
 
 struct ParticlesNeighborBvhWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
   virtual void apply() override {
     auto prim = get_input<zeno::PrimitiveObject>("prim");
     auto primNei = get_input<zeno::PrimitiveObject>("primNei");
@@ -963,6 +967,10 @@ ZENDEFNODE(ParticlesNeighborBvhWrangle,
            });
 
 struct ParticlesNeighborBvhWrangleSorted : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
   virtual void apply() override {
     auto prim = get_input<zeno::PrimitiveObject>("prim");
     auto primNei = get_input<zeno::PrimitiveObject>("primNei");
@@ -1191,6 +1199,10 @@ ZENDEFNODE(ParticlesNeighborBvhWrangleSorted,
 
 
 struct ParticlesNeighborBvhRadiusWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
   virtual void apply() override {
     auto prim = get_input<zeno::PrimitiveObject>("prim");
     auto primNei = get_input<zeno::PrimitiveObject>("primNei");
@@ -190,6 +190,10 @@ ZENDEFNODE(ParticlesBuildHashGrid, {
 });
 
 struct ParticlesNeighborWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = get_input<zeno::PrimitiveObject>("prim");
         auto primNei = get_input<zeno::PrimitiveObject>("primNei");
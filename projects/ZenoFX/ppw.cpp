@@ -57,6 +57,10 @@ static void vectors_wrangle
 }
 
 struct ParticleParticleWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = get_input<zeno::PrimitiveObject>("prim1");
         auto primNei = has_input("prim2") ?
@@ -32,6 +32,11 @@ namespace {
     //   Z:/ZenusTech/Models/out000042.obj
     //
     struct StringEval : zeno::INode {
+        // $F in the string is replaced by the frame number
+        virtual bool dependsOnFrame() const override {
+            return true;
+        }
+
         virtual void apply() override {
             auto code = get_input2<std::string>("zfxCode");
 
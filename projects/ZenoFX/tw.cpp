@@ -62,6 +62,10 @@ static void vectors_wrangle
 }
 
 struct TrianglesWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto prim = get_input<zeno::PrimitiveObject>("prim");
         auto type = get_input<zeno::StringObject>("faceType")->get();
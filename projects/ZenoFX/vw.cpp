@@ -120,6 +120,10 @@ void vdb_wrangle(zfx::x64::Executable *exec, GridPtr &grid, bool modifyActive, b
 }
 
 struct VDBWrangle : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto grid = get_input<zeno::VDBGrid>("grid");
         auto code = get_input<zeno::StringObject>("zfxCode")->get();
@@ -19,6 +19,10 @@
 namespace {
 using namespace zeno;
 
+struct CellRef {
+    int ijk, q, i, j, k;
+};
+
 struct AABBVoronoi : INode {
     virtual void apply() override {
         auto pieces = std::make_shared<ListObject>();
@@ -81,60 +85,89 @@ struct AABBVoronoi : INode {
             }*/
             pcon.setup(con);
 
-            int cid = 0;
+            // enumerate cells in the same order as a serial c_loop_all sweep would visit
+            std::vector<CellRef> cells;
             voro::c_loop_all cl(con);
-            voro::voronoicell_neighbor c;
-            if(cl.start()) do if(con.compute_cell(c, cl)) {
-                double x, y, z;
-                cl.pos(x, y, z);
-
-                std::vector<int> neigh, f_vert;
-                c.neighbors(neigh);
-                c.face_vertices(f_vert);
+            if (cl.start()) do {
+                cells.push_back({cl.ijk, cl.q, cl.i, cl.j, cl.k});
+            } while (cl.inc());
+
+            // cells are independent given the read-only container, so each thread
+            // owns its own voro_compute scratch and computes + meshes cells in parallel
+            std::vector<std::shared_ptr<PrimitiveObject>> cellPrims(cells.size());
+            std::vector<std::vector<int>> cellNeighs(cells.size());
+            int hx = periX ? 2 * nx + 1 : nx;
+            int hy = periY ? 2 * ny + 1 : ny;
+            int hz = periZ ? 2 * nz + 1 : nz;
+
+            #pragma omp parallel
+            {
+                voro::voro_compute<voro::container> vc(con, hx, hy, hz);
+                voro::voronoicell_neighbor c;
+                std::vector<int> f_vert;
                 std::vector<double> v;
-                c.vertices(x, y, z, v);
 
-                auto prim = std::make_shared<PrimitiveObject>();
+                #pragma omp for schedule(dynamic, 16)
+                for (int n = 0; n < (int)cells.size(); n++) {
+                    auto const &cr = cells[n];
+                    if (!vc.compute_cell(c, cr.ijk, cr.q, cr.i, cr.j, cr.k))
+                        continue;
+                    double *pp = con.p[cr.ijk] + 3 * cr.q;
+                    double x = pp[0], y = pp[1], z = pp[2];
+
+                    auto &neigh = cellNeighs[n];
+                    c.neighbors(neigh);
+                    c.face_vertices(f_vert);
+                    c.vertices(x, y, z, v);
+
+                    auto prim = std::make_shared<PrimitiveObject>();
+                    prim->resize(v.size() / 3);
+                    auto &pos = prim->verts.values;
+                    for (int i = 0; i < (int)pos.size(); i++) {
+                        pos[i] = vec3f(v[i * 3], v[i * 3 + 1], v[i * 3 + 2]);
+                    }
 
-                auto &pos = prim->add_attr<vec3f>("pos");
-                for (int i = 0; i < (int)v.size(); i += 3) {
-                    pos.emplace_back(v[i], v[i+1], v[i+2]);
+                    bool isBoundary = false;
+                    prim->loops.reserve(f_vert.size() - neigh.size());
+                    prim->polys.reserve(neigh.size());
+                    for (int i = 0, j = 0; i < (int)neigh.size(); i++) {
+                        if (neigh[i] <= 0)
+                            isBoundary = true;
+                        int len = f_vert[j];
+                        int start = (int)prim->loops.size();
+                        for (int k = j + 1; k < j + 1 + len; k++) {
+                            prim->loops.push_back(f_vert[k]);
+                        }
+                        prim->polys.emplace_back(start, len);
+                        j = j + 1 + len;
+                    }
+                    prim->userData().set("isBoundary", std::make_shared<NumericObject>(isBoundary));
+
+                    if (triangulate)
+                        prim_triangulate(prim.get());
+                    cellPrims[n] = std::move(prim);
                 }
-                prim->resize(pos.size());
-
-                bool isBoundary = false;
-                for (int i = 0, j = 0; i < (int)neigh.size(); i++) {
-                    if (neigh[i] <= 0) {
-                        isBoundary = true;
-                    } else {
-                        if (auto ncid = neigh[i] - 1; ncid > cid) {
+            }
+
+            // gather serially so that piece ids and neighbor pairs match the sweep order
+            int cid = 0;
+            for (int n = 0; n < (int)cells.size(); n++) {
+                if (!cellPrims[n])
+                    continue;
+                for (int nb: cellNeighs[n]) {
+                    if (nb > 0) {
+                        if (auto ncid = nb - 1; ncid > cid) {
                             neighs->arr.push_back(objectFromLiterial(vec2i(cid, ncid)));
                         }
                     }
-                    int len = f_vert[j];
-                    int start = (int)prim->loops.size();
-                    for (int k = j + 1; k < j + 1 + len; k++) {
-                        prim->loops.push_back(f_vert[k]);
-                    }
-                    prim->polys.emplace_back(start, len);
-                    j = j + 1 + len;
                 }
-
-                prim->userData().set("isBoundary", std::make_shared<NumericObject>(isBoundary));
-                pieces->arr.push_back(std::move(prim));
-
+                pieces->arr.push_back(std::move(cellPrims[n]));
                 cid++;
-            } while (cl.inc());
+            }
         }
 
         log_info("AABBVoronoi got {} pieces, {} neighs", pieces->arr.size(), neighs->arr.size());
 
-        if (triangulate) {
-            for (auto const &prim: pieces->get<PrimitiveObject>()) {
-                prim_triangulate(prim.get());
-            }
-        }
-
         set_output("primList", std::move(pieces));
         set_output("neighList", std::move(neighs));
     }
@@ -4,57 +4,419 @@
 #include <openvdb/tools/Morphology.h>
 #include <openvdb/tools/VolumeToMesh.h>
 #include <zeno/VDBGrid.h>
+#include <openvdb/tree/LeafManager.h>
 #include <omp.h>
 #include <zeno/ZenoInc.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <array>
+#include <cstring>
+#include <map>
 
 
 namespace zeno {
 
-struct SDFToPoly : zeno::INode{
-    virtual void apply() override {
-    auto sdf = get_input("SDF")->as<VDBFloatGrid>();
-    auto mesh = IObject::make<PrimitiveObject>();
-    auto adaptivity = get_param<float>(("adaptivity"));
-    auto isoValue = get_param<float>(("isoValue"));
-    auto allowQuads = get_param<bool>("allowQuads");
-    std::vector<openvdb::Vec3s> points(0);
-    std::vector<openvdb::Vec3I> tris(0);
-    std::vector<openvdb::Vec4I> quads(0);
-    openvdb::tools::volumeToMesh(*(sdf->m_grid), points, tris, quads, isoValue, adaptivity, true);
-    mesh->resize(points.size());
-    auto &meshpos = mesh->add_attr<zeno::vec3f>("pos");
-#pragma omp parallel for
-    for(int i=0;i<points.size();i++)
-    {
-        meshpos[i] = zeno::vec3f(points[i][0],points[i][1],points[i][2]);
+namespace {
+
+enum class SDFMeshLayout {
+    TrisQuads,  // tris and quads kept apart
+    Tris,       // quads split into two tris, appended after the tris
+    Polys,      // everything as polys/loops, quads first
+};
+
+// Writes mesher polygons into prim face arrays. Each face goes to a fixed slot, so
+// it is safe to call quad()/tri() concurrently for distinct indices.
+struct SDFMeshWriter {
+    PrimitiveObject *prim;
+    SDFMeshLayout layout;
+    bool reversed;
+    size_t nq = 0, nt = 0;
+
+    void resize(size_t nq_, size_t nt_) {
+        nq = nq_;
+        nt = nt_;
+        switch (layout) {
+        case SDFMeshLayout::TrisQuads:
+            prim->tris.resize(nt);
+            prim->quads.resize(nq);
+            break;
+        case SDFMeshLayout::Tris:
+            prim->tris.resize(nt + 2 * nq);
+            break;
+        case SDFMeshLayout::Polys:
+            prim->polys.resize(nq + nt);
+            prim->loops.resize(4 * nq + 3 * nt);
+            break;
+        }
     }
-    if (allowQuads) {
-        mesh->tris.resize(tris.size());
-        mesh->quads.resize(quads.size());
-#pragma omp parallel for
-        for(int i=0;i<tris.size();i++)
-        {
-            mesh->tris[i] = zeno::vec3i(tris[i][0],tris[i][1],tris[i][2]);
+
+    void quad(size_t i, openvdb::Vec4I const &q) const {
+        switch (layout) {
+        case SDFMeshLayout::TrisQuads:
+            prim->quads[i] = reversed ? vec4i(q[3], q[2], q[1], q[0]) : vec4i(q[0], q[1], q[2], q[3]);
+            break;
+        case SDFMeshLayout::Tris:
+            if (reversed) {
+                prim->tris[nt + 2 * i] = vec3i(q[2], q[1], q[0]);
+                prim->tris[nt + 2 * i + 1] = vec3i(q[0], q[3], q[2]);
+            } else {
+                prim->tris[nt + 2 * i] = vec3i(q[0], q[1], q[2]);
+                prim->tris[nt + 2 * i + 1] = vec3i(q[2], q[3], q[0]);
+            }
+            break;
+        case SDFMeshLayout::Polys:
+            prim->polys[i] = {(int)(4 * i), 4};
+            for (int k = 0; k < 4; k++)
+                prim->loops[4 * i + k] = q[reversed ? 3 - k : k];
+            break;
+        }
+    }
+
+    void tri(size_t i, openvdb::Vec3I const &t) const {
+        switch (layout) {
+        case SDFMeshLayout::TrisQuads:
+        case SDFMeshLayout::Tris:
+            prim->tris[i] = reversed ? vec3i(t[2], t[1], t[0]) : vec3i(t[0], t[1], t[2]);
+            break;
+        case SDFMeshLayout::Polys:
+            prim->polys[nq + i] = {(int)(4 * nq + 3 * i), 3};
+            for (int k = 0; k < 3; k++)
+                prim->loops[4 * nq + 3 * i + k] = t[reversed ? 2 - k : k];
+            break;
         }
+    }
+};
+
+// Copies the mesher output straight into prim in parallel over polygon pools, in the
+// same order volumeToMesh would (it copies everything serially into std::vectors first).
+static void mesherToPrim(openvdb::tools::VolumeToMesh &mesher, SDFMeshWriter writer) {
+    auto *prim = writer.prim;
+    size_t np = mesher.pointListSize();
+    auto const &points = mesher.pointList();
+    prim->resize(np);
+    auto &pos = prim->verts.values;
 #pragma omp parallel for
-        for(int i=0;i<quads.size();i++)
-        {
-            mesh->quads[i] = zeno::vec4i(quads[i][0],quads[i][1],quads[i][2],quads[i][3]);
+    for (size_t i = 0; i < np; i++) {
+        pos[i] = vec3f(points[i][0], points[i][1], points[i][2]);
+    }
+
+    auto &pools = mesher.polygonPoolList();
+    size_t npools = mesher.polygonPoolListSize();
+    std::vector<size_t> qoff(npools + 1), toff(npools + 1);
+    for (size_t n = 0; n < npools; n++) {
+        qoff[n + 1] = qoff[n] + pools[n].numQuads();
+        toff[n + 1] = toff[n] + pools[n].numTriangles();
+    }
+    writer.resize(qoff[npools], toff[npools]);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (size_t n = 0; n < npools; n++) {
+        auto const &pool = pools[n];
+        for (size_t i = 0, e = pool.numQuads(); i < e; i++)
+            writer.quad(qoff[n] + i, pool.quad(i));
+        for (size_t i = 0, e = pool.numTriangles(); i < e; i++)
+            writer.tri(toff[n] + i, pool.triangle(i));
+    }
+}
+
+// Per-leaf spatial adaptivity with hysteresis: a leaf is simplified once its surface
+// gets flat enough, and stays simplified until it is clearly curved again. Since the
+// mesher merges voxels within leaves only, this keeps simplified regions from
+// flickering between frames of an evolving surface.
+struct SDFStableAdaptivity {
+    openvdb::MaskGrid::Ptr flatLeaves;
+
+    openvdb::FloatGrid::Ptr update(openvdb::FloatGrid const &sdf, float isoValue, float threshold) {
+        using LeafT = openvdb::FloatTree::LeafNodeType;
+        openvdb::tree::LeafManager<const openvdb::FloatTree> leafman(sdf.tree());
+        size_t nleafs = leafman.leafCount();
+        float band = (float)sdf.voxelSize()[0];
+        std::vector<char> flat(nleafs);
+
+#pragma omp parallel for schedule(dynamic, 16)
+        for (size_t n = 0; n < nleafs; n++) {
+            LeafT const &leaf = leafman.leaf(n);
+            auto acc = sdf.getConstAccessor();
+            openvdb::Vec3d nsum(0);
+            int count = 0;
+            for (auto it = leaf.cbeginValueOn(); it; ++it) {
+                if (std::abs(*it - isoValue) > band)
+                    continue;
+                auto c = it.getCoord();
+                openvdb::Vec3d g(
+                    acc.getValue(c.offsetBy(1, 0, 0)) - acc.getValue(c.offsetBy(-1, 0, 0)),
+                    acc.getValue(c.offsetBy(0, 1, 0)) - acc.getValue(c.offsetBy(0, -1, 0)),
+                    acc.getValue(c.offsetBy(0, 0, 1)) - acc.getValue(c.offsetBy(0, 0, -1)));
+                double len = g.length();
+                if (len > 0) {
+                    nsum += g / len;
+                    count++;
+                }
+            }
+            // 0 for a plane, growing as normals inside the leaf diverge
+            double curvedness = count ? 1.0 - nsum.length() / count : 0.0;
+            bool wasFlat = flatLeaves && flatLeaves->tree().isValueOn(leaf.origin());
+            flat[n] = curvedness < (wasFlat ? 2 * threshold : threshold);
+        }
+
+        auto newFlat = openvdb::MaskGrid::create();
+        auto adapt = openvdb::FloatGrid::create(0.f);
+        adapt->setTransform(sdf.transform().copy());
+        for (size_t n = 0; n < nleafs; n++) {
+            if (flat[n]) {
+                auto origin = leafman.leaf(n).origin();
+                newFlat->tree().setValueOn(origin);
+                adapt->tree().addTile(1, origin, 1.f, true);
+            }
+        }
+        flatLeaves = newFlat;
+        return adapt;
+    }
+};
+
+static uint64_t sdfHashMix(uint64_t h, uint64_t x) {
+    h ^= x + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+// Re-polygonizes only the regions whose SDF changed since the previous call.
+// The grid is split into bricks (the leaf-parent internal nodes); every leaf is
+// hashed, a brick is dirty when any leaf within one leaf of it changed, and dirty
+// bricks are meshed from a padded copy of their leaves with a surface mask so each
+// polygon is produced by exactly one brick. Seam vertices are computed identically
+// on both sides and welded by exact position.
+struct IncrementalSDFMesher {
+    using TreeT = openvdb::FloatTree;
+    using LeafT = TreeT::LeafNodeType;
+    static constexpr int LEAF = LeafT::DIM;
+    static constexpr int BRICK = TreeT::RootNodeType::ChildNodeType::ChildNodeType::DIM;
+
+    struct Chunk {
+        uint64_t hash = 0;
+        std::vector<openvdb::Vec3s> points;
+        std::vector<openvdb::Vec4I> quads;
+        std::vector<openvdb::Vec3I> tris;
+    };
+
+    std::map<openvdb::Coord, Chunk> bricks;
+    uint64_t paramHash = 0;
+
+    static openvdb::Coord brickOf(openvdb::Coord const &c) {
+        return openvdb::Coord(c[0] & ~(BRICK - 1), c[1] & ~(BRICK - 1), c[2] & ~(BRICK - 1));
+    }
+
+    size_t mesh(openvdb::FloatGrid const &sdf, float isoValue, float adaptivity,
+                openvdb::FloatGrid::ConstPtr const &adaptGrid, uint64_t params, SDFMeshWriter writer) {
+        if (params != paramHash) {
+            bricks.clear();
+            paramHash = params;
+        }
+
+        // 1. hash leaves (and the adaptivity they will be meshed with)
+        openvdb::tree::LeafManager<const TreeT> leafman(sdf.tree());
+        size_t nleafs = leafman.leafCount();
+        std::vector<uint64_t> leafHash(nleafs);
+#pragma omp parallel for schedule(dynamic, 64)
+        for (size_t n = 0; n < nleafs; n++) {
+            LeafT const &leaf = leafman.leaf(n);
+            auto const *data = leaf.buffer().data();
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (openvdb::Index i = 0; i < LeafT::SIZE; i++) {
+                uint32_t bits;
+                std::memcpy(&bits, data + i, sizeof(bits));
+                h = (h ^ bits) * 0x100000001b3ull;
+            }
+            auto o = leaf.origin();
+            h = sdfHashMix(h, ((uint64_t)(uint32_t)o[0] << 32) | (uint32_t)o[1]);
+            h = sdfHashMix(h, (uint32_t)o[2]);
+            if (adaptGrid)
+                h = sdfHashMix(h, adaptGrid->tree().isValueOn(o));
+            leafHash[n] = h;
+        }
+
+        // 2. accumulate into every brick whose padded region the leaf touches;
+        //    summing keeps this independent of traversal order
+        std::map<openvdb::Coord, uint64_t> brickHash;
+        for (size_t n = 0; n < nleafs; n++) {
+            auto o = leafman.leaf(n).origin();
+            auto b = brickOf(o);
+            for (int dx = -1; dx <= 1; dx++) for (int dy = -1; dy <= 1; dy++) for (int dz = -1; dz <= 1; dz++) {
+                auto nb = b.offsetBy(dx * BRICK, dy * BRICK, dz * BRICK);
+                openvdb::CoordBBox padded(nb.offsetBy(-LEAF), nb.offsetBy(BRICK + LEAF - 1));
+                if (padded.isInside(o))
+                    brickHash[nb] += leafHash[n];
+            }
+        }
+
+        // 3. drop vanished bricks, collect dirty ones
+        for (auto it = bricks.begin(); it != bricks.end();) {
+            if (brickHash.find(it->first) == brickHash.end())
+                it = bricks.erase(it);
+            else
+                ++it;
         }
-    } else {
-        mesh->tris.resize(tris.size() + 2*quads.size());
+        std::vector<std::pair<openvdb::Coord, Chunk *>> dirty;
+        for (auto const &[b, h]: brickHash) {
+            auto [it, inserted] = bricks.try_emplace(b);
+            if (inserted || it->second.hash != h) {
+                it->second.hash = h;
+                dirty.emplace_back(b, &it->second);
+            }
+        }
+
+        // 4. re-mesh dirty bricks from a padded copy of their leaves (and inside tiles)
+        tbb::parallel_for(size_t(0), dirty.size(), [&] (size_t d) {
+            auto [b, chunk] = dirty[d];
+            auto sub = openvdb::FloatGrid::create(sdf.background());
+            sub->setTransform(sdf.transform().copy());
+            sub->setGridClass(sdf.getGridClass());
+            auto acc = sdf.getConstAccessor();
+            for (int x = -LEAF; x < BRICK + LEAF; x += LEAF)
+            for (int y = -LEAF; y < BRICK + LEAF; y += LEAF)
+            for (int z = -LEAF; z < BRICK + LEAF; z += LEAF) {
+                auto o = b.offsetBy(x, y, z);
+                if (auto const *leaf = acc.probeConstLeaf(o)) {
+                    sub->tree().addLeaf(new LeafT(*leaf));
+                } else {
+                    float val;
+                    bool on = acc.probeValue(o, val);
+                    if (val != sdf.background() || on)
+                        sub->tree().addTile(1, o, val, on);
+                }
+            }
+            auto mask = openvdb::BoolGrid::create(false);
+            mask->setTransform(sdf.transform().copy());
+            mask->tree().fill(openvdb::CoordBBox(b, b.offsetBy(BRICK - 1)), true, true);
+
+            openvdb::tools::VolumeToMesh mesher(isoValue, adaptivity, true);
+            mesher.setSurfaceMask(mask);
+            if (adaptGrid)
+                mesher.setSpatialAdaptivity(adaptGrid);
+            mesher(*sub);
+
+            auto const &points = mesher.pointList();
+            chunk->points.assign(points.get(), points.get() + mesher.pointListSize());
+            chunk->quads.clear();
+            chunk->tris.clear();
+            auto &pools = mesher.polygonPoolList();
+            for (size_t n = 0, e = mesher.polygonPoolListSize(); n < e; n++) {
+                auto const &pool = pools[n];
+                for (size_t i = 0; i < pool.numQuads(); i++)
+                    chunk->quads.push_back(pool.quad(i));
+                for (size_t i = 0; i < pool.numTriangles(); i++)
+                    chunk->tris.push_back(pool.triangle(i));
+            }
+        });
+
+        assemble(sdf, writer);
+        return dirty.size();
+    }
+
+    void assemble(openvdb::FloatGrid const &sdf, SDFMeshWriter writer) {
+        std::vector<Chunk const *> chunks;
+        for (auto const &[b, chunk]: bricks)
+            chunks.push_back(&chunk);
+        size_t nc = chunks.size();
+        std::vector<size_t> poff(nc + 1), qoff(nc + 1), toff(nc + 1);
+        for (size_t c = 0; c < nc; c++) {
+            poff[c + 1] = poff[c] + chunks[c]->points.size();
+            qoff[c + 1] = qoff[c] + chunks[c]->quads.size();
+            toff[c + 1] = toff[c] + chunks[c]->tris.size();
+        }
+        size_t np = poff[nc];
+        std::vector<openvdb::Vec3s> points(np);
+#pragma omp parallel for schedule(dynamic, 4)
+        for (size_t c = 0; c < nc; c++) {
+            std::copy(chunks[c]->points.begin(), chunks[c]->points.end(), points.begin() + poff[c]);
+        }
+
+        // weld duplicated seam vertices: only points within a voxel of a brick face can be shared
+        std::vector<int> remap(np);
+        std::vector<char> onSeam(np);
 #pragma omp parallel for
-        for(int i=0;i<tris.size();i++)
-        {
-            mesh->tris[i] = zeno::vec3i(tris[i][0],tris[i][1],tris[i][2]);
+        for (size_t i = 0; i < np; i++) {
+            remap[i] = (int)i;
+            auto ip = sdf.transform().worldToIndex(openvdb::Vec3d(points[i]));
+            for (int k = 0; k < 3; k++) {
+                double f = ip[k] - std::floor(ip[k] / BRICK) * BRICK;
+                if (f < 1.5 || f > BRICK - 1.5)
+                    onSeam[i] = 1;
+            }
+        }
+        std::vector<int> seam;
+        for (size_t i = 0; i < np; i++) {
+            if (onSeam[i])
+                seam.push_back((int)i);
         }
+        auto bitsOf = [&] (int i) {
+            std::array<uint32_t, 3> k;
+            std::memcpy(k.data(), &points[i][0], sizeof(k));
+            return k;
+        };
+        tbb::parallel_sort(seam.begin(), seam.end(), [&] (int a, int b) {
+            auto ka = bitsOf(a), kb = bitsOf(b);
+            return ka != kb ? ka < kb : a < b;
+        });
+        for (size_t s = 1; s < seam.size(); s++) {
+            if (bitsOf(seam[s]) == bitsOf(seam[s - 1]))
+                remap[seam[s]] = remap[seam[s - 1]];
+        }
+
+        // keep only referenced representatives, in original order
+        std::vector<int> used(np);
+        auto markFace = [&] (size_t c, auto const &f) {
+            for (int k = 0; k < (int)f.size; k++)
+                used[remap[poff[c] + f[k]]] = 1;
+        };
+#pragma omp parallel for schedule(dynamic, 4)
+        for (size_t c = 0; c < nc; c++) {
+            for (auto const &q: chunks[c]->quads) markFace(c, q);
+            for (auto const &t: chunks[c]->tris) markFace(c, t);
+        }
+        std::vector<int> newIndex(np + 1);
+        for (size_t i = 0; i < np; i++)
+            newIndex[i + 1] = newIndex[i] + used[i];
+
+        auto *prim = writer.prim;
+        prim->resize(newIndex[np]);
+        auto &pos = prim->verts.values;
 #pragma omp parallel for
-        for(int i=0;i<quads.size();i++)
-        {
-            mesh->tris[i*2+tris.size()] = zeno::vec3i(quads[i][0],quads[i][1],quads[i][2]);
-            mesh->tris[i*2+1+tris.size()] = zeno::vec3i(quads[i][2],quads[i][3],quads[i][0]);
+        for (size_t i = 0; i < np; i++) {
+            if (used[i])
+                pos[newIndex[i]] = vec3f(points[i][0], points[i][1], points[i][2]);
+        }
+
+        writer.resize(qoff[nc], toff[nc]);
+#pragma omp parallel for schedule(dynamic, 4)
+        for (size_t c = 0; c < nc; c++) {
+            auto idx = [&] (openvdb::Index v) {
+                return (openvdb::Index)newIndex[remap[poff[c] + v]];
+            };
+            auto const &quads = chunks[c]->quads;
+            for (size_t i = 0; i < quads.size(); i++) {
+                auto const &q = quads[i];
+                writer.quad(qoff[c] + i, openvdb::Vec4I(idx(q[0]), idx(q[1]), idx(q[2]), idx(q[3])));
+            }
+            auto const &tris = chunks[c]->tris;
+            for (size_t i = 0; i < tris.size(); i++) {
+                auto const &t = tris[i];
+                writer.tri(toff[c] + i, openvdb::Vec3I(idx(t[0]), idx(t[1]), idx(t[2])));
+            }
         }
     }
+};
+
+}
+
+struct SDFToPoly : zeno::INode{
+    virtual void apply() override {
+    auto sdf = get_input("SDF")->as<VDBFloatGrid>();
+    auto mesh = IObject::make<PrimitiveObject>();
+    auto adaptivity = get_param<float>(("adaptivity"));
+    auto isoValue = get_param<float>(("isoValue"));
+    auto allowQuads = get_param<bool>("allowQuads");
+    openvdb::tools::VolumeToMesh mesher(isoValue, adaptivity, true);
+    mesher(*(sdf->m_grid));
+    mesherToPrim(mesher, {mesh.get(), allowQuads ? SDFMeshLayout::TrisQuads : SDFMeshLayout::Tris, false});
 
     set_output("Mesh", mesh);
   }
@@ -135,63 +497,55 @@ ZENO_DEFOVERLOADNODE(ToVisualize, _VDBFloatGrid, typeid(VDBFloatGrid).name())({
 #endif
 
 struct SDFToPrim : zeno::INode{
+    SDFStableAdaptivity stable;
+    IncrementalSDFMesher incremental;
+
     virtual void apply() override {
         auto sdf = get_input("SDF")->as<VDBFloatGrid>();
         auto mesh = IObject::make<PrimitiveObject>();
         auto adaptivity = get_input2<float>(("adaptivity"));
         auto isoValue = get_input2<float>(("isoValue"));
         auto allowQuads = get_input2<bool>("allowQuads");
-        std::vector<openvdb::Vec3s> points(0);
-        std::vector<openvdb::Vec3I> tris(0);
-        std::vector<openvdb::Vec4I> quads(0);
+        auto stableAdaptivity = get_input2<bool>("stableAdaptivity");
+        auto stableThreshold = get_input2<float>("stableThreshold");
+        auto doIncremental = get_input2<bool>("incremental");
         if (allowQuads) {
             // no adaptivity
-            openvdb::tools::volumeToMesh(*(sdf->m_grid), points, quads, isoValue);
-        } else {
-            openvdb::tools::volumeToMesh(*(sdf->m_grid), points, tris, quads, isoValue, adaptivity, true);
+            adaptivity = 0;
         }
-        mesh->resize(points.size());
-        auto &meshpos = mesh->add_attr<zeno::vec3f>("pos");
-#pragma omp parallel for
-        for(int i=0;i<points.size();i++)
-        {
-            meshpos[i] = zeno::vec3f(points[i][0],points[i][1],points[i][2]);
+        SDFMeshWriter writer{mesh.get(), allowQuads ? SDFMeshLayout::Polys : SDFMeshLayout::Tris, true};
+        auto const &grid = *(sdf->m_grid);
+
+        openvdb::FloatGrid::ConstPtr adaptGrid;
+        if (stableAdaptivity && adaptivity > 0) {
+            adaptGrid = stable.update(grid, isoValue, stableThreshold);
+        } else {
+            stable.flatLeaves = nullptr;
         }
-        if (allowQuads) {
-//            mesh->tris.resize(tris.size());
-            //mesh->quads.resize(quads.size());
-//#pragma omp parallel for
-//            for(int i=0;i<tris.size();i++)
-//            {
-//                mesh->tris[i] = zeno::vec3i(tris[i][2],tris[i][1],tris[i][0]);
-//            }
-
-            mesh->polys.resize(quads.size());
-            mesh->loops.resize(4*quads.size());
-#pragma omp parallel for
-            for(int i=0;i<quads.size();i++)
-            {
-              mesh->polys[i] = {i*4, 4};
-              for(int k=0;k<4;k++)
-              {
-                mesh->loops[i*4+k] = quads[i][3-k];
-              }
-
-              //mesh->quads[i] = zeno::vec4i(quads[i][3],quads[i][2],quads[i][1],quads[i][0]);
+
+        if (doIncremental) {
+            uint64_t params = sdfHashMix(sdfHashMix(sdfHashMix(0, std::hash<float>()(isoValue)),
+                std::hash<float>()(adaptivity)), (uint64_t)allowQuads << 1 | (bool)adaptGrid);
+            // cached bricks hold world space points, and the background decides the sign of
+            // every voxel the tree does not store, so moving the grid or changing either
+            // remeshes everything
+            auto const &map = *grid.transform().baseMap();
+            params = sdfHashMix(params, std::hash<std::string>()(map.type()));
+            auto xform = map.getAffineMap()->getMat4();
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++)
+                    params = sdfHashMix(params, std::hash<double>()(xform(i, j)));
             }
+            params = sdfHashMix(params, std::hash<float>()(grid.background()));
+            auto remeshed = incremental.mesh(grid, isoValue, adaptivity, adaptGrid, params, writer);
+            log_debug("SDFToPrim: re-meshed {} of {} bricks", remeshed, incremental.bricks.size());
         } else {
-            mesh->tris.resize(tris.size() + 2*quads.size());
-#pragma omp parallel for
-            for(int i=0;i<tris.size();i++)
-            {
-                mesh->tris[i] = zeno::vec3i(tris[i][2],tris[i][1],tris[i][0]);
-            }
-#pragma omp parallel for
-            for(int i=0;i<quads.size();i++)
-            {
-                mesh->tris[i*2+tris.size()] = zeno::vec3i(quads[i][2],quads[i][1],quads[i][0]);
-                mesh->tris[i*2+1+tris.size()] = zeno::vec3i(quads[i][0],quads[i][3],quads[i][2]);
-            }
+            incremental.bricks.clear();
+            openvdb::tools::VolumeToMesh mesher(isoValue, adaptivity, true);
+            if (adaptGrid)
+                mesher.setSpatialAdaptivity(adaptGrid);
+            mesher(grid);
+            mesherToPrim(mesher, writer);
         }
 
         set_output("prim", std::move(mesh));
@@ -203,6 +557,9 @@ ZENDEFNODE(SDFToPrim, {
         {"float", "isoValue", "0"},
         {"float", "adaptivity", "0"},
         {"bool", "allowQuads", "0"},
+        {"bool", "stableAdaptivity", "0"},
+        {"float", "stableThreshold", "0.02"},
+        {"bool", "incremental", "0"},
     },
     {
         "prim",
@@ -7,6 +7,12 @@
 #include <zeno/utils/UserData.h>
 #include <zeno/zeno.h>
 #include <zeno/ZenoInc.h>
+#include <zeno/utils/morton.h>
+#include <zeno/utils/wangsrng.h>
+#include <openvdb/tools/Interpolation.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <chrono>
 
 namespace zeno {
 
@@ -41,29 +47,125 @@ struct is_vdb_to_prim_convertible<std::vector<T>, std::void_t<typename attr_to_v
   static constexpr bool value = true;
 };
 
-template <class T>
-void sampleVDBAttribute(std::vector<vec3f> const &pos, std::vector<T> &arr,
-                        VDBGrid *ggrid) {
+enum class VDBSamplerType { Box, Point, Quadratic, StaggeredBox, StaggeredQuadratic, Auto };
+
+static VDBSamplerType vdbSamplerFromString(std::string const &name) {
+  if (name == "Point") return VDBSamplerType::Point;
+  if (name == "Quadratic") return VDBSamplerType::Quadratic;
+  if (name == "StaggeredBox") return VDBSamplerType::StaggeredBox;
+  if (name == "StaggeredQuadratic") return VDBSamplerType::StaggeredQuadratic;
+  if (name == "Auto") return VDBSamplerType::Auto;
+  return VDBSamplerType::Box;
+}
+
+// Orders query points by the Morton code of the VDB leaf they fall into, so that
+// consecutive queries (and thus each thread's contiguous chunk) hit the same leaf
+// and the accessor cache stays warm.
+template <class GridT>
+std::vector<int> vdbLeafCoherentOrder(std::vector<openvdb::Vec3R> const &ipos) {
+  constexpr int log2dim = GridT::TreeType::LeafNodeType::LOG2DIM;
+  std::vector<std::pair<uint64_t, int>> keys(ipos.size());
+#pragma omp parallel for
+  for (int i = 0; i < (int)ipos.size(); i++) {
+    auto c = openvdb::Coord::floor(ipos[i]);
+    uint64_t x = (uint64_t)((c[0] >> log2dim) + (1 << 20)) & 0x1fffff;
+    uint64_t y = (uint64_t)((c[1] >> log2dim) + (1 << 20)) & 0x1fffff;
+    uint64_t z = (uint64_t)((c[2] >> log2dim) + (1 << 20)) & 0x1fffff;
+    keys[i] = {morton3d::encode(x, y, z), i};
+  }
+  tbb::parallel_sort(keys.begin(), keys.end());
+  std::vector<int> order(keys.size());
+#pragma omp parallel for
+  for (int i = 0; i < (int)keys.size(); i++) {
+    order[i] = keys[i].second;
+  }
+  return order;
+}
+
+// Samples `grid` at index-space positions `ipos`, visiting them in `order` (or input
+// order if empty). Each thread owns one value accessor for its whole chunk.
+template <class Sampler, class GridT, class Store>
+void sampleVDBInOrder(GridT const &grid, std::vector<openvdb::Vec3R> const &ipos,
+                      std::vector<int> const &order, Store const &store) {
+  int n = (int)ipos.size();
+#pragma omp parallel
+  {
+    auto acc = grid.getConstAccessor();
+#pragma omp for schedule(static)
+    for (int k = 0; k < n; k++) {
+      int i = order.empty() ? k : order[k];
+      store(i, Sampler::sample(acc, ipos[i]));
+    }
+  }
+}
+
+template <class GridT, class Store>
+void sampleVDBDispatch(GridT const &grid, std::vector<openvdb::Vec3R> const &ipos,
+                       std::vector<int> const &order, VDBSamplerType type, Store const &store) {
+  using Traits = openvdb::math::VecTraits<typename GridT::ValueType>;
+  if constexpr (!std::is_floating_point_v<typename Traits::ElementType>) {
+    // integer grids only ever supported trilinear sampling
+    return sampleVDBInOrder<openvdb::tools::BoxSampler>(grid, ipos, order, store);
+  } else {
+    if (type == VDBSamplerType::Auto) {
+      type = Traits::IsVec && grid.getGridClass() == openvdb::GRID_STAGGERED
+          ? VDBSamplerType::StaggeredBox : VDBSamplerType::Box;
+    }
+    if constexpr (Traits::IsVec) {
+      if (type == VDBSamplerType::StaggeredBox)
+        return sampleVDBInOrder<openvdb::tools::StaggeredBoxSampler>(grid, ipos, order, store);
+      if (type == VDBSamplerType::StaggeredQuadratic)
+        return sampleVDBInOrder<openvdb::tools::StaggeredQuadraticSampler>(grid, ipos, order, store);
+    }
+    switch (type) {
+    case VDBSamplerType::Point:
+      return sampleVDBInOrder<openvdb::tools::PointSampler>(grid, ipos, order, store);
+    case VDBSamplerType::Quadratic:
+    case VDBSamplerType::StaggeredQuadratic:
+      return sampleVDBInOrder<openvdb::tools::QuadraticSampler>(grid, ipos, order, store);
+    default:
+      return sampleVDBInOrder<openvdb::tools::BoxSampler>(grid, ipos, order, store);
+    }
+  }
+}
+
+template <class T, class PosFn>
+void sampleVDBAttributeImpl(size_t n, PosFn const &posFn, std::vector<T> &arr,
+                            VDBGrid *ggrid, VDBSamplerType type, bool coherent) {
   using VDBType = typename attr_to_vdb_type<T>::type;
   auto ptr = dynamic_cast<VDBType *>(ggrid);
   if (!ptr) {
     zeno::log_error("ERROR: vdb attribute type mismatch!");
     throw std::runtime_error("ERROR: vdb attribute type mismatch!");
   }
-  auto grid = ptr->m_grid;
+  auto const &grid = *ptr->m_grid;
+  using GridT = std::decay_t<decltype(grid)>;
 
+  std::vector<openvdb::Vec3R> ipos(n);
 #pragma omp parallel for
-  for (int i = 0; i < pos.size(); i++) {
-    auto p0 = pos[i];
-    auto p1 = vec_to_other<openvdb::Vec3R>(p0);
-    auto p2 = grid->worldToIndex(p1);
-    auto val = openvdb::tools::BoxSampler::sample(grid->getConstUnsafeAccessor(), p2);
+  for (int i = 0; i < (int)n; i++) {
+    ipos[i] = grid.worldToIndex(vec_to_other<openvdb::Vec3R>(posFn(i)));
+  }
+  std::vector<int> order;
+  if (coherent)
+    order = vdbLeafCoherentOrder<GridT>(ipos);
+
+  sampleVDBDispatch(grid, ipos, order, type, [&] (int i, auto const &val) {
     if constexpr (attr_to_vdb_type<T>::is_scalar) {
       arr[i] = val;
     } else {
       arr[i] = other_to_vec<3>(val);
     }
-  }
+  });
+}
+
+template <class T>
+void sampleVDBAttribute(std::vector<vec3f> const &pos, std::vector<T> &arr,
+                        VDBGrid *ggrid, VDBSamplerType type = VDBSamplerType::Box,
+                        bool coherent = true) {
+  sampleVDBAttributeImpl(pos.size(), [&] (int i) {
+    return pos[i];
+  }, arr, ggrid, type, coherent);
 }
 template <class T>
 void sampleVDBAttribute2(
@@ -73,26 +175,9 @@ void sampleVDBAttribute2(
         float remapMin,
         float remapMax
 ) {
-    using VDBType = typename attr_to_vdb_type<T>::type;
-    auto ptr = dynamic_cast<VDBType *>(ggrid);
-    if (!ptr) {
-        zeno::log_error("ERROR: vdb attribute type mismatch!");
-        throw std::runtime_error("ERROR: vdb attribute type mismatch!");
-    }
-    auto grid = ptr->m_grid;
-
-    #pragma omp parallel for
-    for (int i = 0; i < pos.size(); i++) {
-        auto p0 = (pos[i] - remapMin) / (remapMax - remapMin);
-        auto p1 = vec_to_other<openvdb::Vec3R>(p0);
-        auto p2 = grid->worldToIndex(p1);
-        auto val = openvdb::tools::BoxSampler::sample(grid->getConstUnsafeAccessor(), p2);
-        if constexpr (attr_to_vdb_type<T>::is_scalar) {
-            arr[i] = val;
-        } else {
-            arr[i] = other_to_vec<3>(val);
-        }
-    }
+    sampleVDBAttributeImpl(pos.size(), [&] (int i) {
+        return (pos[i] - remapMin) / (remapMax - remapMin);
+    }, arr, ggrid, VDBSamplerType::Box, true);
 }
 struct SampleVDBToPrimitive : INode {
   virtual void apply() override {
@@ -102,6 +187,8 @@ struct SampleVDBToPrimitive : INode {
     auto sampleby = get_input<StringObject>("sampleBy")->get();
     auto &pos = prim->attr<vec3f>(sampleby);
     auto type = get_param<std::string>(("SampleType"));
+    auto sampler = vdbSamplerFromString(get_param<std::string>("sampler"));
+    auto coherent = get_param<bool>("coherent");
 
 
     if (dynamic_cast<VDBFloatGrid *>(grid.get()))
@@ -121,7 +208,7 @@ struct SampleVDBToPrimitive : INode {
     //std::visit([&](auto &vel) { 
     prim->attr_visit(attr, [&] (auto &vel) {
       if constexpr (is_vdb_to_prim_convertible<std::decay_t<decltype(vel)>>::value)
-        sampleVDBAttribute(pos, vel, grid.get()); 
+        sampleVDBAttribute(pos, vel, grid.get(), sampler, coherent);
     });
                //prim->attr(attr));
 
@@ -139,7 +226,11 @@ struct SampleVDBToPrimitive : INode {
 ZENDEFNODE(SampleVDBToPrimitive, {
                                      {"prim", "vdbGrid", {"string", "sampleBy","pos"}, {"string", "primAttr", "sdf"}},
                                      {"prim"},
-                                     {{"enum Clamp Periodic", "SampleType", "Clamp"}},
+                                     {
+                                         {"enum Clamp Periodic", "SampleType", "Clamp"},
+                                         {"enum Box Point Quadratic StaggeredBox StaggeredQuadratic Auto", "sampler", "Box"},
+                                         {"bool", "coherent", "1"},
+                                     },
                                      {"openvdb"},
                                  });
 
@@ -239,4 +330,65 @@ ZENDEFNODE(PrimSample, {
     {},
     {"primitive"},
 });
+
+// Times sampling the same (shuffled) query points in input order vs. leaf-coherent order.
+struct BenchmarkSampleVDB : zeno::INode {
+    virtual void apply() override {
+        auto prim = get_input<PrimitiveObject>("prim");
+        auto grid = get_input<VDBGrid>("vdbGrid");
+        auto sampleBy = get_input2<std::string>("sampleBy");
+        auto sampler = vdbSamplerFromString(get_input2<std::string>("sampler"));
+        auto repeat = std::max(get_input2<int>("repeat"), 1);
+
+        auto pos = prim->attr<vec3f>(sampleBy);
+        if (get_input2<bool>("shuffle")) {
+            wangsrng rng(pos.size());
+            for (size_t i = pos.size(); i > 1; i--) {
+                std::swap(pos[i - 1], pos[rng.next_uint64() % i]);
+            }
+        }
+
+        auto measure = [&] (bool coherent) {
+            double best = std::numeric_limits<double>::max();
+            for (int r = 0; r < repeat; r++) {
+                auto t0 = std::chrono::steady_clock::now();
+                if (dynamic_cast<VDBFloatGrid *>(grid.get())) {
+                    std::vector<float> arr(pos.size());
+                    sampleVDBAttribute(pos, arr, grid.get(), sampler, coherent);
+                } else if (dynamic_cast<VDBFloat3Grid *>(grid.get())) {
+                    std::vector<vec3f> arr(pos.size());
+                    sampleVDBAttribute(pos, arr, grid.get(), sampler, coherent);
+                } else {
+                    throw zeno::Exception("unknown vdb grid type\n");
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+            }
+            return best;
+        };
+        double randomTime = measure(false);
+        double coherentTime = measure(true);
+        zeno::log_info("BenchmarkSampleVDB: {} points, input order {}s ({} Mpts/s), leaf-coherent {}s ({} Mpts/s)",
+                       pos.size(), randomTime, pos.size() * 1e-6 / randomTime,
+                       coherentTime, pos.size() * 1e-6 / coherentTime);
+        set_output("randomTime", std::make_shared<NumericObject>((float)randomTime));
+        set_output("coherentTime", std::make_shared<NumericObject>((float)coherentTime));
+    }
+};
+ZENDEFNODE(BenchmarkSampleVDB, {
+    {
+        {"PrimitiveObject", "prim"},
+        {"vdbGrid"},
+        {"string", "sampleBy", "pos"},
+        {"enum Box Point Quadratic StaggeredBox StaggeredQuadratic Auto", "sampler", "Box"},
+        {"bool", "shuffle", "1"},
+        {"int", "repeat", "3"},
+    },
+    {
+        {"float", "randomTime"},
+        {"float", "coherentTime"},
+    },
+    {},
+    {"openvdb"},
+});
 } // namespace zeno
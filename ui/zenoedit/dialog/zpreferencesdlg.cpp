@@ -77,14 +77,20 @@ ZenoCachePane::ZenoCachePane(QWidget* parent) : QWidget(parent)
     QVariant varAutoCleanCache = inst.getValue(zsCacheAutoClean);
     QVariant varEnableShiftChangeFOV = inst.getValue(zsEnableShiftChangeFOV);
     QVariant varViewportPointSizeScale = inst.getValue(zsViewportPointSizeScale);
+    QVariant varViewportLodMaxPoints = inst.getValue(zsViewportLodMaxPoints);
+    QVariant varViewportLodMaxTris = inst.getValue(zsViewportLodMaxTris);
+    QVariant varRunnerKeepAlive = inst.getValue(zsRunnerKeepAlive);
 
     bool bEnableCache = varEnableCache.isValid() ? varEnableCache.toBool() : false;
     bool bTempCacheDir = varTempCacheDir.isValid() ? varTempCacheDir.toBool() : false;
     QString cacheRootDir = varCacheRoot.isValid() ? varCacheRoot.toString() : "";
     int cacheNum = varCacheNum.isValid() ? varCacheNum.toInt() : 1;
     double viewportPointSizeScale = varViewportPointSizeScale.isValid() ? varViewportPointSizeScale.toDouble() : 1;
+    int viewportLodMaxPoints = varViewportLodMaxPoints.isValid() ? varViewportLodMaxPoints.toInt() : 10000000;
+    int viewportLodMaxTris = varViewportLodMaxTris.isValid() ? varViewportLodMaxTris.toInt() : 5000000;
     bool bAutoCleanCache = varAutoCleanCache.isValid() ? varAutoCleanCache.toBool() : true;
     bool bEnableShiftChangeFOV = varEnableShiftChangeFOV.isValid() ? varEnableShiftChangeFOV.toBool() : true;
+    bool bRunnerKeepAlive = varRunnerKeepAlive.isValid() ? varRunnerKeepAlive.toBool() : false;
 
     CALLBACK_SWITCH cbSwitch = [=](bool bOn) {
         zenoApp->getMainWindow()->setInDlgEventLoop(bOn); //deal with ubuntu dialog slow problem when update viewport.
@@ -102,6 +108,10 @@ ZenoCachePane::ZenoCachePane(QWidget* parent) : QWidget(parent)
     m_pEnableShiftChangeFOV = new QCheckBox;
     m_pEnableShiftChangeFOV->setCheckState(bEnableShiftChangeFOV ? Qt::Checked : Qt::Unchecked);
 
+    //the runner process keeps its graph and only reruns changed nodes, Kill starts over.
+    m_pRunnerKeepAlive = new QCheckBox;
+    m_pRunnerKeepAlive->setCheckState(bRunnerKeepAlive ? Qt::Checked : Qt::Unchecked);
+
     connect(m_pTempCacheDir, &QCheckBox::stateChanged, [=](bool state) {
         m_pPathEdit->setText("");
         m_pPathEdit->setEnabled(!state);
@@ -117,6 +127,16 @@ ZenoCachePane::ZenoCachePane(QWidget* parent) : QWidget(parent)
     m_pViewportPointSizeScaleSpinBox = new QDoubleSpinBox;
     m_pViewportPointSizeScaleSpinBox->setValue(viewportPointSizeScale);
 
+    //0 draws every point and triangle of an object.
+    m_pViewportLodMaxPointsSpinBox = new QSpinBox;
+    m_pViewportLodMaxPointsSpinBox->setRange(0, 2000000000);
+    m_pViewportLodMaxPointsSpinBox->setSingleStep(1000000);
+    m_pViewportLodMaxPointsSpinBox->setValue(viewportLodMaxPoints);
+    m_pViewportLodMaxTrisSpinBox = new QSpinBox;
+    m_pViewportLodMaxTrisSpinBox->setRange(0, 2000000000);
+    m_pViewportLodMaxTrisSpinBox->setSingleStep(1000000);
+    m_pViewportLodMaxTrisSpinBox->setValue(viewportLodMaxTris);
+
     m_pEnableCheckbox = new QCheckBox;
     m_pEnableCheckbox->setCheckState(bEnableCache ? Qt::Checked : Qt::Unchecked);
     connect(m_pEnableCheckbox, &QCheckBox::stateChanged, [=](bool state) {
@@ -148,6 +168,12 @@ ZenoCachePane::ZenoCachePane(QWidget* parent) : QWidget(parent)
     pLayout->addWidget(m_pEnableShiftChangeFOV, 5, 1);
     pLayout->addWidget(new QLabel(tr("Viewport Point Size scale")), 6, 0);
     pLayout->addWidget(m_pViewportPointSizeScaleSpinBox, 6, 1);
+    pLayout->addWidget(new QLabel(tr("Viewport max points per object")), 7, 0);
+    pLayout->addWidget(m_pViewportLodMaxPointsSpinBox, 7, 1);
+    pLayout->addWidget(new QLabel(tr("Viewport max triangles per object")), 8, 0);
+    pLayout->addWidget(m_pViewportLodMaxTrisSpinBox, 8, 1);
+    pLayout->addWidget(new QLabel(tr("Keep runner alive between runs")), 9, 0);
+    pLayout->addWidget(m_pRunnerKeepAlive, 9, 1);
     QSpacerItem* pSpacerItem = new QSpacerItem(10, 10, QSizePolicy::Expanding);
     pLayout->addItem(pSpacerItem, 0, 2, 5);
     pLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
@@ -163,6 +189,9 @@ void ZenoCachePane::saveValue()
     inst.setValue(zsCacheAutoClean, m_pAutoCleanCache->checkState() == Qt::Checked);
     inst.setValue(zsEnableShiftChangeFOV, m_pEnableShiftChangeFOV->checkState() == Qt::Checked);
     inst.setValue(zsViewportPointSizeScale, m_pViewportPointSizeScaleSpinBox->value());
+    inst.setValue(zsViewportLodMaxPoints, m_pViewportLodMaxPointsSpinBox->value());
+    inst.setValue(zsViewportLodMaxTris, m_pViewportLodMaxTrisSpinBox->value());
+    inst.setValue(zsRunnerKeepAlive, m_pRunnerKeepAlive->checkState() == Qt::Checked);
 }
 
 //layout pane
@@ -33,8 +33,11 @@ private:
     QCheckBox* m_pEnableCheckbox;
     QSpinBox* m_pCacheNumSpinBox;
     QDoubleSpinBox* m_pViewportPointSizeScaleSpinBox;
+    QSpinBox* m_pViewportLodMaxPointsSpinBox;
+    QSpinBox* m_pViewportLodMaxTrisSpinBox;
 
     QCheckBox* m_pEnableShiftChangeFOV;
+    QCheckBox* m_pRunnerKeepAlive;
 };
 
 //NASLOCPane
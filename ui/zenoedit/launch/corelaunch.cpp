@@ -277,6 +277,10 @@ bool initZenCache(char* pCachePath, int& cacheNum)
     bEnableCache = bEnableCache && QFileInfo(qsPath).isDir() && cacheNum > 0;
     if (bEnableCache) {
         zeno::getSession().globalComm->frameCache(qsPath.toStdString(), cacheNum);
+        // memory budget in MB, 0 limits the cache by frame count only
+        size_t budgetMB = settings.value("zencache-membudget", 0).toULongLong();
+        int prefetch = settings.value("zencache-prefetch", 2).toInt();
+        zeno::getSession().globalComm->frameCacheBudget(budgetMB << 20, prefetch);
     }
     else {
         cacheNum = 0;
@@ -21,6 +21,8 @@ struct LAUNCH_PARAM {
     QString zsgPath;
     int projectFps = 24;
     QString paramPath;
+    bool profile = false;   //record node timings in the runner and report them back per frame
+    QString profileTrace;   //chrome trace json written by the runner when it finishes
 };
 
 void launchProgram(IGraphsModel *pModel, LAUNCH_PARAM param);
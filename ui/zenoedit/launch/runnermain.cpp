@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <zeno/utils/log.h>
 #include <zeno/utils/Timer.h>
+#include <zeno/utils/envconfig.h>
 #include <zeno/core/Graph.h>
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
@@ -12,6 +13,7 @@
 #include <zeno/extra/GraphException.h>
 #include <zeno/extra/EventCallbacks.h>
 #include <zeno/extra/assetDir.h>
+#include <zeno/extra/Profiler.h>
 #include <zeno/funcs/ObjectCodec.h>
 #include <zeno/zeno.h>
 #include <string>
@@ -20,6 +22,8 @@
 #include <QtWidgets>
 #include <QTcpSocket>
 #endif
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <zeno/utils/scope_exit.h>
 #include "corelaunch.h"
 #include "viewdecode.h"
@@ -67,25 +71,22 @@ static void send_packet(std::string_view info, const char *buf, size_t len) {
 
     zeno::log_debug("runner tx head-buffer {} data-buffer {}", headbuffer.size(), len);
 #ifdef ZENO_IPC_USE_TCP
-    for (char c: headbuffer) {
-        clientSocket->write(&c, 1);
-    }
+    clientSocket->write(headbuffer.data(), headbuffer.size());
     clientSocket->write(buf, len);
     while (clientSocket->bytesToWrite() > 0) {
         clientSocket->waitForBytesWritten();
     }
 #else
-    for (char c : headbuffer) {
-        fputc(c, ourfp);
-    }
-    for (size_t i = 0; i < len; i++) {
-        fputc(buf[i], ourfp);
-    }
+    fwrite(headbuffer.data(), 1, headbuffer.size(), ourfp);
+    fwrite(buf, 1, len, ourfp);
     fflush(ourfp);
 #endif
 }
 
-static int runner_start(std::string const &progJson, int sessionid, const LAUNCH_PARAM& param) {
+// warmGraph, when given, is the graph kept from the previous run of a warm runner: the program
+// is applied to it as a diff and only the nodes it changes apply again
+static int runner_start(std::string const &progJson, int sessionid, const LAUNCH_PARAM& param,
+                        std::shared_ptr<zeno::Graph> *warmGraph = nullptr) {
     zeno::log_trace("runner got program JSON: {}", progJson);
     //MessageBox(0, "runner", "runner", MB_OK);           //convient to attach process by debugger, at windows.
     zeno::scope_exit sp([=]() { std::cout.flush(); });
@@ -96,7 +97,7 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     session->globalState->clearState();
     session->globalComm->clearState();
     session->globalStatus->clearState();
-    auto graph = session->createGraph();
+    auto graph = warmGraph && *warmGraph ? *warmGraph : session->createGraph();
 
     //$ZSG value
     zeno::setConfigVariable("ZSG", param.zsgPath.toStdString());
@@ -115,6 +116,18 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
         zeno::getSession().globalComm->frameCache("", 0);
     }
 
+    auto &profiler = session->profiler;
+    if (param.profile)
+        profiler->setEnabled(true);
+    zeno::scope_exit dumpTrace([&] {
+        if (!profiler->enabled())
+            return;
+        auto summary = profiler->summaryJson();
+        send_packet("{\"action\":\"profileSummary\",\"key\":\"-1\"}", summary.data(), summary.size());
+        if (!param.profileTrace.isEmpty())
+            profiler->dumpChromeTrace(param.profileTrace.toStdString());
+    });
+
     auto onfail = [&] {
         auto statJson = session->globalStatus->toJson();
         send_packet("{\"action\":\"reportStatus\"}", statJson.data(), statJson.size());
@@ -122,10 +135,19 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     };
 
     zeno::GraphException::catched([&] {
-        graph->loadGraph(progJson.c_str());
+        if (warmGraph)
+            graph->updateGraph(progJson.c_str());
+        else
+            graph->loadGraph(progJson.c_str());
     }, *session->globalStatus);
-    if (session->globalStatus->failed())
+    if (session->globalStatus->failed()) {
+        // a half applied diff cannot be trusted, the next run starts over
+        if (warmGraph)
+            *warmGraph = nullptr;
         return onfail();
+    }
+    if (warmGraph)
+        *warmGraph = graph;
 
     std::vector<char> buffer;
 
@@ -255,6 +277,12 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
             }
         }
 
+        if (profiler->enabled()) {
+            auto summary = profiler->summaryJson(frame);
+            send_packet("{\"action\":\"profileSummary\",\"key\":\"" + std::to_string(frame) + "\"}",
+                summary.data(), summary.size());
+        }
+
         send_packet("{\"action\":\"finishFrame\",\"key\":\"" + std::to_string(frame) + "\"}", "", 0);
 
         if (session->globalStatus->failed())
@@ -263,20 +291,7 @@ static int runner_start(std::string const &progJson, int sessionid, const LAUNCH
     return 0;
 }
 
-}
-int runner_main(const QCoreApplication& app);
-int runner_main(const QCoreApplication& app) {
-    //MessageBox(0, "runner", "runner", MB_OK);           //convient to attach process by debugger, at windows.
-
-#ifdef __linux__
-    stderr = freopen("/dev/stdout", "w", stderr);
-#endif
-    LAUNCH_PARAM param;
-    int sessionid = 0;
-    int port = -1;
-    std::string objcachedir = "";
-    QCommandLineParser cmdParser;
-    cmdParser.addHelpOption();
+static void addRunnerOptions(QCommandLineParser &cmdParser) {
     cmdParser.addOptions({
         {"runner", "runner", "runner"},
         {"sessionid", "sessionid", "sessionid"},
@@ -291,8 +306,13 @@ int runner_main(const QCoreApplication& app) {
         {"projectFps", "current project fps", "fps"},
         {"objcachedir", "objcachedir", "obj temp cache dir"},
         {"generator", "generator", "the node ident which trigger generate command"},
+        {"profile", "profile", "record per-node timings"},
+        {"profiletrace", "profiletrace", "chrome trace output path"},
+        {"warm", "warm", "keep the graph alive and run one program after another from stdin"},
         });
-    cmdParser.process(app);
+}
+
+static void parseRunnerOptions(QCommandLineParser const &cmdParser, LAUNCH_PARAM &param, int &sessionid, int &port) {
     if (cmdParser.isSet("sessionid"))
         sessionid = cmdParser.value("sessionid").toInt();
     if (cmdParser.isSet("port"))
@@ -317,6 +337,65 @@ int runner_main(const QCoreApplication& app) {
         param.projectFps = cmdParser.value("projectFps").toInt();
     if (cmdParser.isSet("generator"))
         param.generator = cmdParser.value("generator");
+    if (cmdParser.isSet("profile"))
+        param.profile = cmdParser.value("profile").toInt();
+    if (cmdParser.isSet("profiletrace"))
+        param.profileTrace = cmdParser.value("profiletrace");
+    else if (auto trace = zeno::envconfig::get("PROFILE_TRACE"))
+        param.profileTrace = QString::fromLocal8Bit(trace);
+}
+
+// A warm runner reads one run after another from stdin until the editor closes it. Each run
+// is a line with the runner arguments of that run as a JSON array, a line with the byte size
+// of its program, then the program itself. Every run ends with a runFinished packet.
+static int runner_warm_loop(int sessionid) {
+    std::shared_ptr<zeno::Graph> graph;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        auto args = QJsonDocument::fromJson(QByteArray::fromStdString(line)).array();
+        std::string sizeLine;
+        if (!std::getline(std::cin, sizeLine))
+            break;
+        std::string progJson(std::stoull(sizeLine), '\0');
+        if (!std::cin.read(progJson.data(), progJson.size()))
+            break;
+
+        QStringList runArgs = {QCoreApplication::applicationFilePath()};
+        for (auto const &arg: args)
+            runArgs.push_back(arg.toString());
+        QCommandLineParser cmdParser;
+        addRunnerOptions(cmdParser);
+        cmdParser.parse(runArgs);
+        LAUNCH_PARAM param;
+        int port = -1;
+        parseRunnerOptions(cmdParser, param, sessionid, port);
+
+        zeno::getSession().profiler->clear();
+        runner_start(progJson, sessionid, param, &graph);
+        send_packet("{\"action\":\"runFinished\"}", "", 0);
+    }
+    zeno::log_debug("warm runner input closed, exiting");
+    return 0;
+}
+
+}
+int runner_main(const QCoreApplication& app);
+int runner_main(const QCoreApplication& app) {
+    //MessageBox(0, "runner", "runner", MB_OK);           //convient to attach process by debugger, at windows.
+
+#ifdef __linux__
+    stderr = freopen("/dev/stdout", "w", stderr);
+#endif
+    LAUNCH_PARAM param;
+    int sessionid = 0;
+    int port = -1;
+    std::string objcachedir = "";
+    QCommandLineParser cmdParser;
+    cmdParser.addHelpOption();
+    addRunnerOptions(cmdParser);
+    cmdParser.process(app);
+    parseRunnerOptions(cmdParser, param, sessionid, port);
+    bool warm = cmdParser.isSet("warm") && cmdParser.value("warm").toInt();
 
     std::cerr.rdbuf(std::cout.rdbuf());
     std::clog.rdbuf(std::cout.rdbuf());
@@ -340,6 +419,13 @@ int runner_main(const QCoreApplication& app) {
 
     zeno::log_debug("runner started on sessionid={}", sessionid);
 
+    if (warm) {
+#ifdef ZENO_IPC_USE_TCP
+        zeno::getSession().eventCallbacks->triggerEvent("preRunnerStart");
+#endif
+        return runner_warm_loop(sessionid);
+    }
+
     std::string progJson;
     std::istreambuf_iterator<char> iit(std::cin.rdbuf()), eiit;
     std::back_insert_iterator<std::string> sit(progJson);
@@ -40,8 +40,8 @@ void resolveOutputSocket(
         QModelIndex dictlistIdx = outSockIdx.data(ROLE_PARAM_COREIDX).toModelIndex();
         bool bDict = dictlistIdx.data(ROLE_PARAM_TYPE) == "dict";
         QString _tmpNode = bDict ? "ExtractDict" : "list-what?";
-        QString mockNode = UiHelper::generateUuid(_tmpNode);
-        mockNode = nameMangling(graphIdPrefix, mockNode);
+        //named after what it extracts, so that the program of an unchanged graph stays the same.
+        QString mockNode = nameMangling(graphIdPrefix, outNodeId + ":" + dictlistIdx.data(ROLE_PARAM_NAME).toString() + ":" + outSock + ":EXTRACTDICT");
         AddStringList({"addNode", _tmpNode, mockNode}, writer);
 
         QString mockSocket = bDict ? "dict" : "list";
@@ -273,8 +273,7 @@ static void serializeGraph(IGraphsModel* pGraphsModel, const QModelIndex& subgId
                             {
                                 //create dict or list as a middle node to connect each other.
                                 QString _tmpNode = bDict ? "MakeDict" : "MakeList";
-                                mockDictList = UiHelper::generateUuid(_tmpNode);
-                                mockDictList = nameMangling(graphIdPrefix, mockDictList);
+                                mockDictList = ident + ":" + inputName + (bDict ? ":MAKEDICT" : ":MAKELIST");
                                 AddStringList({ "addNode", _tmpNode, mockDictList }, writer);
                             }
                             if (!bDict)
@@ -9,6 +9,7 @@
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
+#include <zeno/extra/Profiler.h>
 #include <zeno/funcs/ObjectCodec.h>
 #ifdef ZENO_WITH_UnrealBridge
 #include "unrealhook.h"
@@ -190,6 +191,17 @@ struct PacketProc {
                                                       QString::fromStdString(stat->error->message));
             }
 
+        } else if (action == "runFinished") {
+            //a warm runner stays alive after the run, see ZTcpServer::startProc.
+            ZTcpServer* pServer = zenoApp->getServer();
+            if (pServer)
+                pServer->onRunFinished();
+
+        } else if (action == "profileSummary") {
+            int frame = std::stoi(objKey);
+            zeno::log_debug("profileSummary for frame {}: {}", frame, std::string_view(buf, len));
+            zeno::getSession().profiler->setRemoteSummary(frame, std::string(buf, len));
+
         } else {
             zeno::log_warn("unknown packet action type {}", action);
             return false;
@@ -4,14 +4,18 @@
 #include "ztcpserver.h"
 #include <zeno/extra/GlobalState.h>
 #include <zeno/extra/GlobalComm.h>
+#include <zeno/extra/Profiler.h>
 #include <zeno/utils/log.h>
 #include <QMessageBox>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <zeno/zeno.h>
 #include "launch/viewdecode.h"
 #include "util/log.h"
 #include "zenoapplication.h"
 #include <zenomodel/include/graphsmanagment.h>
 #include "settings/zsettings.h"
+#include "settings/zenosettingsmanager.h"
 #include "zenoapplication.h"
 #include "cache/zcachemgr.h"
 #include "zenomainwindow.h"
@@ -28,6 +32,7 @@ ZTcpServer::ZTcpServer(QObject *parent)
     , m_optixServer(nullptr)
     , m_port(0)
     , m_tcpSocket(nullptr)
+    , m_warmIdle(false)
 {
 }
 
@@ -69,7 +74,7 @@ void ZTcpServer::init(const QHostAddress& address)
 void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
 {
     ZASSERT_EXIT(m_tcpServer);
-    if (m_proc && m_proc->isOpen())
+    if (m_proc && m_proc->isOpen() && !m_warmIdle)
     {
         zeno::log_info("background process already running");
         return;
@@ -78,10 +83,6 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
     zeno::log_info("launching program...");
     zeno::log_debug("program JSON: {}", progJson);
 
-    m_proc = std::make_unique<QProcess>();
-    m_proc->setInputChannelMode(QProcess::InputChannelMode::ManagedInputChannel);
-    m_proc->setReadChannel(QProcess::ProcessChannel::StandardOutput);
-    m_proc->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
     int sessionid = zeno::getSession().globalState->sessionid;
 
     QString cachedir;
@@ -109,6 +110,7 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
 
     //clear last running state
     zeno::getSession().globalComm->clearState();
+    zeno::getSession().profiler->clearRemoteSummaries();
 
     if (param.zsgPath.isEmpty())
     {
@@ -130,21 +132,61 @@ void ZTcpServer::startProc(const std::string& progJson, LAUNCH_PARAM param)
         "--zsg", param.zsgPath,
         "--projectFps", QString::number(param.projectFps),
         "--objcachedir", zenoApp->cacheMgr()->objCachePath(),
-        "--generator", param.generator
+        "--generator", param.generator,
+        "--profile", QString::number(param.profile || zeno::getSession().profiler->enabled()),
     };
+    if (!param.profileTrace.isEmpty())
+        args << "--profiletrace" << param.profileTrace;
 
-    m_proc->start(QCoreApplication::applicationFilePath(), args);
+    //a warm runner keeps its graph between runs and only applies the nodes the new program changes.
+    bool bKeepAlive = ZenoSettingsManager::GetInstance().getValue(zsRunnerKeepAlive).toBool();
+    if (m_proc && !bKeepAlive)
+    {
+        //an idle warm runner left from before the setting was turned off.
+        disconnect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
+        killProc();
+    }
 
-    if (!m_proc->waitForStarted(-1)) {
-        zeno::log_warn("process failed to get started, giving up");
-        return;
+    if (m_proc)
+    {
+        //the runner keeps its connection, so the decoder is not reset by a new one.
+        viewDecodeClear();
     }
+    else
+    {
+        m_proc = std::make_unique<QProcess>();
+        m_proc->setInputChannelMode(QProcess::InputChannelMode::ManagedInputChannel);
+        m_proc->setReadChannel(QProcess::ProcessChannel::StandardOutput);
+        m_proc->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
+
+        QStringList procArgs = args;
+        if (bKeepAlive)
+            procArgs << "--warm" << "1";
+        m_proc->start(QCoreApplication::applicationFilePath(), procArgs);
+
+        if (!m_proc->waitForStarted(-1)) {
+            zeno::log_warn("process failed to get started, giving up");
+            m_proc = nullptr;
+            return;
+        }
 
-    m_proc->write(progJson.data(), progJson.size());
-    m_proc->closeWriteChannel();
+        connect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
+        connect(m_proc.get(), SIGNAL(readyRead()), this, SLOT(onProcPipeReady()));
+    }
 
-    connect(m_proc.get(), SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(onProcFinished(int, QProcess::ExitStatus)));
-    connect(m_proc.get(), SIGNAL(readyRead()), this, SLOT(onProcPipeReady()));
+    if (bKeepAlive)
+    {
+        //arguments of this run, size of the program, then the program, see runner_warm_loop.
+        m_warmIdle = false;
+        m_proc->write(QJsonDocument(QJsonArray::fromStringList(args)).toJson(QJsonDocument::Compact) + '\n');
+        m_proc->write(QByteArray::number((qulonglong)progJson.size()) + '\n');
+        m_proc->write(progJson.data(), progJson.size());
+    }
+    else
+    {
+        m_proc->write(progJson.data(), progJson.size());
+        m_proc->closeWriteChannel();
+    }
     if (ZenoMainWindow* mainwin = zenoApp->getMainWindow())
         emit zenoApp->getMainWindow()->runStarted();
 #ifdef ZENO_OPTIX_PROC
@@ -344,6 +386,7 @@ void ZTcpServer::startOptixProc()
 
 void ZTcpServer::killProc()
 {
+    m_warmIdle = false;
     if (m_proc) {
         m_proc->kill();
         m_proc = nullptr;
@@ -418,8 +461,21 @@ void ZTcpServer::onDisconnect()
     viewDecodeFinish();
 }
 
+void ZTcpServer::onRunFinished()
+{
+    m_warmIdle = true;
+    viewDecodeFinish();
+
+    auto mainWin = zenoApp->getMainWindow();
+    if (mainWin)
+        emit mainWin->runFinished();
+    else
+        emit runFinished();
+}
+
 void ZTcpServer::onProcFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    m_warmIdle = false;
     if (exitStatus == QProcess::NormalExit)
     {
         if (m_proc)
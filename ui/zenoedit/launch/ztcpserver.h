@@ -24,6 +24,7 @@ public:
     void onFrameFinished(const QString& action, const QString& keyObj);
     void onInitFrameRange(const QString& action, int frameStart, int frameEnd);
     void onClearFrameState();
+    void onRunFinished();
 
 signals:
     void runFinished();
@@ -47,6 +48,7 @@ private:
     QLocalServer* m_optixServer;
     QVector<QLocalSocket*> m_optixSockets;
     std::unique_ptr<QProcess> m_proc;
+    bool m_warmIdle;    //m_proc is a warm runner waiting for the next program
 
     std::vector<std::unique_ptr<QProcess>> m_optixProcs;
     int m_port;
@@ -19,6 +19,9 @@ const char* const zsCacheNum = "zencachenum";
 const char* const zsCacheAutoClean = "zencache-autoclean";
 const char* const zsEnableShiftChangeFOV = "viewport-EnableShiftChangeFOV";
 const char* const zsViewportPointSizeScale = "viewport-PointSizeScale";
+const char* const zsViewportLodMaxPoints = "viewport-LodMaxPoints";
+const char* const zsViewportLodMaxTris = "viewport-LodMaxTris";
+const char* const zsRunnerKeepAlive = "runner-keepalive";
 const char* const zsSubgraphType = "SubgraphType";
 
 //short cut
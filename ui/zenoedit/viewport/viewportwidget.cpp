@@ -234,6 +234,10 @@ void ViewportWidget::updatePerspective()
 void ViewportWidget::paintGL()
 {
     m_zenovis->paintGL();
+    //objects over the viewport budget are drawn reduced until the camera rests, keep
+    //repainting until they are all refined.
+    if (m_zenovis->getSession()->is_viewport_lod_pending())
+        QTimer::singleShot(100, this, [=]() { update(); });
     if(updateLightOnce){
         auto scene = m_zenovis->getSession()->get_scene();
         if(scene->objectsMan->lightObjects.size() > 0){
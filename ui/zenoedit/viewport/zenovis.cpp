@@ -44,6 +44,11 @@ void Zenovis::paintGL()
         QVariant varViewportPointSizeScale = inst.getValue(zsViewportPointSizeScale);
         double viewportPointSizeScale = varViewportPointSizeScale.isValid() ? varViewportPointSizeScale.toDouble() : 1;
         session->set_viewport_point_size_scale(viewportPointSizeScale);
+        QVariant varLodMaxPoints = inst.getValue(zsViewportLodMaxPoints);
+        QVariant varLodMaxTris = inst.getValue(zsViewportLodMaxTris);
+        int lodMaxPoints = varLodMaxPoints.isValid() ? varLodMaxPoints.toInt() : 10000000;
+        int lodMaxTris = varLodMaxTris.isValid() ? varLodMaxTris.toInt() : 5000000;
+        session->set_viewport_lod_budget(lodMaxPoints, lodMaxTris);
     }
     int frameid = session->get_curr_frameid();
     doFrameUpdate();
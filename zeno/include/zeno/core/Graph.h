@@ -47,6 +47,12 @@ struct Graph : std::enable_shared_from_this<Graph> {
     std::unique_ptr<Context> ctx;
     std::unique_ptr<DirtyChecker> dirtyChecker;
 
+    // set by updateGraph: the graph lives across runs, clean nodes keep the outputs they
+    // computed for the same frame and substep instead of applying again
+    bool keepOutputs = false;
+    // commands each node was last built from by updateGraph, a subnet node owns its whole scope
+    std::map<std::string, std::string> nodeRecipes;
+
     ZENO_API Graph();
     ZENO_API ~Graph();
 
@@ -60,6 +66,7 @@ struct Graph : std::enable_shared_from_this<Graph> {
     ZENO_API void applyNodesToExec();
     ZENO_API void applyNodes(std::set<std::string> const &ids);
     ZENO_API void addNode(std::string const &cls, std::string const &id);
+    ZENO_API void removeNode(std::string const &id);
     ZENO_API Graph *addSubnetNode(std::string const &id);
     ZENO_API Graph *getSubnetGraph(std::string const &id) const;
     ZENO_API bool applyNode(std::string const &id);
@@ -74,6 +81,7 @@ struct Graph : std::enable_shared_from_this<Graph> {
     ZENO_API zany const &getNodeOutput(std::string const &sn, std::string const &ss) const;
     ZENO_API zany getNodeInput(std::string const &sn, std::string const &ss) const;
     ZENO_API void loadGraph(const char *json);
+    ZENO_API void updateGraph(const char *json);
     ZENO_API void setNodeParam(std::string const &id, std::string const &par,
         std::variant<int, float, std::string, zany> const &val);  /* to be deprecated */
     ZENO_API std::map<std::string, zany> callSubnetNode(std::string const &id,
@@ -5,6 +5,7 @@
 #include <zeno/utils/safe_dynamic_cast.h>
 #include <zeno/funcs/LiterialConverter.h>
 #include <variant>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <set>
@@ -35,6 +36,14 @@ public:
     zany muted_output;
 
     bool bTmpCache = false;
+    // frame and substep the outputs were computed for, -1 while they are incomplete
+    int outputsFrame = -1;
+    int outputsSubstep = -1;
+    // set once apply handed a bound input on as an output, such nodes may have modified it in
+    // place, so they get copies of the outputs kept upstream from then on
+    bool passesInputsOn = false;
+    // myname interned by the session profiler, on the first profiled span
+    uint32_t profNameId = ~uint32_t(0);
 
     ZENO_API INode();
     ZENO_API virtual ~INode();
@@ -54,8 +63,18 @@ public:
 protected:
     ZENO_API virtual void complete();
     ZENO_API virtual void apply() = 0;
+    // false for nodes reading or writing state besides their inputs and outputs, like the frame
+    // time in the global state that substeps advance without going through any input; these
+    // apply on every visit even when the graph keeps outputs between runs
+    ZENO_API virtual bool outputsReusable() const;
 
 public:
+    // true for nodes whose outputs follow the current frame number besides their inputs, caches
+    // keyed by content alone would hand out one frame's result for every other frame; this covers
+    // nodes falling back to the current frame when their frameid input is unlinked, and wrangles
+    // whose code can read $F, $DT and $T
+    ZENO_API virtual bool dependsOnFrame() const;
+
     ZENO_API bool requireInput(std::string const &ds);
 
     ZENO_API virtual void preApply();
@@ -124,6 +143,8 @@ public:
 
     ZENO_API TempNodeCaller temp_node(std::string const &id);
 
+private:
+    void checkInputsPassedOn();
 };
 
 }
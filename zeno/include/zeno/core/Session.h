@@ -27,6 +27,7 @@ struct GlobalComm;
 struct GlobalStatus;
 struct EventCallbacks;
 struct UserData;
+struct Profiler;
 
 struct Session {
     std::map<std::string, std::unique_ptr<INodeClass>> nodeClasses;
@@ -36,6 +37,7 @@ struct Session {
     std::unique_ptr<GlobalStatus> const globalStatus;
     std::unique_ptr<EventCallbacks> const eventCallbacks;
     std::unique_ptr<UserData> const m_userData;
+    std::unique_ptr<Profiler> const profiler;
 
     ZENO_API Session();
     ZENO_API ~Session();
@@ -6,6 +6,9 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
 #include <map>
 #include <set>
 #include <functional>
@@ -21,22 +24,62 @@ struct GlobalComm {
         FRAME_BROKEN
     };
 
+    // totals of the frames written by toDisk in this process
+    struct CacheStats {
+        size_t objects = 0;         // objects encoded
+        size_t sharedObjects = 0;   // of them already in the blob store from an earlier frame
+        size_t logicalBytes = 0;    // encoded size of all objects
+        size_t storedBytes = 0;     // bytes actually written for them
+
+        double dedupRatio() const {
+            return storedBytes ? (double)logicalBytes / storedBytes : 1.0;
+        }
+    };
+
+    // what a loaded frame holds in memory, estimated from the on-disk sizes
+    struct CacheFootprint {
+        size_t fileBytes = 0;       // the frame's own zencache files
+        std::map<std::pair<uint64_t, uint64_t>, size_t> blobs;  // shared blobs it references, hash -> size
+    };
+
     struct FrameData {
         ViewObjects view_objects;
         FRAME_STATE frame_state = FRAME_UNFINISH;
+        CacheFootprint footprint;   // while the frame is loaded
+        uint64_t lastUse = 0;       // LRU stamp of the last access
     };
     std::vector<FrameData> m_frames;
     int m_maxPlayFrame = 0;
     std::set<int> m_inCacheFrames;
+    std::set<int> m_loadingFrames;
+    std::map<std::pair<uint64_t, uint64_t>, int> m_blobRefs;   // loaded frames referencing each blob
+    size_t m_cachedBytes = 0;
+    int m_dumpingFrames = 0;
+    uint64_t m_dumpsStarted = 0;
+    int m_removedSinceSweep = 0;
+    uint64_t m_useClock = 0;
+    uint64_t m_cacheEpoch = 0;
+    int m_playhead = 0;
+    int m_playDirection = 1;
     mutable std::mutex m_mtx;
+    std::condition_variable m_loadCv;
+    std::condition_variable m_prefetchCv;
+    std::thread m_prefetchThread;
+    bool m_prefetchStop = false;
 
     int beginFrameNumber = 0;
     int endFrameNumber = 0;
     int maxCachedFrames = 1;
+    size_t maxCachedBytes = 0;
+    int prefetchFrames = 2;
     std::string cacheFramePath;
     std::string objTmpCachePath;
 
+    GlobalComm() = default;
+    ZENO_API ~GlobalComm();
+
     ZENO_API void frameCache(std::string const &path, int gcmax);
+    ZENO_API void frameCacheBudget(size_t maxBytes, int prefetch);
     ZENO_API void initFrameRange(int beg, int end);
     ZENO_API void newFrame();
     ZENO_API void finishFrame();
@@ -62,8 +105,14 @@ struct GlobalComm {
     ZENO_API void removeCachePath();
     static void toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName = "");
     static bool fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects& objs, std::string fileName = "");
+    ZENO_API static CacheStats cacheStats();
 private:
-    ViewObjects const *_getViewObjects(const int frameid);
+    ViewObjects const *_getViewObjects(std::unique_lock<std::mutex> &lck, const int frameid);
+    void _installFrame(int frameid, ViewObjects &&objs, CacheFootprint &&footprint);
+    void _releaseFrame(int frameid);
+    void _evictFrames(int frameid);
+    bool _inPrefetchWindow(int frameid) const;
+    void _prefetchLoop();
 };
 
 }
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zeno {
+
+struct IObject;
+
+// runtime-togglable node profiler, each thread records into its own ring buffer
+// so the hot path never takes a shared lock; enable with ZENO_PROFILE=1 or setEnabled
+struct Profiler {
+    enum Kind : uint32_t {
+        Apply,
+        Resolve,
+    };
+
+    struct Event {
+        uint32_t nameId;
+        Kind kind;
+        int frameid;
+        int substepid;
+        uint32_t tid;
+        int64_t beginNs;
+        int64_t durNs;
+        int64_t allocBytes;  // heap growth during the scope, only with trackAlloc
+        int64_t outBytes;    // estimated payload of the node outputs, Apply only
+    };
+
+    struct Ring;
+
+    static constexpr uint32_t kNoName = ~uint32_t(0);
+
+    // RAII span, costs one relaxed load when the profiler is off
+    struct Scope {
+        Profiler *prof = nullptr;
+        Event ev{};
+
+        Scope(Profiler &p, std::string const &name, Kind kind, int frameid, int substepid) {
+            if (p.enabled())
+                begin(p, p.internName(name), kind, frameid, substepid);
+        }
+
+        // nameId caches the interned name between spans, so only the first one takes the
+        // profiler's lock; it starts out as kNoName
+        Scope(Profiler &p, uint32_t &nameId, std::string const &name, Kind kind, int frameid, int substepid) {
+            if (!p.enabled())
+                return;
+            if (nameId == kNoName)
+                nameId = p.internName(name);
+            begin(p, nameId, kind, frameid, substepid);
+        }
+
+        Scope(Scope const &) = delete;
+        Scope &operator=(Scope const &) = delete;
+
+        bool active() const {
+            return prof != nullptr;
+        }
+
+        void setOutputBytes(int64_t bytes) {
+            ev.outBytes = bytes;
+        }
+
+        ~Scope() {
+            if (!prof)
+                return;
+            ev.durNs = now() - ev.beginNs;
+            if (prof->trackAlloc())
+                ev.allocBytes = heapBytes() - ev.allocBytes;
+            prof->record(ev);
+        }
+
+    private:
+        void begin(Profiler &p, uint32_t nameId, Kind kind, int frameid, int substepid) {
+            prof = &p;
+            ev.nameId = nameId;
+            ev.kind = kind;
+            ev.frameid = frameid;
+            ev.substepid = substepid;
+            ev.allocBytes = p.trackAlloc() ? heapBytes() : 0;
+            ev.beginNs = now();
+        }
+    };
+
+    ZENO_API Profiler();
+    ZENO_API ~Profiler();
+
+    Profiler(Profiler const &) = delete;
+    Profiler &operator=(Profiler const &) = delete;
+
+    bool enabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    bool trackAlloc() const {
+        return m_trackAlloc.load(std::memory_order_relaxed);
+    }
+
+    ZENO_API void setEnabled(bool on);
+    ZENO_API void setTrackAlloc(bool on);
+    // events kept per thread before the oldest are overwritten, applies to new threads
+    ZENO_API void setRingCapacity(size_t capacity);
+
+    ZENO_API uint32_t internName(std::string const &name);
+    ZENO_API void record(Event const &ev);
+    ZENO_API std::vector<Event> collect() const;
+    ZENO_API void clear();
+
+    // Chrome trace / Perfetto JSON of all recorded events
+    ZENO_API std::string toChromeTrace() const;
+    ZENO_API bool dumpChromeTrace(std::string const &path) const;
+    // per-node totals, restricted to one frame unless frameid is -1
+    ZENO_API std::string summaryJson(int frameid = -1) const;
+
+    // summaries received from a runner process, keyed by frame (-1 for the whole run)
+    ZENO_API void setRemoteSummary(int frameid, std::string json);
+    ZENO_API std::string getRemoteSummary(int frameid) const;
+    ZENO_API void clearRemoteSummaries();
+
+    ZENO_API static int64_t objectBytes(IObject *obj);
+    ZENO_API static int64_t heapBytes();
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_trackAlloc{false};
+    std::atomic<size_t> m_ringCapacity{1 << 16};
+    uint64_t const m_ident;
+
+    mutable std::mutex m_mtx;
+    std::vector<std::shared_ptr<Ring>> m_rings;
+    std::vector<std::string> m_names;
+    std::unordered_map<std::string, uint32_t> m_nameIds;
+    std::map<int, std::string> m_remoteSummaries;
+
+    Ring *threadRing();
+};
+
+}
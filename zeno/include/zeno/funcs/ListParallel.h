@@ -0,0 +1,43 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/utils/Error.h>
+#include <zeno/core/IObject.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zeno {
+
+struct ListElementError {
+    size_t index;
+    std::shared_ptr<Error> error;
+};
+
+using ListMapArgs = std::map<std::string, zany>;
+using ListMapFunc = std::function<zany(zany const &elm, size_t index, ListMapArgs const &args)>;
+using ListReduceFunc = std::function<zany(zany const &lhs, zany const &rhs)>;
+
+// Calls func on every element concurrently. The result keeps the input order; an element
+// whose call throws yields nullptr and is reported in errors, sorted by index.
+ZENO_API std::vector<zany> listParallelMap(std::vector<zany> const &arr, ListMapFunc const &func,
+                                           ListMapArgs const &args, std::vector<ListElementError> &errors);
+
+// Pairwise tree reduction with a fixed pairing, so the result does not depend on the
+// thread count. func must be associative; returns nullptr for an empty list.
+ZENO_API zany listParallelReduce(std::vector<zany> const &arr, ListReduceFunc const &func);
+
+// Named per-object functions for the ListParallelMap / ListParallelReduce nodes.
+ZENO_API void defListMapFunc(std::string const &name, ListMapFunc func);
+ZENO_API void defListReduceFunc(std::string const &name, ListReduceFunc func);
+ZENO_API ListMapFunc getListMapFunc(std::string const &name);
+ZENO_API ListReduceFunc getListReduceFunc(std::string const &name);
+
+#define ZENO_DEFLISTMAP(name, ...) \
+    static int _zeno_deflistmap_##name = (::zeno::defListMapFunc(#name, __VA_ARGS__), 0)
+#define ZENO_DEFLISTREDUCE(name, ...) \
+    static int _zeno_deflistreduce_##name = (::zeno::defListReduceFunc(#name, __VA_ARGS__), 0)
+
+}
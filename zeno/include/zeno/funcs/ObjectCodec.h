@@ -10,4 +10,9 @@ namespace zeno {
 ZENO_API std::shared_ptr<IObject> decodeObject(const char *buf, size_t len);
 ZENO_API bool encodeObject(IObject const *object, std::vector<char> &buf);
 
+// two-phase encoding: encodedObjectSize returns the exact byte count (0 if not encodable),
+// encodeObject then fills that many bytes at `it` and returns the end pointer
+ZENO_API size_t encodedObjectSize(IObject const *object);
+ZENO_API char *encodeObject(IObject const *object, char *it);
+
 }
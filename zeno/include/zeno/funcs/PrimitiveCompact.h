@@ -0,0 +1,60 @@
+#pragma once
+
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/api.h>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace zeno {
+
+// Scratch memory for the gathers below, one compaction of a whole primitive reuses it for
+// every attribute instead of allocating a new array each time.
+struct RevampScratch {
+    std::unique_ptr<char[]> data;
+    size_t capacity = 0;
+
+    ZENO_API void *reserve(size_t nbytes);
+};
+
+// Turns counts into offsets in place and returns the total, blocked so the result does not
+// depend on the thread count.
+ZENO_API int countsToOffsets(std::vector<int> &counts);
+
+// Ascending indices of the nonzero flags: flag, prefix sum, scatter.
+ZENO_API std::vector<int> compactIndices(std::vector<uint8_t> const &flags);
+
+// Old index -> new index of the elements kept by revamp, -1 for the dropped ones.
+ZENO_API std::vector<int> inverseRevamp(std::vector<int> const &revamp, size_t oldSize);
+
+// Parallel arr[i] = arr[revamp[i]] over raw elements of elemSize bytes. revamp may select,
+// repeat or permute elements; data must hold at least revamp.size() elements.
+ZENO_API void revampBytes(void *data, size_t elemSize, std::vector<int> const &revamp, RevampScratch &scratch);
+
+template <class T>
+void revampVector(std::vector<T> &arr, std::vector<int> const &revamp, RevampScratch &scratch) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (arr.size() < revamp.size())
+        arr.resize(revamp.size());
+    revampBytes(arr.data(), sizeof(T), revamp, scratch);
+    arr.resize(revamp.size());
+}
+
+// Gathers the elements and every attribute of an AttrVector.
+template <class T>
+void revampAttrVector(AttrVector<T> &vec, std::vector<int> const &revamp, RevampScratch &scratch) {
+    revampVector(vec.values, revamp, scratch);
+    vec.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
+        revampVector(arr, revamp, scratch);
+    });
+}
+
+// Keeps the verts listed in revamp, drops every face that uses a dropped vertex and
+// renumbers the rest. Loops of dropped polys are removed along with them.
+ZENO_API void primRevampVerts(PrimitiveObject *prim, std::vector<int> const &revamp);
+
+// Keeps the faces with at least one vertex flagged in mask, verts are left untouched.
+ZENO_API void primRevampFaces(PrimitiveObject *prim, std::vector<uint8_t> const &mask);
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <zeno/utils/api.h>
+#include <zeno/utils/vec.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zeno {
+
+struct PrimitiveObject;
+
+// Face adjacency of a primitive in flat arrays. Faces are numbered tris first, then quads,
+// then polys. Corner h of face f is also the half-edge from corners[h] to corners[next(h)].
+struct PrimTopology {
+    int numVerts = 0;
+    int numTris = 0;
+    int numQuads = 0;
+    int numPolys = 0;
+
+    std::vector<int> faceStart;      // numFaces() + 1 offsets into corners
+    std::vector<int> corners;        // vertex of each corner
+    std::vector<int> cornerFace;     // face of each corner
+    std::vector<int> vertStart;      // numVerts + 1 offsets into vertCorners
+    std::vector<int> vertCorners;    // corners at each vertex, ascending
+    // the rest is only filled when hasEdges
+    bool hasEdges = false;
+    std::vector<int> twin;           // the other half-edge of a two-sided edge, -1 otherwise
+    std::vector<int> cornerEdge;     // undirected edge of each half-edge
+    std::vector<vec2i> edges;        // unique edges, oriented like their first half-edge
+    std::vector<int> edgeValence;    // half-edges on each edge, 1 on the boundary
+    std::vector<uint8_t> vertBoundary;
+
+    uint64_t version = 0;
+    uint64_t fingerprint = 0;
+
+    int numFaces() const {
+        return numTris + numQuads + numPolys;
+    }
+
+    int numCorners() const {
+        return (int)corners.size();
+    }
+
+    int faceSize(int f) const {
+        return faceStart[f + 1] - faceStart[f];
+    }
+
+    int next(int h) const {
+        int f = cornerFace[h];
+        return h + 1 == faceStart[f + 1] ? faceStart[f] : h + 1;
+    }
+
+    int prev(int h) const {
+        int f = cornerFace[h];
+        return h == faceStart[f] ? faceStart[f + 1] - 1 : h - 1;
+    }
+
+    // vertex the half-edge h points to
+    int dest(int h) const {
+        return corners[next(h)];
+    }
+
+    bool isBoundaryEdge(int e) const {
+        return edgeValence[e] == 1;
+    }
+
+    // edge joining a and b in either direction, -1 if they are not adjacent
+    ZENO_API int findEdge(int a, int b) const;
+};
+
+// Returns the adjacency of prim's faces, building it in parallel on first use and caching
+// it on the primitive. The cache is reused while topoVersion and the face index contents
+// are unchanged, so callers never see a stale topology; lines are not included. Pass
+// withEdges = false when twin, edges and vertBoundary aren't needed, they are then only
+// built once a later call asks for them.
+ZENO_API std::shared_ptr<PrimTopology const> primTopology(PrimitiveObject *prim, bool withEdges = true);
+
+// Drops the cached topology, call after rewriting face indices in place.
+ZENO_API void primInvalidateTopology(PrimitiveObject *prim);
+
+}
@@ -14,9 +14,12 @@ ZENO_API void primTriangulateIntoPolys(PrimitiveObject *prim);
 ZENO_API void primPolygonate(PrimitiveObject *prim, bool with_uv = true);
 
 ZENO_API void primSepTriangles(PrimitiveObject *prim, bool smoothNormal = true, bool keepTriFaces = true);
-//ZENO_API void primSmoothNormal(PrimitiveObject *prim, bool isFlipped = false);
+// weighting is one of area, angle or uniform; faces meeting at more than hardAngle degrees
+// get split vertices with their own normals, 180 keeps every vertex whole
+ZENO_API void primSmoothNormal(PrimitiveObject *prim, std::string nrmAttr = "nrm", std::string weighting = "area", float hardAngle = 180.0f, float flip = 1.0f);
 
 ZENO_API void primFlipFaces(PrimitiveObject *prim);
+ZENO_API void primSmooth(PrimitiveObject *prim, std::string attr, std::string weightType, int iterations, float lambda, float mu = 0.0f, std::string weightAttr = {}, std::string pinAttr = {}, bool pinBoundary = false);
 ZENO_API void primCalcNormal(PrimitiveObject *prim, float flip = 1.0f, std::string nrmAttr = "nrm");
 //ZENO_API void primCalcInsetDir(PrimitiveObject *prim, float flip = 1.0f, std::string nrmAttr = "nrm");
 
@@ -54,6 +57,6 @@ ZENO_API void primRandomize(PrimitiveObject *prim, std::string attr, std::string
 ZENO_API void primPerlinNoise(PrimitiveObject *prim, std::string inAttr, std::string outAttr, std::string outType, float scale, float detail, float roughness, float disortion, vec3f offset, float average, float strength);
 
 ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
-    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed);
+    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed, bool dartThrowing = false);
 
 }
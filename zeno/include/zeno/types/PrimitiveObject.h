@@ -4,6 +4,7 @@
 #include <zeno/types/AttrVector.h>
 #include <zeno/utils/type_traits.h>
 #include <zeno/utils/vec.h>
+#include <cstdint>
 #include <optional>
 #include <variant>
 #include <memory>
@@ -15,6 +16,7 @@ namespace zeno {
 
 struct MaterialObject;
 struct InstancingObject;
+struct PrimTopology;
 /*
     Assuming points {p_i}, 0<=i<n, forms a counterclockwise polygon,
     compute the sum of the cross product of every triangle of a triangle
@@ -143,6 +145,11 @@ struct PrimitiveObject : IObjectClone<PrimitiveObject> {
     std::shared_ptr<MaterialObject> mtl;
     std::shared_ptr<InstancingObject> inst;
 
+    // adjacency cached by primTopology() in zeno/funcs/PrimitiveTopology.h, shared by copies;
+    // functions that rewrite face indices in place bump topoVersion to drop it early
+    std::shared_ptr<PrimTopology const> topoCache;
+    uint64_t topoVersion = 0;
+
     // deprecated:
     template <class Accept = std::variant<vec3f, float>, class F>
     void foreach_attr(F &&f) {
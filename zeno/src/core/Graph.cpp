@@ -56,6 +56,26 @@ ZENO_API void Graph::addNode(std::string const &cls, std::string const &id) {
     nodes[id] = std::move(node);
 }
 
+ZENO_API void Graph::removeNode(std::string const &id) {
+    nodes.erase(id);
+    nodesToExec.erase(id);
+    // drop what the node registered in complete()
+    auto forget = [&] (std::map<std::string, std::string> &names, bool isPortal) {
+        for (auto it = names.begin(); it != names.end();) {
+            if (it->second != id) {
+                ++it;
+                continue;
+            }
+            if (isPortal)
+                portals.erase(it->first);
+            it = names.erase(it);
+        }
+    };
+    forget(portalIns, true);
+    forget(subInputNodes, false);
+    forget(subOutputNodes, false);
+}
+
 ZENO_API Graph *Graph::addSubnetNode(std::string const &id) {
     auto subcl = std::make_unique<ImplSubnetNodeClass>();
     auto node = subcl->new_instance();
@@ -9,12 +9,11 @@
 #include <zeno/extra/DirtyChecker.h>
 #include <zeno/extra/TempNode.h>
 #include <zeno/utils/Error.h>
-#ifdef ZENO_BENCHMARKING
-#include <zeno/utils/Timer.h>
-#endif
+#include <zeno/extra/Profiler.h>
 #include <zeno/utils/safe_at.h>
 #include <zeno/utils/logger.h>
 #include <zeno/extra/GlobalState.h>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <zeno/extra/GlobalComm.h>
@@ -44,6 +43,14 @@ ZENO_API void INode::doComplete() {
 
 ZENO_API void INode::complete() {}
 
+ZENO_API bool INode::outputsReusable() const {
+    return true;
+}
+
+ZENO_API bool INode::dependsOnFrame() const {
+    return false;
+}
+
 /*ZENO_API bool INode::checkApplyCondition() {
     if (has_option("ONCE")) {  // TODO: frame control should be editor work
         if (!getGlobalState()->isFirstSubstep())
@@ -128,22 +135,79 @@ ZENO_API void INode::preApply() {
             zeno::log_info("remove cache file: {}", path.string());
         }
     }
-    for (auto const &[ds, bound]: inputBounds) {
-        requireInput(ds);
+    auto &prof = *graph->session->profiler;
+    auto gs = graph->session->globalState.get();
+    if (!inputBounds.empty()) {
+        Profiler::Scope _(prof, profNameId, myname, Profiler::Resolve, gs->frameid, gs->substepid);
+        for (auto const &[ds, bound]: inputBounds) {
+            requireInput(ds);
+        }
+    }
+
+    if (graph->keepOutputs) {
+        if (!dc.amIDirty(myname) && outputsFrame == gs->frameid && outputsSubstep == gs->substepid
+            && outputsReusable() && !graph->nodesToExec.count(myname)) {
+            log_debug("==> reuse {}", myname);
+            return;
+        }
+        // whatever consumes a node that applied has to apply as well
+        dc.taintThisNode(myname);
+        outputsFrame = outputsSubstep = -1;
+        // many nodes modify their input in place and pass it on, such nodes work on copies so
+        // the outputs kept upstream stay as they were computed
+        if (passesInputsOn) {
+            for (auto const &[ds, bound]: inputBounds) {
+                auto it = inputs.find(ds);
+                if (it == inputs.end() || !it->second)
+                    continue;
+                auto src = graph->nodes.find(bound.first);
+                if (src == graph->nodes.end() || !src->second->outputsReusable())
+                    continue;
+                if (auto copy = it->second->clone())
+                    it->second = std::move(copy);
+            }
+        }
     }
 
     log_debug("==> enter {}", myname);
     {
-#ifdef ZENO_BENCHMARKING
-        Timer _(myname);
-#endif
+        Profiler::Scope scope(prof, profNameId, myname, Profiler::Apply, gs->frameid, gs->substepid);
         apply();
+        if (scope.active()) {
+            int64_t bytes = 0;
+            for (auto const &[name, value]: outputs)
+                bytes += Profiler::objectBytes(value.get());
+            scope.setOutputBytes(bytes);
+        }
         if (bTmpCache)
             writeTmpCaches();
     }
+    if (graph->keepOutputs && !passesInputsOn)
+        checkInputsPassedOn();
+    outputsFrame = gs->frameid;
+    outputsSubstep = gs->substepid;
     log_debug("==> leave {}", myname);
 }
 
+// Finds the bound inputs this apply handed on as outputs. The upstream node keeping that object
+// can no longer tell whether it was modified, so it applies again on the next run, and this
+// node gets copies from then on.
+void INode::checkInputsPassedOn() {
+    for (auto const &[ds, bound]: inputBounds) {
+        auto it = inputs.find(ds);
+        if (it == inputs.end() || !it->second)
+            continue;
+        bool passedOn = std::any_of(outputs.begin(), outputs.end(), [&] (auto const &output) {
+            return output.second == it->second;
+        });
+        if (!passedOn)
+            continue;
+        passesInputsOn = true;
+        if (auto src = graph->nodes.find(bound.first); src != graph->nodes.end())
+            src->second->outputsFrame = src->second->outputsSubstep = -1;
+    }
+}
+
 ZENO_API bool INode::requireInput(std::string const &ds) {
     auto it = inputBounds.find(ds);
     if (it == inputBounds.end())
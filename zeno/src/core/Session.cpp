@@ -4,6 +4,7 @@
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalStatus.h>
 #include <zeno/extra/EventCallbacks.h>
+#include <zeno/extra/Profiler.h>
 #include <zeno/types/UserData.h>
 #include <zeno/core/Graph.h>
 #include <zeno/core/INode.h>
@@ -37,6 +38,7 @@ ZENO_API Session::Session()
     , globalStatus(std::make_unique<GlobalStatus>())
     , eventCallbacks(std::make_unique<EventCallbacks>())
     , m_userData(std::make_unique<UserData>())
+    , profiler(std::make_unique<Profiler>())
     {
 }
 
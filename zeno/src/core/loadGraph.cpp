@@ -1,6 +1,7 @@
 #include <zeno/core/Graph.h>
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <zeno/funcs/LiterialConverter.h>
 #include <zeno/funcs/ParseObjectFromUi.h>
 #include <zeno/extra/GraphException.h>
@@ -10,6 +11,8 @@
 #include <zeno/utils/zeno_p.h>
 #include <zeno/zeno.h>
 #include <stack>
+#include <set>
+#include <vector>
 
 namespace zeno {
 
@@ -67,6 +70,58 @@ static T generic_get(Value const &x) {
     }
 }
 
+// runs one command of a program on g, the current subnet scope inside root
+static void loadCommand(Graph *root, Graph *&g, std::stack<Graph *> &gStack, Value const &di) {
+    std::string cmd = di[0].GetString();
+    const char *maybeNodeName = cmd == "addNode" ? di[2].GetString() : (
+        di.Size() >= 1 && di[1].IsString() ? di[1].GetString() : "(not a node)");
+    //ZENO_P(cmd);
+    //ZENO_P(maybeNodeName);
+    GraphException::translated([&] {
+        if (0) {
+        } else if (cmd == "addNode") {
+            g->addNode(di[1].GetString(), di[2].GetString());
+        } else if (cmd == "setNodeInput") {
+            g->setNodeInput(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
+        } else if (cmd == "setKeyFrame") {
+            g->setKeyFrame(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
+        } else if (cmd == "setFormula") {
+            g->setFormula(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
+        } else if (cmd == "setNodeParam") {
+            g->setNodeParam(di[1].GetString(), di[2].GetString(), generic_get<std::variant<int, float, std::string, zany>, false>(di[3]));
+        } else if (cmd == "bindNodeInput") {
+            g->bindNodeInput(di[1].GetString(), di[2].GetString(), di[3].GetString(), di[4].GetString());
+        } else if (cmd == "completeNode") {
+            g->completeNode(di[1].GetString());
+        } else if (cmd == "addSubnetNode") {
+            auto newG = g->addSubnetNode(/*di[1].GetString(), */di[2].GetString());
+        } else if (cmd == "addNodeOutput") {
+            g->addNodeOutput(di[1].GetString(), di[2].GetString());
+        } else if (cmd == "pushSubnetScope") {
+            gStack.push(g);
+            g = g->getSubnetGraph(di[1].GetString());
+        } else if (cmd == "popSubnetScope") {
+            g = gStack.top();
+            gStack.pop();
+        } else if (cmd == "setBeginFrameNumber") {
+            root->beginFrameNumber = di[1].GetInt();
+        } else if (cmd == "setEndFrameNumber") {
+            root->endFrameNumber = di[1].GetInt();
+        } else if (cmd == "setNodeOption") {
+            // skip this for compatibility
+        } else if (cmd == "markNodeChanged") {
+            auto ident = di[1].GetString();
+            auto &dc = g->getDirtyChecker();
+            dc.taintThisNode(ident);
+            //todo: mark node data change.
+        } else if (cmd == "cacheToDisk") {
+            g->setTempCache(di[1].GetString());
+        } else {
+            log_warn("got unexpected command: {}", cmd);
+        }
+    }, maybeNodeName);
+}
+
 ZENO_API void Graph::loadGraph(const char *json) {
     Document d;
     d.Parse(json);
@@ -78,57 +133,94 @@ ZENO_API void Graph::loadGraph(const char *json) {
     Graph *g = this;
     std::stack<Graph *> gStack;
 
+    for (int i = 0; i < d.Size(); i++) {
+        loadCommand(this, g, gStack, d[i]);
+    }
+}
+
+ZENO_API void Graph::updateGraph(const char *json) {
+    Document d;
+    d.Parse(json);
+
+    if (!d.IsArray()) {
+        throw GraphException { "None", nullptr };
+    }
+
+    Graph *g = this;
+    std::stack<Graph *> gStack;
+
+    // split the program into the commands building each node, a subnet node owns everything
+    // up to its popSubnetScope
+    std::map<std::string, std::vector<Value const *>> nodeCmds;
+    std::map<std::string, std::string> recipes;
+    std::set<std::string> changed;
+    std::string owner;
+    int depth = 0;
     for (int i = 0; i < d.Size(); i++) {
         Value const &di = d[i];
         std::string cmd = di[0].GetString();
-        const char *maybeNodeName = cmd == "addNode" ? di[2].GetString() : (
-            di.Size() >= 1 && di[1].IsString() ? di[1].GetString() : "(not a node)");
-        //ZENO_P(cmd);
-        //ZENO_P(maybeNodeName);
-        GraphException::translated([&] {
-            if (0) {
-            } else if (cmd == "addNode") {
-                g->addNode(di[1].GetString(), di[2].GetString());
-            } else if (cmd == "setNodeInput") {
-                g->setNodeInput(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
-            } else if (cmd == "setKeyFrame") {
-                g->setKeyFrame(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
-            } else if (cmd == "setFormula") {
-                g->setFormula(di[1].GetString(), di[2].GetString(), generic_get<zany>(di[3]));
-            } else if (cmd == "setNodeParam") {
-                g->setNodeParam(di[1].GetString(), di[2].GetString(), generic_get<std::variant<int, float, std::string, zany>, false>(di[3]));
-            } else if (cmd == "bindNodeInput") {
-                g->bindNodeInput(di[1].GetString(), di[2].GetString(), di[3].GetString(), di[4].GetString());
-            } else if (cmd == "completeNode") {
-                g->completeNode(di[1].GetString());
-            } else if (cmd == "addSubnetNode") {
-                auto newG = g->addSubnetNode(/*di[1].GetString(), */di[2].GetString());
-            } else if (cmd == "addNodeOutput") {
-                g->addNodeOutput(di[1].GetString(), di[2].GetString());
-            } else if (cmd == "pushSubnetScope") {
-                gStack.push(g);
-                g = g->getSubnetGraph(di[1].GetString());
-            } else if (cmd == "popSubnetScope") {
-                g = gStack.top();
-                gStack.pop();
-            } else if (cmd == "setBeginFrameNumber") {
-                this->beginFrameNumber = di[1].GetInt();
-            } else if (cmd == "setEndFrameNumber") {
-                this->endFrameNumber = di[1].GetInt();
-            } else if (cmd == "setNodeOption") {
-                // skip this for compatibility
-            } else if (cmd == "markNodeChanged") {
-                auto ident = di[1].GetString();
-                auto &dc = g->getDirtyChecker();
-                dc.taintThisNode(ident);
-                //todo: mark node data change.
-            } else if (cmd == "cacheToDisk") {
-                g->setTempCache(di[1].GetString());
-            } else {
-                log_warn("got unexpected command: {}", cmd);
+        std::string id;
+        if (depth) {
+            id = owner;
+            if (cmd == "pushSubnetScope")
+                depth++;
+            else if (cmd == "popSubnetScope")
+                depth--;
+        } else if (cmd == "setBeginFrameNumber" || cmd == "setEndFrameNumber" || cmd == "setNodeOption") {
+            loadCommand(this, g, gStack, di);
+            continue;
+        } else {
+            id = cmd == "addNode" || cmd == "addSubnetNode" ? di[2].GetString() : di[1].GetString();
+            if (cmd == "pushSubnetScope") {
+                owner = id;
+                depth = 1;
             }
-        }, maybeNodeName);
+        }
+        // the editor marks nodes it changed in place, that is no change of the commands
+        if (cmd == "markNodeChanged") {
+            changed.insert(id);
+            continue;
+        }
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        di.Accept(writer);
+        auto &recipe = recipes[id];
+        recipe.append(sb.GetString(), sb.GetSize());
+        recipe.push_back('\n');
+        nodeCmds[id].push_back(&di);
+    }
+
+    auto &dc = getDirtyChecker();
+    dc.dirts.clear();
+    keepOutputs = true;
+
+    for (auto const &[id, recipe]: nodeRecipes) {
+        if (!recipes.count(id))
+            removeNode(id);
+    }
+    int rebuilt = 0;
+    for (auto const &[id, recipe]: recipes) {
+        auto it = nodeRecipes.find(id);
+        if (it != nodeRecipes.end() && it->second == recipe && nodes.count(id) && !changed.count(id))
+            continue;
+        // consumers still bind by name, they get tainted when they require this node
+        INodeClass *oldClass = nullptr;
+        bool passesInputsOn = false;
+        if (auto old = nodes.find(id); old != nodes.end()) {
+            oldClass = old->second->nodeClass;
+            passesInputsOn = old->second->passesInputsOn;
+        }
+        removeNode(id);
+        for (auto di: nodeCmds.at(id))
+            loadCommand(this, g, gStack, *di);
+        // a rebuilt node keeps what its last apply learned, its upstream need not apply again for it
+        if (auto node = nodes.find(id); node != nodes.end() && node->second->nodeClass == oldClass)
+            node->second->passesInputsOn = passesInputsOn;
+        dc.taintThisNode(id);
+        rebuilt++;
     }
+    nodeRecipes = std::move(recipes);
+    log_debug("updateGraph: rebuilt {} of {} nodes", rebuilt, nodeRecipes.size());
 }
 
 }
@@ -1,11 +1,15 @@
 #include <zeno/extra/GlobalComm.h>
 #include <zeno/extra/GlobalState.h>
 #include <zeno/funcs/ObjectCodec.h>
+#include <zeno/funcs/ParseObjectFromUi.h>
 #include <zeno/utils/log.h>
 #include <filesystem>
 #include <algorithm>
 #include <fstream>
 #include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <random>
 #include <zeno/types/UserData.h>
 #include <unordered_set>
 #include <zeno/types/MaterialObject.h>
@@ -18,13 +22,291 @@
 
 namespace zeno {
 
-std::vector<std::filesystem::path> cachepath(3);
 std::unordered_set<std::string> lightCameraNodes({
     "CameraEval", "CameraNode", "CihouMayaCameraFov", "ExtractCameraData", "GetAlembicCamera","MakeCamera",
     "LightNode", "BindLight", "ProceduralSky", "HDRSky",
     });
 std::set<std::string> matNodeNames = {"ShaderFinalize", "ShaderVolume", "ShaderVolumeHomogeneous"};
 
+namespace {
+
+std::filesystem::path frameCacheDir(std::string const &cachedir, int frameid) {
+    return std::filesystem::u8path(cachedir) / std::to_string(1000000 + frameid).substr(1);
+}
+
+// frames ahead of the playhead worth loading, leaves room for the current one
+int prefetchWindow(int prefetchFrames, int maxCachedFrames) {
+    return std::max(0, std::min(prefetchFrames, maxCachedFrames - 1));
+}
+
+// Objects encoding to at least kBlobMinBytes are stored once per cache dir under blobs/,
+// named by a hash of their encoded bytes; frame files keep a BlobRef in their place. Static
+// geometry, materials and cameras are then written once per shot instead of once per frame.
+constexpr size_t kBlobMinBytes = 4096;
+constexpr char kBlobDir[] = "blobs";
+constexpr char kBlobMagic[8] = {'Z', 'E', 'N', 'B', 'L', 'O', 'B', '1'};
+
+struct BlobRef {
+    char magic[8];
+    uint64_t hash[2];
+    uint64_t size;
+};
+
+uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+BlobRef makeBlobRef(const char *data, size_t size) {
+    BlobRef ref;
+    std::memcpy(ref.magic, kBlobMagic, sizeof(kBlobMagic));
+    uint64_t h0 = 0x9e3779b97f4a7c15ull ^ size, h1 = 0x6a09e667f3bcc909ull + size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h0 = (h0 ^ mix64(w)) * 0x100000001b3ull;
+        h1 = mix64(h1 + w) ^ (h1 >> 29);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    ref.hash[0] = mix64(h0 ^ tail);
+    ref.hash[1] = mix64(h1 + tail + 1);
+    ref.size = size;
+    return ref;
+}
+
+bool isBlobRef(const char *data, size_t size) {
+    return size == sizeof(BlobRef) && !std::memcmp(data, kBlobMagic, sizeof(kBlobMagic));
+}
+
+std::string blobFileName(BlobRef const &ref) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%016llx%016llx.zencache",
+                  (unsigned long long)ref.hash[0], (unsigned long long)ref.hash[1]);
+    return name;
+}
+
+std::filesystem::path blobPath(std::string const &cachedir, BlobRef const &ref) {
+    return std::filesystem::u8path(cachedir) / kBlobDir / blobFileName(ref);
+}
+
+bool blobStored(std::string const &cachedir, BlobRef const &ref) {
+    std::error_code ec;
+    return std::filesystem::file_size(blobPath(cachedir, ref), ec) == ref.size && !ec;
+}
+
+// writes the blob unless an earlier frame already did, false if it could not be written
+bool storeBlob(std::string const &cachedir, BlobRef const &ref, const char *data, bool &written) {
+    auto path = blobPath(cachedir, ref);
+    std::error_code ec;
+    written = false;
+    if (blobStored(cachedir, ref))
+        return true;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    // write aside and rename, a reader never sees a partial blob
+    auto tmpfile = path;
+    tmpfile += ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream ofs(tmpfile, std::ios::binary);
+        ofs.write(data, ref.size);
+        if (!ofs) {
+            ofs.close();
+            std::filesystem::remove(tmpfile, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmpfile, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpfile, ec);
+        return false;
+    }
+    written = true;
+    return true;
+}
+
+// decoded blobs are shared by every frame referencing them while any of them is alive
+std::shared_ptr<IObject> loadBlob(std::string const &cachedir, BlobRef const &ref) {
+    static std::mutex mtx;
+    static std::map<std::pair<uint64_t, uint64_t>, std::weak_ptr<IObject>> decoded;
+    static size_t sweepAt = 64;
+    std::pair<uint64_t, uint64_t> key(ref.hash[0], ref.hash[1]);
+    {
+        std::lock_guard lck(mtx);
+        auto it = decoded.find(key);
+        if (it != decoded.end()) {
+            if (auto obj = it->second.lock())
+                return obj;
+        }
+    }
+
+    auto path = blobPath(cachedir, ref);
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) != ref.size || ec) {
+        log_error("zeno cache blob missing or broken: {}", path);
+        return nullptr;
+    }
+    std::vector<char> dat(ref.size);
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.read(dat.data(), dat.size())) {
+        log_error("zeno cache blob unreadable: {}", path);
+        return nullptr;
+    }
+    auto obj = decodeObject(dat.data(), dat.size());
+
+    std::lock_guard lck(mtx);
+    auto &slot = decoded[key];
+    if (auto other = slot.lock())
+        return other;  // decoded concurrently, keep a single copy
+    slot = obj;
+    if (decoded.size() >= sweepAt) {
+        for (auto it = decoded.begin(); it != decoded.end();) {
+            if (it->second.expired())
+                it = decoded.erase(it);
+            else
+                ++it;
+        }
+        sweepAt = std::max<size_t>(64, decoded.size() * 2);
+    }
+    return obj;
+}
+
+bool readCacheFile(std::filesystem::path const &path, std::vector<char> &dat) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    dat.resize(size);
+    std::ifstream ifs(path, std::ios::binary);
+    return (bool)ifs.read(dat.data(), dat.size());
+}
+
+// walks the entries of a zencache file, visit(key, data, len) is called for each of them
+template <class Visit>
+bool parseCacheFile(std::vector<char> const &dat, Visit const &visit) {
+    if (dat.size() <= 8 || std::string(dat.data(), 8) != "ZENCACHE") {
+        log_error("zeno cache file broken (1)");
+        return false;
+    }
+    size_t pos = std::find(dat.begin() + 8, dat.end(), '\a') - dat.begin();
+    if (pos == dat.size()) {
+        log_error("zeno cache file broken (2)");
+        return false;
+    }
+    size_t keyscount = std::stoi(std::string(dat.data() + 8, pos - 8));
+    pos = pos + 1;
+    std::vector<std::string> keys;
+    for (int k = 0; k < keyscount; k++) {
+        size_t newpos = std::find(dat.begin() + pos, dat.end(), '\a') - dat.begin();
+        if (newpos == dat.size()) {
+            log_error("zeno cache file broken (3.{})", k);
+            return false;
+        }
+        keys.emplace_back(dat.data() + pos, newpos - pos);
+        pos = newpos + 1;
+    }
+    std::vector<size_t> poses(keyscount + 1);
+    if ((keyscount + 1) * sizeof(size_t) > dat.size() - pos) {
+        log_error("zeno cache file broken (4)");
+        return false;
+    }
+    std::copy_n(dat.data() + pos, (keyscount + 1) * sizeof(size_t), (char *)poses.data());
+    pos += (keyscount + 1) * sizeof(size_t);
+    for (int k = 0; k < keyscount; k++) {
+        if (poses[k + 1] > dat.size() - pos || poses[k + 1] < poses[k]) {
+            log_error("zeno cache file broken (4.{})", k);
+            return false;
+        }
+        visit(keys[k], dat.data() + pos + poses[k], poses[k + 1] - poses[k]);
+    }
+    return true;
+}
+
+using BlobKey = std::pair<uint64_t, uint64_t>;
+
+template <class Visit>
+bool forEachBlobRef(std::vector<char> const &dat, Visit const &visit) {
+    return parseCacheFile(dat, [&] (std::string const &, const char *p, size_t len) {
+        if (isBlobRef(p, len)) {
+            BlobRef ref;
+            std::memcpy(&ref, p, sizeof(ref));
+            visit(ref);
+        }
+    });
+}
+
+// what a frame pins once loaded: its zencache files, which stand in for the decoded objects,
+// and the blobs they reference
+GlobalComm::CacheFootprint frameFootprint(std::string const &cachedir, int frameid) {
+    GlobalComm::CacheFootprint footprint;
+    auto dir = frameCacheDir(cachedir, frameid);
+    for (auto name: {"lightCameraObj.zencache", "materialObj.zencache", "normalObj.zencache"}) {
+        std::vector<char> dat;
+        if (!readCacheFile(dir / name, dat))
+            continue;
+        footprint.fileBytes += dat.size();
+        forEachBlobRef(dat, [&] (BlobRef const &ref) {
+            footprint.blobs.try_emplace(BlobKey(ref.hash[0], ref.hash[1]), ref.size);
+        });
+    }
+    return footprint;
+}
+
+// a frame is being written into cachedir by a runner, its blobs may be stored before its files
+bool cacheDirLocked(std::filesystem::path const &root) {
+    std::error_code ec;
+    size_t prefixLen = std::strlen(iotags::sZencache_lockfile_prefix);
+    for (auto const &entry: std::filesystem::directory_iterator(root, ec)) {
+        if (entry.path().filename().string().compare(0, prefixLen, iotags::sZencache_lockfile_prefix) == 0)
+            return true;
+    }
+    return false;
+}
+
+// finds the blobs no frame under cachedir references any more, false if it had to give up
+bool collectBlobGarbage(std::filesystem::path const &root, std::vector<std::filesystem::path> &garbage) {
+    std::error_code ec;
+    std::set<std::string> referenced;
+    for (auto const &entry: std::filesystem::directory_iterator(root, ec)) {
+        if (!entry.is_directory() || entry.path().filename() == kBlobDir)
+            continue;
+        for (auto const &file: std::filesystem::directory_iterator(entry.path(), ec)) {
+            if (file.path().extension() != ".zencache")
+                continue;
+            std::vector<char> dat;
+            // a frame we cannot read may still need any of the blobs
+            if (!readCacheFile(file.path(), dat) || !forEachBlobRef(dat, [&] (BlobRef const &ref) {
+                    referenced.insert(blobFileName(ref));
+                }))
+                return false;
+        }
+    }
+    for (auto const &entry: std::filesystem::directory_iterator(root / kBlobDir, ec)) {
+        if (!referenced.count(entry.path().filename().string()))
+            garbage.push_back(entry.path());
+    }
+    return true;
+}
+
+void removeBlobs(std::filesystem::path const &root, std::vector<std::filesystem::path> const &garbage) {
+    std::error_code ec;
+    for (auto const &path: garbage)
+        std::filesystem::remove(path, ec);
+    if (!garbage.empty())
+        log_info("removed {} unreferenced zencache blobs", garbage.size());
+    if (std::filesystem::is_empty(root / kBlobDir, ec) && !ec)
+        std::filesystem::remove(root / kBlobDir, ec);
+}
+
+std::mutex g_statsMtx;
+GlobalComm::CacheStats g_stats;
+
+}
+
 void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, bool cacheLightCameraOnly, bool cacheMaterialOnly, std::string fileName) {
     if (cachedir.empty()) return;
     std::filesystem::path dir = std::filesystem::u8path(cachedir + "/" + std::to_string(1000000 + frameid).substr(1));
@@ -35,6 +317,29 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
     std::vector<std::vector<char>> bufCaches(3);
     std::vector<std::vector<size_t>> poses(3);
     std::vector<std::string> keys(3);
+    std::vector<std::filesystem::path> cachepath(3);
+    // node tmp caches are removed file by file, they keep their objects inline
+    bool dedup = fileName.empty();
+    CacheStats frameStats;
+    // large objects stay inline until the free space check passed, then they are stored as blobs
+    struct PendingBlob {
+        size_t base;
+        BlobRef ref;
+    };
+    std::vector<std::vector<PendingBlob>> blobs(3);
+    auto encodeShared = [&] (IObject const *obj, std::vector<char> &buf) {
+        size_t base = buf.size();
+        if (!encodeObject(obj, buf))
+            return false;
+        size_t len = buf.size() - base;
+        frameStats.objects++;
+        frameStats.logicalBytes += len;
+        if (dedup && len >= kBlobMinBytes)
+            blobs[&buf - bufCaches.data()].push_back({base, makeBlobRef(buf.data() + base, len)});
+        else
+            frameStats.storedBytes += len;
+        return true;
+    };
     for (auto const &[key, obj]: objs) {
 
         size_t bufsize =0;
@@ -42,7 +347,7 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
         if (cacheLightCameraOnly && (lightCameraNodes.count(nodeName) || obj->userData().get2<int>("isL", 0) || std::dynamic_pointer_cast<CameraObject>(obj)))
         {
             bufsize = bufCaches[0].size();
-            if (encodeObject(obj.get(), bufCaches[0]))
+            if (encodeShared(obj.get(), bufCaches[0]))
             {
                 keys[0].push_back('\a');
                 keys[0].append(key);
@@ -52,7 +357,7 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
         if (cacheMaterialOnly && (matNodeNames.count(nodeName)>0 || std::dynamic_pointer_cast<MaterialObject>(obj)))
         {
             bufsize = bufCaches[1].size();
-            if (encodeObject(obj.get(), bufCaches[1]))
+            if (encodeShared(obj.get(), bufCaches[1]))
             {
                 keys[1].push_back('\a');
                 keys[1].append(key);
@@ -63,7 +368,7 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
         {
             if (lightCameraNodes.count(nodeName) || obj->userData().get2<int>("isL", 0) || std::dynamic_pointer_cast<CameraObject>(obj)) {
                 bufsize = bufCaches[0].size();
-                if (encodeObject(obj.get(), bufCaches[0]))
+                if (encodeShared(obj.get(), bufCaches[0]))
                 {
                     keys[0].push_back('\a');
                     keys[0].append(key);
@@ -71,7 +376,7 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
                 }
             } else if (matNodeNames.count(nodeName)>0 || std::dynamic_pointer_cast<MaterialObject>(obj)) {
                 bufsize = bufCaches[1].size();
-                if (encodeObject(obj.get(), bufCaches[1]))
+                if (encodeShared(obj.get(), bufCaches[1]))
                 {
                     keys[1].push_back('\a');
                     keys[1].append(key);
@@ -79,7 +384,7 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
                 }
             } else {
                 bufsize = bufCaches[2].size();
-                if (encodeObject(obj.get(), bufCaches[2]))
+                if (encodeShared(obj.get(), bufCaches[2]))
                 {
                     keys[2].push_back('\a');
                     keys[2].append(key);
@@ -109,6 +414,15 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
         poses[i].push_back(bufCaches[i].size());
         currentFrameSize += keys[i].size() + poses[i].size() * sizeof(size_t) + bufCaches[i].size();
     }
+    // a blob shrinks the frame file to its ref, and takes its own size unless already stored
+    std::set<std::string> newBlobs;
+    for (auto const &pending: blobs) {
+        for (auto const &blob: pending) {
+            currentFrameSize -= blob.ref.size - sizeof(BlobRef);
+            if (!blobStored(cachedir, blob.ref) && newBlobs.insert(blobFileName(blob.ref)).second)
+                currentFrameSize += blob.ref.size;
+        }
+    }
     size_t freeSpace = 0;
     #ifdef __linux__
         struct statfs diskInfo;
@@ -132,6 +446,34 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
             freeSpace = std::filesystem::space(std::filesystem::u8path(cachedir)).free;
         #endif
     }
+    // replace the stored blobs by their refs, the ones that could not be written stay inline
+    for (int i = 0; i < 3; i++) {
+        if (blobs[i].empty())
+            continue;
+        auto const &buf = bufCaches[i];
+        std::vector<char> packed;
+        size_t from = 0, shift = 0, p = 0;
+        for (auto const &blob: blobs[i]) {
+            for (; p < poses[i].size() && poses[i][p] <= blob.base; p++)
+                poses[i][p] -= shift;
+            packed.insert(packed.end(), buf.begin() + from, buf.begin() + blob.base);
+            from = blob.base + blob.ref.size;
+            bool written;
+            if (storeBlob(cachedir, blob.ref, buf.data() + blob.base, written)) {
+                packed.insert(packed.end(), (const char *)&blob.ref, (const char *)&blob.ref + sizeof(BlobRef));
+                shift += blob.ref.size - sizeof(BlobRef);
+                frameStats.storedBytes += sizeof(BlobRef) + (written ? blob.ref.size : 0);
+                frameStats.sharedObjects += !written;
+            } else {
+                packed.insert(packed.end(), buf.begin() + blob.base, buf.begin() + from);
+                frameStats.storedBytes += blob.ref.size;
+            }
+        }
+        for (; p < poses[i].size(); p++)
+            poses[i][p] -= shift;
+        packed.insert(packed.end(), buf.begin() + from, buf.end());
+        bufCaches[i] = std::move(packed);
+    }
     for (int i = 0; i < 3; i++)
     {
         if (poses[i].size() == 0 && (cacheLightCameraOnly && i != 0 || cacheMaterialOnly && i != 1 || fileName != "" && i != 2))
@@ -144,22 +486,39 @@ void GlobalComm::toDisk(std::string cachedir, int frameid, GlobalComm::ViewObjec
         std::copy(bufCaches[i].begin(), bufCaches[i].end(), oit);
     }
     objs.clear();
+
+    if (dedup) {
+        std::lock_guard lck(g_statsMtx);
+        g_stats.objects += frameStats.objects;
+        g_stats.sharedObjects += frameStats.sharedObjects;
+        g_stats.logicalBytes += frameStats.logicalBytes;
+        g_stats.storedBytes += frameStats.storedBytes;
+        log_info("zencache frame {}: {} of {} objects shared with earlier frames, wrote {} of {} KB, "
+                 "total dedup ratio {}", frameid, frameStats.sharedObjects, frameStats.objects,
+                 frameStats.storedBytes >> 10, frameStats.logicalBytes >> 10, g_stats.dedupRatio());
+    }
+}
+
+ZENO_API GlobalComm::CacheStats GlobalComm::cacheStats() {
+    std::lock_guard lck(g_statsMtx);
+    return g_stats;
 }
 
 bool GlobalComm::fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObjects &objs, std::string fileName) {
     if (cachedir.empty())
         return false;
     objs.clear();
-    auto dir = std::filesystem::u8path(cachedir) / std::to_string(1000000 + frameid).substr(1);
+    auto dir = frameCacheDir(cachedir, frameid);
+    std::vector<std::filesystem::path> cachepath;
     if (fileName == "")
     {
-        cachepath[0] = dir / "lightCameraObj.zencache";
-        cachepath[1] = dir / "materialObj.zencache";
-        cachepath[2] = dir / "normalObj.zencache";
+        cachepath.push_back(dir / "lightCameraObj.zencache");
+        cachepath.push_back(dir / "materialObj.zencache");
+        cachepath.push_back(dir / "normalObj.zencache");
     }
     else
     {
-        cachepath[2] = std::filesystem::u8path(dir.string() + "/" + fileName);
+        cachepath.push_back(std::filesystem::u8path(dir.string() + "/" + fileName));
     }
 
     for (auto path : cachepath)
@@ -170,49 +529,22 @@ bool GlobalComm::fromDisk(std::string cachedir, int frameid, GlobalComm::ViewObj
         }
         log_debug("load cache from disk {}", path);
 
-        auto szBuffer = std::filesystem::file_size(path);
-        std::vector<char> dat(szBuffer);
-        FILE *fp = fopen(path.string().c_str(), "rb");
-        if (!fp) {
-            log_error("zeno cache file does not exist");
+        std::vector<char> dat;
+        if (!readCacheFile(path, dat)) {
+            log_error("zeno cache file unreadable: {}", path);
             return false;
         }
-        size_t ret = fread(&dat[0], 1, szBuffer, fp);
-        assert(ret == szBuffer);
-        fclose(fp);
-        fp = nullptr;
-
-        if (dat.size() <= 8 || std::string(dat.data(), 8) != "ZENCACHE") {
-            log_error("zeno cache file broken (1)");
-            return false;
-        }
-        size_t pos = std::find(dat.begin() + 8, dat.end(), '\a') - dat.begin();
-        if (pos == dat.size()) {
-            log_error("zeno cache file broken (2)");
-            return false;
-        }
-        size_t keyscount = std::stoi(std::string(dat.data() + 8, pos - 8));
-        pos = pos + 1;
-        std::vector<std::string> keys;
-        for (int k = 0; k < keyscount; k++) {
-            size_t newpos = std::find(dat.begin() + pos, dat.end(), '\a') - dat.begin();
-            if (newpos == dat.size()) {
-                log_error("zeno cache file broken (3.{})", k);
-                return false;
-            }
-            keys.emplace_back(dat.data() + pos, newpos - pos);
-            pos = newpos + 1;
-        }
-        std::vector<size_t> poses(keyscount + 1);
-        std::copy_n(dat.data() + pos, (keyscount + 1) * sizeof(size_t), (char *)poses.data());
-        pos += (keyscount + 1) * sizeof(size_t);
-        for (int k = 0; k < keyscount; k++) {
-            if (poses[k] > dat.size() - pos || poses[k + 1] < poses[k]) {
-                log_error("zeno cache file broken (4.{})", k);
+        bool ok = parseCacheFile(dat, [&] (std::string const &key, const char *p, size_t len) {
+            if (isBlobRef(p, len)) {
+                BlobRef ref;
+                std::memcpy(&ref, p, sizeof(ref));
+                objs.try_emplace(key, loadBlob(cachedir, ref));
+            } else {
+                objs.try_emplace(key, decodeObject(p, len));
             }
-            const char *p = dat.data() + pos + poses[k];
-            objs.try_emplace(keys[k], decodeObject(p, poses[k + 1] - poses[k]));
-        }
+        });
+        if (!ok)
+            return false;
     }
     return true;
 }
@@ -232,12 +564,24 @@ ZENO_API void GlobalComm::finishFrame() {
 }
 
 ZENO_API void GlobalComm::dumpFrameCache(int frameid, bool cacheLightCameraOnly, bool cacheMaterialOnly) {
-    std::lock_guard lck(m_mtx);
-    int frameIdx = frameid - beginFrameNumber;
-    if (frameIdx >= 0 && frameIdx < m_frames.size()) {
-        log_debug("dumping frame {}", frameid);
-        toDisk(cacheFramePath, frameid, m_frames[frameIdx].view_objects, cacheLightCameraOnly, cacheMaterialOnly);
+    ViewObjects objs;
+    std::string path;
+    {
+        std::lock_guard lck(m_mtx);
+        int frameIdx = frameid - beginFrameNumber;
+        // without a cache dir the objects stay in memory
+        if (frameIdx < 0 || frameIdx >= m_frames.size() || cacheFramePath.empty())
+            return;
+        std::swap(objs, m_frames[frameIdx].view_objects);
+        path = cacheFramePath;
+        m_dumpingFrames++;
+        m_dumpsStarted++;
     }
+    // encode and write outside the lock, the frame is not completed yet so nobody reads it
+    log_debug("dumping frame {}", frameid);
+    toDisk(path, frameid, objs, cacheLightCameraOnly, cacheMaterialOnly);
+    std::lock_guard lck(m_mtx);
+    m_dumpingFrames--;
 }
 
 ZENO_API void GlobalComm::addViewObject(std::string const &key, std::shared_ptr<IObject> object) {
@@ -251,9 +595,14 @@ ZENO_API void GlobalComm::clearState() {
     std::lock_guard lck(m_mtx);
     m_frames.clear();
     m_inCacheFrames.clear();
+    m_loadingFrames.clear();
+    m_blobRefs.clear();
+    m_cachedBytes = 0;
+    m_cacheEpoch++;
     m_maxPlayFrame = 0;
     maxCachedFrames = 1;
     cacheFramePath = {};
+    m_loadCv.notify_all();
 }
 
 ZENO_API void GlobalComm::clearFrameState()
@@ -261,13 +610,42 @@ ZENO_API void GlobalComm::clearFrameState()
     std::lock_guard lck(m_mtx);
     m_frames.clear();
     m_inCacheFrames.clear();
+    m_loadingFrames.clear();
+    m_blobRefs.clear();
+    m_cachedBytes = 0;
+    m_cacheEpoch++;
     m_maxPlayFrame = 0;
+    m_loadCv.notify_all();
 }
 
 ZENO_API void GlobalComm::frameCache(std::string const &path, int gcmax) {
     std::lock_guard lck(m_mtx);
+    if (path != cacheFramePath) {
+        // loads still reading the old dir must not land in the cache
+        m_cacheEpoch++;
+        m_removedSinceSweep = 0;
+        m_loadCv.notify_all();
+    }
     cacheFramePath = path;
     maxCachedFrames = gcmax;
+    m_prefetchCv.notify_one();
+}
+
+ZENO_API void GlobalComm::frameCacheBudget(size_t maxBytes, int prefetch) {
+    std::lock_guard lck(m_mtx);
+    maxCachedBytes = maxBytes;
+    prefetchFrames = prefetch;
+    m_prefetchCv.notify_one();
+}
+
+ZENO_API GlobalComm::~GlobalComm() {
+    {
+        std::lock_guard lck(m_mtx);
+        m_prefetchStop = true;
+    }
+    m_prefetchCv.notify_all();
+    if (m_prefetchThread.joinable())
+        m_prefetchThread.join();
 }
 
 ZENO_API void GlobalComm::initFrameRange(int beg, int end) {
@@ -298,38 +676,169 @@ ZENO_API std::pair<int, int> GlobalComm::frameRange() {
 }
 
 ZENO_API GlobalComm::ViewObjects const *GlobalComm::getViewObjects(const int frameid) {
-    std::lock_guard lck(m_mtx);
-    return _getViewObjects(frameid);
+    std::unique_lock lck(m_mtx);
+    return _getViewObjects(lck, frameid);
 }
 
-GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(const int frameid) {
+GlobalComm::ViewObjects const* GlobalComm::_getViewObjects(std::unique_lock<std::mutex> &lck, const int frameid) {
     int frameIdx = frameid - beginFrameNumber;
     if (frameIdx < 0 || frameIdx >= m_frames.size())
         return nullptr;
-    if (maxCachedFrames != 0) {
-        // load back one gc:
-        if (!m_inCacheFrames.count(frameid)) {  // notinmem then cacheit
-            bool ret = fromDisk(cacheFramePath, frameid, m_frames[frameIdx].view_objects);
-            if (!ret)
-                return nullptr;
-
-            m_inCacheFrames.insert(frameid);
-            // and dump one as balance:
-            if (m_inCacheFrames.size() && m_inCacheFrames.size() > maxCachedFrames) { // notindisk then dumpit
-                for (int i: m_inCacheFrames) {
-                    if (i != frameid) {
-                        // seems that objs will not be modified when load_objects called later.
-                        // so, there is no need to dump.
-                        //toDisk(cacheFramePath, i, m_frames[i - beginFrameNumber].view_objects);
-                        m_frames[i - beginFrameNumber].view_objects.clear();
-                        m_inCacheFrames.erase(i);
-                        break;
-                    }
+    if (maxCachedFrames == 0)
+        return &m_frames[frameIdx].view_objects;
+
+    if (frameid != m_playhead) {
+        m_playDirection = frameid > m_playhead ? 1 : -1;
+        m_playhead = frameid;
+    }
+    m_frames[frameIdx].lastUse = ++m_useClock;
+    if (prefetchFrames > 0 && !m_prefetchThread.joinable())
+        m_prefetchThread = std::thread([this] { _prefetchLoop(); });
+    m_prefetchCv.notify_one();
+
+    // the prefetcher may be reading this very frame, wait for it rather than read it twice
+    auto epoch = m_cacheEpoch;
+    m_loadCv.wait(lck, [&] { return !m_loadingFrames.count(frameid) || m_cacheEpoch != epoch; });
+    if (m_cacheEpoch != epoch)
+        return nullptr;
+    if (!m_inCacheFrames.count(frameid)) {
+        m_loadingFrames.insert(frameid);
+        auto path = cacheFramePath;
+        lck.unlock();
+        ViewObjects objs;
+        bool ret = fromDisk(path, frameid, objs);
+        auto footprint = ret ? frameFootprint(path, frameid) : CacheFootprint{};
+        lck.lock();
+        m_loadingFrames.erase(frameid);
+        m_loadCv.notify_all();
+        if (!ret || m_cacheEpoch != epoch)
+            return nullptr;
+        _installFrame(frameid, std::move(objs), std::move(footprint));
+    }
+    _evictFrames(frameid);
+    return &m_frames[frameIdx].view_objects;
+}
+
+void GlobalComm::_installFrame(int frameid, ViewObjects &&objs, CacheFootprint &&footprint) {
+    auto &frame = m_frames[frameid - beginFrameNumber];
+    frame.view_objects = std::move(objs);
+    frame.footprint = std::move(footprint);
+    frame.lastUse = ++m_useClock;
+    // a blob shared by several loaded frames is decoded once, so it is counted once
+    m_cachedBytes += frame.footprint.fileBytes;
+    for (auto const &[key, size]: frame.footprint.blobs) {
+        if (m_blobRefs[key]++ == 0)
+            m_cachedBytes += size;
+    }
+    m_inCacheFrames.insert(frameid);
+}
+
+void GlobalComm::_releaseFrame(int frameid) {
+    // objects handed out by load_objects stay alive through their own references
+    auto &frame = m_frames[frameid - beginFrameNumber];
+    frame.view_objects.clear();
+    m_cachedBytes -= frame.footprint.fileBytes;
+    for (auto const &[key, size]: frame.footprint.blobs) {
+        auto it = m_blobRefs.find(key);
+        if (--it->second == 0) {
+            m_cachedBytes -= size;
+            m_blobRefs.erase(it);
+        }
+    }
+    frame.footprint = {};
+    m_inCacheFrames.erase(frameid);
+}
+
+bool GlobalComm::_inPrefetchWindow(int frameid) const {
+    int ahead = (frameid - m_playhead) * m_playDirection;
+    return ahead > 0 && ahead <= prefetchWindow(prefetchFrames, maxCachedFrames);
+}
+
+// drops least recently used frames until both the frame count and the byte budget are met,
+// keeping the requested frame and the prefetched frames ahead of the playhead
+void GlobalComm::_evictFrames(int frameid) {
+    while (m_inCacheFrames.size() > maxCachedFrames || (maxCachedBytes && m_cachedBytes > maxCachedBytes)) {
+        int victim = -1;
+        uint64_t oldest = UINT64_MAX;
+        for (int i: m_inCacheFrames) {
+            if (i == frameid || i == m_playhead || _inPrefetchWindow(i))
+                continue;
+            auto use = m_frames[i - beginFrameNumber].lastUse;
+            if (use < oldest) {
+                oldest = use;
+                victim = i;
+            }
+        }
+        if (victim == -1)
+            break;
+        _releaseFrame(victim);
+    }
+}
+
+void GlobalComm::_prefetchLoop() {
+    std::unique_lock lck(m_mtx);
+    // playhead at which prefetching ran out of budget, retried once it moves
+    int stalledAt = 0;
+    uint64_t stalledEpoch = UINT64_MAX;
+    while (!m_prefetchStop) {
+        int target = -1;
+        bool stalled = stalledAt == m_playhead && stalledEpoch == m_cacheEpoch;
+        if (maxCachedFrames != 0 && !cacheFramePath.empty() && !stalled) {
+            int window = prefetchWindow(prefetchFrames, maxCachedFrames);
+            for (int k = 1; k <= window; k++) {
+                int f = m_playhead + k * m_playDirection;
+                int idx = f - beginFrameNumber;
+                if (idx < 0 || idx >= m_frames.size() || m_frames[idx].frame_state != FRAME_COMPLETED)
+                    break;
+                if (!m_inCacheFrames.count(f) && !m_loadingFrames.count(f)) {
+                    target = f;
+                    break;
                 }
             }
         }
+        if (target == -1) {
+            m_prefetchCv.wait(lck);
+            continue;
+        }
+
+        auto epoch = m_cacheEpoch;
+        auto path = cacheFramePath;
+        m_loadingFrames.insert(target);
+        lck.unlock();
+        auto footprint = frameFootprint(path, target);
+        lck.lock();
+
+        // only frames that must stay count against the budget, everything else can be evicted
+        size_t pinnedBytes = footprint.fileBytes;
+        auto pinnedBlobs = footprint.blobs;
+        for (int i: m_inCacheFrames) {
+            if (i == m_playhead || _inPrefetchWindow(i)) {
+                auto const &pinned = m_frames[i - beginFrameNumber].footprint;
+                pinnedBytes += pinned.fileBytes;
+                pinnedBlobs.insert(pinned.blobs.begin(), pinned.blobs.end());
+            }
+        }
+        for (auto const &[key, size]: pinnedBlobs)
+            pinnedBytes += size;
+        bool ok = epoch == m_cacheEpoch && !(maxCachedBytes && pinnedBytes > maxCachedBytes);
+        if (ok) {
+            lck.unlock();
+            ViewObjects objs;
+            ok = fromDisk(path, target, objs);
+            lck.lock();
+            ok = ok && epoch == m_cacheEpoch;
+            if (ok) {
+                _installFrame(target, std::move(objs), std::move(footprint));
+                _evictFrames(target);
+            }
+        }
+        m_loadingFrames.erase(target);
+        m_loadCv.notify_all();
+        if (!ok) {
+            stalledAt = m_playhead;
+            stalledEpoch = m_cacheEpoch;
+        }
     }
-    return &m_frames[frameIdx].view_objects;
 }
 
 ZENO_API GlobalComm::ViewObjects const &GlobalComm::getViewObjects() {
@@ -345,7 +854,7 @@ ZENO_API bool GlobalComm::load_objects(
     if (!callback)
         return false;
 
-    std::lock_guard lck(m_mtx);
+    std::unique_lock lck(m_mtx);
 
     int frame = frameid;
     frame -= beginFrameNumber;
@@ -357,10 +866,16 @@ ZENO_API bool GlobalComm::load_objects(
 
     isFrameValid = true;
     bool inserted = false;
-    auto const* viewObjs = _getViewObjects(frameid);
+    auto const* viewObjs = _getViewObjects(lck, frameid);
+    // run the callback on a snapshot without the lock, so uploading to the viewport does not
+    // block the prefetcher or the runner; eviction only drops the cache's own references
+    std::map<std::string, std::shared_ptr<zeno::IObject>> objs;
+    if (viewObjs)
+        objs = viewObjs->m_curr;
+    lck.unlock();
     if (viewObjs) {
-        zeno::log_trace("load_objects: {} objects at frame {}", viewObjs->size(), frameid);
-        inserted = callback(viewObjs->m_curr);
+        zeno::log_trace("load_objects: {} objects at frame {}", objs.size(), frameid);
+        inserted = callback(objs);
     }
     else {
         zeno::log_trace("load_objects: no objects at frame {}", frameid);
@@ -409,7 +924,7 @@ ZENO_API std::string GlobalComm::cachePath()
 
 ZENO_API bool GlobalComm::removeCache(int frame)
 {
-    std::lock_guard lck(m_mtx);
+    std::unique_lock lck(m_mtx);
     bool hasZencacheOnly = true;
     std::filesystem::path dirToRemove = std::filesystem::u8path(cacheFramePath + "/" + std::to_string(1000000 + frame).substr(1));
     if (std::filesystem::exists(dirToRemove))
@@ -430,6 +945,29 @@ ZENO_API bool GlobalComm::removeCache(int frame)
             zeno::log_info("remove dir: {}", dirToRemove);
         }
     }
+    // the blob store is shared by all frames: collect what no frame references any more, once as
+    // many frames went as are left so that removing a whole range reads each frame file O(1) times
+    auto root = std::filesystem::u8path(cacheFramePath);
+    std::error_code ec;
+    if (std::filesystem::exists(root / kBlobDir, ec)) {
+        int framesLeft = 0;
+        for (auto const &entry: std::filesystem::directory_iterator(root, ec))
+            framesLeft += entry.is_directory() && entry.path().filename() != kBlobDir;
+        // frames being written may have stored their blobs but not their files yet
+        if (++m_removedSinceSweep >= framesLeft && !m_dumpingFrames && !cacheDirLocked(root)) {
+            // reading every frame file takes long, only the removal needs that no frame was
+            // dumped meanwhile, whose blobs could be stored before its files
+            uint64_t dumps = m_dumpsStarted;
+            std::vector<std::filesystem::path> garbage;
+            lck.unlock();
+            bool collected = collectBlobGarbage(root, garbage);
+            lck.lock();
+            if (collected && m_dumpsStarted == dumps && !m_dumpingFrames && !cacheDirLocked(root)) {
+                removeBlobs(root, garbage);
+                m_removedSinceSweep = 0;
+            }
+        }
+    }
     if (frame == endFrameNumber && std::filesystem::exists(std::filesystem::u8path(cacheFramePath)) && std::filesystem::is_empty(std::filesystem::u8path(cacheFramePath)))
     {
         std::filesystem::remove(std::filesystem::u8path(cacheFramePath));
@@ -0,0 +1,309 @@
+#include <zeno/extra/Profiler.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/ListObject.h>
+#include <zeno/utils/envconfig.h>
+#include <zeno/utils/log.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+#include <fstream>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace zeno {
+
+struct Profiler::Ring {
+    std::mutex mtx;  // only contended while collecting
+    std::vector<Event> events;
+    size_t written = 0;
+    uint32_t tid = 0;
+};
+
+namespace {
+
+std::atomic<uint64_t> nextProfilerIdent{1};
+
+template <class T>
+int64_t attrVectorBytes(AttrVector<T> const &av) {
+    int64_t bytes = av.values.size() * sizeof(T);
+    av.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &arr) {
+        bytes += arr.size() * sizeof(arr[0]);
+    });
+    return bytes;
+}
+
+}
+
+ZENO_API Profiler::Profiler() : m_ident(nextProfilerIdent++) {
+    if (envconfig::getBool("PROFILE"))
+        setEnabled(true);
+    if (envconfig::getBool("PROFILE_ALLOC"))
+        setTrackAlloc(true);
+    if (auto cap = envconfig::getUint64("PROFILE_CAPACITY"))
+        setRingCapacity(cap);
+}
+
+ZENO_API Profiler::~Profiler() = default;
+
+ZENO_API void Profiler::setEnabled(bool on) {
+    m_enabled.store(on, std::memory_order_relaxed);
+}
+
+ZENO_API void Profiler::setTrackAlloc(bool on) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    m_trackAlloc.store(on, std::memory_order_relaxed);
+#else
+    if (on)
+        log_warn("Profiler: allocation tracking is not supported on this platform");
+#endif
+}
+
+ZENO_API void Profiler::setRingCapacity(size_t capacity) {
+    m_ringCapacity.store(std::max<size_t>(capacity, 1), std::memory_order_relaxed);
+}
+
+ZENO_API uint32_t Profiler::internName(std::string const &name) {
+    std::lock_guard lck(m_mtx);
+    auto [it, inserted] = m_nameIds.try_emplace(name, (uint32_t)m_names.size());
+    if (inserted)
+        m_names.push_back(name);
+    return it->second;
+}
+
+Profiler::Ring *Profiler::threadRing() {
+    // keyed by profiler ident rather than address, so a destroyed profiler is never matched again
+    thread_local std::vector<std::pair<uint64_t, Ring *>> tlsRings;
+    for (auto const &[ident, ring]: tlsRings) {
+        if (ident == m_ident)
+            return ring;
+    }
+    auto ring = std::make_shared<Ring>();
+    ring->events.resize(m_ringCapacity.load(std::memory_order_relaxed));
+    {
+        std::lock_guard lck(m_mtx);
+        ring->tid = (uint32_t)m_rings.size();
+        m_rings.push_back(ring);
+    }
+    tlsRings.emplace_back(m_ident, ring.get());
+    return ring.get();
+}
+
+ZENO_API void Profiler::record(Event const &ev) {
+    auto ring = threadRing();
+    std::lock_guard lck(ring->mtx);
+    auto &slot = ring->events[ring->written % ring->events.size()];
+    slot = ev;
+    slot.tid = ring->tid;
+    ring->written++;
+}
+
+ZENO_API std::vector<Profiler::Event> Profiler::collect() const {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard lck(m_mtx);
+        rings = m_rings;
+    }
+    std::vector<Event> res;
+    for (auto const &ring: rings) {
+        std::lock_guard lck(ring->mtx);
+        size_t cap = ring->events.size();
+        size_t n = std::min(ring->written, cap);
+        for (size_t i = ring->written - n; i < ring->written; i++)
+            res.push_back(ring->events[i % cap]);
+    }
+    std::sort(res.begin(), res.end(), [] (Event const &a, Event const &b) {
+        return a.beginNs < b.beginNs;
+    });
+    return res;
+}
+
+ZENO_API void Profiler::clear() {
+    std::lock_guard lck(m_mtx);
+    for (auto const &ring: m_rings) {
+        std::lock_guard rlck(ring->mtx);
+        ring->written = 0;
+    }
+}
+
+ZENO_API std::string Profiler::toChromeTrace() const {
+    auto events = collect();
+    std::vector<std::string> names;
+    {
+        std::lock_guard lck(m_mtx);
+        names = m_names;
+    }
+    int64_t origin = events.empty() ? 0 : events.front().beginNs;
+
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buf);
+    writer.StartObject();
+    writer.Key("displayTimeUnit");
+    writer.String("ms");
+    writer.Key("traceEvents");
+    writer.StartArray();
+    for (auto const &ev: events) {
+        auto const &name = names[ev.nameId];
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name.data(), name.size());
+        writer.Key("cat");
+        writer.String(ev.kind == Apply ? "apply" : "resolve");
+        writer.Key("ph");
+        writer.String("X");
+        writer.Key("ts");
+        writer.Double((ev.beginNs - origin) * 1e-3);
+        writer.Key("dur");
+        writer.Double(ev.durNs * 1e-3);
+        writer.Key("pid");
+        writer.Int(1);
+        writer.Key("tid");
+        writer.Uint(ev.tid);
+        writer.Key("args");
+        writer.StartObject();
+        writer.Key("frame");
+        writer.Int(ev.frameid);
+        writer.Key("substep");
+        writer.Int(ev.substepid);
+        writer.Key("allocBytes");
+        writer.Int64(ev.allocBytes);
+        if (ev.kind == Apply) {
+            writer.Key("outBytes");
+            writer.Int64(ev.outBytes);
+        }
+        writer.EndObject();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return {buf.GetString(), buf.GetSize()};
+}
+
+ZENO_API bool Profiler::dumpChromeTrace(std::string const &path) const {
+    std::ofstream fout(path, std::ios::binary);
+    if (!fout) {
+        log_warn("Profiler: cannot open trace file {}", path);
+        return false;
+    }
+    fout << toChromeTrace();
+    return (bool)fout;
+}
+
+ZENO_API std::string Profiler::summaryJson(int frameid) const {
+    auto events = collect();
+    std::vector<std::string> names;
+    {
+        std::lock_guard lck(m_mtx);
+        names = m_names;
+    }
+
+    struct Stat {
+        bool seen = false;
+        int count = 0;
+        int64_t applyNs = 0;
+        int64_t maxApplyNs = 0;
+        int64_t resolveNs = 0;
+        int64_t allocBytes = 0;
+        int64_t outBytes = 0;
+    };
+    std::vector<Stat> stats(names.size());
+    std::vector<uint32_t> order;
+    for (auto const &ev: events) {
+        if (frameid != -1 && ev.frameid != frameid)
+            continue;
+        auto &st = stats[ev.nameId];
+        if (!st.seen) {
+            st.seen = true;
+            order.push_back(ev.nameId);
+        }
+        if (ev.kind == Apply) {
+            st.count++;
+            st.applyNs += ev.durNs;
+            st.maxApplyNs = std::max(st.maxApplyNs, ev.durNs);
+            st.outBytes = std::max(st.outBytes, ev.outBytes);
+            st.allocBytes += ev.allocBytes;
+        } else {
+            // resolve spans include the upstream nodes they had to apply
+            st.resolveNs += ev.durNs;
+        }
+    }
+    std::sort(order.begin(), order.end(), [&] (uint32_t a, uint32_t b) {
+        return stats[a].applyNs > stats[b].applyNs;
+    });
+
+    rapidjson::StringBuffer buf;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buf);
+    writer.StartObject();
+    writer.Key("frame");
+    writer.Int(frameid);
+    writer.Key("nodes");
+    writer.StartArray();
+    for (auto id: order) {
+        auto const &st = stats[id];
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(names[id].data(), names[id].size());
+        writer.Key("count");
+        writer.Int(st.count);
+        writer.Key("applyMs");
+        writer.Double(st.applyNs * 1e-6);
+        writer.Key("maxApplyMs");
+        writer.Double(st.maxApplyNs * 1e-6);
+        writer.Key("resolveMs");
+        writer.Double(st.resolveNs * 1e-6);
+        writer.Key("allocBytes");
+        writer.Int64(st.allocBytes);
+        writer.Key("outBytes");
+        writer.Int64(st.outBytes);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return {buf.GetString(), buf.GetSize()};
+}
+
+ZENO_API void Profiler::setRemoteSummary(int frameid, std::string json) {
+    std::lock_guard lck(m_mtx);
+    m_remoteSummaries[frameid] = std::move(json);
+}
+
+ZENO_API std::string Profiler::getRemoteSummary(int frameid) const {
+    std::lock_guard lck(m_mtx);
+    auto it = m_remoteSummaries.find(frameid);
+    return it == m_remoteSummaries.end() ? std::string{} : it->second;
+}
+
+ZENO_API void Profiler::clearRemoteSummaries() {
+    std::lock_guard lck(m_mtx);
+    m_remoteSummaries.clear();
+}
+
+ZENO_API int64_t Profiler::objectBytes(IObject *obj) {
+    if (auto prim = dynamic_cast<PrimitiveObject *>(obj)) {
+        return attrVectorBytes(prim->verts) + attrVectorBytes(prim->points)
+             + attrVectorBytes(prim->lines) + attrVectorBytes(prim->tris)
+             + attrVectorBytes(prim->quads) + attrVectorBytes(prim->loops)
+             + attrVectorBytes(prim->polys) + attrVectorBytes(prim->edges)
+             + attrVectorBytes(prim->uvs);
+    }
+    if (auto lst = dynamic_cast<ListObject *>(obj)) {
+        int64_t bytes = 0;
+        for (auto const &elm: lst->arr)
+            bytes += objectBytes(elm.get());
+        return bytes;
+    }
+    return 0;
+}
+
+ZENO_API int64_t Profiler::heapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    // process-wide, so concurrent nodes see each other's allocations
+    struct mallinfo2 mi = mallinfo2();
+    return (int64_t)(mi.uordblks + mi.hblkhd);
+#else
+    return 0;
+#endif
+}
+
+}
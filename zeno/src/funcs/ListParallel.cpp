@@ -0,0 +1,116 @@
+#include <zeno/funcs/ListParallel.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+#include <mutex>
+
+namespace zeno {
+
+namespace {
+
+template <class F>
+struct FuncRegistry {
+    std::mutex mtx;
+    std::map<std::string, F> funcs;
+
+    void def(std::string const &name, F func) {
+        std::lock_guard lck(mtx);
+        if (!funcs.emplace(name, std::move(func)).second)
+            log_error("list function redefined: `{}`", name);
+    }
+
+    F get(std::string const &name) {
+        std::lock_guard lck(mtx);
+        auto it = funcs.find(name);
+        if (it == funcs.end())
+            throw makeError<KeyError>(name, "registered list function");
+        return it->second;
+    }
+};
+
+// function-local statics, registration happens during static initialization of plugins
+FuncRegistry<ListMapFunc> &mapRegistry() {
+    static FuncRegistry<ListMapFunc> reg;
+    return reg;
+}
+
+FuncRegistry<ListReduceFunc> &reduceRegistry() {
+    static FuncRegistry<ListReduceFunc> reg;
+    return reg;
+}
+
+std::shared_ptr<Error> currentError() {
+    try {
+        throw;
+    } catch (ErrorException const &e) {
+        return e.getError();
+    } catch (...) {
+        return std::make_shared<StdError>(std::current_exception());
+    }
+}
+
+}
+
+ZENO_API std::vector<zany> listParallelMap(std::vector<zany> const &arr, ListMapFunc const &func,
+                                           ListMapArgs const &args, std::vector<ListElementError> &errors) {
+    std::vector<zany> res(arr.size());
+    std::vector<std::shared_ptr<Error>> errs(arr.size());
+    std::ptrdiff_t n = arr.size();
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        try {
+            res[i] = func(arr[i], i, args);
+        } catch (...) {
+            errs[i] = currentError();
+        }
+    }
+    for (size_t i = 0; i < errs.size(); i++) {
+        if (errs[i])
+            errors.push_back({i, std::move(errs[i])});
+    }
+    return res;
+}
+
+ZENO_API zany listParallelReduce(std::vector<zany> const &arr, ListReduceFunc const &func) {
+    if (arr.empty())
+        return nullptr;
+    std::vector<zany> level = arr;
+    while (level.size() > 1) {
+        std::vector<zany> next((level.size() + 1) / 2);
+        std::ptrdiff_t npairs = level.size() / 2;
+        std::vector<std::exception_ptr> eps(npairs);
+#pragma omp parallel for schedule(dynamic)
+        for (std::ptrdiff_t i = 0; i < npairs; i++) {
+            try {
+                next[i] = func(level[i * 2], level[i * 2 + 1]);
+            } catch (...) {
+                eps[i] = std::current_exception();
+            }
+        }
+        for (auto const &ep: eps) {
+            if (ep)
+                std::rethrow_exception(ep);
+        }
+        if (level.size() % 2)
+            next.back() = std::move(level.back());
+        level = std::move(next);
+    }
+    return level[0];
+}
+
+ZENO_API void defListMapFunc(std::string const &name, ListMapFunc func) {
+    mapRegistry().def(name, std::move(func));
+}
+
+ZENO_API void defListReduceFunc(std::string const &name, ListReduceFunc func) {
+    reduceRegistry().def(name, std::move(func));
+}
+
+ZENO_API ListMapFunc getListMapFunc(std::string const &name) {
+    return mapRegistry().get(name);
+}
+
+ZENO_API ListReduceFunc getListReduceFunc(std::string const &name) {
+    return reduceRegistry().get(name);
+}
+
+}
@@ -39,10 +39,31 @@ namespace _implObjectCodec {
 
 #define _PER_OBJECT_TYPE(TypeName, ...) \
 std::shared_ptr<TypeName> decode##TypeName(const char *it); \
-bool encode##TypeName(TypeName const *obj, std::back_insert_iterator<std::vector<char>> it);
+bool encodedSize##TypeName(TypeName const *obj, size_t &size); \
+char *encode##TypeName(TypeName const *obj, char *it);
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
+char *bulkCopy(char *it, void const *src, size_t n);
+char *bulkCopy(char *it, void const *src, size_t n) {
+#if defined(_OPENMP)
+    // a single thread cannot saturate memory bandwidth on multi-GB attributes
+    constexpr size_t kChunk = 4 << 20;
+    if (n >= 4 * kChunk) {
+        std::ptrdiff_t nchunks = (n + kChunk - 1) / kChunk;
+#pragma omp parallel for
+        for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+            size_t off = c * kChunk;
+            std::memcpy(it + off, (char const *)src + off, std::min(kChunk, n - off));
+        }
+        return it + n;
+    }
+#endif
+    if (n)
+        std::memcpy(it, src, n);
+    return it + n;
+}
+
 }
 
 using namespace _implObjectCodec;
@@ -100,8 +121,24 @@ std::shared_ptr<IObject> decodeObject(const char *buf, size_t len) {
     return object;
 }
 
-static bool _encodeObjectImpl(IObject const *object, std::vector<char> &buf) {
-    auto it = std::back_inserter(buf);
+static bool _encodedSizeImpl(IObject const *object, size_t &size) {
+    size = sizeof(ObjectHeader);
+
+    if (0) {
+
+#define _PER_OBJECT_TYPE(TypeName, ...) \
+    } else if (auto obj = dynamic_cast<TypeName const *>(object)) { \
+        return encodedSize##TypeName(obj, size);
+ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
+#undef _PER_OBJECT_TYPE
+
+    } else {
+        log_error("invalid object type to encode `{}`", cppdemangle(typeid(*object)));
+        return false;
+    }
+}
+
+static char *_encodeObjectImpl(IObject const *object, char *it) {
     ObjectHeader header;
     header.magicNumber = ObjectHeader::kMagicNumber;
 
@@ -110,38 +147,66 @@ static bool _encodeObjectImpl(IObject const *object, std::vector<char> &buf) {
 #define _PER_OBJECT_TYPE(TypeName, ...) \
     } else if (auto obj = dynamic_cast<TypeName const *>(object)) { \
         header.type = ObjectType::TypeName; \
-        it = std::copy_n((char *)&header, sizeof(ObjectHeader), it); \
+        it = bulkCopy(it, &header, sizeof(ObjectHeader)); \
         return encode##TypeName(obj, it);
 ZENO_XMACRO_IObject(_PER_OBJECT_TYPE)
 #undef _PER_OBJECT_TYPE
 
     } else {
         log_error("invalid object type to encode `{}`", cppdemangle(typeid(*object)));
-        return false;
+        return nullptr;
     }
 }
 
-bool encodeObject(IObject const *object, std::vector<char> &buf) {
-    auto oldsize = buf.size();
-    if (!_encodeObjectImpl(object, buf))
-        return false;
+size_t encodedObjectSize(IObject const *object) {
+    size_t size;
+    if (!_encodedSizeImpl(object, size))
+        return 0;
+    // user data entries that cannot be encoded are skipped rather than failing the object
+    for (auto const &[key, val]: object->userData()) {
+        if (size_t valsize = encodedObjectSize(val.get()))
+            size += sizeof(size_t) * 2 + key.size() + valsize;
+    }
+    return size;
+}
 
-    std::vector<std::vector<char>> valbufs;
+char *encodeObject(IObject const *object, char *it) {
+    auto begin = it;
+    it = _encodeObjectImpl(object, it);
+    if (!it)
+        return nullptr;
+
+    auto &header = *(ObjectHeader *)begin;
+    header.numUserData = 0;
+    header.beginUserData = it - begin;
     for (auto const &[key, val]: object->userData()) {
-        std::vector<char> valbuf;
+        size_t valsize = encodedObjectSize(val.get());
+        if (!valsize)
+            continue;
         size_t keysize = key.size();
-        valbuf.insert(valbuf.end(), (char *)&keysize, (char *)(&keysize + 1));
-        valbuf.insert(valbuf.end(), key.begin(), key.end());
-        if (encodeObject(val.get(), valbuf))
-            valbufs.push_back(std::move(valbuf));
+        size_t valbufsize = sizeof(keysize) + keysize + valsize;
+        it = bulkCopy(it, &valbufsize, sizeof(valbufsize));
+        it = bulkCopy(it, &keysize, sizeof(keysize));
+        it = bulkCopy(it, key.data(), keysize);
+        it = encodeObject(val.get(), it);
+        if (!it)
+            return nullptr;
+        header.numUserData++;
     }
-    auto &header = *(ObjectHeader *)(buf.data() + oldsize);
-    header.numUserData = valbufs.size();
-    header.beginUserData = buf.size() - oldsize;
-    for (auto const &valbuf: valbufs) {
-        size_t valbufsize = valbuf.size();
-        buf.insert(buf.end(), (char *)&valbufsize, (char *)(&valbufsize + 1));
-        buf.insert(buf.end(), valbuf.begin(), valbuf.end());
+    return it;
+}
+
+bool encodeObject(IObject const *object, std::vector<char> &buf) {
+    size_t size = encodedObjectSize(object);
+    if (!size)
+        return false;
+    auto oldsize = buf.size();
+    buf.resize(oldsize + size);
+    auto end = encodeObject(object, buf.data() + oldsize);
+    if (end != buf.data() + buf.size()) {
+        log_error("encoded object size mismatch, expect {} got {}", size, end - (buf.data() + oldsize));
+        buf.resize(oldsize);
+        return false;
     }
     return true;
 }
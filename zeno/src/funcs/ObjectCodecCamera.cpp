@@ -9,6 +9,8 @@ namespace zeno {
 
 namespace _implObjectCodec {
 
+char *bulkCopy(char *it, void const *src, size_t n);
+
 std::shared_ptr<CameraObject> decodeCameraObject(const char *it);
 std::shared_ptr<CameraObject> decodeCameraObject(const char *it) {
     auto obj = std::make_shared<CameraObject>();
@@ -16,12 +18,17 @@ std::shared_ptr<CameraObject> decodeCameraObject(const char *it) {
     return obj;
 }
 
-bool encodeCameraObject(CameraObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeCameraObject(CameraObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    it = std::copy_n((char const *)static_cast<CameraData const *>(obj), sizeof(CameraData), it);
+bool encodedSizeCameraObject(CameraObject const *obj, size_t &size);
+bool encodedSizeCameraObject(CameraObject const *obj, size_t &size) {
+    size += sizeof(CameraData);
     return true;
 }
 
+char *encodeCameraObject(CameraObject const *obj, char *it);
+char *encodeCameraObject(CameraObject const *obj, char *it) {
+    return bulkCopy(it, static_cast<CameraData const *>(obj), sizeof(CameraData));
+}
+
 std::shared_ptr<LightObject> decodeLightObject(const char *it);
 std::shared_ptr<LightObject> decodeLightObject(const char *it) {
     auto obj = std::make_shared<LightObject>();
@@ -29,12 +36,17 @@ std::shared_ptr<LightObject> decodeLightObject(const char *it) {
     return obj;
 }
 
-bool encodeLightObject(LightObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeLightObject(LightObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    it = std::copy_n((char const *)static_cast<LightData const *>(obj), sizeof(LightData), it);
+bool encodedSizeLightObject(LightObject const *obj, size_t &size);
+bool encodedSizeLightObject(LightObject const *obj, size_t &size) {
+    size += sizeof(LightData);
     return true;
 }
 
+char *encodeLightObject(LightObject const *obj, char *it);
+char *encodeLightObject(LightObject const *obj, char *it) {
+    return bulkCopy(it, static_cast<LightData const *>(obj), sizeof(LightData));
+}
+
 }
 
 }
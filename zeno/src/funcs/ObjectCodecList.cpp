@@ -2,6 +2,7 @@
 #include <zeno/funcs/ObjectCodec.h>
 #include <zeno/utils/log.h>
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 
 namespace zeno {
@@ -29,30 +30,45 @@ std::shared_ptr<ListObject> decodeListObject(const char *it) {
     return obj;
 }
 
-bool encodeListObject(ListObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeListObject(ListObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodedSizeListObject(ListObject const *obj, size_t &size);
+bool encodedSizeListObject(ListObject const *obj, size_t &size) {
+    size += sizeof(size_t) * (1 + obj->arr.size() * 2);
+    for (auto const &elm: obj->arr) {
+        size_t len = encodedObjectSize(elm.get());
+        if (!len)
+            return false;
+        size += len;
+    }
+    return true;
+}
+
+char *encodeListObject(ListObject const *obj, char *it);
+char *encodeListObject(ListObject const *obj, char *it) {
     size_t size = obj->arr.size();
-    std::copy_n((char const *)&size, sizeof(size), it);
+    std::memcpy(it, &size, sizeof(size));
+    it += sizeof(size);
 
-    std::vector<char> buf;
-    std::vector<char> fin;
     std::vector<size_t> tab(size * 2);
     size_t base = 0;
     for (size_t i = 0; i < size; i++) {
-        auto const *elm = obj->arr[i].get();
-        if (!encodeObject(elm, buf))
-            return false;
-        size_t len = buf.size();
-        fin.insert(fin.end(), buf.begin(), buf.end());
-        buf.clear();
+        size_t len = encodedObjectSize(obj->arr[i].get());
+        if (!len)
+            return nullptr;
         tab[i * 2] = base;
         tab[i * 2 + 1] = len;
         base += len;
     }
-    std::copy_n(tab.data(), tab.size() * sizeof(size_t), it);
-    std::copy(fin.begin(), fin.end(), it);
+    std::memcpy(it, tab.data(), tab.size() * sizeof(size_t));
+    it += tab.size() * sizeof(size_t);
 
-    return true;
+    // offsets are known up front, so elements can be written concurrently
+    std::atomic<bool> failed{false};
+#pragma omp parallel for schedule(dynamic) if (size > 1)
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)size; i++) {
+        if (!encodeObject(obj->arr[i].get(), it + tab[i * 2]))
+            failed = true;
+    }
+    return failed ? nullptr : it + base;
 }
 
 // TODO: support DictObject
@@ -9,6 +9,8 @@ namespace zeno {
 
 namespace _implObjectCodec {
 
+char *bulkCopy(char *it, void const *src, size_t n);
+
 std::shared_ptr<NumericObject> decodeNumericObject(const char *it);
 std::shared_ptr<NumericObject> decodeNumericObject(const char *it) {
     auto obj = std::make_shared<NumericObject>();
@@ -27,17 +29,25 @@ std::shared_ptr<NumericObject> decodeNumericObject(const char *it) {
     return succ ? obj : nullptr;
 }
 
-bool encodeNumericObject(NumericObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeNumericObject(NumericObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    size_t index = obj->value.index();
-    it = std::copy_n((char const *)&index, sizeof(index), it);
+bool encodedSizeNumericObject(NumericObject const *obj, size_t &size);
+bool encodedSizeNumericObject(NumericObject const *obj, size_t &size) {
+    size += sizeof(size_t);
     std::visit([&] (auto const &val) {
-        using T = std::decay_t<decltype(val)>;
-        it = std::copy_n((char const *)&val, sizeof(val), it);
+        size += sizeof(val);
     }, obj->value);
     return true;
 }
 
+char *encodeNumericObject(NumericObject const *obj, char *it);
+char *encodeNumericObject(NumericObject const *obj, char *it) {
+    size_t index = obj->value.index();
+    it = bulkCopy(it, &index, sizeof(index));
+    std::visit([&] (auto const &val) {
+        it = bulkCopy(it, &val, sizeof(val));
+    }, obj->value);
+    return it;
+}
+
 std::shared_ptr<StringObject> decodeStringObject(const char *it);
 std::shared_ptr<StringObject> decodeStringObject(const char *it) {
     auto obj = std::make_shared<StringObject>();
@@ -47,15 +57,20 @@ std::shared_ptr<StringObject> decodeStringObject(const char *it) {
     return obj;
 }
 
-bool encodeStringObject(StringObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeStringObject(StringObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    size_t size = obj->value.size();
-    char const *data = obj->value.data();
-    it = std::copy_n((char const *)&size, sizeof(size), it);
-    it = std::copy_n(data, size, it);
+bool encodedSizeStringObject(StringObject const *obj, size_t &size);
+bool encodedSizeStringObject(StringObject const *obj, size_t &size) {
+    size += sizeof(size_t) + obj->value.size();
     return true;
 }
 
+char *encodeStringObject(StringObject const *obj, char *it);
+char *encodeStringObject(StringObject const *obj, char *it) {
+    size_t size = obj->value.size();
+    it = bulkCopy(it, &size, sizeof(size));
+    it = bulkCopy(it, obj->value.data(), size);
+    return it;
+}
+
 }
 
 }
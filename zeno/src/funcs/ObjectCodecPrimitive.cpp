@@ -10,6 +10,8 @@ namespace zeno {
 
 namespace _implObjectCodec {
 
+char *bulkCopy(char *it, void const *src, size_t n);
+
 namespace {
 
 struct AttributeHeader {
@@ -50,13 +52,23 @@ void decodeAttrVector(AttrVector<T0> &arr, It &it) {
     arr.update();
 }
 
-template <class T0, class It>
-void encodeAttrVector(AttrVector<T0> const &arr, It &it) {
+template <class T0>
+size_t encodedSizeAttrVector(AttrVector<T0> const &arr) {
+    size_t size = sizeof(AttrVectorHeader) + sizeof(T0) * arr.size();
+    arr.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
+        using T = std::decay_t<decltype(attr[0])>;
+        size += sizeof(AttributeHeader) + sizeof(T) * attr.size();
+    });
+    return size;
+}
+
+template <class T0>
+char *encodeAttrVector(AttrVector<T0> const &arr, char *it) {
     AttrVectorHeader header;
     header.size = arr.size();
     header.nattrs = arr.template num_attrs<AttrAcceptAll>();
-    it = std::copy_n((char const *)&header, sizeof(header), it);
-    it = std::copy_n((char const *)arr.data(), sizeof(T0) * arr.size(), it);
+    it = bulkCopy(it, &header, sizeof(header));
+    it = bulkCopy(it, arr.data(), sizeof(T0) * arr.size());
 
     arr.template foreach_attr<AttrAcceptAll>([&] (auto const &key, auto const &attr) {
         AttributeHeader h;
@@ -65,9 +77,10 @@ void encodeAttrVector(AttrVector<T0> const &arr, It &it) {
         h.size = attr.size();
         h.namelen = key.size();
         std::strncpy(h.name, key.c_str(), sizeof(h.name));
-        it = std::copy_n((char const *)&h, sizeof(h), it);
-        it = std::copy_n((char const *)attr.data(), sizeof(T) * attr.size(), it);
+        it = bulkCopy(it, &h, sizeof(h));
+        it = bulkCopy(it, attr.data(), sizeof(T) * attr.size());
     });
+    return it;
 }
 
 }
@@ -91,25 +104,42 @@ std::shared_ptr<PrimitiveObject> decodePrimitiveObject(const char *it) {
     return obj;
 }
 
-bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodePrimitiveObject(PrimitiveObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    encodeAttrVector(obj->verts, it);
-    encodeAttrVector(obj->points, it);
-    encodeAttrVector(obj->lines, it);
-    encodeAttrVector(obj->tris, it);
-    encodeAttrVector(obj->quads, it);
-    encodeAttrVector(obj->loops, it);
-    encodeAttrVector(obj->polys, it);
-    encodeAttrVector(obj->edges, it);
-    encodeAttrVector(obj->uvs, it);
+bool encodedSizePrimitiveObject(PrimitiveObject const *obj, size_t &size);
+bool encodedSizePrimitiveObject(PrimitiveObject const *obj, size_t &size) {
+    size += encodedSizeAttrVector(obj->verts);
+    size += encodedSizeAttrVector(obj->points);
+    size += encodedSizeAttrVector(obj->lines);
+    size += encodedSizeAttrVector(obj->tris);
+    size += encodedSizeAttrVector(obj->quads);
+    size += encodedSizeAttrVector(obj->loops);
+    size += encodedSizeAttrVector(obj->polys);
+    size += encodedSizeAttrVector(obj->edges);
+    size += encodedSizeAttrVector(obj->uvs);
+    size += 1;
+    if (obj->mtl)
+        size += obj->mtl->serializeSize();
+    return true;
+}
+
+char *encodePrimitiveObject(PrimitiveObject const *obj, char *it);
+char *encodePrimitiveObject(PrimitiveObject const *obj, char *it) {
+    it = encodeAttrVector(obj->verts, it);
+    it = encodeAttrVector(obj->points, it);
+    it = encodeAttrVector(obj->lines, it);
+    it = encodeAttrVector(obj->tris, it);
+    it = encodeAttrVector(obj->quads, it);
+    it = encodeAttrVector(obj->loops, it);
+    it = encodeAttrVector(obj->polys, it);
+    it = encodeAttrVector(obj->edges, it);
+    it = encodeAttrVector(obj->uvs, it);
     if (obj->mtl) {
         *it++ = '1';
-        for (char c: obj->mtl->serialize())
-            *it++ = c;
+        obj->mtl->serialize(it);
+        it += obj->mtl->serializeSize();
     } else {
         *it++ = '0';
     }
-    return true;
+    return it;
 }
 
 }
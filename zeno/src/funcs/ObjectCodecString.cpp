@@ -16,23 +16,33 @@ std::shared_ptr<MaterialObject> decodeMaterialObject(const char *it) {
     return mtl;
 }
 
-bool encodeMaterialObject(MaterialObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeMaterialObject(MaterialObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
-    auto v = obj->serialize();
-    std::copy(v.begin(), v.end(), it);
+bool encodedSizeMaterialObject(MaterialObject const *obj, size_t &size);
+bool encodedSizeMaterialObject(MaterialObject const *obj, size_t &size) {
+    size += obj->serializeSize();
     return true;
 }
 
+char *encodeMaterialObject(MaterialObject const *obj, char *it);
+char *encodeMaterialObject(MaterialObject const *obj, char *it) {
+    obj->serialize(it);
+    return it + obj->serializeSize();
+}
+
 std::shared_ptr<DummyObject> decodeDummyObject(const char *it);
 std::shared_ptr<DummyObject> decodeDummyObject(const char *it) {
     return std::make_shared<DummyObject>();
 }
 
-bool encodeDummyObject(DummyObject const *obj, std::back_insert_iterator<std::vector<char>> it);
-bool encodeDummyObject(DummyObject const *obj, std::back_insert_iterator<std::vector<char>> it) {
+bool encodedSizeDummyObject(DummyObject const *obj, size_t &size);
+bool encodedSizeDummyObject(DummyObject const *obj, size_t &size) {
     return true;
 }
 
+char *encodeDummyObject(DummyObject const *obj, char *it);
+char *encodeDummyObject(DummyObject const *obj, char *it) {
+    return it;
+}
+
 }
 
 }
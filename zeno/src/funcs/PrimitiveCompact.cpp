@@ -0,0 +1,250 @@
+#include <zeno/funcs/PrimitiveCompact.h>
+#include <algorithm>
+#include <cstring>
+
+namespace zeno {
+
+namespace {
+
+constexpr std::ptrdiff_t kBlock = 1 << 16;
+
+struct Bytes12 {
+    uint32_t v[3];
+};
+
+struct Bytes16 {
+    uint64_t v[2];
+};
+
+template <class T>
+void gather(void *dst, void const *src, std::vector<int> const &revamp) {
+    auto d = static_cast<T *>(dst);
+    auto s = static_cast<T const *>(src);
+    std::ptrdiff_t n = revamp.size();
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        d[i] = s[revamp[i]];
+}
+
+// face arrays store their indices as packed ints: int for points, vec2i..vec4i for the rest
+template <class Vec>
+constexpr int kIndexCount = sizeof(Vec) / sizeof(int);
+
+// keeps the faces for which keep(indices, count) holds, keep may rewrite the indices
+template <class Vec, class Keep>
+void compactFaces(AttrVector<Vec> &faces, Keep const &keep, RevampScratch &scratch) {
+    std::ptrdiff_t n = faces.size();
+    if (!n)
+        return;
+    std::vector<uint8_t> flags(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        flags[i] = keep(reinterpret_cast<int *>(&faces.values[i]), kIndexCount<Vec>);
+    auto revamp = compactIndices(flags);
+    if (revamp.size() != faces.size())
+        revampAttrVector(faces, revamp, scratch);
+}
+
+// keeps the flagged polys and packs the loops of the survivors in poly order
+void compactPolys(PrimitiveObject *prim, std::vector<uint8_t> const &flags, RevampScratch &scratch) {
+    auto revamp = compactIndices(flags);
+    if (revamp.size() == prim->polys.size())
+        return;
+    std::ptrdiff_t npolys = revamp.size();
+    std::vector<int> starts(npolys + 1);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < npolys; i++)
+        starts[i] = prim->polys[revamp[i]][1];
+    starts.back() = 0;
+    int nloops = countsToOffsets(starts);
+
+    std::vector<int> loopRevamp(nloops);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < npolys; i++) {
+        auto [base, len] = prim->polys[revamp[i]];
+        for (int j = 0; j < len; j++)
+            loopRevamp[starts[i] + j] = base + j;
+    }
+    revampAttrVector(prim->loops, loopRevamp, scratch);
+    revampAttrVector(prim->polys, revamp, scratch);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < npolys; i++)
+        prim->polys[i][0] = starts[i];
+}
+
+}
+
+ZENO_API void *RevampScratch::reserve(size_t nbytes) {
+    if (nbytes > capacity) {
+        data.reset(new char[nbytes]);
+        capacity = nbytes;
+    }
+    return data.get();
+}
+
+ZENO_API int countsToOffsets(std::vector<int> &counts) {
+    std::ptrdiff_t n = counts.size();
+    std::ptrdiff_t nblocks = (n + kBlock - 1) / kBlock;
+    std::vector<int> blockSums(nblocks + 1);
+#pragma omp parallel for
+    for (std::ptrdiff_t b = 0; b < nblocks; b++) {
+        int sum = 0;
+        for (std::ptrdiff_t i = b * kBlock; i < std::min(n, (b + 1) * kBlock); i++)
+            sum += counts[i];
+        blockSums[b + 1] = sum;
+    }
+    for (std::ptrdiff_t b = 0; b < nblocks; b++)
+        blockSums[b + 1] += blockSums[b];
+#pragma omp parallel for
+    for (std::ptrdiff_t b = 0; b < nblocks; b++) {
+        int sum = blockSums[b];
+        for (std::ptrdiff_t i = b * kBlock; i < std::min(n, (b + 1) * kBlock); i++) {
+            int cnt = counts[i];
+            counts[i] = sum;
+            sum += cnt;
+        }
+    }
+    return blockSums[nblocks];
+}
+
+ZENO_API std::vector<int> compactIndices(std::vector<uint8_t> const &flags) {
+    std::ptrdiff_t n = flags.size();
+    std::ptrdiff_t nblocks = (n + kBlock - 1) / kBlock;
+    std::vector<int> blockStart(nblocks + 1);
+#pragma omp parallel for
+    for (std::ptrdiff_t b = 0; b < nblocks; b++) {
+        int cnt = 0;
+        for (std::ptrdiff_t i = b * kBlock; i < std::min(n, (b + 1) * kBlock); i++)
+            cnt += flags[i] != 0;
+        blockStart[b] = cnt;
+    }
+    int total = countsToOffsets(blockStart);
+
+    std::vector<int> res(total);
+#pragma omp parallel for
+    for (std::ptrdiff_t b = 0; b < nblocks; b++) {
+        int k = blockStart[b];
+        for (std::ptrdiff_t i = b * kBlock; i < std::min(n, (b + 1) * kBlock); i++) {
+            if (flags[i])
+                res[k++] = (int)i;
+        }
+    }
+    return res;
+}
+
+ZENO_API std::vector<int> inverseRevamp(std::vector<int> const &revamp, size_t oldSize) {
+    std::vector<int> res(oldSize);
+    std::ptrdiff_t nold = oldSize;
+    std::ptrdiff_t n = revamp.size();
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < nold; i++)
+        res[i] = -1;
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        res[revamp[i]] = (int)i;
+    return res;
+}
+
+ZENO_API void revampBytes(void *data, size_t elemSize, std::vector<int> const &revamp, RevampScratch &scratch) {
+    size_t nbytes = revamp.size() * elemSize;
+    if (!nbytes)
+        return;
+    auto tmp = scratch.reserve(nbytes);
+    switch (elemSize) {
+    case 4: gather<uint32_t>(tmp, data, revamp); break;
+    case 8: gather<uint64_t>(tmp, data, revamp); break;
+    case 12: gather<Bytes12>(tmp, data, revamp); break;
+    case 16: gather<Bytes16>(tmp, data, revamp); break;
+    default: {
+        auto d = static_cast<char *>(tmp);
+        auto s = static_cast<char const *>(data);
+        std::ptrdiff_t n = revamp.size();
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < n; i++)
+            std::memcpy(d + i * elemSize, s + revamp[i] * elemSize, elemSize);
+    } break;
+    }
+    // the gather cannot run in place since revamp may read slots already written
+    constexpr std::ptrdiff_t kChunk = 1 << 20;
+    std::ptrdiff_t nchunks = (nbytes + kChunk - 1) / kChunk;
+#pragma omp parallel for
+    for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+        std::memcpy(static_cast<char *>(data) + c * kChunk, static_cast<char const *>(tmp) + c * kChunk,
+                    std::min<size_t>(kChunk, nbytes - c * kChunk));
+    }
+}
+
+ZENO_API void primRevampVerts(PrimitiveObject *prim, std::vector<int> const &revamp) {
+    RevampScratch scratch;
+    size_t oldSize = prim->verts.size();
+    revampAttrVector(prim->verts, revamp, scratch);
+    if (!(prim->points.size() || prim->lines.size() || prim->tris.size() || prim->quads.size()
+          || prim->edges.size() || prim->polys.size()))
+        return;
+
+    auto unrevamp = inverseRevamp(revamp, oldSize);
+    auto remap = [&] (int *ind, int count) {
+        bool ok = true;
+        for (int j = 0; j < count; j++) {
+            int loc = unrevamp[ind[j]];
+            if (loc == -1)
+                ok = false;
+            else
+                ind[j] = loc;
+        }
+        return ok;
+    };
+    compactFaces(prim->points, remap, scratch);
+    compactFaces(prim->lines, remap, scratch);
+    compactFaces(prim->tris, remap, scratch);
+    compactFaces(prim->quads, remap, scratch);
+    compactFaces(prim->edges, remap, scratch);
+
+    if (prim->polys.size()) {
+        // remap each loop once, polys may share loops
+        std::ptrdiff_t nloops = prim->loops.size();
+        std::vector<uint8_t> loopOk(nloops);
+#pragma omp parallel for
+        for (std::ptrdiff_t l = 0; l < nloops; l++)
+            loopOk[l] = remap(&prim->loops[l], 1);
+        std::ptrdiff_t npolys = prim->polys.size();
+        std::vector<uint8_t> flags(npolys);
+#pragma omp parallel for
+        for (std::ptrdiff_t p = 0; p < npolys; p++) {
+            auto [base, len] = prim->polys[p];
+            flags[p] = std::all_of(loopOk.begin() + base, loopOk.begin() + base + len, [] (uint8_t ok) {
+                return ok != 0;
+            });
+        }
+        compactPolys(prim, flags, scratch);
+    }
+}
+
+ZENO_API void primRevampFaces(PrimitiveObject *prim, std::vector<uint8_t> const &mask) {
+    RevampScratch scratch;
+    auto touches = [&] (int *ind, int count) {
+        for (int j = 0; j < count; j++) {
+            if (mask[ind[j]])
+                return true;
+        }
+        return false;
+    };
+    compactFaces(prim->points, touches, scratch);
+    compactFaces(prim->lines, touches, scratch);
+    compactFaces(prim->tris, touches, scratch);
+    compactFaces(prim->quads, touches, scratch);
+    compactFaces(prim->edges, touches, scratch);
+
+    if (prim->polys.size()) {
+        std::ptrdiff_t npolys = prim->polys.size();
+        std::vector<uint8_t> flags(npolys);
+#pragma omp parallel for
+        for (std::ptrdiff_t p = 0; p < npolys; p++) {
+            auto [base, len] = prim->polys[p];
+            flags[p] = touches(prim->loops.values.data() + base, len);
+        }
+        compactPolys(prim, flags, scratch);
+    }
+}
+
+}
@@ -0,0 +1,281 @@
+#include <zeno/funcs/PrimitiveTopology.h>
+#include <zeno/funcs/PrimitiveCompact.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/Error.h>
+#include <zeno/utils/format.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace zeno {
+
+namespace {
+
+uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// content hash of the face index arrays, hashed in fixed chunks in parallel
+uint64_t hashBytes(void const *data, size_t size, uint64_t seed) {
+    constexpr std::ptrdiff_t kChunk = 1 << 20;
+    auto bytes = static_cast<unsigned char const *>(data);
+    std::ptrdiff_t nchunks = (size + kChunk - 1) / kChunk;
+    std::vector<uint64_t> chunkHashes(nchunks);
+#pragma omp parallel for
+    for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+        auto p = bytes + c * kChunk;
+        size_t n = std::min<size_t>(kChunk, size - c * kChunk);
+        uint64_t h = 0x9e3779b97f4a7c15ull * (c + 1);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            h = (h ^ mix64(w)) * 0x100000001b3ull;
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, p + i, n - i);
+        chunkHashes[c] = mix64(h ^ tail ^ n);
+    }
+    uint64_t h = mix64(seed ^ size);
+    for (auto ch: chunkHashes)
+        h = mix64(h ^ ch) + 0x9e3779b97f4a7c15ull;
+    return h;
+}
+
+uint64_t topologyFingerprint(PrimitiveObject const *prim) {
+    uint64_t h = mix64(prim->verts.size());
+    h = hashBytes(prim->tris.values.data(), prim->tris.size() * sizeof(vec3i), h);
+    h = hashBytes(prim->quads.values.data(), prim->quads.size() * sizeof(vec4i), h);
+    h = hashBytes(prim->polys.values.data(), prim->polys.size() * sizeof(vec2i), h);
+    h = hashBytes(prim->loops.values.data(), prim->loops.size() * sizeof(int), h);
+    return h;
+}
+
+void buildFaces(PrimTopology &topo, PrimitiveObject const *prim) {
+    topo.numVerts = (int)prim->verts.size();
+    topo.numTris = (int)prim->tris.size();
+    topo.numQuads = (int)prim->quads.size();
+    topo.numPolys = (int)prim->polys.size();
+    std::ptrdiff_t nfaces = topo.numFaces();
+    std::ptrdiff_t polyBase = topo.numTris + topo.numQuads;
+
+    topo.faceStart.resize(nfaces + 1);
+#pragma omp parallel for
+    for (std::ptrdiff_t f = 0; f < nfaces; f++) {
+        topo.faceStart[f] = f < topo.numTris ? 3 : f < polyBase ? 4 : prim->polys[f - polyBase][1];
+    }
+    topo.faceStart.back() = 0;
+    int ncorners = countsToOffsets(topo.faceStart);
+    topo.faceStart.back() = ncorners;
+
+    topo.corners.resize(ncorners);
+    topo.cornerFace.resize(ncorners);
+    int nloops = (int)prim->loops.size();
+    bool badPoly = false;
+#pragma omp parallel for reduction(||: badPoly)
+    for (std::ptrdiff_t f = 0; f < nfaces; f++) {
+        int h = topo.faceStart[f];
+        if (f < topo.numTris) {
+            auto ind = prim->tris[f];
+            for (int j = 0; j < 3; j++)
+                topo.corners[h + j] = ind[j];
+        } else if (f < polyBase) {
+            auto ind = prim->quads[f - topo.numTris];
+            for (int j = 0; j < 4; j++)
+                topo.corners[h + j] = ind[j];
+        } else {
+            auto [start, len] = prim->polys[f - polyBase];
+            if (start < 0 || len < 0 || start + len > nloops) {
+                badPoly = true;
+                continue;
+            }
+            for (int j = 0; j < len; j++)
+                topo.corners[h + j] = prim->loops[start + j];
+        }
+        for (int j = h; j < topo.faceStart[f + 1]; j++)
+            topo.cornerFace[j] = (int)f;
+    }
+    if (badPoly)
+        throw makeError(format("primTopology: polygon exceeds the {} loops", nloops));
+
+    bool badVert = false;
+#pragma omp parallel for reduction(||: badVert)
+    for (std::ptrdiff_t h = 0; h < ncorners; h++) {
+        if (topo.corners[h] < 0 || topo.corners[h] >= topo.numVerts)
+            badVert = true;
+    }
+    if (badVert) {
+        auto it = std::find_if(topo.corners.begin(), topo.corners.end(), [&] (int v) {
+            return v < 0 || v >= topo.numVerts;
+        });
+        throw makeError<IndexError>((size_t)*it, (size_t)topo.numVerts, "primTopology: face vertex");
+    }
+}
+
+// Counting sort of the corners into one bucket per vertex: start gets nverts + 1 offsets into
+// items, items holds valueOf(h) of every corner h in the bucket of keyOf(h), in racy order.
+template <class T, class KeyOf, class ValueOf>
+void bucketCorners(std::ptrdiff_t nverts, std::ptrdiff_t ncorners, KeyOf keyOf, ValueOf valueOf,
+                   std::vector<int> &start, std::vector<T> &items) {
+    std::unique_ptr<std::atomic<int>[]> counts(new std::atomic<int>[nverts]);
+#pragma omp parallel for
+    for (std::ptrdiff_t v = 0; v < nverts; v++)
+        counts[v].store(0, std::memory_order_relaxed);
+#pragma omp parallel for
+    for (std::ptrdiff_t h = 0; h < ncorners; h++)
+        counts[keyOf((int)h)].fetch_add(1, std::memory_order_relaxed);
+
+    start.resize(nverts + 1);
+#pragma omp parallel for
+    for (std::ptrdiff_t v = 0; v < nverts; v++) {
+        start[v] = counts[v].load(std::memory_order_relaxed);
+        counts[v].store(0, std::memory_order_relaxed);
+    }
+    start.back() = 0;
+    start.back() = countsToOffsets(start);
+
+    items.resize(ncorners);
+#pragma omp parallel for
+    for (std::ptrdiff_t h = 0; h < ncorners; h++) {
+        int v = keyOf((int)h);
+        items[start[v] + counts[v].fetch_add(1, std::memory_order_relaxed)] = valueOf((int)h);
+    }
+}
+
+void buildVertCorners(PrimTopology &topo) {
+    std::ptrdiff_t nverts = topo.numVerts;
+    bucketCorners(nverts, topo.numCorners(), [&] (int h) {
+        return topo.corners[h];
+    }, [] (int h) {
+        return h;
+    }, topo.vertStart, topo.vertCorners);
+    // fill order is racy, sorting each fan makes the result deterministic
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::ptrdiff_t v = 0; v < nverts; v++)
+        std::sort(topo.vertCorners.begin() + topo.vertStart[v], topo.vertCorners.begin() + topo.vertStart[v + 1]);
+}
+
+void buildEdges(PrimTopology &topo) {
+    std::ptrdiff_t nverts = topo.numVerts;
+    std::ptrdiff_t ncorners = topo.numCorners();
+    // sort the half-edges by their (min, max) vertex pair: bucket them by the smaller vertex,
+    // then sort each bucket by the larger one and the half-edge, so the half-edges of an edge
+    // end up next to each other with the smallest, which stands for the edge, first
+    std::vector<int> loStart;
+    std::vector<uint64_t> keys;
+    bucketCorners(nverts, ncorners, [&] (int h) {
+        return std::min(topo.corners[h], topo.dest(h));
+    }, [&] (int h) {
+        return uint64_t(std::max(topo.corners[h], topo.dest(h))) << 32 | uint32_t(h);
+    }, loStart, keys);
+
+    std::vector<int> rep(ncorners);
+    std::vector<int> valence(ncorners);
+    topo.twin.resize(ncorners);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::ptrdiff_t v = 0; v < nverts; v++) {
+        auto beg = keys.begin() + loStart[v], end = keys.begin() + loStart[v + 1];
+        std::sort(beg, end);
+        for (auto it = beg; it != end;) {
+            auto last = it;
+            while (last != end && *last >> 32 == *it >> 32)
+                ++last;
+            int count = int(last - it);
+            int first = int(uint32_t(*it));
+            for (auto jt = it; jt != last; ++jt) {
+                int h = int(uint32_t(*jt));
+                rep[h] = first;
+                valence[h] = count;
+                topo.twin[h] = count == 2 ? int(uint32_t(jt == it ? it[1] : *it)) : -1;
+            }
+            it = last;
+        }
+    }
+
+    std::vector<int> edgeIds(ncorners);
+#pragma omp parallel for
+    for (std::ptrdiff_t h = 0; h < ncorners; h++)
+        edgeIds[h] = rep[h] == h;
+    int nedges = countsToOffsets(edgeIds);
+
+    topo.edges.resize(nedges);
+    topo.edgeValence.resize(nedges);
+    topo.cornerEdge.resize(ncorners);
+#pragma omp parallel for
+    for (std::ptrdiff_t h = 0; h < ncorners; h++) {
+        int e = edgeIds[rep[h]];
+        topo.cornerEdge[h] = e;
+        if (rep[h] == h) {
+            topo.edges[e] = vec2i(topo.corners[h], topo.dest((int)h));
+            topo.edgeValence[e] = valence[h];
+        }
+    }
+
+    topo.vertBoundary.resize(nverts);
+#pragma omp parallel for
+    for (std::ptrdiff_t v = 0; v < nverts; v++) {
+        uint8_t bound = 0;
+        for (int i = topo.vertStart[v]; i < topo.vertStart[v + 1]; i++) {
+            int h = topo.vertCorners[i];
+            // outgoing half-edge h and the incoming one ending at this corner
+            if (topo.isBoundaryEdge(topo.cornerEdge[h]) || topo.isBoundaryEdge(topo.cornerEdge[topo.prev(h)]))
+                bound = 1;
+        }
+        topo.vertBoundary[v] = bound;
+    }
+}
+
+}
+
+ZENO_API int PrimTopology::findEdge(int a, int b) const {
+    for (int i = vertStart[a]; i < vertStart[a + 1]; i++) {
+        int h = vertCorners[i];
+        if (dest(h) == b)
+            return cornerEdge[h];
+    }
+    for (int i = vertStart[b]; i < vertStart[b + 1]; i++) {
+        int h = vertCorners[i];
+        if (dest(h) == a)
+            return cornerEdge[h];
+    }
+    return -1;
+}
+
+ZENO_API std::shared_ptr<PrimTopology const> primTopology(PrimitiveObject *prim, bool withEdges) {
+    auto cached = std::atomic_load(&prim->topoCache);
+    uint64_t fingerprint = topologyFingerprint(prim);
+    bool upToDate = cached && cached->version == prim->topoVersion && cached->fingerprint == fingerprint;
+    if (upToDate && (cached->hasEdges || !withEdges))
+        return cached;
+
+    std::shared_ptr<PrimTopology> topo;
+    if (upToDate) {
+        // the faces are still right, only the edges are missing
+        topo = std::make_shared<PrimTopology>(*cached);
+    } else {
+        topo = std::make_shared<PrimTopology>();
+        topo->version = prim->topoVersion;
+        topo->fingerprint = fingerprint;
+        buildFaces(*topo, prim);
+        buildVertCorners(*topo);
+    }
+    if (withEdges) {
+        buildEdges(*topo);
+        topo->hasEdges = true;
+    }
+    std::shared_ptr<PrimTopology const> res = std::move(topo);
+    std::atomic_store(&prim->topoCache, res);
+    return res;
+}
+
+ZENO_API void primInvalidateTopology(PrimitiveObject *prim) {
+    prim->topoVersion++;
+    std::atomic_store(&prim->topoCache, std::shared_ptr<PrimTopology const>());
+}
+
+}
@@ -3,8 +3,13 @@
 #include <zeno/types/NumericObject.h>
 #include <zeno/types/DummyObject.h>
 #include <zeno/extra/ContextManaged.h>
+#include <zeno/extra/SubnetNode.h>
 #include <zeno/extra/evaluate_condition.h>
+#include <zeno/core/Session.h>
 #include <zeno/utils/safe_at.h>
+#include <zeno/utils/log.h>
+#include <exception>
+#include <functional>
 
 namespace zeno {
 
@@ -170,34 +175,46 @@ ZENDEFNODE(BeginForEach, {
     {"control"},
 });
 
+// stands in for a node outside of the loop body in a parallel ForEach
+// iteration, only carries the outputs already computed in the parent graph
+struct ForEachOutputStub : zeno::INode {
+    virtual void apply() override {}
+};
+
 struct EndForEach : EndFor {
     std::vector<zany> result;
     std::vector<zany> dropped_result;
 
-    virtual void post_do_apply() override {
-        bool accept = true;
-        if (requireInput("accept")) {
-            accept = evaluate_condition(get_input("accept").get());
-        }
-        if (requireInput("object")) {
-            auto obj = get_input("object");
+    void collectResult(zany const &accept_obj, bool has_obj, zany obj, std::shared_ptr<ListObject> const &listObj,
+                       std::vector<zany> &res, std::vector<zany> &dropped) const {
+        bool accept = !accept_obj || evaluate_condition(accept_obj.get());
+        if (has_obj) {
             if (accept)
-                result.push_back(std::move(obj));
+                res.push_back(std::move(obj));
             else
-                dropped_result.push_back(std::move(obj));
+                dropped.push_back(std::move(obj));
         }
-        if (requireInput("list")) {
-            if (accept) {
-                auto listObj = get_input<zeno::ListObject>("list");
-                for(auto obj : listObj->arr)
-                    result.push_back(std::move(obj));
-            }
-            else{
-                auto listObj = get_input<zeno::ListObject>("list");
-                for(auto obj : listObj->arr)
-                    dropped_result.push_back(std::move(obj));
+        if (listObj) {
+            for (auto obj : listObj->arr) {
+                if (accept)
+                    res.push_back(std::move(obj));
+                else
+                    dropped.push_back(std::move(obj));
             }
         }
+    }
+
+    virtual void post_do_apply() override {
+        zany accept_obj, obj;
+        std::shared_ptr<ListObject> listObj;
+        if (requireInput("accept"))
+            accept_obj = get_input("accept");
+        bool has_obj = requireInput("object");
+        if (has_obj)
+            obj = get_input("object");
+        if (requireInput("list"))
+            listObj = get_input<zeno::ListObject>("list");
+        collectResult(accept_obj, has_obj, std::move(obj), listObj, result, dropped_result);
         if (requireInput("accumate")) {
             auto [sn, ss] = safe_at(inputBounds, "FOR", "input socket of EndForEach");
             auto fore = dynamic_cast<BeginForEach *>(graph->nodes.at(sn).get());
@@ -209,8 +226,203 @@ struct EndForEach : EndFor {
         }
     }
 
+    std::string nodeClassName(INode *node) const {
+        for (auto const &[name, cls]: graph->session->nodeClasses) {
+            if (cls.get() == node->nodeClass)
+                return name;
+        }
+        return {};
+    }
+
+    // Finds the nodes that have to be instantiated per iteration: everything
+    // upstream of this node depending on the BeginForEach, plus loop heads of
+    // nested loops they use. Their other inputs are loop invariant and only
+    // evaluated once. Returns false if the body can't be evaluated detached
+    // from this graph.
+    bool collectLoopBody(std::string const &begin, std::set<std::string> &body,
+                         std::set<std::string> &invariants) {
+        std::map<std::string, bool> depends;
+        std::function<bool(std::string const &)> visit = [&] (std::string const &id) {
+            if (id == begin)
+                return true;
+            if (auto it = depends.find(id); it != depends.end())
+                return it->second;
+            depends[id] = false;
+            bool dep = false;
+            for (auto const &[ds, bound]: safe_at(graph->nodes, id, "node name")->inputBounds)
+                dep = visit(bound.first) || dep;
+            return depends[id] = dep;
+        };
+        std::vector<std::string> stack;
+        for (auto const &[ds, bound]: inputBounds) {
+            auto const &sn = bound.first;
+            // the loop head is stubbed per iteration, everything else is either body or invariant
+            if (ds == "FOR" || sn == begin)
+                continue;
+            if (visit(sn) || dynamic_cast<IBeginFor *>(graph->nodes.at(sn).get()))
+                stack.push_back(sn);
+            else
+                invariants.insert(sn);
+        }
+        while (!stack.empty()) {
+            auto id = std::move(stack.back());
+            stack.pop_back();
+            if (!body.insert(id).second)
+                continue;
+            auto node = graph->nodes.at(id).get();
+            // subnets own their graph, portals look up nodes by name
+            if (dynamic_cast<SubnetNode *>(node))
+                return false;
+            if (auto cls = nodeClassName(node); cls.empty() || cls == "PortalIn" || cls == "PortalOut")
+                return false;
+            for (auto const &[ds, bound]: node->inputBounds) {
+                auto const &sn = bound.first;
+                if (sn == begin)
+                    continue;
+                if (depends[sn] || dynamic_cast<IBeginFor *>(graph->nodes.at(sn).get()))
+                    stack.push_back(sn);
+                else
+                    invariants.insert(sn);
+            }
+        }
+        for (auto const &id: body)
+            invariants.erase(id);
+        return true;
+    }
+
+    bool canRunParallel(std::string const &sn, BeginForEach *fore) const {
+        if (!get_input2<bool>("parallel:", false))
+            return false;
+        // accumate chains iterations and BreakFor stops them, both need order
+        if (inputBounds.count("accumate") || fore->inputBounds.count("accumate"))
+            return false;
+        for (auto const &[id, node]: graph->nodes) {
+            if (auto brk = dynamic_cast<BreakFor *>(node.get()); brk) {
+                if (auto it = brk->inputBounds.find("FOR"); it != brk->inputBounds.end() && it->second.first == sn)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    std::unique_ptr<Graph> makeIterationGraph(std::string const &begin, BeginForEach *fore, int index,
+                                              std::set<std::string> const &body,
+                                              std::set<std::string> const &invariants) const {
+        auto g = std::make_unique<Graph>();
+        g->session = graph->session;
+        g->ctx = std::make_unique<Context>();
+        auto addStub = [&] (std::string const &id) -> INode * {
+            auto src = graph->nodes.at(id).get();
+            auto stub = std::make_unique<ForEachOutputStub>();
+            stub->graph = g.get();
+            stub->myname = id;
+            stub->nodeClass = src->nodeClass;
+            g->ctx->visited.insert(id);
+            return (g->nodes[id] = std::move(stub)).get();
+        };
+        for (auto const &id: invariants) {
+            auto src = graph->nodes.at(id).get();
+            auto stub = addStub(id);
+            // iterations run at once and may modify their inputs in place, each gets its own copy
+            for (auto const &[ss, obj]: src->outputs) {
+                auto copy = obj ? obj->clone() : nullptr;
+                stub->outputs[ss] = copy ? std::move(copy) : obj;
+            }
+            stub->muted_output = src->muted_output;
+        }
+        auto head = addStub(begin);
+        head->outputs["FOR"] = fore->outputs.at("FOR");
+        head->outputs["object"] = fore->m_list->arr[index];
+        head->outputs["index"] = std::make_shared<NumericObject>(index);
+        for (auto const &id: body) {
+            auto src = graph->nodes.at(id).get();
+            auto node = src->nodeClass->new_instance();
+            node->graph = g.get();
+            node->myname = id;
+            node->nodeClass = src->nodeClass;
+            node->inputBounds = src->inputBounds;
+            node->inputs = src->inputs;
+            node->kframes = src->kframes;
+            node->formulas = src->formulas;
+            node->doComplete();
+            g->nodes[id] = std::move(node);
+        }
+        return g;
+    }
+
+    bool applyParallel() {
+        auto [sn, ss] = safe_at(inputBounds, "FOR", "input socket of EndForEach");
+        auto fore = dynamic_cast<BeginForEach *>(graph->nodes.at(sn).get());
+        if (!fore)
+            return false;
+        graph->applyNode(sn);
+        if (!canRunParallel(sn, fore))
+            return false;
+        std::set<std::string> body, invariants;
+        if (!collectLoopBody(sn, body, invariants)) {
+            log_warn("EndForEach {}: loop body not detachable, running serially", myname);
+            return false;
+        }
+        for (auto const &id: invariants)
+            graph->applyNode(id);
+
+        int n = fore->m_list->arr.size();
+        std::vector<std::vector<zany>> results(n), dropped(n);
+        std::vector<std::exception_ptr> errors(n);
+        std::unique_ptr<Graph> lastGraph;
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < n; i++) {
+            try {
+                auto g = makeIterationGraph(sn, fore, i, body, invariants);
+                auto fetch = [&] (std::string const &ds) -> zany {
+                    auto it = inputBounds.find(ds);
+                    if (it == inputBounds.end())
+                        return nullptr;
+                    g->applyNode(it->second.first);
+                    return g->getNodeOutput(it->second.first, it->second.second);
+                };
+                auto accept_obj = fetch("accept");
+                auto obj = fetch("object");
+                auto list = fetch("list");
+                auto listObj = list ? safe_dynamic_cast<ListObject>(list, "input socket `list` of node `" + myname + "`") : nullptr;
+                collectResult(accept_obj, inputBounds.count("object") != 0, std::move(obj), listObj, results[i], dropped[i]);
+                if (i == n - 1)
+                    lastGraph = std::move(g);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+        for (auto const &ep: errors) {
+            if (ep)
+                std::rethrow_exception(ep);
+        }
+
+        for (int i = 0; i < n; i++) {
+            for (auto &obj: results[i])
+                result.push_back(std::move(obj));
+            for (auto &obj: dropped[i])
+                dropped_result.push_back(std::move(obj));
+        }
+        fore->m_index = n;
+        if (lastGraph) {
+            // auto-valid the nodes in last iteration when refered from outside
+            fore->set_output("object", lastGraph->nodes.at(sn)->outputs.at("object"));
+            fore->set_output("index", lastGraph->nodes.at(sn)->outputs.at("index"));
+            for (auto const &id: body) {
+                if (lastGraph->ctx->visited.count(id)) {
+                    auto node = graph->nodes.at(id).get();
+                    node->outputs = std::move(lastGraph->nodes.at(id)->outputs);
+                    node->muted_output = std::move(lastGraph->nodes.at(id)->muted_output);
+                    graph->ctx->visited.insert(id);
+                }
+            }
+        }
+        return true;
+    }
+
     virtual void preApply() override {
-        EndFor::preApply();
+        if (!applyParallel())
+            EndFor::preApply();
         if (get_param<bool>("doConcat")) {
             decltype(result) newres;
             for (auto &xs: result) {
@@ -243,7 +455,7 @@ struct EndForEach : EndFor {
 ZENDEFNODE(EndForEach, {
     {"object", "list", "accumate", {"bool", "accept", "1"}, "FOR"},
     {"list", "droppedList", "accumate"},
-    {{"bool", "doConcat", "0"}},
+    {{"bool", "doConcat", "0"}, {"bool", "parallel", "0"}},
     {"control"},
 });
 
@@ -2,35 +2,141 @@
 #include <zeno/funcs/ObjectCodec.h>
 #include <zeno/core/Graph.h>
 #include <zeno/utils/log.h>
-#include <zeno/funcs/ObjectCodec.h>
 #include <zeno/types/DictObject.h>
-#include <zeno/extra/DirtyChecker.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/extra/SubnetNode.h>
+#include <zeno/utils/safe_at.h>
 #include <zeno/extra/assetDir.h>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <limits>
 #include <random>
+#include <tuple>
 #include <cstdlib>
+#include <cstring>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace zeno {
 namespace {
 
+struct CacheFileHeader {
+    constexpr static uint32_t kMagicNumber = 0x44544343;  // "CCTD"
+    constexpr static uint32_t kVersion = 1;
+
+    uint32_t magicNumber;
+    uint32_t version;
+    uint64_t key;
+    uint64_t payloadSize;
+};
+
+// 64-bit FNV-1a, only used to name cache files
+struct CacheKeyHasher {
+    uint64_t h = 14695981039346656037ull;
+
+    void bytes(void const *p, size_t n) {
+        auto c = (unsigned char const *)p;
+        for (size_t i = 0; i < n; i++) {
+            h ^= c[i];
+            h *= 1099511628211ull;
+        }
+    }
+
+    template <class T>
+    void pod(T const &val) {
+        bytes(&val, sizeof(val));
+    }
+
+    void str(std::string_view s) {
+        pod(s.size());
+        bytes(s.data(), s.size());
+    }
+};
+
+// read-only view of a whole file, so decodeObject works straight from the page cache
+struct MappedFile {
+    char const *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    HANDLE hMap = nullptr;
+#endif
+
+    explicit MappedFile(std::filesystem::path const &path) {
+#ifdef _WIN32
+        hFile = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER li;
+        if (!GetFileSizeEx(hFile, &li) || !li.QuadPart)
+            return;
+        hMap = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!hMap)
+            return;
+        if (auto p = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0)) {
+            data = (char const *)p;
+            size = (size_t)li.QuadPart;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = (char const *)p;
+                size = st.st_size;
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data)
+            UnmapViewOfFile(data);
+        if (hMap)
+            CloseHandle(hMap);
+        if (hFile != INVALID_HANDLE_VALUE)
+            CloseHandle(hFile);
+#else
+        if (data)
+            ::munmap((void *)data, size);
+#endif
+    }
+};
+
 struct CacheToDisk : zeno::INode {
+    uint64_t cacheKey = 0;
+
     virtual void preApply() override {
-        if (auto it = inputBounds.find("object"); it != inputBounds.end()) {
-            auto snid = it->second.first;
-            auto &dc = graph->getDirtyChecker();
-            if (dc.amIDirty(snid)) {
-                invalidateCache();
-            } else {
-                if (auto cached = tryGetCached()) {
-                    log_info("CacheToDisk: reusing cache at {}", getCachePath());
-                    set_output("object", std::move(cached));
-                    return;
-                }
-            }
-        } else {
+        auto it = inputBounds.find("object");
+        if (it == inputBounds.end()) {
             throw makeError("CacheToDisk: input socket object not connected");
         }
+        cacheKey = computeCacheKey(it->second.first, it->second.second);
+        if (auto cached = tryGetCached()) {
+            log_info("CacheToDisk: reusing cache at {}", getCachePath());
+            set_output("object", std::move(cached));
+            return;
+        }
         log_info("CacheToDisk: updating cache at {}", getCachePath());
         INode::preApply();
     }
@@ -38,30 +144,110 @@ struct CacheToDisk : zeno::INode {
     virtual void apply() override {
         auto obj = get_input("object");
         if (obj) {
-            std::vector<char> out;
-            encodeObject(obj.get(), out);
-            auto cachefile = getCachePath();
-            if (std::ofstream ofs(cachefile); !ofs) {
-                log_error("failed to open file for write: {}", cachefile);
-            } else {
-                std::ostreambuf_iterator<char> oit(ofs);
-                std::copy(out.begin(), out.end(), oit);
-            }
+            writeCache(obj.get());
         }
         set_output("object", std::move(obj));
     }
 
-    void invalidateCache() {
-        auto cachefile = getCachePath();
-        if (std::filesystem::exists(cachefile)) {
-            std::filesystem::remove(cachefile);
-            if (std::filesystem::exists(cachefile)) {
-                throw makeError(format("failed to remove out-of-date cache file: {}", cachefile));
+    struct NodeKey {
+        uint64_t hash;
+        bool frameDependent;
+    };
+
+    static std::string nodeClassName(INode *node) {
+        if (dynamic_cast<SubnetNode *>(node))
+            return "Subnet";
+        for (auto const &[name, cls]: node->getThisSession()->nodeClasses) {
+            if (cls.get() == node->nodeClass)
+                return name;
+        }
+        return {};
+    }
+
+    static void hashObject(CacheKeyHasher &h, IObject *obj) {
+        if (!obj) {
+            h.str("null");
+        } else if (auto num = dynamic_cast<NumericObject *>(obj)) {
+            h.pod(num->value.index());
+            std::visit([&] (auto const &val) {
+                h.pod(val);
+            }, num->value);
+        } else if (auto str = dynamic_cast<StringObject *>(obj)) {
+            h.str(str->value);
+            // input files are keyed by size and modification time, like make
+            std::error_code ec;
+            auto path = std::filesystem::u8path(str->value);
+            if (!str->value.empty() && std::filesystem::is_regular_file(path, ec)) {
+                h.pod((uint64_t)std::filesystem::file_size(path, ec));
+                h.pod(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
             }
+        } else if (size_t size = encodedObjectSize(obj)) {
+            std::vector<char> buf(size);
+            encodeObject(obj, buf.data());
+            h.bytes(buf.data(), buf.size());
+        } else {
+            h.str(typeid(*obj).name());
         }
     }
 
-    std::string getCachePath() {
+    // hashes a node by its class, literal inputs and the keys of the nodes it is bound to,
+    // so the key follows the upstream content rather than node names
+    static NodeKey hashNode(Graph *g, std::string const &ident, std::map<INode *, NodeKey> &memo) {
+        INode *node = safe_at(g->nodes, ident, "node name").get();
+        if (auto it = memo.find(node); it != memo.end())
+            return it->second;
+        memo[node] = {0, false};  // guards against cycles through portals
+
+        CacheKeyHasher h;
+        auto cls = nodeClassName(node);
+        h.str(cls);
+        bool frameDependent = !node->kframes.empty() || !node->formulas.empty() || node->dependsOnFrame();
+
+        for (auto const &[ds, val]: node->inputs) {
+            if (node->inputBounds.count(ds))
+                continue;  // holds the last evaluated value, the bound node is hashed instead
+            h.str(ds);
+            hashObject(h, val.get());
+        }
+        for (auto const &[ds, bound]: node->inputBounds) {
+            auto up = hashNode(g, bound.first, memo);
+            h.str(ds);
+            h.pod(up.hash);
+            h.str(bound.second);
+            frameDependent |= up.frameDependent;
+        }
+        if (cls == "PortalOut") {
+            auto name = node->get_param<std::string>("name");
+            if (auto it = g->portalIns.find(name); it != g->portalIns.end()) {
+                auto up = hashNode(g, it->second, memo);
+                h.pod(up.hash);
+                frameDependent |= up.frameDependent;
+            }
+        }
+        if (auto subnet = dynamic_cast<SubnetNode *>(node)) {
+            for (auto const &[subident, subnode]: subnet->subgraph->nodes) {
+                auto up = hashNode(subnet->subgraph.get(), subident, memo);
+                h.str(subident);
+                h.pod(up.hash);
+                frameDependent |= up.frameDependent;
+            }
+        }
+        return memo[node] = {h.h, frameDependent};
+    }
+
+    uint64_t computeCacheKey(std::string const &sn, std::string const &ss) {
+        std::map<INode *, NodeKey> memo;
+        auto up = hashNode(graph, sn, memo);
+        CacheKeyHasher h;
+        h.pod(up.hash);
+        h.str(ss);
+        if (up.frameDependent || get_param<bool>("perFrame")) {
+            h.pod(getGlobalState()->frameid);
+        }
+        return h.h;
+    }
+
+    std::filesystem::path getCacheDir() {
         auto cachebasedir = get_param<std::string>("cachebasedir");
         if (cachebasedir.empty()) {
             cachebasedir = zeno::getConfigVariable("ZENCACHE");
@@ -69,28 +255,116 @@ struct CacheToDisk : zeno::INode {
                 cachebasedir = std::filesystem::temp_directory_path().string();
             }
         }
-        auto cachefile = std::filesystem::u8path(cachebasedir) / ("CTD-" + myname + ".zenobjbinarycache");
-        return cachefile.string();
+        return std::filesystem::u8path(cachebasedir);
+    }
+
+    std::string getCachePath() {
+        char name[64];
+        std::snprintf(name, sizeof(name), "CTD-%016llx.zenobjbinarycache", (unsigned long long)cacheKey);
+        return (getCacheDir() / name).string();
+    }
+
+    void writeCache(IObject *obj) {
+        auto cachefile = std::filesystem::u8path(getCachePath());
+        CacheFileHeader header;
+        header.magicNumber = CacheFileHeader::kMagicNumber;
+        header.version = CacheFileHeader::kVersion;
+        header.key = cacheKey;
+        header.payloadSize = encodedObjectSize(obj);
+        if (!header.payloadSize) {
+            log_error("failed to encode object for cache: {}", cachefile.string());
+            return;
+        }
+        // uninitialized on purpose, every byte is written by encodeObject
+        std::unique_ptr<char[]> out(new char[header.payloadSize]);
+        encodeObject(obj, out.get());
+
+        // write aside and rename, so a crashed run never leaves a truncated cache behind
+        auto tmpfile = cachefile;
+        tmpfile += ".tmp" + std::to_string(std::random_device()());
+        if (std::ofstream ofs(tmpfile, std::ios::binary); !ofs) {
+            log_error("failed to open file for write: {}", tmpfile.string());
+            return;
+        } else {
+            ofs.write((char const *)&header, sizeof(header));
+            ofs.write(out.get(), header.payloadSize);
+            if (!ofs) {
+                log_error("failed to write cache file: {}", tmpfile.string());
+                ofs.close();
+                std::filesystem::remove(tmpfile);
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpfile, cachefile, ec);
+        if (ec) {
+            log_error("failed to move cache file into place: {}", ec.message());
+            std::filesystem::remove(tmpfile, ec);
+            return;
+        }
+        enforceBudget(cachefile);
+    }
+
+    // least recently used files go first; reads refresh the mtime, so it doubles as access time
+    void enforceBudget(std::filesystem::path const &keep) {
+        auto budget = (uintmax_t)std::max(get_param<int>("budgetMB"), 0) << 20;
+        if (!budget)
+            return;
+        std::vector<std::tuple<std::filesystem::file_time_type, uintmax_t, std::filesystem::path>> files;
+        uintmax_t total = 0;
+        std::error_code ec;
+        for (auto const &entry: std::filesystem::directory_iterator(getCacheDir(), ec)) {
+            auto name = entry.path().filename().string();
+            if (name.rfind("CTD-", 0) != 0 || entry.path().extension() != ".zenobjbinarycache")
+                continue;
+            auto size = entry.file_size(ec);
+            if (ec)
+                continue;
+            files.emplace_back(entry.last_write_time(ec), size, entry.path());
+            total += size;
+        }
+        std::sort(files.begin(), files.end());
+        for (auto const &[mtime, size, path]: files) {
+            if (total <= budget)
+                break;
+            if (path == keep)
+                continue;
+            if (std::filesystem::remove(path, ec)) {
+                log_debug("CacheToDisk: evicted {}", path.string());
+                total -= size;
+            }
+        }
     }
 
     std::shared_ptr<IObject> tryGetCached() {
-        auto cachefile = getCachePath();
-        if (!std::filesystem::exists(cachefile)) {
+        auto cachefile = std::filesystem::u8path(getCachePath());
+        std::error_code ec;
+        if (!std::filesystem::exists(cachefile, ec)) {
             return nullptr;
         }
-        std::ifstream ifs(cachefile);
-        if (!ifs) {
-            log_error("failed to open file for read: {}", cachefile);
-            return nullptr;
+        std::shared_ptr<IObject> obj;
+        {
+            MappedFile file(cachefile);
+            if (!file.data) {
+                log_error("failed to open file for read: {}", cachefile.string());
+                return nullptr;
+            }
+            CacheFileHeader header;
+            if (file.size >= sizeof(header))
+                std::memcpy(&header, file.data, sizeof(header));
+            if (file.size < sizeof(header) || header.magicNumber != CacheFileHeader::kMagicNumber
+                || header.version != CacheFileHeader::kVersion || header.key != cacheKey
+                || header.payloadSize != file.size - sizeof(header)) {
+                log_warn("ignoring stale or corrupted cache file: {}", cachefile.string());
+                return nullptr;
+            }
+            obj = decodeObject(file.data + sizeof(header), header.payloadSize);
         }
-        std::istreambuf_iterator<char> iit(ifs), eiit;
-        std::vector<char> dat;
-        std::copy(iit, eiit, std::back_inserter(dat));
-        auto obj = decodeObject(dat.data(), dat.size());
         if (!obj) {
-            log_error("failed to decode object in file: {}", cachefile);
+            log_error("failed to decode object in file: {}", cachefile.string());
             return nullptr;
         }
+        std::filesystem::last_write_time(cachefile, std::filesystem::file_time_type::clock::now(), ec);
         return obj;
     }
 };
@@ -104,6 +378,59 @@ ZENO_DEFNODE(CacheToDisk)({
     },
     {
        {"string", "cachebasedir", ""},
+       {"bool", "perFrame", "0"},
+       {"int", "budgetMB", "10240"},
+    },
+    {"lifecycle"},
+});
+
+struct BenchmarkEncodeObject : zeno::INode {
+    virtual void apply() override {
+        auto obj = get_input("object");
+        auto repeat = std::max(get_input2<int>("repeat"), 1);
+
+        double sizeTime = std::numeric_limits<double>::max();
+        double encodeTime = std::numeric_limits<double>::max();
+        double decodeTime = std::numeric_limits<double>::max();
+        size_t size = 0;
+        std::vector<char> buf;
+        for (int r = 0; r < repeat; r++) {
+            auto t0 = std::chrono::steady_clock::now();
+            size = encodedObjectSize(obj.get());
+            auto t1 = std::chrono::steady_clock::now();
+            if (!size)
+                throw makeError("BenchmarkEncodeObject: object type cannot be encoded");
+            buf.resize(size);
+            auto t2 = std::chrono::steady_clock::now();
+            encodeObject(obj.get(), buf.data());
+            auto t3 = std::chrono::steady_clock::now();
+            auto decoded = decodeObject(buf.data(), buf.size());
+            auto t4 = std::chrono::steady_clock::now();
+            sizeTime = std::min(sizeTime, std::chrono::duration<double>(t1 - t0).count());
+            encodeTime = std::min(encodeTime, std::chrono::duration<double>(t3 - t2).count());
+            decodeTime = std::min(decodeTime, std::chrono::duration<double>(t4 - t3).count());
+        }
+        double encodeGBps = size * 1e-9 / (sizeTime + encodeTime);
+        double decodeGBps = size * 1e-9 / decodeTime;
+        log_info("BenchmarkEncodeObject: {} bytes, size pass {}s, encode {}s ({} GB/s), decode {}s ({} GB/s)",
+                 size, sizeTime, encodeTime, encodeGBps, decodeTime, decodeGBps);
+        set_output("bytes", std::make_shared<NumericObject>((int)std::min<size_t>(size, std::numeric_limits<int>::max())));
+        set_output("encodeGBps", std::make_shared<NumericObject>((float)encodeGBps));
+        set_output("decodeGBps", std::make_shared<NumericObject>((float)decodeGBps));
+    }
+};
+
+ZENO_DEFNODE(BenchmarkEncodeObject)({
+    {
+       {"object"},
+       {"int", "repeat", "3"},
+    },
+    {
+       {"int", "bytes"},
+       {"float", "encodeGBps"},
+       {"float", "decodeGBps"},
+    },
+    {
     },
     {"lifecycle"},
 });
@@ -0,0 +1,172 @@
+#include <zeno/zeno.h>
+#include <zeno/funcs/ListParallel.h>
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/types/ListObject.h>
+#include <zeno/types/DictObject.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/StringObject.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/utils/format.h>
+#include <zeno/utils/log.h>
+#include <algorithm>
+
+namespace zeno {
+namespace {
+
+template <class T>
+T listArg(ListMapArgs const &args, std::string const &key, T defl) {
+    auto it = args.find(key);
+    return it == args.end() ? defl : objectToLiterial<T>(it->second, "list function argument `" + key + "`");
+}
+
+std::shared_ptr<PrimitiveObject> listPrim(zany const &elm) {
+    return safe_dynamic_cast<PrimitiveObject>(elm, "list element");
+}
+
+// the prim functions modify a copy of each element: the input list belongs to the upstream
+// node, and an object listed twice would otherwise be modified by two workers at once
+std::shared_ptr<PrimitiveObject> listPrimCopy(zany const &elm) {
+    return std::make_shared<PrimitiveObject>(*listPrim(elm));
+}
+
+ZENO_DEFLISTMAP(clone, [] (zany const &elm, size_t, ListMapArgs const &) -> zany {
+    return elm->clone();
+});
+
+ZENO_DEFLISTMAP(primTriangulate, [] (zany const &elm, size_t, ListMapArgs const &) -> zany {
+    auto prim = listPrimCopy(elm);
+    primTriangulate(prim.get());
+    return prim;
+});
+
+ZENO_DEFLISTMAP(primCalcNormal, [] (zany const &elm, size_t, ListMapArgs const &args) -> zany {
+    auto prim = listPrimCopy(elm);
+    primCalcNormal(prim.get(), listArg<bool>(args, "flip", false) ? -1.0f : 1.0f,
+                   listArg<std::string>(args, "nrmAttr", "nrm"));
+    return prim;
+});
+
+ZENO_DEFLISTMAP(primFlipFaces, [] (zany const &elm, size_t, ListMapArgs const &) -> zany {
+    auto prim = listPrimCopy(elm);
+    primFlipFaces(prim.get());
+    return prim;
+});
+
+ZENO_DEFLISTMAP(primKillDeadVerts, [] (zany const &elm, size_t, ListMapArgs const &) -> zany {
+    auto prim = listPrimCopy(elm);
+    primKillDeadVerts(prim.get());
+    return prim;
+});
+
+ZENO_DEFLISTMAP(primTranslate, [] (zany const &elm, size_t, ListMapArgs const &args) -> zany {
+    auto prim = listPrimCopy(elm);
+    primTranslate(prim.get(), listArg<vec3f>(args, "offset", vec3f(0)));
+    return prim;
+});
+
+ZENO_DEFLISTMAP(primScale, [] (zany const &elm, size_t, ListMapArgs const &args) -> zany {
+    auto prim = listPrimCopy(elm);
+    primScale(prim.get(), listArg<vec3f>(args, "scale", vec3f(1)));
+    return prim;
+});
+
+template <class Op>
+zany numericBinary(zany const &lhs, zany const &rhs, Op op) {
+    auto const &a = safe_dynamic_cast<NumericObject>(lhs, "list element")->get();
+    auto const &b = safe_dynamic_cast<NumericObject>(rhs, "list element")->get();
+    return std::visit([&] (auto const &x, auto const &y) -> zany {
+        using X = std::decay_t<decltype(x)>;
+        using Y = std::decay_t<decltype(y)>;
+        if constexpr (std::is_same_v<X, Y>) {
+            return std::make_shared<NumericObject>(X(op(x, y)));
+        } else {
+            throw makeError<TypeError>(typeid(X), typeid(Y), "list elements of mixed numeric types");
+        }
+    }, a, b);
+}
+
+ZENO_DEFLISTREDUCE(add, [] (zany const &lhs, zany const &rhs) {
+    return numericBinary(lhs, rhs, [] (auto const &x, auto const &y) { return x + y; });
+});
+
+ZENO_DEFLISTREDUCE(min, [] (zany const &lhs, zany const &rhs) {
+    return numericBinary(lhs, rhs, [] (auto const &x, auto const &y) { return zeno::min(x, y); });
+});
+
+ZENO_DEFLISTREDUCE(max, [] (zany const &lhs, zany const &rhs) {
+    return numericBinary(lhs, rhs, [] (auto const &x, auto const &y) { return zeno::max(x, y); });
+});
+
+ZENO_DEFLISTREDUCE(primMerge, [] (zany const &lhs, zany const &rhs) -> zany {
+    return primMerge({listPrim(lhs).get(), listPrim(rhs).get()});
+});
+
+struct ListParallelMap : zeno::INode {
+    virtual void apply() override {
+        auto list = get_input<ListObject>("list");
+        auto func = getListMapFunc(get_input2<std::string>("function"));
+        ListMapArgs args;
+        if (has_input("args"))
+            args = get_input<DictObject>("args")->lut;
+
+        std::vector<ListElementError> errors;
+        auto res = std::make_shared<ListObject>(listParallelMap(list->arr, func, args, errors));
+
+        auto errlist = std::make_shared<ListObject>();
+        for (auto const &[index, err]: errors) {
+            errlist->arr.push_back(std::make_shared<StringObject>(format("{}: {}", index, err->message)));
+        }
+        if (!errors.empty()) {
+            auto const &[index, err] = errors.front();
+            auto msg = format("{} of {} elements failed, first at index {}: {}",
+                              errors.size(), list->arr.size(), index, err->message);
+            if (get_input2<bool>("failOnError"))
+                throw makeError(msg);
+            log_warn("ListParallelMap: {}", msg);
+            // failed elements come back null, drop them so downstream nodes see valid objects
+            res->arr.erase(std::remove(res->arr.begin(), res->arr.end(), nullptr), res->arr.end());
+        }
+        set_output("list", std::move(res));
+        set_output("errors", std::move(errlist));
+    }
+};
+
+ZENDEFNODE(ListParallelMap, {
+    {
+        {"list", "list"},
+        {"string", "function", "primCalcNormal"},
+        {"dict", "args"},
+        {"bool", "failOnError", "1"},
+    },
+    {
+        {"list", "list"},
+        {"list", "errors"},
+    },
+    {},
+    {"list"},
+});
+
+struct ListParallelReduce : zeno::INode {
+    virtual void apply() override {
+        auto list = get_input<ListObject>("list");
+        auto func = getListReduceFunc(get_input2<std::string>("function"));
+        if (list->arr.empty())
+            throw makeError("ListParallelReduce: cannot reduce an empty list");
+        set_output("result", listParallelReduce(list->arr, func));
+    }
+};
+
+ZENDEFNODE(ListParallelReduce, {
+    {
+        {"list", "list"},
+        {"string", "function", "add"},
+    },
+    {
+        {"result"},
+    },
+    {},
+    {"list"},
+});
+
+}
+}
@@ -29,6 +29,11 @@ ZENDEFNODE(PortalIn, {
 });
 
 struct PortalOut : zeno::INode {
+    // takes its object from the PortalIn, not from a bound input
+    virtual bool outputsReusable() const override {
+        return false;
+    }
+
     virtual void apply() override {
         auto name = get_param<std::string>("name");
         auto depnode = zeno::safe_at(graph->portalIns, name, "PortalIn");
@@ -56,6 +56,10 @@ ZENDEFNODE(RunBeforeFrame, {
 
 
 struct SetFrameTime : zeno::INode {
+    virtual bool outputsReusable() const override {
+        return false;
+    }
+
     virtual void apply() override {
         auto time = get_input<zeno::NumericObject>("time")->get<float>();
         getGlobalState()->frame_time = time;
@@ -70,6 +74,14 @@ ZENDEFNODE(SetFrameTime, {
 });
 
 struct GetFrameTime : zeno::INode {
+    virtual bool outputsReusable() const override {
+        return false;
+    }
+
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto time = std::make_shared<zeno::NumericObject>();
         time->set(getGlobalState()->frame_time);
@@ -85,6 +97,14 @@ ZENDEFNODE(GetFrameTime, {
 });
 
 struct GetFrameTimeElapsed : zeno::INode {
+    virtual bool outputsReusable() const override {
+        return false;
+    }
+
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto time = std::make_shared<zeno::NumericObject>();
         time->set(getGlobalState()->frame_time_elapsed);
@@ -100,6 +120,10 @@ ZENDEFNODE(GetFrameTimeElapsed, {
 });
 
 struct GetFrameNum : zeno::INode {
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto num = std::make_shared<zeno::NumericObject>();
         num->set(getGlobalState()->frameid);
@@ -115,6 +139,14 @@ ZENDEFNODE(GetFrameNum, {
 });
 
 struct GetTime : zeno::INode {
+    virtual bool outputsReusable() const override {
+        return false;
+    }
+
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto time = std::make_shared<zeno::NumericObject>();
         time->set(getGlobalState()->frameid * getGlobalState()->frame_time
@@ -131,6 +163,14 @@ ZENDEFNODE(GetTime, {
 });
 
 struct GetFramePortion : zeno::INode {
+    virtual bool outputsReusable() const override {
+        return false;
+    }
+
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto portion = std::make_shared<zeno::NumericObject>();
         portion->set(getGlobalState()->frame_time_elapsed / getGlobalState()->frame_time);
@@ -146,6 +186,14 @@ ZENDEFNODE(GetFramePortion, {
 });
 
 struct IntegrateFrameTime : zeno::INode {
+    virtual bool outputsReusable() const override {
+        return false;
+    }
+
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         float dt = getGlobalState()->frame_time;
         if (has_input("desired_dt")) {
@@ -147,6 +147,11 @@ ZENDEFNODE(
     });
 
 struct StringFormat : zeno::INode {
+    // $F reads the frame number
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void apply() override {
         auto str = get_input2<std::string>("str");
         for (int i = 0; i < str.size() - 1; i++) {
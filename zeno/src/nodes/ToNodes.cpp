@@ -12,6 +12,11 @@ namespace zeno {
 namespace {
 
 struct ToView : zeno::INode {
+    // view objects are keyed by the frame they were added on
+    virtual bool dependsOnFrame() const override {
+        return true;
+    }
+
     virtual void complete() override {
         log_debug("ToView: {}", myname);
         graph->nodesToExec.insert(myname);
@@ -2,6 +2,8 @@
 #include <zeno/types/StringObject.h>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/funcs/PrimitiveTopology.h>
+#include <zeno/para/parallel_for.h>
 #include <zeno/utils/variantswitch.h>
 #include <zeno/utils/arrayindex.h>
 #include <zeno/utils/scope_exit.h>
@@ -104,35 +106,22 @@ struct PrimDualMesh : INode {
 
         scope_exit<> revertoldpolysize;
         if (keepBounds) {
-            std::map<std::pair<int, int>, int> bounde2f;
-            {
-                std::vector<std::pair<int, int>> notbound;
-                for (int f = 0; f < prim->polys.size(); f++) {
-                    auto each_edge = [&] (int v1, int v2) {
-                        std::pair<int, int> key(std::min(v1, v2), std::max(v1, v2));
-                        auto [it, succ] = bounde2f.try_emplace(key, f);
-                        if (!succ) {
-                            notbound.push_back(key);
-                            it->second = -1;
-                        }
-                    };
-                    auto [start, len] = prim->polys[f];
-                    if (len >= 1) {
-                        for (int l = start; l < start + len - 1; l++) {
-                            each_edge(prim->loops[l], prim->loops[l + 1]);
-                        }
-                        each_edge(prim->loops[start + len - 1], prim->loops[start]);
-                    }
+            auto topo = primTopology(prim.get());
+            int polyBase = topo->numTris + topo->numQuads;
+            std::vector<vec2i> bounds;
+            for (int h = 0; h < topo->numCorners(); h++) {
+                // a half-edge alone on its edge lies on the boundary
+                if (topo->cornerFace[h] >= polyBase && topo->isBoundaryEdge(topo->cornerEdge[h])) {
+                    int v1 = topo->corners[h], v2 = topo->dest(h);
+                    bounds.emplace_back(std::min(v1, v2), std::max(v1, v2));
                 }
-                for (auto const &nbk: notbound)
-                    bounde2f.erase(nbk);
             }
             auto oldpolysize = prim->polys.size();
             revertoldpolysize = scope_exit<>([prim, oldpolysize] {
                 prim->polys.resize(oldpolysize);
+                primInvalidateTopology(prim.get());
             });
-            for (auto const &[ev, f]: bounde2f) {
-                auto [v1, v2] = ev;
+            for (auto [v1, v2]: bounds) {
                 int loopbase = prim->loops.size();
                 prim->loops.push_back(v1);
                 prim->loops.push_back(v2);
@@ -140,49 +129,44 @@ struct PrimDualMesh : INode {
             }
         }
 
-        std::map<int, std::vector<int>> v2f;
+        auto topo = primTopology(prim.get(), false);
+        int polyBase = topo->numTris + topo->numQuads;
         outprim->verts.resize(prim->polys.size());
-        for (int f = 0; f < prim->polys.size(); f++) {
+        parallel_for(prim->polys.size(), [&] (size_t f) {
             meth_average<vec3f> reducer;
             auto [start, len] = prim->polys[f];
             for (int l = start; l < start + len; l++) {
-                int v = prim->loops[l];
-                reducer.add(prim->verts[v]);
-                v2f[v].push_back(f);
+                reducer.add(prim->verts[prim->loops[l]]);
             }
             outprim->verts[f] = reducer.get();
-        }
+        });
 
-        std::for_each(v2f.begin(), v2f.end(), [&] (auto const &v2fent) {
-            auto const &[vid, faceids] = v2fent;
+        for (int vid = 0; vid < topo->numVerts; vid++) {
+            if (topo->vertStart[vid] == topo->vertStart[vid + 1])
+                continue;
             int loopbase = outprim->loops.size();
             std::map<int, std::vector<int>> lut;
             std::map<int, int> vid2f;
-            for (int ff = 0; ff < faceids.size(); ff++) {
-                int f = faceids[ff];
-                auto [start, len] = prim->polys[f];
-                if (len < 2) {
-                    log_warn("polygon has {} edges < 2", len);
-                    return;
-                }
-                int resl = -1;
-                for (int l = 0; l < len; l++) {
-                    if (prim->loops[start + l] == vid) {
-                        resl = l;
-                        break;
-                    }
+            bool failed = false;
+            for (int k = topo->vertStart[vid]; k < topo->vertStart[vid + 1]; k++) {
+                int h = topo->vertCorners[k];
+                int face = topo->cornerFace[h];
+                if (face < polyBase)
+                    continue;
+                if (topo->faceSize(face) < 2) {
+                    log_warn("polygon has {} edges < 2", topo->faceSize(face));
+                    failed = true;
+                    break;
                 }
-                if (resl == -1) {
-                    log_warn("cannot find vertex {} in face {}", vid, f);
-                    return;
-                }
-                auto vnext = prim->loops[start + (resl + 1) % len];
-                auto vprev = prim->loops[start + (resl - 1 + len) % len];
+                auto vnext = topo->corners[topo->next(h)];
+                auto vprev = topo->corners[topo->prev(h)];
                 lut[vnext].push_back(vprev);
                 if (vnext != vprev)
                     lut[vprev].push_back(vnext);
-                vid2f.emplace(vnext, f);
+                vid2f.emplace(vnext, face - polyBase);
             }
+            if (failed || lut.empty())
+                continue;
             //ZENO_P(lut);
 
             std::set<int> visited;
@@ -213,7 +197,7 @@ struct PrimDualMesh : INode {
             dfs(dfs, lut.begin()->first);
 
             outprim->polys.emplace_back(loopbase, outprim->loops.size() - loopbase);
-        });
+        }
 
         set_output("prim", std::move(outprim));
     }
@@ -1,3 +1,4 @@
+#include <zeno/funcs/PrimitiveTopology.h>
 #include <zeno/para/parallel_for.h>
 #include <zeno/types/NumericObject.h>
 #include <zeno/types/PrimitiveObject.h>
@@ -150,36 +151,23 @@ struct PrimExtrude : INode {
                     < std::make_pair(std::min(b[0], b[1]), std::max(b[0], b[1]));
             }
         };
+        // face edges come from the cached topology, only lines and edges off the faces need a map
+        auto topo = primTopology(prim2.get());
+        std::vector<int> edgeUses = topo->edgeValence;
         std::map<vec2i, bool, segment_less> segments;
-        auto append = [&] (int i, int j) {
-            auto [it, succ] = segments.emplace(vec2i(i, j), false);
-            if (!succ)
-                it->second = true;
-        };
         for (auto const &ind: prim2->lines) {
-            append(ind[0], ind[1]);
-        }
-        for (auto const &ind: prim2->tris) {
-            append(ind[0], ind[1]);
-            append(ind[1], ind[2]);
-            append(ind[2], ind[0]);
-        }
-        for (auto const &ind: prim2->quads) {
-            append(ind[0], ind[1]);
-            append(ind[1], ind[2]);
-            append(ind[2], ind[3]);
-            append(ind[3], ind[0]);
-        }
-        for (auto const &[start, len]: prim2->polys) {
-            if (len < 2)
+            int e = topo->findEdge(ind[0], ind[1]);
+            if (e != -1) {
+                edgeUses[e]++;
                 continue;
-            for (int i = start + 1; i < start + len; i++) {
-                append(prim2->loops[i - 1], prim2->loops[i]);
             }
-            append(prim2->loops[start + len - 1], prim2->loops[start]);
+            auto [it, succ] = segments.emplace(ind, false);
+            if (!succ)
+                it->second = true;
         }
         for (auto const &ind: prim2->edges) {
-            segments.emplace(vec2i(ind[0], ind[1]), false); // if fail then just let it fail
+            if (topo->findEdge(ind[0], ind[1]) == -1)
+                segments.emplace(vec2i(ind[0], ind[1]), false); // if fail then just let it fail
         }
 
         //if (avgoffset != 0) {
@@ -209,6 +197,10 @@ struct PrimExtrude : INode {
         //auto tmpBoundTagAttr = "%%extrude1";
         //primMarkBoundaryEdges(prim2.get(), tmpBoundTagAttr);
         std::vector<vec2i> bounds;
+        for (int e = 0; e < topo->edges.size(); e++) {
+            if (edgeUses[e] == 1)
+                bounds.push_back(topo->edges[e]);
+        }
         for (auto const &[edge, hasdup]: segments) {
             if (!hasdup)
                 bounds.push_back(edge);
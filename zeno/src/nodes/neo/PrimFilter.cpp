@@ -1,59 +1,35 @@
 #include <zeno/zeno.h>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/funcs/PrimitiveCompact.h>
 #include <zeno/types/NumericObject.h>
 #include <zeno/types/StringObject.h>
+#include <zeno/para/parallel_for.h>
 #include <zeno/utils/vec.h>
-#include <zeno/utils/zeno_p.h>
+#include <zeno/utils/wangsrng.h>
+#include <zeno/utils/log.h>
+#include <chrono>
 #include <cstring>
 #include <cstdlib>
 
 namespace zeno {
 
-static void primRevampVerts(PrimitiveObject *prim, std::vector<int> const &revamp);
-static void primRevampFaces(PrimitiveObject *prim, std::vector<uint8_t> const &unrevamp);
-
 ZENO_API void primFilterVerts(PrimitiveObject *prim, std::string tagAttr, int tagValue, bool isInversed, std::string revampAttrO, std::string method) {
+    std::vector<uint8_t> keep(prim->size());
+    auto const &tagArr = prim->verts.attr<int>(tagAttr);
+    parallel_for(keep.size(), [&] (size_t i) {
+        keep[i] = (tagArr[i] == tagValue) != isInversed;
+    });
     if (method == "faces") {
-        std::vector<uint8_t> unrevamp(prim->size());
-        auto const &tagArr = prim->verts.attr<int>(tagAttr);
-        if (!isInversed) {
-            for (int i = 0; i < prim->size(); i++) {
-                unrevamp[i] = tagArr[i] == tagValue;
-            }
-        } else {
-            for (int i = 0; i < prim->size(); i++) {
-                unrevamp[i] = tagArr[i] != tagValue;
-            }
-        }
-        primRevampFaces(prim, unrevamp);
+        primRevampFaces(prim, keep);
         if (!revampAttrO.empty()) {
             auto &revamp = prim->add_attr<int>(revampAttrO);
-            if (!isInversed) {
-                for (int i = 0; i < prim->size(); i++) {
-                    revamp[i] = tagArr[i] == tagValue ? i : -1;
-                }
-            } else {
-                for (int i = 0; i < prim->size(); i++) {
-                    revamp[i] = tagArr[i] != tagValue ? i : -1;
-                }
-            }
+            parallel_for(keep.size(), [&] (size_t i) {
+                revamp[i] = keep[i] ? (int)i : -1;
+            });
         }
     } else {
-        std::vector<int> revamp;
-        revamp.reserve(prim->size());
-        auto const &tagArr = prim->verts.attr<int>(tagAttr);
-        if (!isInversed) {
-            for (int i = 0; i < prim->size(); i++) {
-                if (tagArr[i] == tagValue)
-                    revamp.emplace_back(i);
-            }
-        } else {
-            for (int i = 0; i < prim->size(); i++) {
-                if (tagArr[i] != tagValue)
-                    revamp.emplace_back(i);
-            }
-        }
+        auto revamp = compactIndices(keep);
         primRevampVerts(prim, revamp);
         if (!revampAttrO.empty()) {
             prim->add_attr<int>(revampAttrO) = std::move(revamp);
@@ -61,13 +37,31 @@ ZENO_API void primFilterVerts(PrimitiveObject *prim, std::string tagAttr, int ta
     }
 }
 
-template <class T>
-static void revamp_vector(std::vector<T> &arr, std::vector<int> const &revamp) {
-    std::vector<T> newarr(arr.size());
-    for (int i = 0; i < revamp.size(); i++) {
-        newarr[i] = arr[revamp[i]];
-    }
-    std::swap(arr, newarr);
+namespace {
+
+// flags every vertex referenced by a face, duplicates write the same value
+template <class Vec>
+void markReached(std::vector<uint8_t> &reached, AttrVector<Vec> const &faces) {
+    constexpr int count = sizeof(Vec) / sizeof(int);
+    parallel_for(faces.size(), [&] (size_t i) {
+        auto ind = reinterpret_cast<int const *>(&faces[i]);
+        for (int j = 0; j < count; j++) {
+#pragma omp atomic write
+            reached[ind[j]] = 1;
+        }
+    });
+}
+
+template <class Vec>
+void remapIndices(AttrVector<Vec> &faces, std::vector<int> const &unrevamp) {
+    constexpr int count = sizeof(Vec) / sizeof(int);
+    parallel_for(faces.size(), [&] (size_t i) {
+        auto ind = reinterpret_cast<int *>(&faces[i]);
+        for (int j = 0; j < count; j++)
+            ind[j] = unrevamp[ind[j]];
+    });
+}
+
 }
 
 void primKillDeadUVs(PrimitiveObject *prim) {
@@ -75,398 +69,84 @@ void primKillDeadUVs(PrimitiveObject *prim) {
         return;
     }
     auto &uvs = prim->loops.attr<int>("uvs");
-    std::set<int> reached;
-    for (auto const &[start, len]: prim->polys) {
+    std::vector<uint8_t> reached(prim->uvs.size());
+    parallel_for(prim->polys.size(), [&] (size_t p) {
+        auto const &[start, len] = prim->polys[p];
         for (int i = start; i < start + len; i++) {
-            reached.insert(uvs[i]);
+#pragma omp atomic write
+            reached[uvs[i]] = 1;
         }
-    }
-    std::vector<int> revamp(reached.begin(), reached.end());
-    auto old_prim_size = prim->uvs.size();
-    prim->uvs.forall_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-        revamp_vector(arr, revamp);
     });
-    prim->uvs.resize(revamp.size());
+    auto revamp = compactIndices(reached);
+    auto unrevamp = inverseRevamp(revamp, prim->uvs.size());
+    RevampScratch scratch;
+    revampAttrVector(prim->uvs, revamp, scratch);
 
-    std::vector<int> unrevamp(old_prim_size);
-    for (int i = 0; i < revamp.size(); i++) {
-        unrevamp[revamp[i]] = i;
-    }
-
-    auto mock = [&] (int &ind) {
-        ind = unrevamp[ind];
-    };
-    for (auto const &[start, len]: prim->polys) {
+    parallel_for(prim->polys.size(), [&] (size_t p) {
+        auto const &[start, len] = prim->polys[p];
         for (int i = start; i < start + len; i++) {
-            mock(uvs[i]);
+            uvs[i] = unrevamp[uvs[i]];
         }
-    }
+    });
 }
+
 void primKillDeadLoops(PrimitiveObject *prim) {
     if (prim->loops.size() == 0) {
         return;
     }
-    std::set<int> reached;
-    for (auto const &[start, len]: prim->polys) {
+    std::vector<uint8_t> reached(prim->loops.size());
+    parallel_for(prim->polys.size(), [&] (size_t p) {
+        auto const &[start, len] = prim->polys[p];
         for (int i = start; i < start + len; i++) {
-            reached.insert(i);
+#pragma omp atomic write
+            reached[i] = 1;
         }
-    }
-    std::vector<int> revamp(reached.begin(), reached.end());
-    auto old_prim_size = prim->loops.size();
-    prim->loops.forall_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-        revamp_vector(arr, revamp);
     });
-    prim->loops.resize(revamp.size());
-
-    std::vector<int> unrevamp(old_prim_size);
-    for (int i = 0; i < revamp.size(); i++) {
-        unrevamp[revamp[i]] = i;
-    }
-    int count = 0;
-    for (auto &[start, len]: prim->polys) {
-        start = count;
-        count += len;
-    }
+    auto revamp = compactIndices(reached);
+    auto unrevamp = inverseRevamp(revamp, prim->loops.size());
+    RevampScratch scratch;
+    revampAttrVector(prim->loops, revamp, scratch);
+    parallel_for(prim->polys.size(), [&] (size_t p) {
+        auto &start = prim->polys[p][0];
+        if (prim->polys[p][1])
+            start = unrevamp[start];
+    });
 }
 
 ZENO_API void primKillDeadVerts(PrimitiveObject *prim) {
-    std::set<int> reached(prim->points.begin(), prim->points.end());
-    for (auto const &ind: prim->lines) {
-        reached.insert(ind[0]);
-        reached.insert(ind[1]);
-    }
-    for (auto const &ind: prim->tris) {
-        reached.insert(ind[0]);
-        reached.insert(ind[1]);
-        reached.insert(ind[2]);
-    }
-    for (auto const &ind: prim->quads) {
-        reached.insert(ind[0]);
-        reached.insert(ind[1]);
-        reached.insert(ind[2]);
-        reached.insert(ind[3]);
-    }
-    for (auto const &[start, len]: prim->polys) {
+    std::vector<uint8_t> reached(prim->verts.size());
+    markReached(reached, prim->points);
+    markReached(reached, prim->lines);
+    markReached(reached, prim->tris);
+    markReached(reached, prim->quads);
+    markReached(reached, prim->edges);
+    parallel_for(prim->polys.size(), [&] (size_t p) {
+        auto const &[start, len] = prim->polys[p];
         for (int i = start; i < start + len; i++) {
-            reached.insert(prim->loops[i]);
+#pragma omp atomic write
+            reached[prim->loops[i]] = 1;
         }
-    }
-    std::vector<int> revamp(reached.begin(), reached.end());
-    auto old_prim_size = prim->verts.size();
-    prim->verts.forall_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-        revamp_vector(arr, revamp);
     });
-    prim->verts.resize(revamp.size());
-
-    std::vector<int> unrevamp(old_prim_size);
-    for (int i = 0; i < revamp.size(); i++) {
-        unrevamp[revamp[i]] = i;
-    }
-
-    auto mock = [&] (int &ind) {
-        ind = unrevamp[ind];
-    };
-    for (auto &ind: prim->points) {
-        mock(ind);
-    }
-    for (auto &ind: prim->lines) {
-        mock(ind[0]);
-        mock(ind[1]);
-    }
-    for (auto &ind: prim->tris) {
-        mock(ind[0]);
-        mock(ind[1]);
-        mock(ind[2]);
-    }
-    for (auto &ind: prim->quads) {
-        mock(ind[0]);
-        mock(ind[1]);
-        mock(ind[2]);
-        mock(ind[3]);
-    }
-    for (auto const &[start, len]: prim->polys) {
+    auto revamp = compactIndices(reached);
+    auto unrevamp = inverseRevamp(revamp, prim->verts.size());
+    RevampScratch scratch;
+    revampAttrVector(prim->verts, revamp, scratch);
+
+    remapIndices(prim->points, unrevamp);
+    remapIndices(prim->lines, unrevamp);
+    remapIndices(prim->tris, unrevamp);
+    remapIndices(prim->quads, unrevamp);
+    remapIndices(prim->edges, unrevamp);
+    parallel_for(prim->polys.size(), [&] (size_t p) {
+        auto const &[start, len] = prim->polys[p];
         for (int i = start; i < start + len; i++) {
-            mock(prim->loops[i]);
+            prim->loops[i] = unrevamp[prim->loops[i]];
         }
-    }
+    });
     primKillDeadUVs(prim);
     primKillDeadLoops(prim);
 }
 
-static void primRevampVerts(PrimitiveObject *prim, std::vector<int> const &revamp) {
-    prim->foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-        revamp_vector(arr, revamp);
-    });
-    auto old_prim_size = prim->size();
-    prim->resize(revamp.size());
-
-    if ((0
-            || prim->tris.size()
-            || prim->quads.size()
-            || prim->lines.size()
-            || prim->edges.size()
-            || prim->polys.size()
-            || prim->points.size()
-         )) {
-
-        std::vector<int> unrevamp(old_prim_size, -1);
-        for (int i = 0; i < revamp.size(); i++) {
-            unrevamp[revamp[i]] = i;
-        }
-
-        auto mock = [&] (int &x) -> bool {
-            int loc = unrevamp[x];
-            if (loc == -1)
-                return false;
-            x = loc;
-            return true;
-        };
-
-        if (prim->tris.size()) {
-            std::vector<int> trisrevamp;
-            trisrevamp.reserve(prim->tris.size());
-            for (int i = 0; i < prim->tris.size(); i++) {
-                auto &tri = prim->tris[i];
-                //ZENO_P(tri);
-                //ZENO_P(unrevamp[tri[0]]);
-                //ZENO_P(unrevamp[tri[1]]);
-                //ZENO_P(unrevamp[tri[2]]);
-                if (mock(tri[0]) && mock(tri[1]) && mock(tri[2]))
-                    trisrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < trisrevamp.size(); i++) {
-                prim->tris[i] = prim->tris[trisrevamp[i]];
-            }
-            prim->tris.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, trisrevamp);
-            });
-            prim->tris.resize(trisrevamp.size());
-        }
-
-        if (prim->quads.size()) {
-            std::vector<int> quadsrevamp;
-            quadsrevamp.reserve(prim->quads.size());
-            for (int i = 0; i < prim->quads.size(); i++) {
-                auto &quad = prim->quads[i];
-                if (mock(quad[0]) && mock(quad[1]) && mock(quad[2]) && mock(quad[3]))
-                    quadsrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < quadsrevamp.size(); i++) {
-                prim->quads[i] = prim->quads[quadsrevamp[i]];
-            }
-            prim->quads.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, quadsrevamp);
-            });
-            prim->quads.resize(quadsrevamp.size());
-        }
-
-        if (prim->lines.size()) {
-            std::vector<int> linesrevamp;
-            linesrevamp.reserve(prim->lines.size());
-            for (int i = 0; i < prim->lines.size(); i++) {
-                auto &line = prim->lines[i];
-                if (mock(line[0]) && mock(line[1]))
-                    linesrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < linesrevamp.size(); i++) {
-                prim->lines[i] = prim->lines[linesrevamp[i]];
-            }
-            prim->lines.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, linesrevamp);
-            });
-            prim->lines.resize(linesrevamp.size());
-        }
-
-        if (prim->edges.size()) {
-            std::vector<int> edgesrevamp;
-            edgesrevamp.reserve(prim->edges.size());
-            for (int i = 0; i < prim->edges.size(); i++) {
-                auto &edge = prim->edges[i];
-                if (mock(edge[0]) && mock(edge[1]))
-                    edgesrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < edgesrevamp.size(); i++) {
-                prim->edges[i] = prim->edges[edgesrevamp[i]];
-            }
-            prim->edges.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, edgesrevamp);
-            });
-            prim->edges.resize(edgesrevamp.size());
-        }
-
-        if (prim->polys.size()) {
-            std::vector<int> polysrevamp;
-            polysrevamp.reserve(prim->polys.size());
-            for (int i = 0; i < prim->polys.size(); i++) {
-                auto &poly = prim->polys[i];
-                bool succ = [&] {
-                    for (int p = poly[0]; p < poly[0] + poly[1]; p++)
-                        if (!mock(prim->loops[p]))
-                            return false;
-                    return true;
-                }();
-                if (succ)
-                    polysrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < polysrevamp.size(); i++) {
-                prim->polys[i] = prim->polys[polysrevamp[i]];
-            }
-            prim->polys.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, polysrevamp);
-            });
-            prim->polys.resize(polysrevamp.size());
-        }
-
-        if (prim->points.size()) {
-            std::vector<int> pointsrevamp;
-            pointsrevamp.reserve(prim->points.size());
-            for (int i = 0; i < prim->points.size(); i++) {
-                auto &point = prim->points[i];
-                if (mock(point))
-                    pointsrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < pointsrevamp.size(); i++) {
-                prim->points[i] = prim->points[pointsrevamp[i]];
-            }
-            prim->points.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, pointsrevamp);
-            });
-            prim->points.resize(pointsrevamp.size());
-        }
-
-    }
-}
-
-static void primRevampFaces(PrimitiveObject *prim, std::vector<uint8_t> const &unrevamp) {
-    if ((0
-            || prim->tris.size()
-            || prim->quads.size()
-            || prim->lines.size()
-            || prim->edges.size()
-            || prim->polys.size()
-            || prim->points.size()
-         )) {
-
-        auto mock = [&] (int const &x) -> bool {
-            return unrevamp[x];
-        };
-
-        if (prim->tris.size()) {
-            std::vector<int> trisrevamp;
-            trisrevamp.reserve(prim->tris.size());
-            for (int i = 0; i < prim->tris.size(); i++) {
-                auto &tri = prim->tris[i];
-                //ZENO_P(tri);
-                //ZENO_P(unrevamp[tri[0]]);
-                //ZENO_P(unrevamp[tri[1]]);
-                //ZENO_P(unrevamp[tri[2]]);
-                if (mock(tri[0]) || mock(tri[1]) || mock(tri[2]))
-                    trisrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < trisrevamp.size(); i++) {
-                prim->tris[i] = prim->tris[trisrevamp[i]];
-            }
-            prim->tris.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, trisrevamp);
-            });
-            prim->tris.resize(trisrevamp.size());
-        }
-
-        if (prim->quads.size()) {
-            std::vector<int> quadsrevamp;
-            quadsrevamp.reserve(prim->quads.size());
-            for (int i = 0; i < prim->quads.size(); i++) {
-                auto &quad = prim->quads[i];
-                if (mock(quad[0]) || mock(quad[1]) || mock(quad[2]) || mock(quad[3]))
-                    quadsrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < quadsrevamp.size(); i++) {
-                prim->quads[i] = prim->quads[quadsrevamp[i]];
-            }
-            prim->quads.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, quadsrevamp);
-            });
-            prim->quads.resize(quadsrevamp.size());
-        }
-
-        if (prim->lines.size()) {
-            std::vector<int> linesrevamp;
-            linesrevamp.reserve(prim->lines.size());
-            for (int i = 0; i < prim->lines.size(); i++) {
-                auto &line = prim->lines[i];
-                if (mock(line[0]) || mock(line[1]))
-                    linesrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < linesrevamp.size(); i++) {
-                prim->lines[i] = prim->lines[linesrevamp[i]];
-            }
-            prim->lines.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, linesrevamp);
-            });
-            prim->lines.resize(linesrevamp.size());
-        }
-
-        if (prim->edges.size()) {
-            std::vector<int> edgesrevamp;
-            edgesrevamp.reserve(prim->edges.size());
-            for (int i = 0; i < prim->edges.size(); i++) {
-                auto &edge = prim->edges[i];
-                if (mock(edge[0]) || mock(edge[1]))
-                    edgesrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < edgesrevamp.size(); i++) {
-                prim->edges[i] = prim->edges[edgesrevamp[i]];
-            }
-            prim->edges.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, edgesrevamp);
-            });
-            prim->edges.resize(edgesrevamp.size());
-        }
-
-        if (prim->polys.size()) {
-            std::vector<int> polysrevamp;
-            polysrevamp.reserve(prim->polys.size());
-            for (int i = 0; i < prim->polys.size(); i++) {
-                auto &poly = prim->polys[i];
-                bool succ = [&] {
-                    for (int p = poly[0]; p < poly[0] + poly[1]; p++)
-                        if (mock(prim->loops[p]))
-                            return true;
-                    return false;
-                }();
-                if (succ)
-                    polysrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < polysrevamp.size(); i++) {
-                prim->polys[i] = prim->polys[polysrevamp[i]];
-            }
-            prim->polys.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, polysrevamp);
-            });
-            prim->polys.resize(polysrevamp.size());
-        }
-
-        if (prim->points.size()) {
-            std::vector<int> pointsrevamp;
-            pointsrevamp.reserve(prim->points.size());
-            for (int i = 0; i < prim->points.size(); i++) {
-                auto &point = prim->points[i];
-                if (mock(point))
-                    pointsrevamp.emplace_back(i);
-            }
-            for (int i = 0; i < pointsrevamp.size(); i++) {
-                prim->points[i] = prim->points[pointsrevamp[i]];
-            }
-            prim->points.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, pointsrevamp);
-            });
-            prim->points.resize(pointsrevamp.size());
-        }
-
-    }
-}
-
 namespace {
 
 struct PrimFilter : INode {
@@ -519,5 +199,50 @@ ZENDEFNODE(PrimKillDeadVerts, {
     {"primitive"},
 });
 
+struct BenchmarkPrimFilter : INode {
+    virtual void apply() override {
+        auto count = (size_t)std::max(get_input2<int>("count"), 3);
+        auto seed = get_input2<int>("seed");
+
+        // a triangle strip with a few attributes, every vertex tagged at random
+        auto prim = std::make_shared<PrimitiveObject>();
+        prim->verts.resize(count);
+        auto &vel = prim->verts.add_attr<vec3f>("vel");
+        auto &tag = prim->verts.add_attr<int>("tag");
+        prim->tris.resize(count - 2);
+        parallel_for(count, [&] (size_t i) {
+            wangsrng rng(seed, i);
+            prim->verts[i] = vec3f(i, rng.next_float(), 0);
+            vel[i] = vec3f(rng.next_float(), rng.next_float(), rng.next_float());
+            tag[i] = rng.next_float() < 0.5f;
+            if (i + 2 < count)
+                prim->tris[i] = vec3i(i, i + 1, i + 2);
+        });
+
+        auto t0 = std::chrono::steady_clock::now();
+        primFilterVerts(prim.get(), "tag", 1, false);
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double pointsPerSec = count / std::max(time, 1e-9);
+        log_info("BenchmarkPrimFilter: {} of {} verts and {} tris kept in {}s, {} points/s",
+                 prim->verts.size(), count, prim->tris.size(), time, pointsPerSec);
+        set_output("time", std::make_shared<NumericObject>((float)time));
+        set_output("pointsPerSec", std::make_shared<NumericObject>((float)pointsPerSec));
+    }
+};
+
+ZENDEFNODE(BenchmarkPrimFilter, {
+    {
+    {"int", "count", "20000000"},
+    {"int", "seed", "0"},
+    },
+    {
+    {"float", "time"},
+    {"float", "pointsPerSec"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
 }
 }
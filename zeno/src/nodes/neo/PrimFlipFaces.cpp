@@ -1,6 +1,7 @@
 #include <zeno/zeno.h>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/funcs/PrimitiveTopology.h>
 #include <zeno/types/NumericObject.h>
 #include <zeno/para/parallel_for.h>
 #include <zeno/utils/vec.h>
@@ -42,6 +43,7 @@ ZENO_API void primFlipFaces(PrimitiveObject *prim) {
             });
         });
     }
+    primInvalidateTopology(prim);
 }
 
 struct PrimFlipFaces : zeno::INode {
@@ -5,13 +5,16 @@
 #include <zeno/types/NumericObject.h>
 #include <zeno/para/parallel_for.h>
 #include <zeno/para/parallel_scan.h>
+#include <zeno/para/parallel_sort.h>
 #define ZENO_NOTICKTOCK
 #include <zeno/utils/ticktock.h>
 #include <zeno/utils/variantswitch.h>
 #include <zeno/utils/wangsrng.h>
-#include <zeno/utils/tuple_hash.h>
+#include <zeno/utils/format.h>
 #include <zeno/utils/log.h>
-#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
 #include <random>
 #include <cmath>
 #ifndef M_PI
@@ -20,69 +23,175 @@
 
 namespace zeno {
 
-template <class T>
-static void revamp_vector(std::vector<T> &arr, std::vector<int> const &revamp) {
-    std::vector<T> newarr(arr.size());
-    for (int i = 0; i < revamp.size(); i++) {
-        newarr[i] = arr[revamp[i]];
+namespace {
+
+// Points binned into cells of minRadius, so two points closer than the radius always sit in
+// the same or adjacent cells. Occupied cells are kept sorted by key rather than hashed.
+struct PoissonGrid {
+    std::vector<int> order;      // point indices grouped by cell, ascending within a cell
+    std::vector<int> cellStart;  // ncells + 1 offsets into order
+    std::vector<int> neighbors;  // 27 per cell including itself, -1 where empty
+
+    int numCells() const {
+        return (int)cellStart.size() - 1;
+    }
+};
+
+PoissonGrid buildPoissonGrid(std::vector<vec3f> const &pos, float minRadius) {
+    PoissonGrid grid;
+    float invRadius = 1.f / minRadius;
+    size_t n = pos.size();
+    std::vector<vec3i> ipos(n);
+    parallel_for(n, [&] (size_t i) {
+        ipos[i] = vec3i(zeno::floor(pos[i] * invRadius));
+    });
+    vec3i imin(std::numeric_limits<int>::max()), imax(std::numeric_limits<int>::min());
+    for (auto const &ip: ipos) {
+        imin = zeno::min(imin, ip);
+        imax = zeno::max(imax, ip);
     }
-    std::swap(arr, newarr);
+    // one spare cell on each side so neighbor keys never wrap
+    imin -= 1;
+    imax += 1;
+    int bits[3];
+    for (int d = 0; d < 3; d++) {
+        bits[d] = 1;
+        while (bits[d] < 63 && (int64_t(1) << bits[d]) <= int64_t(imax[d]) - imin[d])
+            bits[d]++;
+    }
+    if (bits[0] + bits[1] + bits[2] > 64)
+        throw makeError(format("PrimScatter: minRadius {} too small for the extent of the points", minRadius));
+    auto cellKey = [&] (vec3i ip) {
+        return (uint64_t(ip[0] - imin[0]) << (bits[1] + bits[2]))
+             | (uint64_t(ip[1] - imin[1]) << bits[2]) | uint64_t(ip[2] - imin[2]);
+    };
+
+    std::vector<std::pair<uint64_t, int>> keyed(n);
+    parallel_for(n, [&] (size_t i) {
+        keyed[i] = {cellKey(ipos[i]), (int)i};
+    });
+    parallel_sort(keyed.begin(), keyed.end(), [] (auto const &x, auto const &y) {
+        return x < y;
+    });
+
+    grid.order.resize(n);
+    std::vector<int> isHead(n);
+    parallel_for(n, [&] (size_t i) {
+        grid.order[i] = keyed[i].second;
+        isHead[i] = i == 0 || keyed[i].first != keyed[i - 1].first;
+    });
+    std::vector<int> headScan(n);
+    int ncells = parallel_exclusive_scan_sum(isHead.begin(), isHead.end(), headScan.begin());
+    grid.cellStart.resize(ncells + 1);
+    std::vector<uint64_t> cellKeys(ncells);
+    parallel_for(n, [&] (size_t i) {
+        if (isHead[i]) {
+            grid.cellStart[headScan[i]] = (int)i;
+            cellKeys[headScan[i]] = keyed[i].first;
+        }
+    });
+    grid.cellStart.back() = (int)n;
+
+    grid.neighbors.resize(ncells * 27);
+    parallel_for((size_t)ncells, [&] (size_t c) {
+        auto ip = ipos[grid.order[grid.cellStart[c]]];
+        int k = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                // z is the lowest part of the key, the three cells along it have consecutive keys
+                auto key = cellKey(ip + vec3i(dx, dy, -1));
+                auto it = std::lower_bound(cellKeys.begin(), cellKeys.end(), key);
+                for (int dz = -1; dz <= 1; dz++, key++) {
+                    bool found = it != cellKeys.end() && *it == key;
+                    grid.neighbors[c * 27 + k++] = found ? int(it - cellKeys.begin()) : -1;
+                    if (found)
+                        ++it;
+                }
+            }
+        }
+    });
+    return grid;
 }
 
-static void primPossionFilter(PrimitiveObject *prim, float minRadius) {
-    if (minRadius <= 0) return;
+// Dart throwing over the given candidates in index order: a point is kept unless an earlier kept
+// point lies within minRadius. Points are settled in parallel rounds, one is decided as soon as
+// every earlier point within the radius is, so the result is exactly that of the serial pass for
+// any thread count. The candidates are in random order, so few rounds are needed. The first
+// numFixed points are kept unconditionally and must already be minRadius apart.
+std::vector<uint8_t> poissonEliminate(std::vector<vec3f> const &pos, float minRadius, size_t numFixed = 0) {
+    enum : uint8_t { Undecided, Kept, Dropped };
+    std::vector<uint8_t> keep(pos.size());
+    if (pos.empty())
+        return keep;
+    auto grid = buildPoissonGrid(pos, minRadius);
+    int ncells = grid.numCells();
+    float r2 = minRadius * minRadius;
 
-    TICK(possion);
-    float invRadius = 1.f / minRadius;
-    std::unordered_map<vec3i, std::vector<int>, tuple_hash, tuple_equal> lut;
-    for (int i = 0; i < prim->verts.size(); i++) {
-        vec3i ipos(prim->verts[i] * invRadius);
-        lut[ipos].push_back(i);
+    // everything per slot of order, so a cell's points are scanned contiguously
+    size_t n = pos.size();
+    std::vector<vec3f> slotPos(n);
+    std::vector<int> slotCell(n);
+    std::vector<uint8_t> state(n);
+    parallel_for((size_t)ncells, [&] (size_t c) {
+        for (int q = grid.cellStart[c]; q < grid.cellStart[c + 1]; q++) {
+            slotPos[q] = pos[grid.order[q]];
+            slotCell[q] = (int)c;
+            state[q] = (size_t)grid.order[q] < numFixed ? Kept : Undecided;
+        }
+    });
+    std::vector<int> active;
+    for (size_t q = 0; q < n; q++) {
+        if (state[q] == Undecided)
+            active.push_back((int)q);
     }
 
-    std::vector<uint8_t> erased(prim->verts.size());
-    for (int i = 0; i < prim->verts.size(); i++) {
-        if (erased[i])
-            continue;
-        vec3i ipos(prim->verts[i] * invRadius);
-        erased[i] = [&] {
-            for (int dz = -1; dz <= 1; dz++) {
-                for (int dy = -1; dy <= 1; dy++) {
-                    for (int dx = -1; dx <= 1; dx++) {
-                        auto it = lut.find(ipos + vec3i(dx, dy, dz));
-                        if (it != lut.end()) {
-                            for (int j: it->second) {
-                                if (j == i || erased[j])
-                                    continue;
-                                auto dis = prim->verts[i] - prim->verts[j];
-                                if (length(dis) < minRadius)
-                                    return true;
-                            }
+    std::vector<uint8_t> decided;
+    while (!active.empty()) {
+        decided.resize(active.size());
+        parallel_for(active.size(), [&] (size_t j) {
+            int slot = active[j];
+            int i = grid.order[slot];
+            int c = slotCell[slot];
+            auto p = slotPos[slot];
+            bool pending = false;
+            for (int t = 0; t < 27; t++) {
+                int nc = grid.neighbors[c * 27 + t];
+                if (nc == -1)
+                    continue;
+                // ascending within a cell, only earlier points matter
+                for (int q = grid.cellStart[nc]; q < grid.cellStart[nc + 1] && grid.order[q] < i; q++) {
+                    if (state[q] == Dropped)
+                        continue;
+                    auto d = slotPos[q] - p;
+                    if (dot(d, d) < r2) {
+                        if (state[q] == Kept) {
+                            decided[j] = Dropped;
+                            return;
                         }
+                        pending = true;
                     }
                 }
             }
-            return false;
-        }();
-    }
-
-    std::vector<int> revamp(prim->verts.size());
-    int nrevamp = 0;
-    for (int i = 0; i < erased.size(); i++) {
-        if (!erased[i])
-            revamp[nrevamp++] = i;
+            decided[j] = pending ? Undecided : Kept;
+        });
+        size_t m = 0;
+        for (size_t j = 0; j < active.size(); j++) {
+            state[active[j]] = decided[j];
+            if (decided[j] == Undecided)
+                active[m++] = active[j];
+        }
+        active.resize(m);
     }
-    revamp.resize(nrevamp);
-
-    prim->verts.forall_attr([&] (auto const &key, auto &arr) {
-        revamp_vector(arr, revamp);
+    parallel_for(n, [&] (size_t q) {
+        keep[grid.order[q]] = state[q] == Kept;
     });
-    prim->verts.resize(nrevamp);
-    TOCK(possion);
+    return keep;
+}
+
 }
 
 ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
-    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed) {
+    PrimitiveObject *prim, std::string type, std::string denAttr, float density, float minRadius, bool interpAttrs, int seed, bool dartThrowing) {
     auto retprim = std::make_shared<PrimitiveObject>();
 
     if (seed == -1) seed = std::random_device{}();
@@ -132,77 +241,108 @@ ZENO_API std::shared_ptr<PrimitiveObject> primScatter(
     });
     zeno::log_info("PrimScatter total npoints {}", npoints);
 
-    retprim->verts.resize(npoints);
-
     if (!prim->verts.num_attrs()) {
         interpAttrs = false;
     }
-    if (interpAttrs) {
-        prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
-            using T = std::decay_t<decltype(arr[0])>;
-            retprim->add_attr<T>(key);
-        });
-    }
 
-    if (type == "tris") {
-        parallel_for((size_t)0, (size_t)npoints, [&] (size_t i) {
-            wangsrng rng(seed, i);
-            auto val = rng.next_float();
-            auto it = std::lower_bound(cdf.begin(), cdf.end(), val);
-            size_t index = it - cdf.begin();
+    // candidate id -> element and interpolation weights, reproducible from the seed alone
+    auto sample = [&] (size_t id) -> std::pair<size_t, vec3f> {
+        wangsrng rng(seed, id);
+        auto val = rng.next_float();
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), val);
+        size_t index = it - cdf.begin();
+        if (type == "tris") {
             index = std::min(index, prim->tris.size() - 1);
-            auto const &ind = prim->tris[index];
-            auto a = prim->verts[ind[0]];
-            auto b = prim->verts[ind[1]];
-            auto c = prim->verts[ind[2]];
             auto r1 = std::sqrt(rng.next_float());
             auto r2 = rng.next_float();
-            auto w1 = 1 - r1;
-            auto w2 = r1 * (1 - r2);
-            auto w3 = r1 * r2;
-            auto p = w1 * a + w2 * b + w3 * c;
-            retprim->verts[i] = p;
-            if (interpAttrs) {
-                prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
-                    using T = std::decay_t<decltype(arr[0])>;
-                    auto &retarr = retprim->attr<T>(key);
-                    auto a = arr[ind[0]];
-                    auto b = arr[ind[1]];
-                    auto c = arr[ind[2]];
-                    auto p = w1 * a + w2 * b + w3 * c;
-                    retarr[i] = p;
-                });
-            }
-        });
-    } else if (type == "lines") {
-        parallel_for((size_t)0, (size_t)npoints, [&] (size_t i) {
-            wangsrng rng(seed, i);
-            auto val = rng.next_float();
-            auto it = std::lower_bound(cdf.begin(), cdf.end(), val);
-            size_t index = it - cdf.begin();
+            return {index, vec3f(1 - r1, r1 * (1 - r2), r1 * r2)};
+        } else {
             index = std::min(index, prim->lines.size() - 1);
-            auto const &ind = prim->lines[index];
-            auto a = prim->verts[ind[0]];
-            auto b = prim->verts[ind[1]];
             auto r1 = rng.next_float();
-            auto p = a * (1 - r1) + b * r1;
-            retprim->verts[i] = p;
-            if (interpAttrs) {
-                prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
-                    using T = std::decay_t<decltype(arr[0])>;
-                    auto &retarr = retprim->attr<T>(key);
-                    auto a = arr[ind[0]];
-                    auto b = arr[ind[1]];
-                    auto p = a * (1 - r1) + b * r1;
-                    retarr[i] = p;
-                });
+            return {index, vec3f(1 - r1, r1, 0)};
+        }
+    };
+    auto interp = [&] (auto const &arr, size_t index, vec3f const &w) {
+        if (type == "tris") {
+            auto const &ind = prim->tris[index];
+            return w[0] * arr[ind[0]] + w[1] * arr[ind[1]] + w[2] * arr[ind[2]];
+        } else {
+            auto const &ind = prim->lines[index];
+            return w[0] * arr[ind[0]] + w[1] * arr[ind[1]];
+        }
+    };
+    auto samplePositions = [&] (size_t first, size_t count) {
+        std::vector<vec3f> pos(count);
+        parallel_for(count, [&] (size_t i) {
+            auto [index, w] = sample(first + i);
+            pos[i] = interp(prim->verts.values, index, w);
+        });
+        return pos;
+    };
+
+    // ids of the candidates that make it into the result
+    std::vector<size_t> ids;
+    if (minRadius <= 0) {
+        ids.resize(npoints);
+        std::iota(ids.begin(), ids.end(), size_t(0));
+    } else if (!dartThrowing) {
+        // thin out npoints candidates, the result gets sparser than density asks for
+        TICK(possion);
+        auto keep = poissonEliminate(samplePositions(0, npoints), minRadius);
+        for (size_t i = 0; i < keep.size(); i++) {
+            if (keep[i])
+                ids.push_back(i);
+        }
+        TOCK(possion);
+    } else {
+        // throw batches of candidates against the points kept so far until npoints are
+        // placed or the surface saturates
+        TICK(possion);
+        std::vector<vec3f> keptPos;
+        size_t nextId = 0;
+        for (int batch = 0; batch < 64 && ids.size() < (size_t)npoints; batch++) {
+            size_t need = npoints - ids.size();
+            size_t count = std::max<size_t>(need * 2, 1024);
+            auto pos = samplePositions(nextId, count);
+            size_t nfixed = keptPos.size();
+            pos.insert(pos.begin(), keptPos.begin(), keptPos.end());
+            auto keep = poissonEliminate(pos, minRadius, nfixed);
+            size_t added = 0;
+            for (size_t i = nfixed; i < pos.size() && added < need; i++) {
+                if (keep[i]) {
+                    ids.push_back(nextId + i - nfixed);
+                    keptPos.push_back(pos[i]);
+                    added++;
+                }
             }
+            nextId += count;
+            if (added * 100 < count)
+                break;
+        }
+        if (ids.size() < (size_t)npoints)
+            zeno::log_info("PrimScatter placed {} of {} points, minRadius leaves no room for more", ids.size(), npoints);
+        TOCK(possion);
+    }
+
+    retprim->verts.resize(ids.size());
+    if (interpAttrs) {
+        prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
+            using T = std::decay_t<decltype(arr[0])>;
+            retprim->add_attr<T>(key);
         });
     }
+    parallel_for(ids.size(), [&] (size_t i) {
+        auto [index, w] = sample(ids[i]);
+        retprim->verts[i] = interp(prim->verts.values, index, w);
+        if (interpAttrs) {
+            prim->verts.foreach_attr([&] (auto const &key, auto const &arr) {
+                using T = std::decay_t<decltype(arr[0])>;
+                retprim->attr<T>(key)[i] = interp(arr, index, w);
+            });
+        }
+    });
 
     TOCK(scatter);
-    primPossionFilter(retprim.get(), minRadius);
-
     return retprim;
 }
 
@@ -217,7 +357,8 @@ struct PrimScatter : INode {
         auto minRadius = get_input2<float>("minRadius");
         auto interpAttrs = get_input2<bool>("interpAttrs");
         auto seed = get_input2<int>("seed");
-        auto retprim = primScatter(prim.get(), type, denAttr, density, minRadius, interpAttrs, seed);
+        auto dartThrowing = get_input2<std::string>("poissonMethod") == "dart";
+        auto retprim = primScatter(prim.get(), type, denAttr, density, minRadius, interpAttrs, seed, dartThrowing);
         set_output("parsPrim", retprim);
     }
 };
@@ -229,6 +370,7 @@ ZENO_DEFNODE(PrimScatter)({
         {"string", "denAttr", ""},
         {"float", "density", "100"},
         {"float", "minRadius", "0"},
+        {"enum filter dart", "poissonMethod", "filter"},
         {"bool", "interpAttrs", "1"},
         {"int", "seed", "-1"},
     },
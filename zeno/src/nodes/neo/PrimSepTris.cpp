@@ -1,37 +1,10 @@
 #include <zeno/zeno.h>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/funcs/PrimitiveUtils.h>
-//#include <zeno/para/execution.h>
-//#include <algorithm>
+#include <zeno/para/parallel_for.h>
 
 namespace zeno {
 
-#if 0
-ZENO_API void primSmoothNormal(PrimitiveObject *prim) {
-    auto &nrm = prim->verts.add_attr<vec3f>("nrm");
-    std::fill(ZENO_PAR_UNSEQ nrm.begin(), nrm.end(), vec3f());
-    for (size_t i = 0; i < prim->polys.size(); i++) {
-        auto [base, len] = prim->polys[i];
-        if (len < 3) continue;
-        auto a = prim->verts[prim->loops[base]];
-        auto b = prim->verts[prim->loops[base + 1]];
-        auto c = prim->verts[prim->loops[base + 2]];
-        auto n = cross(b - a, c - a);
-        for (size_t j = base + 2; j < base + len; j++) {
-            auto b = prim->verts[prim->loops[j]];
-            auto c = prim->verts[prim->loops[j + 1]];
-            n += cross(b - a, c - a);
-        }
-        for (size_t j = base; j < base + len; j++) {
-            nrm[j] += n;
-        }
-    }
-    std::for_each(ZENO_PAR_UNSEQ nrm.begin(), nrm.end(), [] (vec3f &n) {
-        n = normalizeSafe(n, 1e-6f);
-    });
-}
-#endif
-
 ZENO_API void primSepTriangles(PrimitiveObject *prim, bool smoothNormal, bool keepTriFaces) {
     if (!prim->tris.size() && !prim->quads.size() && !prim->polys.size()) {
         //if ((prim->points.size() || prim->lines.size()) && !prim->verts.has_attr("clr")) {
@@ -41,9 +14,6 @@ ZENO_API void primSepTriangles(PrimitiveObject *prim, bool smoothNormal, bool ke
         return; // TODO: cihou pars and lines
     }
     // TODO: support index compress?
-    //if (smoothNormal && !prim->verts.has_attr("nrm")) {
-        //primSmoothNormal(prim);
-    //}
     bool needCompNormal = !prim->verts.has_attr("nrm");
     bool needCompUVs = !prim->verts.has_attr("uv");
 
@@ -86,6 +56,20 @@ ZENO_API void primSepTriangles(PrimitiveObject *prim, bool smoothNormal, bool ke
         b += (len - 2) * 3;
     }
 
+    std::vector<vec3f> shn;
+    if (smoothNormal && needCompNormal) {
+        // smooth over the triangles made above, so a quad or polygon weighs as much as the
+        // triangles it is split into here
+        PrimitiveObject triPrim;
+        triPrim.verts.values = prim->verts.values;
+        triPrim.tris.resize(v.size() / 3);
+        parallel_for(triPrim.tris.size(), [&] (size_t i) {
+            triPrim.tris[i] = vec3i(v[i * 3 + 0], v[i * 3 + 1], v[i * 3 + 2]);
+        });
+        primSmoothNormal(&triPrim, "nrm", "uniform");
+        shn = std::move(triPrim.verts.attr<vec3f>("nrm"));
+    }
+
     AttrVector<vec3f> new_verts;
     new_verts.resize(v.size());
     for (size_t i = 0; i < v.size(); i++) {
@@ -168,23 +152,10 @@ ZENO_API void primSepTriangles(PrimitiveObject *prim, bool smoothNormal, bool ke
     prim->uvs.clear();
 
     if (smoothNormal && needCompNormal) {
-        std::vector<vec3f> shn(prim->verts.size());
-        for (size_t i = 0; i < v.size() / 3; i++) {
-            auto a = new_verts[i * 3 + 0];
-            auto b = new_verts[i * 3 + 1];
-            auto c = new_verts[i * 3 + 2];
-            auto n = cross(b - a, c - a);
-            n = normalizeSafe(n);
-            shn[v[i * 3 + 0]] += n;
-            shn[v[i * 3 + 1]] += n;
-            shn[v[i * 3 + 2]] += n;
-        }
         auto &new_nrm = new_verts.add_attr<vec3f>("nrm");
-        for (size_t i = 0; i < v.size(); i++) {
-            auto n = shn[v[i]];
-            n = normalizeSafe(n);
-            new_nrm[i] = n;
-        }
+        parallel_for(v.size(), [&] (size_t i) {
+            new_nrm[i] = shn[v[i]];
+        });
     }
 
     std::swap(new_verts, prim->verts);
@@ -1,81 +1,75 @@
 #include <zeno/zeno.h>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/funcs/PrimitiveCompact.h>
 #include <zeno/types/StringObject.h>
 #include <zeno/types/NumericObject.h>
-#include <unordered_map>
+#include <zeno/para/parallel_sort.h>
 #include <algorithm>
+#include <numeric>
 
 namespace zeno {
 namespace {
 
-template <class T>
-static void revamp_vector(std::vector<T> &arr, std::vector<int> const &revamp) {
-    std::vector<T> newarr(arr.size());
-    for (int i = 0; i < revamp.size(); i++) {
-        newarr[i] = arr[revamp[i]];
-    }
-    std::swap(arr, newarr);
-}
-
 struct PrimWeld : INode {
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
         auto tagAttr = get_input<StringObject>("tagAttr")->get();
         auto isAverage = get_input<StringObject>("method")->get() == "average";
 
-        std::unordered_multimap<int, int> lut;
+        // group the verts by tag, each group is welded into its lowest vertex
         auto &tag = prim->verts.attr<int>(tagAttr);
-        for (int i = 0; i < prim->size(); i++) {
-            lut.insert({tag[i], i});
-        }
-        std::vector<int> revamp;
-        std::vector<int> unrevamp(prim->size());
-        revamp.resize(lut.size());
-        int nrevamp = 0;
-        for (auto it = lut.begin(); it != lut.end();) {
-            auto nit = std::find_if(std::next(it), lut.end(), [val = it->first] (auto const &p) {
-                return p.first != val;
-            });
-            auto start = it->second;
-            if (isAverage) {
-                vec3f average = prim->verts[start];
-                int count = 1;
-                for (++it; it != nit; ++it) {
-                    unrevamp[it->second] = nrevamp;
-                    auto pos = prim->verts[it->second];
-                    average += pos;
-                    ++count;
-                }
-                average *= 1 / (float)count;
-                prim->verts[start] = average;
-            } else {
-                for (; it != nit; ++it) {
-                    //printf("(%d) %d -> %d\n", it->first, it->second, nrevamp);
-                    unrevamp[it->second] = nrevamp;
-                    // unrevamp[old_coor] = new_coor
-                }
-            }
-            revamp[nrevamp] = start;
-            ++nrevamp;
+        std::ptrdiff_t n = prim->size();
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        parallel_stable_sort(order.begin(), order.end(), [&] (int i, int j) {
+            return tag[i] < tag[j];
+        });
+        std::vector<uint8_t> groupHead(n);
+#pragma omp parallel for
+        for (std::ptrdiff_t k = 0; k < n; k++)
+            groupHead[k] = k == 0 || tag[order[k]] != tag[order[k - 1]];
+        auto groupStart = compactIndices(groupHead);
+        std::ptrdiff_t ngroups = groupStart.size();
+        groupStart.push_back(n);
+
+        std::vector<int> weldTo(n);
+#pragma omp parallel for
+        for (std::ptrdiff_t g = 0; g < ngroups; g++) {
+            for (int k = groupStart[g]; k < groupStart[g + 1]; k++)
+                weldTo[order[k]] = order[groupStart[g]];
         }
-        revamp.resize(nrevamp);
-        //primRevampVerts(prim.get(), revamp, &unrevamp);
+        std::vector<uint8_t> kept(n);
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < n; i++)
+            kept[i] = weldTo[i] == i;
+        auto revamp = compactIndices(kept);
+        int nrevamp = revamp.size();
+        auto unrevamp = inverseRevamp(revamp, n);
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < n; i++)
+            unrevamp[i] = unrevamp[weldTo[i]];
 
-        revamp_vector(prim->verts.values, revamp);
         if (isAverage) {
-            prim->verts.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
+            auto average = [&] (auto &arr) {
                 using T = std::decay_t<decltype(arr[0])>;
                 std::vector<T> new_arr(nrevamp);
-                for (size_t i = 0; i < arr.size(); i++) {
-                    new_arr[unrevamp[i]] += arr[i] / (T)lut.count(i);
+#pragma omp parallel for
+                for (std::ptrdiff_t g = 0; g < ngroups; g++) {
+                    T sum = arr[order[groupStart[g]]];
+                    for (int k = groupStart[g] + 1; k < groupStart[g + 1]; k++)
+                        sum += arr[order[k]];
+                    new_arr[unrevamp[order[groupStart[g]]]] = sum / (T)(groupStart[g + 1] - groupStart[g]);
                 }
                 arr = std::move(new_arr);
-            });
-        } else {
+            };
+            average(prim->verts.values);
             prim->verts.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
-                revamp_vector(arr, revamp);
+                average(arr);
             });
+        } else {
+            RevampScratch scratch;
+            revampAttrVector(prim->verts, revamp, scratch);
         }
 
         auto repair = [&] (int &x) {
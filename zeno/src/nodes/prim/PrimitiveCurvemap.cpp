@@ -372,6 +372,11 @@ ZENDEFNODE(PrimitiveCurvemap, {
 
     }
     struct DynamicNumber : zeno::INode {
+        // the current frame is the default of the frame input
+        virtual bool dependsOnFrame() const override {
+            return !has_input("frame");
+        }
+
         virtual void apply() override {
             std::map<std::string, std::vector<ControlPoint>> keyframes_table;
             auto _tmp = get_param<std::string>("_TMP");
@@ -1,142 +1,238 @@
 #include <zeno/zeno.h>
 #include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/funcs/PrimitiveTopology.h>
 #include <zeno/types/PrimitiveObject.h>
 #include <zeno/types/NumericObject.h>
 #include <zeno/types/StringObject.h>
+#include <zeno/utils/format.h>
 #include <zeno/utils/vec.h>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <cstdlib>
 #include <cassert>
-#if defined(_OPENMP) && defined(__GNUG__)
-#include <omp.h>
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
 #endif
 
 namespace zeno {
-// for parallel atomic float add
-template <typename DstT, typename SrcT> constexpr auto reinterpret_bits(SrcT &&val) {
-    using Src = std::remove_cv_t<std::remove_reference_t<SrcT>>;
-    using Dst = std::remove_cv_t<std::remove_reference_t<DstT>>;
-    static_assert(sizeof(Src) == sizeof(Dst),
-                  "Source Type and Destination Type must be of the same size");
-    static_assert(std::is_trivially_copyable_v<Src> && std::is_trivially_copyable_v<Dst>,
-                  "Both types should be trivially copyable.");
-    static_assert(std::alignment_of_v<Src> % std::alignment_of_v<Dst> == 0,
-                  "The original type should at least have an alignment as strict.");
-    Dst dst{};
-    std::memcpy(&dst, const_cast<const Src *>(&val), sizeof(Dst));
-    return dst;
-  }
-ZENO_API void primCalcNormal(zeno::PrimitiveObject* prim, float flip, std::string nrmAttr)
-{
-    auto &nrm = prim->add_attr<zeno::vec3f>(nrmAttr);
-    auto &pos = prim->verts.values;
+namespace {
+
+enum class NormalWeighting {
+    Area,
+    Angle,
+    Uniform,
+};
+
+NormalWeighting parseNormalWeighting(std::string const &weighting) {
+    if (weighting == "area") return NormalWeighting::Area;
+    if (weighting == "angle") return NormalWeighting::Angle;
+    if (weighting == "uniform") return NormalWeighting::Uniform;
+    throw makeError(format("unknown normal weighting `{}`", weighting));
+}
 
-#if defined(_OPENMP) && defined(__GNUG__)
+// unit face normals, summed over the triangle fan so concave polygons are fine
+std::vector<vec3f> faceNormals(PrimTopology const &topo, std::vector<vec3f> const &pos) {
+    std::vector<vec3f> fnrm(topo.numFaces());
 #pragma omp parallel for
-#endif
-    for (size_t i = 0; i < nrm.size(); i++) {
-        nrm[i] = zeno::vec3f(0);
+    for (std::ptrdiff_t f = 0; f < (std::ptrdiff_t)fnrm.size(); f++) {
+        int h0 = topo.faceStart[f];
+        auto p0 = pos[topo.corners[h0]];
+        vec3f n(0);
+        for (int h = h0 + 1; h + 1 < topo.faceStart[f + 1]; h++)
+            n += cross(pos[topo.corners[h]] - p0, pos[topo.corners[h + 1]] - p0);
+        fnrm[f] = normalizeSafe(n);
     }
+    return fnrm;
+}
 
-#if defined(_OPENMP) && defined(__GNUG__)
-    auto atomicCas = [](int* dest, int expected, int desired) {
-        __atomic_compare_exchange_n(const_cast<int volatile *>(dest), &expected,
-                                    desired, false, __ATOMIC_ACQ_REL,
-                                    __ATOMIC_RELAXED);
-        return expected;
-    };
-    auto atomicFloatAdd = [&](float*dst, float val) {
-        static_assert(sizeof(float) == sizeof(int), "sizeof float != sizeof int");
-        int oldVal = reinterpret_bits<int>(*dst);
-        int newVal = reinterpret_bits<int>(reinterpret_bits<float>(oldVal) + val), readVal{};
-        while ((readVal = atomicCas((int*)dst, oldVal, newVal)) != oldVal) {
-            oldVal = readVal;
-            newVal = reinterpret_bits<int>(reinterpret_bits<float>(readVal) + val);
-        }
-        return reinterpret_bits<float>(oldVal);
-    };
-#endif
-
-#if defined(_OPENMP) && defined(__GNUG__)
+// what each corner adds to the normal of its vertex; for area this is the triangle spanned by
+// the corner and the next two corners, which is the face area for triangles
+std::vector<vec3f> cornerContributions(PrimTopology const &topo, std::vector<vec3f> const &pos,
+                                       std::vector<vec3f> const &fnrm, NormalWeighting weighting) {
+    std::vector<vec3f> contrib(topo.numCorners());
 #pragma omp parallel for
-#endif
-    for (size_t i = 0; i < prim->tris.size(); i++) {
-        auto ind = prim->tris[i];
-        auto n = cross(pos[ind[1]] - pos[ind[0]], pos[ind[2]] - pos[ind[0]]);
-
-#if defined(_OPENMP) && defined(__GNUG__)
-        for (int j = 0; j != 3; ++j) {
-            auto &n_i = nrm[ind[j]];
-            for (int d = 0; d != 3; ++d)
-                atomicFloatAdd(&n_i[d], n[d]);
+    for (std::ptrdiff_t h = 0; h < (std::ptrdiff_t)contrib.size(); h++) {
+        auto p = pos[topo.corners[h]];
+        auto pn = pos[topo.corners[topo.next((int)h)]];
+        if (weighting == NormalWeighting::Area) {
+            auto pnn = pos[topo.corners[topo.next(topo.next((int)h))]];
+            contrib[h] = cross(pn - p, pnn - p);
+        } else if (weighting == NormalWeighting::Angle) {
+            auto pp = pos[topo.corners[topo.prev((int)h)]];
+            float c = dot(normalizeSafe(pn - p), normalizeSafe(pp - p));
+            contrib[h] = std::acos(std::clamp(c, -1.0f, 1.0f)) * fnrm[topo.cornerFace[h]];
+        } else {
+            contrib[h] = fnrm[topo.cornerFace[h]];
         }
-#else
-        nrm[ind[0]] += n;
-        nrm[ind[1]] += n;
-        nrm[ind[2]] += n;
-#endif
     }
+    return contrib;
+}
 
-#if defined(_OPENMP) && defined(__GNUG__)
-#pragma omp parallel for
-#endif
-    for (size_t i = 0; i < prim->quads.size(); i++) {
-        auto ind = prim->quads[i];
-        std::array<vec3f, 4> ns = {
-            cross(pos[ind[1]] - pos[ind[0]], pos[ind[2]] - pos[ind[0]]),
-            cross(pos[ind[2]] - pos[ind[1]], pos[ind[3]] - pos[ind[1]]),
-            cross(pos[ind[3]] - pos[ind[2]], pos[ind[0]] - pos[ind[2]]),
-            cross(pos[ind[0]] - pos[ind[3]], pos[ind[1]] - pos[ind[3]]),
+// the normal of a vertex or fan from the sum of its corner contributions, both normal paths go
+// through here so they agree, also on isolated vertices whose sum is zero
+vec3f finishNormal(vec3f const &sum, float flip) {
+    return flip * normalizeSafe(sum);
+}
+
+// Splits every vertex into the fans of its corners that are joined across edges sharper than
+// hardAngle, appending the extra vertices and rewriting the faces to use them.
+void splitHardEdges(PrimitiveObject *prim, PrimTopology const &topo, std::vector<vec3f> const &fnrm,
+                    std::vector<vec3f> const &contrib, float hardAngle, float flip, std::string const &nrmAttr) {
+    std::ptrdiff_t nverts = topo.numVerts;
+    float cosHard = std::cos(hardAngle * (float)M_PI / 180.0f);
+    std::vector<int> group(topo.numCorners());  // first corner of the fan each corner is in
+    std::vector<vec3f> groupNrm(topo.numCorners());
+    std::vector<int> extra(nverts + 1);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::ptrdiff_t v = 0; v < nverts; v++) {
+        int beg = topo.vertStart[v], end = topo.vertStart[v + 1];
+        auto find = [&] (int i) {
+            while (group[topo.vertCorners[i]] != i)
+                i = group[topo.vertCorners[i]];
+            return i;
         };
+        for (int i = beg; i < end; i++)
+            group[topo.vertCorners[i]] = i;
+        for (int i = beg; i < end; i++) {
+            int h = topo.vertCorners[i];
+            int t = topo.twin[h];
+            if (t == -1)
+                continue;
+            // the twin's corner at this vertex, whichever way the other face is oriented
+            int c = topo.corners[t] == v ? t : topo.next(t);
+            auto const &n1 = fnrm[topo.cornerFace[h]];
+            auto const &n2 = fnrm[topo.cornerFace[c]];
+            if (dot(n1, n2) < cosHard)
+                continue;
+            int j = std::lower_bound(topo.vertCorners.begin() + beg, topo.vertCorners.begin() + end, c)
+                  - topo.vertCorners.begin();
+            int ri = find(i), rj = find(j);
+            if (ri != rj)
+                group[topo.vertCorners[std::max(ri, rj)]] = std::min(ri, rj);
+        }
+        int ngroups = 0;
+        for (int i = beg; i < end; i++) {
+            int h = topo.vertCorners[i];
+            group[h] = find(i);
+            if (group[h] == i) {
+                ngroups++;
+                groupNrm[h] = vec3f(0);
+            }
+        }
+        for (int i = beg; i < end; i++) {
+            int h = topo.vertCorners[i];
+            groupNrm[topo.vertCorners[group[h]]] += contrib[h];
+        }
+        extra[v] = std::max(ngroups - 1, 0);
+    }
+    extra.back() = 0;
+    int nextra = 0;
+    for (std::ptrdiff_t v = 0; v <= nverts; v++) {
+        int cnt = extra[v];
+        extra[v] = nextra;
+        nextra += cnt;
+    }
 
-#if defined(_OPENMP) && defined(__GNUG__)
-        for (int j = 0; j != 4; ++j) {
-            auto &n_i = nrm[ind[j]];
-            for (int d = 0; d != 3; ++d)
-                atomicFloatAdd(&n_i[d], ns[j][d]);
+    // the fan holding the vertex's first corner keeps the vertex, later fans get new ones
+    std::vector<int> newVert(topo.numCorners());
+    std::vector<int> srcVert(nextra);
+    prim->verts.resize(nverts + nextra);
+    auto &nrm = prim->verts.add_attr<vec3f>(nrmAttr);
+#pragma omp parallel for
+    for (std::ptrdiff_t v = 0; v < nverts; v++) {
+        int beg = topo.vertStart[v], end = topo.vertStart[v + 1];
+        int next = (int)nverts + extra[v];
+        for (int i = beg; i < end; i++) {
+            int h = topo.vertCorners[i];
+            if (group[h] != i)
+                continue;
+            int nv = i == beg ? (int)v : next++;
+            if (nv != v)
+                srcVert[nv - nverts] = (int)v;
+            newVert[h] = nv;
+            nrm[nv] = finishNormal(groupNrm[h], flip);
         }
-#else
-        for (int j = 0; j != 4; ++j) {
-            nrm[ind[j]] += ns[j];
+        if (beg == end)
+            nrm[v] = finishNormal(vec3f(0), flip);
+        for (int i = beg; i < end; i++) {
+            int h = topo.vertCorners[i];
+            newVert[h] = newVert[topo.vertCorners[group[h]]];
         }
-#endif
     }
 
-#if defined(_OPENMP) && defined(__GNUG__)
+    auto copyVerts = [&] (auto &arr) {
 #pragma omp parallel for
-#endif
-    for (size_t i = 0; i < prim->polys.size(); i++) {
-        auto [beg, len] = prim->polys[i];
+        for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)nextra; i++)
+            arr[nverts + i] = arr[srcVert[i]];
+    };
+    copyVerts(prim->verts.values);
+    prim->verts.foreach_attr<AttrAcceptAll>([&] (auto const &key, auto &arr) {
+        if (key != nrmAttr)
+            copyVerts(arr);
+    });
 
-        auto ind = [loops = prim->loops.data(), beg = beg, len = len] (int t) -> int {
-            if (t >= len) t -= len;
-            return loops[beg + t];
-        };
-        for (int j = 0; j < len; ++j) {
-            auto nsj = cross(pos[ind(j + 1)] - pos[ind(j)], pos[ind(j + 2)] - pos[ind(j)]);
-#if defined(_OPENMP) && defined(__GNUG__)
-            auto &n_i = nrm[ind(j)];
-            for (int d = 0; d != 3; ++d)
-                atomicFloatAdd(&n_i[d], nsj[d]);
-#else
-            nrm[ind(j)] += nsj;
-#endif
+    int polyBase = topo.numTris + topo.numQuads;
+#pragma omp parallel for
+    for (std::ptrdiff_t f = 0; f < topo.numFaces(); f++) {
+        int h0 = topo.faceStart[f];
+        if (f < topo.numTris) {
+            for (int j = 0; j < 3; j++)
+                prim->tris[f][j] = newVert[h0 + j];
+        } else if (f < polyBase) {
+            for (int j = 0; j < 4; j++)
+                prim->quads[f - topo.numTris][j] = newVert[h0 + j];
+        } else {
+            int start = prim->polys[f - polyBase][0];
+            for (int j = 0; j < topo.faceSize(f); j++)
+                prim->loops[start + j] = newVert[h0 + j];
         }
     }
+    primInvalidateTopology(prim);
+}
+
+}
 
-#if defined(_OPENMP) && defined(__GNUG__)
+ZENO_API void primSmoothNormal(PrimitiveObject *prim, std::string nrmAttr, std::string weighting,
+                               float hardAngle, float flip) {
+    auto wt = parseNormalWeighting(weighting);
+    // only splitting hard edges needs to know the edges
+    auto topo = primTopology(prim, hardAngle < 180.0f);
+    auto const &pos = prim->verts.values;
+    std::vector<vec3f> fnrm;
+    if (wt != NormalWeighting::Area || hardAngle < 180.0f)
+        fnrm = faceNormals(*topo, pos);
+    auto contrib = cornerContributions(*topo, pos, fnrm, wt);
+    if (hardAngle < 180.0f) {
+        splitHardEdges(prim, *topo, fnrm, contrib, hardAngle, flip, nrmAttr);
+        return;
+    }
+
+    // gather over each vertex's corners in a fixed order, so the sum is deterministic
+    auto &nrm = prim->verts.add_attr<vec3f>(nrmAttr);
 #pragma omp parallel for
-#endif
-    for (size_t i = 0; i < nrm.size(); i++) {
-        nrm[i] = flip * normalizeSafe(nrm[i]);
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)nrm.size(); i++) {
+        vec3f n(0);
+        for (int k = topo->vertStart[i]; k < topo->vertStart[i + 1]; k++)
+            n += contrib[topo->vertCorners[k]];
+        nrm[i] = finishNormal(n, flip);
     }
 }
+
+ZENO_API void primCalcNormal(zeno::PrimitiveObject* prim, float flip, std::string nrmAttr)
+{
+    primSmoothNormal(prim, nrmAttr, "area", 180.0f, flip);
+}
+
 struct PrimitiveCalcNormal : zeno::INode {
     virtual void apply() override {
         auto prim = get_input<PrimitiveObject>("prim");
         auto nrmAttr = get_input<StringObject>("nrmAttr")->get();
         auto flip = get_input<NumericObject>("flip")->get<bool>();
-        primCalcNormal(prim.get(), flip ? -1 : 1, nrmAttr);
+        auto weighting = get_input2<std::string>("weighting");
+        auto hardAngle = get_input2<bool>("hardEdges") ? get_input2<float>("hardAngle") : 180.0f;
+        primSmoothNormal(prim.get(), nrmAttr, weighting, hardAngle, flip ? -1 : 1);
         set_output("prim", get_input("prim"));
     }
 };
@@ -146,6 +242,9 @@ ZENDEFNODE(PrimitiveCalcNormal, {
     {"prim"},
     {"string", "nrmAttr", "nrm"},
     {"bool", "flip", "0"},
+    {"enum area angle uniform", "weighting", "area"},
+    {"bool", "hardEdges", "0"},
+    {"float", "hardAngle", "60"},
     },
     {"prim"},
     {},
@@ -0,0 +1,36 @@
+#include "zenotest.h"
+#include <zeno/extra/GraphException.h>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+// zenotests [name...]: runs the named tests, or all of them
+int main(int argc, char **argv) {
+    int failed = 0, ran = 0;
+    for (auto const &test: zeno::tests::testCases()) {
+        bool wanted = argc < 2;
+        for (int i = 1; i < argc; i++)
+            wanted = wanted || !std::strcmp(argv[i], test.name);
+        if (!wanted)
+            continue;
+        ran++;
+        try {
+            test.run();
+            std::printf("[ PASS ] %s\n", test.name);
+        } catch (std::exception const &e) {
+            std::printf("[ FAIL ] %s: %s\n", test.name, e.what());
+            failed++;
+        } catch (zeno::GraphException const &e) {
+            try {
+                std::rethrow_exception(e.ep);
+            } catch (std::exception const &ne) {
+                std::printf("[ FAIL ] %s: in node %s: %s\n", test.name, e.nodeName.c_str(), ne.what());
+            } catch (...) {
+                std::printf("[ FAIL ] %s: in node %s\n", test.name, e.nodeName.c_str());
+            }
+            failed++;
+        }
+    }
+    std::printf("%d of %d tests passed\n", ran - failed, ran);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+#include "zenotest.h"
+#include <zeno/core/Graph.h>
+#include <zeno/core/Session.h>
+#include <zeno/types/ListObject.h>
+#include <zeno/types/NumericObject.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// adds 10 to each of 1..4 in a ForEach, `object` either comes from the body or straight from
+// the BeginForEach, `accept` is wired from a node outside of the loop
+std::string forEachProgram(bool parallel, bool throughBody, int accept) {
+    std::string objectSource = throughBody ? R"("add", "ret")" : R"("begin", "object")";
+    return R"([
+        ["addNode", "MakeList", "lst"],
+        ["setNodeParam", "lst", "doConcat", 0],
+        ["setNodeInput", "lst", "obj0", 1],
+        ["setNodeInput", "lst", "obj1", 2],
+        ["setNodeInput", "lst", "obj2", 3],
+        ["setNodeInput", "lst", "obj3", 4],
+        ["completeNode", "lst"],
+        ["addNode", "NumericInt", "acc"],
+        ["setNodeParam", "acc", "value", )" + std::to_string(accept) + R"(],
+        ["completeNode", "acc"],
+        ["addNode", "BeginForEach", "begin"],
+        ["bindNodeInput", "begin", "list", "lst", "list"],
+        ["completeNode", "begin"],
+        ["addNode", "NumericOperator", "add"],
+        ["setNodeParam", "add", "op_type", "add"],
+        ["bindNodeInput", "add", "lhs", "begin", "object"],
+        ["setNodeInput", "add", "rhs", 10],
+        ["completeNode", "add"],
+        ["addNode", "EndForEach", "end"],
+        ["setNodeParam", "end", "doConcat", 0],
+        ["setNodeParam", "end", "parallel", )" + std::to_string((int)parallel) + R"(],
+        ["bindNodeInput", "end", "object", )" + objectSource + R"(],
+        ["bindNodeInput", "end", "accept", "acc", "value"],
+        ["bindNodeInput", "end", "FOR", "begin", "FOR"],
+        ["completeNode", "end"]
+    ])";
+}
+
+std::vector<int> runForEach(bool parallel, bool throughBody, int accept, std::string const &output) {
+    auto graph = zeno::getSession().createGraph();
+    graph->loadGraph(forEachProgram(parallel, throughBody, accept).c_str());
+    graph->applyNodes({"end"});
+    auto list = zeno::safe_dynamic_cast<zeno::ListObject>(graph->getNodeOutput("end", output));
+    std::vector<int> values;
+    for (auto const &obj: list->arr)
+        values.push_back(zeno::safe_dynamic_cast<zeno::NumericObject>(obj)->get<int>());
+    return values;
+}
+
+}
+
+ZENO_TEST(parallelForEachMatchesSerial) {
+    for (bool throughBody: {true, false}) {
+        for (int accept: {0, 1}) {
+            auto serial = runForEach(false, throughBody, accept, "list");
+            auto parallel = runForEach(true, throughBody, accept, "list");
+            ZENO_CHECK(serial == parallel);
+            ZENO_CHECK(runForEach(false, throughBody, accept, "droppedList")
+                       == runForEach(true, throughBody, accept, "droppedList"));
+        }
+    }
+    ZENO_CHECK(runForEach(true, true, 1, "list") == std::vector<int>({11, 12, 13, 14}));
+    ZENO_CHECK(runForEach(true, false, 1, "list") == std::vector<int>({1, 2, 3, 4}));
+    ZENO_CHECK(runForEach(true, true, 0, "list").empty());
+    ZENO_CHECK(runForEach(true, true, 0, "droppedList") == std::vector<int>({11, 12, 13, 14}));
+}
@@ -0,0 +1,51 @@
+#include "zenotest.h"
+#include <zeno/extra/GlobalComm.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <filesystem>
+#include <string>
+
+// three frames sharing one large primitive, which goes to the blob store once
+ZENO_TEST(frameCacheCountsAndCollectsSharedBlobs) {
+    auto dir = std::filesystem::temp_directory_path() / "zenotests_frameCache";
+    std::filesystem::remove_all(dir);
+    auto blobDir = dir / "blobs";
+
+    zeno::GlobalComm comm;
+    comm.frameCache(dir.string(), 10);
+    comm.frameCacheBudget(0, 0);
+    comm.initFrameRange(0, 2);
+    auto shared = std::make_shared<zeno::PrimitiveObject>();
+    shared->verts.resize(10000);
+    for (int f = 0; f <= 2; f++) {
+        comm.newFrame();
+        comm.addViewObject("1-Shared:0", shared);
+        comm.addViewObject("2-Frame:0", std::make_shared<zeno::NumericObject>(f));
+        comm.finishFrame();
+        comm.dumpFrameCache(f);
+    }
+
+    size_t blobBytes = 0, blobCount = 0, fileBytes = 0;
+    for (auto const &entry: std::filesystem::directory_iterator(blobDir)) {
+        blobBytes += entry.file_size();
+        blobCount++;
+    }
+    ZENO_CHECK(blobCount == 1);
+    ZENO_CHECK(blobBytes > shared->verts.size() * sizeof(zeno::vec3f));
+    for (auto const &entry: std::filesystem::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().parent_path() != blobDir)
+            fileBytes += entry.file_size();
+    }
+
+    for (int f = 0; f <= 2; f++)
+        ZENO_CHECK(comm.getViewObjects(f) != nullptr);
+    ZENO_CHECK(comm.m_cachedBytes == fileBytes + blobBytes);
+
+    // the blob goes with the last frame referencing it, whichever that is
+    comm.removeCache(2);
+    comm.removeCache(0);
+    ZENO_CHECK(std::filesystem::exists(blobDir));
+    comm.removeCache(1);
+    ZENO_CHECK(!std::filesystem::exists(blobDir));
+    std::filesystem::remove_all(dir);
+}
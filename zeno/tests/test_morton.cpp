@@ -0,0 +1,21 @@
+#include "zenotest.h"
+#include <zeno/utils/morton.h>
+#include <cstdint>
+#include <random>
+
+// each coordinate bit lands on its own key bit, so distinct cells never share a key
+ZENO_TEST(mortonKeysInterleaveBits) {
+    std::mt19937_64 rng(1);
+    for (int i = 0; i < 1000; i++) {
+        uint64_t x = rng() & 0x1fffff, y = rng() & 0x1fffff, z = rng() & 0x1fffff;
+        uint64_t expected = 0;
+        for (int b = 0; b < 21; b++)
+            expected |= ((x >> b) & 1) << 3 * b | ((y >> b) & 1) << (3 * b + 1) | ((z >> b) & 1) << (3 * b + 2);
+        ZENO_CHECK(zeno::morton3d::encode(x, y, z) == expected);
+        ZENO_CHECK(zeno::morton3d::decode(expected) == std::make_tuple(x, y, z));
+
+        uint64_t u = rng() & 0xffffffff, v = rng() & 0xffffffff;
+        ZENO_CHECK(zeno::morton2d::decode(zeno::morton2d::encode(u, v)) == std::make_tuple(u, v));
+    }
+    ZENO_CHECK(zeno::morton3d::encode(0, 1, 0) != zeno::morton3d::encode(0, 0, 2));
+}
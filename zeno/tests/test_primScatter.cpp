@@ -0,0 +1,67 @@
+#include "zenotest.h"
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+std::shared_ptr<zeno::PrimitiveObject> makeSquare(float size) {
+    auto prim = std::make_shared<zeno::PrimitiveObject>();
+    prim->verts.resize(4);
+    prim->verts[0] = zeno::vec3f(0, 0, 0);
+    prim->verts[1] = zeno::vec3f(size, 0, 0);
+    prim->verts[2] = zeno::vec3f(size, 0, size);
+    prim->verts[3] = zeno::vec3f(0, 0, size);
+    prim->tris.resize(2);
+    prim->tris[0] = zeno::vec3i(0, 1, 2);
+    prim->tris[1] = zeno::vec3i(0, 2, 3);
+    return prim;
+}
+
+// points kept by one serial dart throwing pass over the candidates in order
+std::vector<zeno::vec3f> serialDartThrowing(std::vector<zeno::vec3f> const &candidates, float minRadius) {
+    std::vector<zeno::vec3f> kept;
+    for (auto const &p: candidates) {
+        bool isFar = std::all_of(kept.begin(), kept.end(), [&] (zeno::vec3f const &q) {
+            return zeno::lengthSquared(p - q) >= minRadius * minRadius;
+        });
+        if (isFar)
+            kept.push_back(p);
+    }
+    return kept;
+}
+
+// points per parity class of the minRadius grid they fall in
+std::vector<int> phaseCounts(std::vector<zeno::vec3f> const &points, float minRadius) {
+    std::vector<int> counts(4);
+    for (auto const &p: points) {
+        int ix = (int)std::floor(p[0] / minRadius), iz = (int)std::floor(p[2] / minRadius);
+        counts[(ix & 1) | (iz & 1) << 1]++;
+    }
+    return counts;
+}
+
+}
+
+ZENO_TEST(primScatterPoissonMatchesSerialPass) {
+    auto square = makeSquare(60);
+    float density = 4, minRadius = 1;
+    int seed = 7;
+    // without a radius every candidate is returned, in the order they are thrown
+    auto candidates = zeno::primScatter(square.get(), "tris", "", density, 0, false, seed);
+    auto filtered = zeno::primScatter(square.get(), "tris", "", density, minRadius, false, seed);
+    ZENO_CHECK(candidates->verts.size() > 20000);
+
+    auto expected = serialDartThrowing(candidates->verts.values, minRadius);
+    ZENO_CHECK(filtered->verts.size() == expected.size());
+    ZENO_CHECK(std::equal(expected.begin(), expected.end(), filtered->verts.begin(), [] (auto const &a, auto const &b) {
+        return zeno::alltrue(a == b);
+    }));
+
+    // the parallel rounds must not favour cells of some parity
+    auto counts = phaseCounts(filtered->verts.values, minRadius);
+    auto [lo, hi] = std::minmax_element(counts.begin(), counts.end());
+    ZENO_CHECK(*hi < *lo * 1.1f);
+}
@@ -0,0 +1,52 @@
+#include "zenotest.h"
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <cmath>
+#include <vector>
+
+// a bent quad next to a triangle, plus one vertex no face uses; every triangle the quad is split
+// into counts once towards the smooth normals, like a triangle mesh would
+ZENO_TEST(primSepTrianglesWeighsQuadsAsTriangles) {
+    auto prim = std::make_shared<zeno::PrimitiveObject>();
+    prim->verts.resize(6);
+    prim->verts[0] = zeno::vec3f(0, 0, 0);
+    prim->verts[1] = zeno::vec3f(1, 0, 0);
+    prim->verts[2] = zeno::vec3f(1, 0.5f, 1);
+    prim->verts[3] = zeno::vec3f(0, 0, 1);
+    prim->verts[4] = zeno::vec3f(2, 1, 0);
+    prim->verts[5] = zeno::vec3f(5, 5, 5);
+    prim->quads.push_back(zeno::vec4i(0, 3, 2, 1));
+    prim->tris.push_back(zeno::vec3i(1, 2, 4));
+
+    std::vector<zeno::vec3i> tris{{1, 2, 4}, {0, 3, 2}, {0, 2, 1}};
+    std::vector<zeno::vec3f> expected(prim->verts.size());
+    for (auto const &t: tris) {
+        auto a = prim->verts[t[0]], b = prim->verts[t[1]], c = prim->verts[t[2]];
+        auto n = zeno::normalizeSafe(zeno::cross(b - a, c - a));
+        for (int j = 0; j < 3; j++)
+            expected[t[j]] += n;
+    }
+    for (auto &n: expected)
+        n = zeno::normalizeSafe(n);
+
+    zeno::primSepTriangles(prim.get(), true, false);
+    ZENO_CHECK(prim->verts.size() == tris.size() * 3);
+    auto const &nrm = prim->verts.attr<zeno::vec3f>("nrm");
+    for (size_t i = 0; i < tris.size(); i++) {
+        for (int j = 0; j < 3; j++)
+            ZENO_CHECK(zeno::length(nrm[i * 3 + j] - expected[tris[i][j]]) < 1e-5f);
+    }
+
+    // an isolated vertex gets a zero normal whether or not hard edges split the others
+    for (float hardAngle: {180.0f, 30.0f}) {
+        auto loose = std::make_shared<zeno::PrimitiveObject>();
+        loose->verts.resize(4);
+        loose->verts[1] = zeno::vec3f(1, 0, 0);
+        loose->verts[2] = zeno::vec3f(0, 1, 0);
+        loose->tris.push_back(zeno::vec3i(0, 1, 2));
+        zeno::primSmoothNormal(loose.get(), "nrm", "area", hardAngle, -1.0f);
+        auto const &lnrm = loose->verts.attr<zeno::vec3f>("nrm");
+        ZENO_CHECK(zeno::alltrue(lnrm[3] == zeno::vec3f(0)));
+        ZENO_CHECK(zeno::length(lnrm[0] - zeno::vec3f(0, 0, -1)) < 1e-6f);
+    }
+}
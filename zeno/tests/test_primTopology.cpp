@@ -0,0 +1,46 @@
+#include "zenotest.h"
+#include <zeno/funcs/PrimitiveTopology.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+// a closed fan around one pole vertex, plus a quad and a triangle on the rim edge 1-2, which is
+// then shared by three faces
+ZENO_TEST(primTopologyEdgesOfHighValenceFan) {
+    int n = 100000;
+    auto prim = std::make_shared<zeno::PrimitiveObject>();
+    prim->verts.resize(n + 3);
+    for (int i = 0; i < n; i++)
+        prim->tris.push_back(zeno::vec3i(0, 1 + i, 1 + (i + 1) % n));
+    prim->tris.push_back(zeno::vec3i(1, 2, n + 1));
+    prim->quads.push_back(zeno::vec4i(2, 1, n + 1, n + 2));
+
+    auto faceOnly = zeno::primTopology(prim.get(), false);
+    ZENO_CHECK(!faceOnly->hasEdges);
+    auto topo = zeno::primTopology(prim.get());
+    ZENO_CHECK(topo->hasEdges);
+    ZENO_CHECK(topo->vertCorners == faceOnly->vertCorners);
+    ZENO_CHECK(zeno::primTopology(prim.get(), false) == topo);
+
+    std::map<std::pair<int, int>, std::vector<int>> halfEdges;
+    for (int h = 0; h < topo->numCorners(); h++) {
+        int a = topo->corners[h], b = topo->dest(h);
+        halfEdges[{std::min(a, b), std::max(a, b)}].push_back(h);
+    }
+    ZENO_CHECK((int)topo->edges.size() == (int)halfEdges.size());
+    for (auto const &[key, hs]: halfEdges) {
+        int e = topo->cornerEdge[hs[0]];
+        ZENO_CHECK(topo->edgeValence[e] == (int)hs.size());
+        ZENO_CHECK(zeno::alltrue(topo->edges[e] == zeno::vec2i(topo->corners[hs[0]], topo->dest(hs[0]))));
+        ZENO_CHECK(topo->findEdge(key.second, key.first) == e);
+        for (int h: hs) {
+            ZENO_CHECK(topo->cornerEdge[h] == e);
+            ZENO_CHECK(topo->twin[h] == (hs.size() == 2 ? hs[0] + hs[1] - h : -1));
+        }
+    }
+    ZENO_CHECK(topo->edgeValence[topo->findEdge(1, 2)] == 3);
+    ZENO_CHECK(!topo->vertBoundary[0]);
+    ZENO_CHECK(topo->vertBoundary[n + 1]);
+}
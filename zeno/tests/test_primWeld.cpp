@@ -0,0 +1,65 @@
+#include "zenotest.h"
+#include <zeno/core/Graph.h>
+#include <zeno/core/Session.h>
+#include <zeno/funcs/LiterialConverter.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <memory>
+
+namespace {
+
+std::shared_ptr<zeno::PrimitiveObject> callPrimNode(std::string const &cls, std::map<std::string, zeno::zany> inputs) {
+    auto graph = zeno::getSession().createGraph();
+    auto outputs = graph->callTempNode(cls, std::move(inputs));
+    return zeno::safe_dynamic_cast<zeno::PrimitiveObject>(outputs.at("prim"));
+}
+
+}
+
+// a quad as two triangles, split into one vertex per corner and welded back by the original index
+ZENO_TEST(primSplitThenWeldRestoresQuad) {
+    auto prim = std::make_shared<zeno::PrimitiveObject>();
+    prim->verts.resize(4);
+    auto &weld = prim->verts.add_attr<int>("weld");
+    auto &val = prim->verts.add_attr<float>("val");
+    for (int i = 0; i < 4; i++) {
+        prim->verts[i] = zeno::vec3f(i & 1, 0, i >> 1);
+        weld[i] = 10 - i;
+        val[i] = i;
+    }
+    prim->tris.push_back(zeno::vec3i(0, 1, 3));
+    prim->tris.push_back(zeno::vec3i(0, 3, 2));
+
+    auto split = callPrimNode("PrimSplit", {{"prim", std::make_shared<zeno::PrimitiveObject>(*prim)}});
+    ZENO_CHECK(split->verts.size() == 6);
+    for (int c = 0; c < 6; c++) {
+        int v = prim->tris[c / 3][c % 3];
+        ZENO_CHECK(split->tris[c / 3][c % 3] == c);
+        ZENO_CHECK(zeno::alltrue(split->verts[c] == prim->verts[v]));
+        ZENO_CHECK(split->verts.attr<int>("weld")[c] == weld[v]);
+    }
+
+    // the first corner of each original vertex is kept, in the order they come
+    auto oneof = callPrimNode("PrimWeld", {{"prim", std::make_shared<zeno::PrimitiveObject>(*split)},
+                                           {"tagAttr", zeno::objectFromLiterial("weld")},
+                                           {"method", zeno::objectFromLiterial("oneof")}});
+    int firstOrder[4] = {0, 1, 3, 2};
+    ZENO_CHECK(oneof->verts.size() == 4);
+    for (int i = 0; i < 4; i++) {
+        ZENO_CHECK(zeno::alltrue(oneof->verts[i] == prim->verts[firstOrder[i]]));
+        ZENO_CHECK(oneof->verts.attr<float>("val")[i] == val[firstOrder[i]]);
+    }
+    ZENO_CHECK(zeno::alltrue(oneof->tris[0] == zeno::vec3i(0, 1, 2)));
+    ZENO_CHECK(zeno::alltrue(oneof->tris[1] == zeno::vec3i(0, 2, 3)));
+
+    // corners of the same vertex moved apart are averaged back, attributes with them
+    split->verts[0] += zeno::vec3f(0, 1, 0);
+    split->verts[3] -= zeno::vec3f(0, 1, 0);
+    split->verts.attr<float>("val")[4] = 5;
+    auto average = callPrimNode("PrimWeld", {{"prim", split},
+                                             {"tagAttr", zeno::objectFromLiterial("weld")},
+                                             {"method", zeno::objectFromLiterial("average")}});
+    ZENO_CHECK(average->verts.size() == 4);
+    for (int i = 0; i < 4; i++)
+        ZENO_CHECK(zeno::alltrue(average->verts[i] == prim->verts[firstOrder[i]]));
+    ZENO_CHECK(average->verts.attr<float>("val")[2] == 4);
+}
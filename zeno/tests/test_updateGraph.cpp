@@ -0,0 +1,59 @@
+#include "zenotest.h"
+#include <zeno/core/Graph.h>
+#include <zeno/core/INode.h>
+#include <zeno/core/Session.h>
+#include <zeno/extra/GlobalState.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <string>
+
+namespace {
+
+std::string translatedPointProgram(float offset) {
+    return R"([
+        ["addNode", "CreatePoint", "pt"],
+        ["setNodeParam", "pt", "x", 0.5],
+        ["setNodeParam", "pt", "y", 0.0],
+        ["setNodeParam", "pt", "z", 0.0],
+        ["completeNode", "pt"],
+        ["addNode", "PrimTranslate", "tr"],
+        ["bindNodeInput", "tr", "prim", "pt", "prim"],
+        ["setNodeInput", "tr", "offset", [)" + std::to_string(offset) + R"(, 0.0, 0.0]],
+        ["completeNode", "tr"]
+    ])";
+}
+
+float runAndGetX(zeno::Graph &graph, std::string const &node) {
+    graph.applyNodes({node});
+    auto prim = zeno::safe_dynamic_cast<zeno::PrimitiveObject>(graph.getNodeOutput(node, "prim"));
+    return prim->verts[0][0];
+}
+
+}
+
+// a node kept between runs must not see what its consumers did to its outputs last run
+ZENO_TEST(updateGraphReusedOutputsStayClean) {
+    auto graph = zeno::getSession().createGraph();
+    zeno::getSession().globalState->frameid = 0;
+    zeno::getSession().globalState->substepid = 0;
+
+    graph->updateGraph(translatedPointProgram(1).c_str());
+    ZENO_CHECK(runAndGetX(*graph, "tr") == 1.5f);
+    auto pt = graph->nodes.at("pt").get();
+
+    graph->updateGraph(translatedPointProgram(2).c_str());
+    ZENO_CHECK(graph->nodes.at("pt").get() == pt);
+    ZENO_CHECK(runAndGetX(*graph, "tr") == 2.5f);
+    // the translate handed its input on, from now on it works on a copy and the point is kept
+    auto ptOutput = graph->getNodeOutput("pt", "prim");
+
+    graph->updateGraph(translatedPointProgram(3).c_str());
+    ZENO_CHECK(runAndGetX(*graph, "tr") == 3.5f);
+    ZENO_CHECK(graph->getNodeOutput("pt", "prim") == ptOutput);
+    ZENO_CHECK(runAndGetX(*graph, "pt") == 0.5f);
+
+    // an unchanged program reuses everything
+    graph->updateGraph(translatedPointProgram(3).c_str());
+    auto before = graph->getNodeOutput("tr", "prim");
+    ZENO_CHECK(runAndGetX(*graph, "tr") == 3.5f);
+    ZENO_CHECK(graph->getNodeOutput("tr", "prim") == before);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace zeno::tests {
+
+struct TestCase {
+    const char *name;
+    void (*run)();
+};
+
+inline std::vector<TestCase> &testCases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char *name, void (*run)()) {
+        testCases().push_back({name, run});
+    }
+};
+
+struct TestFailure : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+}
+
+#define ZENO_TEST(name) \
+    static void zeno_test_##name(); \
+    static ::zeno::tests::TestRegistrar zeno_test_registrar_##name(#name, zeno_test_##name); \
+    static void zeno_test_##name()
+
+#define ZENO_CHECK(cond) do { \
+    if (!(cond)) \
+        throw ::zeno::tests::TestFailure(std::string(__FILE__) + ":" + std::to_string(__LINE__) + ": " #cond); \
+} while (0)
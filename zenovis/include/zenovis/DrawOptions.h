@@ -24,6 +24,13 @@ struct DrawOptions {
     int msaa_samples = 0;
     bool denoise = false;
     float viewportPointSizeScale = 1;
+    // per-object point and triangle budgets of the bate viewport, 0 draws everything; objects
+    // over them are drawn reduced until the camera rests
+    size_t viewportMaxPoints = 0;
+    size_t viewportMaxTris = 0;
+    // set by the viewport while it still draws reduced objects that a later frame will refine,
+    // or has objects still being prepared that a later frame will upload
+    bool viewportLodPending = false;
 
     std::shared_ptr<IGraphicHandler> handler;
 
@@ -45,6 +45,8 @@ struct Session : zeno::disable_copy {
     std::tuple<float, float, float> get_background_color();
     void set_num_samples(int num_samples);
     void set_viewport_point_size_scale(double scale);
+    void set_viewport_lod_budget(int maxPoints, int maxTris);
+    bool is_viewport_lod_pending();
     void set_enable_gi(bool enable_gi);
     void set_smooth_shading(bool smooth);
     void set_normal_check(bool check);
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <map>
+#include <set>
 #include <vector>
 #include <zeno/types/UserData.h>
 #include <zeno/utils/MapStablizer.h>
 #include <zeno/utils/PolymorphicMap.h>
 #include <zeno/utils/log.h>
+#include <zeno/types/PrimitiveObject.h>
 #include <zenovis/bate/IGraphic.h>
+#include <zenovis/bate/PrimitivePrep.h>
+#include <zenovis/DrawOptions.h>
 #include <zenovis/Scene.h>
 
 namespace zenovis {
@@ -18,6 +25,29 @@ struct GraphicsManager {
         std::string, std::unique_ptr<IGraphic>>>> graphics;
     zeno::PolymorphicMap<std::map<std::string, std::unique_ptr<IGraphic>>> realtime_graphics;
 
+    // prims drawn cut down to the viewport budget, and their full resolution once refine()
+    // has prepared it
+    struct Refinement {
+        std::shared_ptr<zeno::IObject> obj;
+        std::future<std::shared_ptr<PrimRenderData const>> full;
+        std::unique_ptr<IGraphicDraw> fullGraphic;
+    };
+    std::map<std::string, Refinement> refinements;
+    // preparations of prims no longer shown, kept until they finish so that dropping them
+    // never waits on a worker
+    std::vector<Refinement> retired;
+    // prims of a load_objects() pass being prepared on worker threads, upload_prepared()
+    // uploads them on a later frame once they are done
+    struct Preparing {
+        std::vector<std::pair<std::string, std::shared_ptr<zeno::IObject>>> objs;
+        std::future<std::vector<std::shared_ptr<PrimRenderData const>>> prepared;
+    };
+    std::vector<Preparing> preparing;
+    std::set<std::string> shown;
+    // graphics a load_objects() pass dropped while prims were still being prepared, drawn
+    // until upload_prepared() is done with every batch so no frame shows with them missing
+    std::vector<std::unique_ptr<IGraphic>> replaced;
+
     explicit GraphicsManager(Scene *scene) : scene(scene) {
     }
 
@@ -42,24 +72,147 @@ struct GraphicsManager {
     bool load_objects(std::vector<std::pair<std::string, std::shared_ptr<zeno::IObject>>> const &objs) {
         auto ins = graphics.insertPass();
         realtime_graphics.clear();
+        std::set<std::string> inFlight;
+        for (auto const &batch : preparing) {
+            for (auto const &[key, obj] : batch.objs)
+                inFlight.insert(key);
+        }
+        shown.clear();
+        Preparing batch;
         for (auto const &[key, obj] : objs) {
+            shown.insert(key);
             if (load_realtime_object(key, obj)) continue;
-            if (ins.may_emplace(key)) {
+            if (!ins.may_emplace(key) || inFlight.count(key)) continue;
+            // primitives are prepared on worker threads, the GL thread only uploads them
+            if (dynamic_cast<zeno::PrimitiveObject const *>(obj.get())) {
+                batch.objs.emplace_back(key, obj);
+                continue;
+            }
+            zeno::log_debug("load_object: loading graphics [{}]", key);
+            retire(key);
+            auto ig = makeGraphic(scene, obj.get());
+            zeno::log_debug("load_object: loaded graphics to {}", ig.get());
+            ig->nameid = key;
+            ig->objholder = obj;
+            ins.try_emplace(key, std::move(ig));
+        }
+        if (!batch.objs.empty()) {
+            RenderBudget budget;
+            budget.maxPoints = scene->drawOptions->viewportMaxPoints;
+            budget.maxTris = scene->drawOptions->viewportMaxTris;
+            batch.prepared = std::async(std::launch::async, [objs = batch.objs, budget] {
+                std::vector<zeno::PrimitiveObject const *> prims;
+                for (auto const &[key, obj] : objs)
+                    prims.push_back(static_cast<zeno::PrimitiveObject const *>(obj.get()));
+                return prepareRenderDataBatch(prims, true, budget);
+            });
+            preparing.push_back(std::move(batch));
+        }
+        std::vector<std::string> gone;
+        for (auto const &[key, ref] : refinements) {
+            if (!shown.count(key))
+                gone.push_back(key);
+        }
+        for (auto const &key : gone)
+            retire(key);
+        if (!preparing.empty()) {
+            // what the pass did not carry over is still owned by the current map
+            for (auto &[key, ig] : graphics.m_curr) {
+                if (ig)
+                    replaced.push_back(std::move(ig));
+            }
+        }
+        return ins.has_changed();
+    }
+
+    // Uploads the prims whose preparation is done, waiting for all of them with wait set.
+    // Returns whether any graphics were added.
+    bool upload_prepared(bool wait) {
+        bool uploaded = false;
+        for (auto &batch : preparing) {
+            if (!wait && batch.prepared.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                continue;
+            auto prepared = batch.prepared.get();
+            for (size_t i = 0; i < batch.objs.size(); i++) {
+                auto const &[key, obj] = batch.objs[i];
+                // dropped by a later load_objects() while it was being prepared
+                if (!shown.count(key) || graphics.find(key) != graphics.end())
+                    continue;
                 zeno::log_debug("load_object: loading graphics [{}]", key);
-                auto ig = makeGraphic(scene, obj.get());
+                retire(key);
+                if (prepared[i]->reduced)
+                    refinements[key].obj = obj;
+                auto ig = makeGraphicPrimitive(scene, std::move(prepared[i]));
                 zeno::log_debug("load_object: loaded graphics to {}", ig.get());
                 ig->nameid = key;
                 ig->objholder = obj;
-                ins.try_emplace(key, std::move(ig));
+                graphics.m_curr.try_emplace(key, std::move(ig));
+                uploaded = true;
             }
         }
-        return ins.has_changed();
+        preparing.erase(std::remove_if(preparing.begin(), preparing.end(), [] (Preparing const &batch) {
+            return !batch.prepared.valid();
+        }), preparing.end());
+        if (preparing.empty() && !replaced.empty()) {
+            replaced.clear();
+            uploaded = true;
+        }
+        return uploaded;
+    }
+
+    bool has_preparing() const {
+        return !preparing.empty();
+    }
+
+    void retire(std::string const &key) {
+        auto it = refinements.find(key);
+        if (it == refinements.end())
+            return;
+        if (it->second.full.valid())
+            retired.push_back(std::move(it->second));
+        refinements.erase(it);
+    }
+
+    // Starts preparing the full resolution of every reduced prim and uploads the ones that
+    // are done, waiting for all of them with wait set. Returns whether some are still left.
+    bool refine(bool wait) {
+        retired.erase(std::remove_if(retired.begin(), retired.end(), [] (Refinement const &r) {
+            return r.full.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }), retired.end());
+        bool pending = false;
+        for (auto &[key, ref] : refinements) {
+            if (ref.fullGraphic)
+                continue;
+            if (!ref.full.valid()) {
+                ref.full = std::async(std::launch::async, [obj = ref.obj] {
+                    return prepareRenderData(static_cast<zeno::PrimitiveObject const *>(obj.get()));
+                });
+            }
+            if (wait || ref.full.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                ref.fullGraphic = makeGraphicPrimitive(scene, ref.full.get());
+            else
+                pending = true;
+        }
+        return pending;
     }
 
-    void draw() {
+    bool has_reduced() const {
+        return !refinements.empty();
+    }
+
+    // refined draws the full resolution of the reduced prims that refine() has uploaded
+    void draw(bool refined = false) {
+        for (auto const &ig : replaced) {
+            if (auto gra = dynamic_cast<IGraphicDraw *>(ig.get()))
+                gra->draw();
+        }
         for (auto const &[key, gra] : graphics.pairs<IGraphicDraw>()) {
             // if (realtime_graphics.find(key) == realtime_graphics.end())
-            gra->draw();
+            auto it = refined ? refinements.find(key) : refinements.end();
+            if (it != refinements.end() && it->second.fullGraphic)
+                it->second.fullGraphic->draw();
+            else
+                gra->draw();
         }
         for (auto const &[key, gra] : realtime_graphics.pairs<IGraphicDraw>()) {
             gra->draw();
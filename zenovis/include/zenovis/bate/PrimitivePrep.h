@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <zeno/utils/vec.h>
+#include <zenovis/bate/IGraphic.h>
+
+namespace zenovis {
+
+// index and uv arrays shared by all prepared prims with the same faces
+struct PrimRenderTopo;
+
+// Everything the bate viewport uploads for a primitive. Built on the CPU without a GL
+// context, the GL thread only copies these arrays into buffers. Arrays are immutable and
+// shared between prepared prims whose inputs hash the same, so an array that is still the
+// same object needs no new upload.
+struct PrimRenderData {
+    template <class T>
+    using Array = std::shared_ptr<std::vector<T> const>;
+
+    enum { Pos, Clr, Nrm, Uv, Tang, NumVertAttrs };
+    using VertArrays = std::array<Array<zeno::vec3f>, NumVertAttrs>;
+
+    bool invisible = false;
+    bool customColor = false;
+    bool drawAllPoints = false;
+    // fewer points or triangles than the prim has, cut down to the viewport budget
+    bool reduced = false;
+
+    VertArrays verts;
+    Array<int> points;
+    Array<zeno::vec2i> lines;
+    Array<zeno::vec3i> tris;
+    // lines and tris carrying uvs are drawn from their own de-indexed arrays, null otherwise
+    VertArrays lineVerts;
+    VertArrays triVerts;
+
+    // outline of the polygons with more than three sides, drawn instead of the triangle edges;
+    // null when there is none
+    Array<int> polyEdges;
+    Array<zeno::vec3f> polyEdgeVerts;  // positions before subdivision
+    Array<int> polyUvEdges;
+    Array<zeno::vec3f> polyUvs;
+
+    std::shared_ptr<PrimRenderTopo const> topo;
+
+    size_t vertexCount() const {
+        return verts[Pos]->size();
+    }
+
+    size_t nbytes() const;
+};
+
+// Largest number of points and triangles the viewport draws of one prim, 0 for no limit.
+// A prim can bring its own limits in the "viewportMaxPoints" and "viewportMaxTris" user data.
+// Point clouds over the budget are subsampled, meshes over it are decimated by vertex
+// clustering; subdivided prims are always drawn whole.
+struct RenderBudget {
+    size_t maxPoints = 0;
+    size_t maxTris = 0;
+};
+
+// Triangulates, fills in normals, tangents and default attributes and de-indexes the faces
+// carrying uvs. prim is only read, it may be shared with other threads.
+// With cached set, the result and its arrays come from the viewport's render-prep cache
+// when the same content was prepared before, and only the attributes that changed are
+// rebuilt for a prim whose faces were seen before.
+std::shared_ptr<PrimRenderData const> prepareRenderData(zeno::PrimitiveObject const *prim, bool cached = true,
+                                                        RenderBudget const &budget = {});
+
+// prepareRenderData for every prim, spread over a pool of worker threads.
+std::vector<std::shared_ptr<PrimRenderData const>> prepareRenderDataBatch(
+    std::vector<zeno::PrimitiveObject const *> const &prims, bool cached = true, RenderBudget const &budget = {});
+
+// Bytes of prepared prims kept alive for scrubbing back, 0 keeps only what is displayed.
+void setRenderPrepCacheBudget(size_t maxBytes);
+
+std::unique_ptr<IGraphicDraw> makeGraphicPrimitive(Scene *scene, std::shared_ptr<PrimRenderData const> data);
+
+} // namespace zenovis
@@ -91,6 +91,15 @@ void Session::set_viewport_point_size_scale(double scale) {
     impl->scene->drawOptions->viewportPointSizeScale = scale;
 }
 
+void Session::set_viewport_lod_budget(int maxPoints, int maxTris) {
+    impl->scene->drawOptions->viewportMaxPoints = std::max(maxPoints, 0);
+    impl->scene->drawOptions->viewportMaxTris = std::max(maxTris, 0);
+}
+
+bool Session::is_viewport_lod_pending() {
+    return impl->scene->drawOptions->viewportLodPending;
+}
+
 void Session::set_normal_check(bool check) {
     impl->scene->drawOptions->normal_check = check;
 }
@@ -1,3 +1,4 @@
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -9,11 +10,11 @@
 #include <zeno/utils/orthonormal.h>
 #include <zeno/utils/ticktock.h>
 #include <zeno/utils/vec.h>
-#include <zeno/extra/TempNode.h>
 #include <zenovis/Camera.h>
 #include <zenovis/DrawOptions.h>
 #include <zenovis/Scene.h>
 #include <zenovis/bate/IGraphic.h>
+#include <zenovis/bate/PrimitivePrep.h>
 #include <zenovis/ShaderManager.h>
 #include <zenovis/opengl/buffer.h>
 #include <zenovis/opengl/shader.h>
@@ -25,8 +26,8 @@ namespace {
 using namespace opengl;
 
 struct ZhxxDrawObject {
-    std::vector<std::unique_ptr<Buffer>> vbos;
-    std::unique_ptr<Buffer> ebo;
+    std::vector<std::shared_ptr<Buffer>> vbos;
+    std::shared_ptr<Buffer> ebo;
     size_t count = 0;
     Program *prog{};
 };
@@ -59,119 +60,6 @@ static void parsePointsDrawBuffer(zeno::PrimitiveObject *prim, ZhxxDrawObject &o
 }
 #endif
 
-static void parseLinesDrawBuffer(zeno::PrimitiveObject *prim, ZhxxDrawObject &obj) {
-    auto const &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &clr = prim->attr<zeno::vec3f>("clr");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-    auto const &tang = prim->attr<zeno::vec3f>("tang");
-    auto const &lines = prim->lines;
-    obj.count = prim->lines.size();
-    obj.vbos.resize(5);
-    std::vector<zeno::vec2i> linesdata(obj.count);
-    std::vector<zeno::vec3f> _pos(obj.count * 2);
-    std::vector<zeno::vec3f> _clr(obj.count * 2);
-    std::vector<zeno::vec3f> _nrm(obj.count * 2);
-    std::vector<zeno::vec3f> _uv(obj.count * 2);
-    std::vector<zeno::vec3f> _tang(obj.count * 2);
-#pragma omp parallel for
-    for (auto i = 0; i < obj.count; i++) {
-        _pos[i * 2 + 0] = pos[lines[i][0]];
-        _pos[i * 2 + 1] = pos[lines[i][1]];
-
-        _clr[i * 2 + 0] = clr[lines[i][0]];
-        _clr[i * 2 + 1] = clr[lines[i][1]];
-
-        _nrm[i * 2 + 0] = nrm[lines[i][0]];
-        _nrm[i * 2 + 1] = nrm[lines[i][1]];
-
-        _tang[i * 2 + 0] = tang[lines[i][0]];
-        _tang[i * 2 + 1] = tang[lines[i][1]];
-
-        linesdata[i] = zeno::vec2i(i * 2, i * 2 + 1);
-    }
-    bool has_uv = lines.has_attr("uv0") && lines.has_attr("uv1");
-    if (has_uv) {
-        auto &uv0 = lines.attr<zeno::vec3f>("uv0");
-        auto &uv1 = lines.attr<zeno::vec3f>("uv1");
-        for (auto i = 0; i < obj.count; i++) {
-            _uv[i * 2 + 0] = uv0[i];
-            _uv[i * 2 + 1] = uv1[i];
-        }
-    }
-
-    obj.vbos[0] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[0]->bind_data(_pos.data(), _pos.size() * sizeof(_pos[0]));
-    obj.vbos[1] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[1]->bind_data(_clr.data(), _clr.size() * sizeof(_clr[0]));
-    obj.vbos[2] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[2]->bind_data(_nrm.data(), _nrm.size() * sizeof(_nrm[0]));
-    obj.vbos[3] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[3]->bind_data(_uv.data(), _uv.size() * sizeof(_uv[0]));
-    obj.vbos[4] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[4]->bind_data(_tang.data(), _tang.size() * sizeof(_tang[0]));
-
-    if (obj.count) {
-        obj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-        obj.ebo->bind_data(&(linesdata[0]), obj.count * sizeof(linesdata[0]));
-    }
-}
-
-static void computeTrianglesTangent(zeno::PrimitiveObject *prim) {
-    const auto &tris = prim->tris;
-    const auto &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-    auto &tang = prim->tris.add_attr<zeno::vec3f>("tang");
-    bool has_uv =
-        tris.has_attr("uv0") && tris.has_attr("uv1") && tris.has_attr("uv2");
-    //printf("!!has_uv = %d\n", has_uv);
-    const zeno::vec3f *uv0_data = nullptr;
-    const zeno::vec3f *uv1_data = nullptr;
-    const zeno::vec3f *uv2_data = nullptr;
-    if(has_uv)
-    {
-        uv0_data = tris.attr<zeno::vec3f>("uv0").data();
-        uv1_data = tris.attr<zeno::vec3f>("uv1").data();
-        uv2_data = tris.attr<zeno::vec3f>("uv2").data();
-    }
-#pragma omp parallel for
-    for (auto i = 0; i < prim->tris.size(); ++i) {
-        if (has_uv) {
-            const auto &pos0 = pos[tris[i][0]];
-            const auto &pos1 = pos[tris[i][1]];
-            const auto &pos2 = pos[tris[i][2]];
-            auto uv0 = uv0_data[i];
-            auto uv1 = uv1_data[i];
-            auto uv2 = uv2_data[i];
-
-            auto edge0 = pos1 - pos0;
-            auto edge1 = pos2 - pos0;
-            auto deltaUV0 = uv1 - uv0;
-            auto deltaUV1 = uv2 - uv0;
-
-            auto f = 1.0f / (deltaUV0[0] * deltaUV1[1] -
-                             deltaUV1[0] * deltaUV0[1] + 1e-5);
-
-            zeno::vec3f tangent;
-            tangent[0] = f * (deltaUV1[1] * edge0[0] - deltaUV0[1] * edge1[0]);
-            tangent[1] = f * (deltaUV1[1] * edge0[1] - deltaUV0[1] * edge1[1]);
-            tangent[2] = f * (deltaUV1[1] * edge0[2] - deltaUV0[1] * edge1[2]);
-            //printf("%f %f %f\n", tangent[0], tangent[1], tangent[3]);
-            auto tanlen = zeno::length(tangent);
-            tangent *(1.f / (tanlen + 1e-8));
-            /*if (std::abs(tanlen) < 1e-8) {//fix by BATE
-                zeno::vec3f n = nrm[tris[i][0]], unused;
-                zeno::pixarONB(n, tang[i], unused);//TODO calc this in shader?
-            } else {
-                tang[i] = tangent * (1.f / tanlen);
-            }*/
-            tang[i] = tangent;
-        } else {
-            tang[i] = zeno::vec3f(0);
-            //zeno::vec3f n = nrm[tris[i][0]], unused;
-            //zeno::pixarONB(n, tang[i], unused);
-        }
-    }
-}
 #if 0
 static void parseTrianglesDrawBufferCompress(zeno::PrimitiveObject *prim, ZhxxDrawObject &obj) {
     //TICK(parse);
@@ -257,78 +145,37 @@ static void parseTrianglesDrawBufferCompress(zeno::PrimitiveObject *prim, ZhxxDr
     /* TOCK(bindebo); */
 }
 #endif
-static void parseTrianglesDrawBuffer(zeno::PrimitiveObject *prim, ZhxxDrawObject &obj) {
-    /* TICK(parse); */
-    auto const &pos = prim->attr<zeno::vec3f>("pos");
-    auto const &clr = prim->attr<zeno::vec3f>("clr");
-    auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-    auto const &tris = prim->tris;
-
-    obj.count = tris.size();
-    obj.vbos.resize(5);
-    std::vector<zeno::vec3i> trisdata(obj.count);
-    auto &tang = prim->tris.attr<zeno::vec3f>("tang");
-    std::vector<zeno::vec3f> _pos(obj.count * 3);
-    std::vector<zeno::vec3f> _clr(obj.count * 3);
-    std::vector<zeno::vec3f> _nrm(obj.count * 3);
-    std::vector<zeno::vec3f> _uv(obj.count * 3);
-    std::vector<zeno::vec3f> _tang(obj.count * 3);
-
-#pragma omp parallel for
-    for (auto i = 0; i < obj.count; i++) {
-        _pos[i * 3 + 0] = pos[tris[i][0]];
-        _pos[i * 3 + 1] = pos[tris[i][1]];
-        _pos[i * 3 + 2] = pos[tris[i][2]];
-
-        _clr[i * 3 + 0] = clr[tris[i][0]];
-        _clr[i * 3 + 1] = clr[tris[i][1]];
-        _clr[i * 3 + 2] = clr[tris[i][2]];
-
-        _nrm[i * 3 + 0] = nrm[tris[i][0]];
-        _nrm[i * 3 + 1] = nrm[tris[i][1]];
-        _nrm[i * 3 + 2] = nrm[tris[i][2]];
-
-        _tang[i * 3 + 0] = tang[i];
-        _tang[i * 3 + 1] = tang[i];
-        _tang[i * 3 + 2] = tang[i];
-
-        trisdata[i] = zeno::vec3i(i * 3, i * 3 + 1, i * 3 + 2);
+// GL buffers of the prepared arrays still drawn by some graphic of the scene. Arrays left
+// unchanged by the next frame are the same objects and keep their buffers, only the
+// changed ones get uploaded.
+template <class T>
+std::shared_ptr<Buffer> sharedBuffer(Scene *scene, GLuint target, PrimRenderData::Array<T> const &arr) {
+    static std::map<std::pair<Scene *, void const *>, std::pair<std::weak_ptr<void const>, std::weak_ptr<Buffer>>> buffers;
+    static size_t sweepAt = 256;
+    auto &slot = buffers[{scene, arr.get()}];
+    // an alive array at the address is this very array, an expired one was a different array
+    if (!slot.first.expired()) {
+        if (auto buf = slot.second.lock())
+            return buf;
     }
-    bool has_uv =
-            tris.has_attr("uv0") && tris.has_attr("uv1") && tris.has_attr("uv2");
-    if (has_uv) {
-        auto &uv0 = tris.attr<zeno::vec3f>("uv0");
-        auto &uv1 = tris.attr<zeno::vec3f>("uv1");
-        auto &uv2 = tris.attr<zeno::vec3f>("uv2");
-        for (auto i = 0; i < obj.count; i++) {
-            _uv[i * 3 + 0] = uv0[i];
-            _uv[i * 3 + 1] = uv1[i];
-            _uv[i * 3 + 2] = uv2[i];
+    auto buf = std::make_shared<Buffer>(target);
+    buf->bind_data(arr->data(), arr->size() * sizeof(T));
+    slot = {arr, buf};
+    if (buffers.size() >= sweepAt) {
+        for (auto it = buffers.begin(); it != buffers.end();) {
+            if (it->second.first.expired() || it->second.second.expired())
+                it = buffers.erase(it);
+            else
+                ++it;
         }
+        sweepAt = std::max<size_t>(256, buffers.size() * 2);
     }
-
-    obj.vbos[0] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[0]->bind_data(_pos.data(), _pos.size() * sizeof(_pos[0]));
-    obj.vbos[1] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[1]->bind_data(_clr.data(), _clr.size() * sizeof(_clr[0]));
-    obj.vbos[2] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[2]->bind_data(_nrm.data(), _nrm.size() * sizeof(_nrm[0]));
-    obj.vbos[3] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[3]->bind_data(_uv.data(), _uv.size() * sizeof(_uv[0]));
-    obj.vbos[4] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-    obj.vbos[4]->bind_data(_tang.data(), _tang.size() * sizeof(_tang[0]));
-    /* TOCK(bindvbo); */
-    /* TICK(bindebo); */
-    if (obj.count) {
-        obj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-        obj.ebo->bind_data(&(trisdata[0]), obj.count * sizeof(trisdata[0]));
-    }
-    /* TOCK(bindebo); */
+    return buf;
 }
 
 struct ZhxxGraphicPrimitive final : IGraphicDraw {
     Scene *scene;
-    std::vector<std::unique_ptr<Buffer>> vbos = std::vector<std::unique_ptr<Buffer>>(5);
+    std::vector<std::shared_ptr<Buffer>> vbos = std::vector<std::shared_ptr<Buffer>>(5);
     size_t vertex_count;
     bool draw_all_points;
 
@@ -351,273 +198,75 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
     ZhxxDrawObject lineObj;
     ZhxxDrawObject triObj;
     std::vector<std::unique_ptr<Texture>> textures;
-    std::shared_ptr<zeno::PrimitiveObject> primUnique;
-    zeno::PrimitiveObject *prim;
 
     ZhxxDrawObject polyEdgeObj = {};
     ZhxxDrawObject polyUvObj = {};
-
-    explicit ZhxxGraphicPrimitive(Scene *scene_, zeno::PrimitiveObject *primArg)
-        : scene(scene_), primUnique(std::make_shared<zeno::PrimitiveObject>(*primArg)) {
-        prim = primUnique.get();
-        invisible = prim->userData().get2<bool>("invisible", 0);
-        zeno::log_trace("rendering primitive size {}", prim->size());
-
-        {
-            bool any_not_triangle = false;
-            for (const auto &[b, c]: prim->polys) {
-                if (c > 3) {
-                    any_not_triangle = true;
-                }
-            }
-            if (any_not_triangle) {
-                std::vector<int> edge_list;
-                auto add_edge = [&](int a, int b) {
-                    int p0 = prim->loops[a];
-                    int p1 = prim->loops[b];
-                    edge_list.push_back(p0);
-                    edge_list.push_back(p1);
-                };
-                for (const auto &[b, c]: prim->polys) {
-                    for (auto i = 2; i < c; i++) {
-                        if (i == 2) {
-                            add_edge(b, b + 1);
-                        }
-                        add_edge(b + i - 1, b + i);
-                        if (i == c - 1) {
-                            add_edge(b, b + i);
-                        }
-                    }
-                }
-                polyEdgeObj.count = edge_list.size();
-                polyEdgeObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-                polyEdgeObj.ebo->bind_data(edge_list.data(), edge_list.size() * sizeof(edge_list[0]));
-                auto vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-                vbo->bind_data(prim->verts.data(), prim->verts.size() * sizeof(prim->verts[0]));
-                polyEdgeObj.vbos.push_back(std::move(vbo));
-                polyEdgeObj.prog = get_edge_program();
-            }
-            if (any_not_triangle && prim->loops.attr_is<int>("uvs")) {
-                std::vector<zeno::vec3f> uv_data;
-                std::vector<int> uv_list;
-                auto &uvs = prim->loops.attr<int>("uvs");
-                auto add_uv = [&](int a, int b) {
-                    int p0 = uvs[a];
-                    int p1 = uvs[b];
-                    uv_list.push_back(p0);
-                    uv_list.push_back(p1);
-                };
-                for (const auto &[b, c]: prim->polys) {
-                    for (auto i = 2; i < c; i++) {
-                        if (i == 2) {
-                            add_uv(b, b + 1);
-                        }
-                        add_uv(b + i - 1, b + i);
-                        if (i == c - 1) {
-                            add_uv(b, b + i);
-                        }
-                    }
-                }
-                polyUvObj.count = uv_list.size();
-                polyUvObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-                polyUvObj.ebo->bind_data(uv_list.data(), uv_list.size() * sizeof(uv_list[0]));
-                auto vbo = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-                for (const auto &uv: prim->uvs) {
-                    uv_data.emplace_back(uv[0], uv[1], 0);
-                }
-                vbo->bind_data(uv_data.data(), uv_data.size() * sizeof(uv_data[0]));
-                polyUvObj.vbos.push_back(std::move(vbo));
-                polyUvObj.prog = get_edge_program();
-            }
-        }
-
-        if (!prim->attr_is<zeno::vec3f>("pos")) {
-            auto &pos = prim->add_attr<zeno::vec3f>("pos");
-            for (size_t i = 0; i < pos.size(); i++) {
-                pos[i] = zeno::vec3f(i * (1.0f / (pos.size() - 1)), 0, 0);
-            }
-        }
-        custom_color = prim->attr_is<zeno::vec3f>("clr");
-        if (!prim->attr_is<zeno::vec3f>("clr")) {
-            auto &clr = prim->add_attr<zeno::vec3f>("clr");
-            zeno::vec3f clr0(1.0f);
-            if (!prim->tris.size() && !prim->quads.size() && !prim->polys.size()) {
-                if (prim->lines.size())
-                    clr0 = {1.0f, 0.6f, 0.2f};
-                else
-                    clr0 = {0.2f, 0.6f, 1.0f};
-            }
-            std::fill(clr.begin(), clr.end(), clr0);
-        }
-#if 1
-        bool primNormalCorrect =
-            prim->attr_is<zeno::vec3f>("nrm") &&
-            (!prim->attr<zeno::vec3f>("nrm").size() ||
-             length(prim->attr<zeno::vec3f>("nrm")[0]) > 1e-5);
-        bool need_computeNormal =
-            !primNormalCorrect || !(prim->attr_is<zeno::vec3f>("nrm"));
-        bool thePrmHasFaces = !(!prim->tris.size() && !prim->quads.size() && !prim->polys.size());
-        if (thePrmHasFaces && need_computeNormal) {
-            /* std::cout << "computing normal\n"; */
-            zeno::log_trace("computing normal");
-            zeno::primCalcNormal(&*prim, 1);
-        }
-        if (int subdlevs = prim->userData().get2<int>("delayedSubdivLevels", 0)) {
-            // todo: zhxx, should comp normal after subd or before?
-            zeno::log_trace("computing subdiv {}", subdlevs);
-            (void)zeno::TempNodeSimpleCaller("OSDPrimSubdiv")
-                .set("prim", primUnique)
-                .set2<int>("levels", subdlevs)
-                .set2<std::string>("edgeCreaseAttr", "")
-                .set2<bool>("triangulate", false)
-                .set2<bool>("asQuadFaces", true)
-                .set2<bool>("hasLoopUVs", true)
-                .set2<bool>("delayTillIpc", false)
-                .call();  // will inplace subdiv prim
-            prim->userData().del("delayedSubdivLevels");
+    // holding the arrays lets the next frame find their buffers in sharedBuffer
+    std::shared_ptr<PrimRenderData const> prepared;
+
+    // only uploads here, everything else was done by prepareRenderData off the GL thread
+    explicit ZhxxGraphicPrimitive(Scene *scene_, std::shared_ptr<PrimRenderData const> data)
+        : scene(scene_), prepared(data) {
+        invisible = data->invisible;
+        custom_color = data->customColor;
+
+        if (data->polyEdges) {
+            polyEdgeObj.count = data->polyEdges->size();
+            polyEdgeObj.ebo = sharedBuffer(scene, GL_ELEMENT_ARRAY_BUFFER, data->polyEdges);
+            polyEdgeObj.vbos.push_back(sharedBuffer(scene, GL_ARRAY_BUFFER, data->polyEdgeVerts));
+            polyEdgeObj.prog = get_edge_program();
         }
-        if (thePrmHasFaces) {
-            zeno::log_trace("demoting faces");
-            zeno::primTriangulateQuads(&*prim);
-            zeno::primTriangulate(&*prim);//will further loop.attr("uv") to tris.attr("uv0")...
+        if (data->polyUvEdges) {
+            polyUvObj.count = data->polyUvEdges->size();
+            polyUvObj.ebo = sharedBuffer(scene, GL_ELEMENT_ARRAY_BUFFER, data->polyUvEdges);
+            polyUvObj.vbos.push_back(sharedBuffer(scene, GL_ARRAY_BUFFER, data->polyUvs));
+            polyUvObj.prog = get_edge_program();
         }
-#else
-        zeno::primSepTriangles(&*prim, true, true);//TODO: rm keepTriFaces
-#endif
-        /* BEGIN TODO */
-        //if (!prim->has_attr("nrm")) {
-        if (!thePrmHasFaces) {
-            if (prim->attr_is<float>("rad")) {
-                if (prim->attr_is<float>("opa")) {
-                    auto &rad = prim->attr<float>("rad");
-                    auto &opa = prim->attr<float>("opa");
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(rad[i], opa[i], 0.0f);
-                    }
-                } else {
-                    auto &rad = prim->attr<float>("rad");
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(rad[i], 0.0f, 0.0f);
-                    }
-                }
-            } else {
-                if (prim->attr_is<float>("opa")) {
-                    auto &opa = prim->attr<float>("opa");
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(1.0f, opa[i], 0.0f);
-                    }
-                } else {
-                    auto &radopa = prim->add_attr<zeno::vec3f>("nrm");
-                    for (size_t i = 0; i < radopa.size(); i++) {
-                        radopa[i] = zeno::vec3f(1.0f, 0.0f, 0.0f);
-                    }
-                }
-            }
-        } else {
-        }
-            //} else if (prim->tris.size()) {
-                //// for (size_t i = 0; i < radopa.size(); i++) {
-                ////     radopa[i] = zeno::vec3f(1 / zeno::sqrt(3.0f));
-                //// }
-                //for (size_t i = 0; i < radopa.size(); i++) {
-                    //radopa[i] = zeno::vec3f(0.0f);
-                //}
-
-            //} else {
-                //for (size_t i = 0; i < radopa.size(); i++) {
-                    //radopa[i] = zeno::vec3f(1.5f, 0.0f, 0.0f);
-                //}
-            //}
-        //}
-        /* END TODO */
-        if (!prim->attr_is<zeno::vec3f>("nrm")) {
-            auto &nrm = prim->add_attr<zeno::vec3f>("nrm");
-            std::fill(nrm.begin(), nrm.end(), zeno::vec3f(1.0f, 0.0f, 0.0f));
-        }
-        if (!prim->attr_is<zeno::vec3f>("uv")) {
-            auto &uv = prim->add_attr<zeno::vec3f>("uv");
-            std::fill(uv.begin(), uv.end(), zeno::vec3f(0.0f));
-        }
-        if (!prim->attr_is<zeno::vec3f>("tang")) {
-            auto &tang = prim->add_attr<zeno::vec3f>("tang");
-            std::fill(tang.begin(), tang.end(), zeno::vec3f(0.0f));
-        }
-        bool enable_uv = false;
-
-        auto const &pos = prim->attr<zeno::vec3f>("pos");
-        auto const &clr = prim->attr<zeno::vec3f>("clr");
-        auto const &nrm = prim->attr<zeno::vec3f>("nrm");
-        auto const &uv = prim->attr<zeno::vec3f>("uv");
-        auto const &tang = prim->attr<zeno::vec3f>("tang");
-        vertex_count = prim->size();
-
-        vbos[0] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-        vbos[0]->bind_data(pos.data(), pos.size() * sizeof(pos[0]));
-        vbos[1] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-        vbos[1]->bind_data(clr.data(), clr.size() * sizeof(clr[0]));
-        vbos[2] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-        vbos[2]->bind_data(nrm.data(), nrm.size() * sizeof(nrm[0]));
-        vbos[3] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-        vbos[3]->bind_data(uv.data(), uv.size() * sizeof(uv[0]));
-        vbos[4] = std::make_unique<Buffer>(GL_ARRAY_BUFFER);
-        vbos[4]->bind_data(tang.data(), tang.size() * sizeof(tang[0]));
-
-        points_count = prim->points.size();
+
+        vertex_count = data->vertexCount();
+        bind_verts(vbos, data->verts);
+
+        points_count = data->points->size();
         if (points_count) {
             pointObj.count = points_count;
-            pointObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-            pointObj.ebo->bind_data(prim->points.data(),
-                                    points_count * sizeof(prim->points[0]));
+            pointObj.ebo = sharedBuffer(scene, GL_ELEMENT_ARRAY_BUFFER, data->points);
             pointObj.prog = get_points_program();
         }
 
-        lines_count = prim->lines.size();
+        lines_count = data->lines->size();
         if (lines_count) {
-            // lines_ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-            // lines_ebo->bind_data(prim->lines.data(), lines_count * sizeof(prim->lines[0]));
-            // lines_prog = get_lines_program();
-            if (!(prim->lines.has_attr("uv0") && prim->lines.has_attr("uv1"))) {
-                lineObj.count = lines_count;
-                lineObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-                lineObj.ebo->bind_data(prim->lines.data(),
-                                       lines_count * sizeof(prim->lines[0]));
-            } else {
-                parseLinesDrawBuffer(&*prim, lineObj);
+            lineObj.count = lines_count;
+            lineObj.ebo = sharedBuffer(scene, GL_ELEMENT_ARRAY_BUFFER, data->lines);
+            if (data->lineVerts[PrimRenderData::Pos]) {
+                lineObj.vbos.resize(PrimRenderData::NumVertAttrs);
+                bind_verts(lineObj.vbos, data->lineVerts);
             }
             lineObj.prog = get_lines_program();
         }
 
-        tris_count = prim->tris.size();
+        tris_count = data->tris->size();
         if (tris_count) {
-            if (!(prim->tris.has_attr("uv0") && prim->tris.has_attr("uv1") &&
-                  prim->tris.has_attr("uv2"))) {
-                triObj.count = tris_count;
-                triObj.ebo = std::make_unique<Buffer>(GL_ELEMENT_ARRAY_BUFFER);
-                triObj.ebo->bind_data(prim->tris.data(),
-                                      tris_count * sizeof(prim->tris[0]));
-
-            } else {
-                computeTrianglesTangent(&*prim);
-                parseTrianglesDrawBuffer(&*prim, triObj);
+            triObj.count = tris_count;
+            triObj.ebo = sharedBuffer(scene, GL_ELEMENT_ARRAY_BUFFER, data->tris);
+            if (data->triVerts[PrimRenderData::Pos]) {
+                triObj.vbos.resize(PrimRenderData::NumVertAttrs);
+                bind_verts(triObj.vbos, data->triVerts);
             }
-
-            bool findCamera = false;
             triObj.prog = get_tris_program();
         }
 
-        draw_all_points = !points_count && !lines_count && !tris_count;
-        auto& ud = prim->userData();
-        if (ud.get2<int>("isImage", 0)) {
-            draw_all_points = false;
-        }
+        draw_all_points = data->drawAllPoints;
         if (draw_all_points) {
             pointObj.prog = get_points_program();
         }
     }
 
+    void bind_verts(std::vector<std::shared_ptr<Buffer>> &vbos, PrimRenderData::VertArrays const &arrs) {
+        for (size_t i = 0; i < arrs.size(); i++) {
+            vbos[i] = sharedBuffer(scene, GL_ARRAY_BUFFER, arrs[i]);
+        }
+    }
+
     virtual void draw() override {
         bool selected = scene->selected.count(nameid) > 0;
         if (scene->drawOptions->uv_mode && !selected) {
@@ -826,8 +475,12 @@ struct ZhxxGraphicPrimitive final : IGraphicDraw {
 
 }
 
+std::unique_ptr<IGraphicDraw> makeGraphicPrimitive(Scene *scene, std::shared_ptr<PrimRenderData const> data) {
+    return std::make_unique<ZhxxGraphicPrimitive>(scene, std::move(data));
+}
+
 void MakeGraphicVisitor::visit(zeno::PrimitiveObject *obj) {
-     this->out_result = std::make_unique<ZhxxGraphicPrimitive>(this->in_scene, obj);
+     this->out_result = makeGraphicPrimitive(this->in_scene, prepareRenderData(obj));
 }
 
 } // namespace zenovis
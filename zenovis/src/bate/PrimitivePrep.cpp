@@ -0,0 +1,1134 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <zeno/zeno.h>
+#include <zeno/core/INode.h>
+#include <zeno/extra/TempNode.h>
+#include <zeno/funcs/PrimitiveCompact.h>
+#include <zeno/funcs/PrimitiveUtils.h>
+#include <zeno/types/NumericObject.h>
+#include <zeno/types/PrimitiveObject.h>
+#include <zeno/types/UserData.h>
+#include <zeno/utils/log.h>
+#include <zenovis/bate/PrimitivePrep.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace zenovis {
+
+template <class T>
+using Array = PrimRenderData::Array<T>;
+
+struct PrimRenderTopo {
+    size_t numVerts = 0;
+    bool hasFaces = false;
+    Array<int> points;
+    Array<zeno::vec2i> lines;
+    Array<zeno::vec3i> tris;
+    // vertex ids behind the de-indexed lines and tris, null when those are drawn indexed
+    Array<zeno::vec2i> lineCorners;
+    Array<zeno::vec3i> triCorners;
+    Array<zeno::vec3f> lineUvs;
+    Array<zeno::vec3f> triUvs;
+    Array<int> polyEdges;
+    Array<int> polyUvEdges;
+    Array<zeno::vec3f> polyUvs;
+
+    // the faces before triangulation, normals are computed on them so that the topology
+    // primCalcNormal caches in the prim is reused from frame to frame
+    mutable std::mutex normalMtx;
+    mutable std::shared_ptr<zeno::PrimitiveObject> normalPrim;
+};
+
+size_t PrimRenderData::nbytes() const {
+    size_t n = 0;
+    auto add = [&] (auto const &arr) {
+        if (arr)
+            n += arr->size() * sizeof(typename std::decay_t<decltype(*arr)>::value_type);
+    };
+    for (auto const *arrs: {&verts, &lineVerts, &triVerts}) {
+        for (auto const &arr: *arrs)
+            add(arr);
+    }
+    add(points);
+    add(lines);
+    add(tris);
+    add(polyEdges);
+    add(polyEdgeVerts);
+    add(polyUvEdges);
+    add(polyUvs);
+    return n;
+}
+
+namespace {
+
+uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t combine(uint64_t h, uint64_t v) {
+    return mix64(h ^ (v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)));
+}
+
+// chunks are hashed in parallel, the chunk size is fixed so the hash is too
+uint64_t hashBytes(void const *data, size_t size, uint64_t seed) {
+    constexpr std::ptrdiff_t kChunk = 1 << 20;
+    auto bytes = static_cast<unsigned char const *>(data);
+    std::ptrdiff_t nchunks = (size + kChunk - 1) / kChunk;
+    std::vector<uint64_t> chunkHashes(nchunks);
+#pragma omp parallel for
+    for (std::ptrdiff_t c = 0; c < nchunks; c++) {
+        auto p = bytes + c * kChunk;
+        size_t n = std::min<size_t>(kChunk, size - c * kChunk);
+        uint64_t h = 0x9e3779b97f4a7c15ull * (c + 1);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            h = (h ^ mix64(w)) * 0x100000001b3ull;
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, p + i, n - i);
+        chunkHashes[c] = mix64(h ^ tail ^ n);
+    }
+    uint64_t h = mix64(seed ^ size);
+    for (auto ch: chunkHashes)
+        h = combine(h, ch);
+    return h;
+}
+
+template <class T>
+uint64_t hashArray(std::vector<T> const &arr, uint64_t seed) {
+    return hashBytes(arr.data(), arr.size() * sizeof(T), seed);
+}
+
+// 0 when the attribute is missing or not of the type the viewport reads
+template <class T, class AttrVec>
+uint64_t hashAttr(AttrVec const &vec, const char *name) {
+    if (!vec.template attr_is<T>(name))
+        return 0;
+    return hashArray(vec.template attr<T>(name), std::hash<std::string>()(name));
+}
+
+// hashes of everything prepareRenderData reads from a prim
+struct SourceKeys {
+    uint64_t topo = 0;
+    uint64_t pos = 0, clr = 0, nrm = 0, uv = 0, tang = 0, rad = 0, opa = 0;
+
+    uint64_t full(bool invisible, bool isImage) const {
+        uint64_t h = combine(topo, invisible * 2 + isImage);
+        for (auto k: {pos, clr, nrm, uv, tang, rad, opa})
+            h = combine(h, k);
+        return h;
+    }
+};
+
+SourceKeys sourceKeys(zeno::PrimitiveObject const *prim, int subdlevs) {
+    SourceKeys k;
+    uint64_t h = combine(mix64(prim->verts.size()), subdlevs);
+    h = hashArray(prim->points.values, h);
+    h = hashArray(prim->lines.values, h);
+    h = hashArray(prim->tris.values, h);
+    h = hashArray(prim->quads.values, h);
+    h = hashArray(prim->polys.values, h);
+    h = hashArray(prim->loops.values, h);
+    h = hashArray(prim->uvs.values, h);
+    h = combine(h, hashAttr<int>(prim->loops, "uvs"));
+    for (auto name: {"uv0", "uv1"})
+        h = combine(h, hashAttr<zeno::vec3f>(prim->lines, name));
+    for (auto name: {"uv0", "uv1", "uv2"})
+        h = combine(h, hashAttr<zeno::vec3f>(prim->tris, name));
+    k.topo = h;
+    k.pos = hashArray(prim->verts.values, 1);
+    k.clr = hashAttr<zeno::vec3f>(prim->verts, "clr");
+    k.nrm = hashAttr<zeno::vec3f>(prim->verts, "nrm");
+    k.uv = hashAttr<zeno::vec3f>(prim->verts, "uv");
+    k.tang = hashAttr<zeno::vec3f>(prim->verts, "tang");
+    k.rad = hashAttr<float>(prim->verts, "rad");
+    k.opa = hashAttr<float>(prim->verts, "opa");
+    return k;
+}
+
+// what a derived array was computed by, keeps the keys of different arrays apart
+enum ArrayKind : uint64_t {
+    kPos = 1,
+    kClr,
+    kDefaultClr,
+    kNrm,
+    kCalcNrm,
+    kRadOpa,
+    kUv,
+    kTang,
+    kZeros,
+    kLineGather,
+    kTriGather,
+    kTriTang,
+};
+
+// Prepared prims of the viewport by content. Derived arrays and topologies are found by key
+// while any prepared prim still holds them; the LRU keeps recent prims alive for scrubbing
+// back to a frame just shown.
+struct RenderPrepCache {
+    std::mutex mtx;
+    std::map<uint64_t, std::weak_ptr<void const>> arrays;
+    std::map<uint64_t, std::weak_ptr<PrimRenderTopo const>> topos;
+    size_t sweepAt = 256;
+
+    std::list<std::pair<uint64_t, std::shared_ptr<PrimRenderData const>>> lru;
+    std::unordered_map<uint64_t, decltype(lru)::iterator> lruIndex;
+    size_t lruBytes = 0;
+    size_t maxBytes = size_t(512) << 20;
+
+    template <class T>
+    std::shared_ptr<T const> find(std::map<uint64_t, std::weak_ptr<T const>> &map, uint64_t key) {
+        std::lock_guard lck(mtx);
+        auto it = map.find(key);
+        return it != map.end() ? it->second.lock() : nullptr;
+    }
+
+    // the first of concurrent inserts wins, the others drop their copy
+    template <class T>
+    std::shared_ptr<T const> insert(std::map<uint64_t, std::weak_ptr<T const>> &map, uint64_t key,
+                                    std::shared_ptr<T const> val) {
+        std::lock_guard lck(mtx);
+        auto &slot = map[key];
+        if (auto other = slot.lock())
+            return other;
+        slot = val;
+        if (arrays.size() + topos.size() >= sweepAt) {
+            sweep(arrays);
+            sweep(topos);
+            sweepAt = std::max<size_t>(256, (arrays.size() + topos.size()) * 2);
+        }
+        return val;
+    }
+
+    template <class Map>
+    static void sweep(Map &map) {
+        for (auto it = map.begin(); it != map.end();) {
+            if (it->second.expired())
+                it = map.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    std::shared_ptr<PrimRenderData const> lookup(uint64_t key) {
+        std::lock_guard lck(mtx);
+        auto it = lruIndex.find(key);
+        if (it == lruIndex.end())
+            return nullptr;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+
+    void remember(uint64_t key, std::shared_ptr<PrimRenderData const> data) {
+        size_t nbytes = data->nbytes();
+        std::lock_guard lck(mtx);
+        if (nbytes > maxBytes || lruIndex.count(key))
+            return;
+        lru.emplace_front(key, std::move(data));
+        lruIndex.emplace(key, lru.begin());
+        lruBytes += nbytes;
+        evict();
+    }
+
+    void evict() {
+        while (lruBytes > maxBytes && !lru.empty()) {
+            lruBytes -= lru.back().second->nbytes();
+            lruIndex.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+};
+
+RenderPrepCache &renderPrepCache() {
+    static RenderPrepCache cache;
+    return cache;
+}
+
+// the array for key, computed only when no prepared prim holds it already
+template <class T, class F>
+Array<T> sharedArray(RenderPrepCache *cache, uint64_t key, F const &compute) {
+    if (!cache)
+        return std::make_shared<std::vector<T> const>(compute());
+    if (auto arr = cache->find(cache->arrays, key))
+        return std::static_pointer_cast<std::vector<T> const>(arr);
+    Array<T> arr = std::make_shared<std::vector<T> const>(compute());
+    return std::static_pointer_cast<std::vector<T> const>(cache->insert<void>(cache->arrays, key, arr));
+}
+
+template <class T>
+Array<T> makeArray(std::vector<T> &&arr) {
+    return std::make_shared<std::vector<T> const>(std::move(arr));
+}
+
+template <class AttrVec>
+void copyAttrs(AttrVec &dst, AttrVec const &src, std::initializer_list<const char *> names) {
+    for (auto name: names) {
+        auto it = src.attrs.find(name);
+        if (it != src.attrs.end())
+            dst.attrs[name] = it->second;
+    }
+}
+
+// copies what the viewport draws, the other attributes never leave the source prim
+std::shared_ptr<zeno::PrimitiveObject> renderCopy(zeno::PrimitiveObject const *prim, bool withVerts) {
+    auto res = std::make_shared<zeno::PrimitiveObject>();
+    if (withVerts) {
+        res->verts.values = prim->verts.values;
+        copyAttrs(res->verts, prim->verts, {"clr", "nrm", "uv", "tang", "rad", "opa"});
+    } else {
+        res->verts.resize(prim->verts.size());
+    }
+    res->points.values = prim->points.values;
+    res->lines.values = prim->lines.values;
+    copyAttrs(res->lines, prim->lines, {"uv0", "uv1"});
+    res->tris.values = prim->tris.values;
+    copyAttrs(res->tris, prim->tris, {"uv0", "uv1", "uv2"});
+    res->quads.values = prim->quads.values;
+    res->polys.values = prim->polys.values;
+    res->loops.values = prim->loops.values;
+    copyAttrs(res->loops, prim->loops, {"uvs"});
+    res->uvs.values = prim->uvs.values;
+    return res;
+}
+
+template <class F>
+void forPolyEdges(zeno::PrimitiveObject const *prim, F const &f) {
+    for (const auto &[b, c]: prim->polys) {
+        for (auto i = 2; i < c; i++) {
+            if (i == 2) {
+                f(b, b + 1);
+            }
+            f(b + i - 1, b + i);
+            if (i == c - 1) {
+                f(b, b + i);
+            }
+        }
+    }
+}
+
+void preparePolyEdges(zeno::PrimitiveObject const *prim, PrimRenderTopo &topo) {
+    bool any_not_triangle = std::any_of(prim->polys.begin(), prim->polys.end(), [] (auto const &poly) {
+        return poly[1] > 3;
+    });
+    if (!any_not_triangle)
+        return;
+    std::vector<int> edge_list;
+    forPolyEdges(prim, [&] (int a, int b) {
+        edge_list.push_back(prim->loops[a]);
+        edge_list.push_back(prim->loops[b]);
+    });
+    topo.polyEdges = makeArray(std::move(edge_list));
+    if (prim->loops.attr_is<int>("uvs")) {
+        auto &uvs = prim->loops.attr<int>("uvs");
+        std::vector<int> uv_list;
+        forPolyEdges(prim, [&] (int a, int b) {
+            uv_list.push_back(uvs[a]);
+            uv_list.push_back(uvs[b]);
+        });
+        std::vector<zeno::vec3f> uv_data;
+        uv_data.reserve(prim->uvs.size());
+        for (const auto &uv: prim->uvs) {
+            uv_data.emplace_back(uv[0], uv[1], 0);
+        }
+        topo.polyUvEdges = makeArray(std::move(uv_list));
+        topo.polyUvs = makeArray(std::move(uv_data));
+    }
+}
+
+template <size_t N>
+std::vector<zeno::vec3f> deindexUvs(zeno::AttrVector<zeno::vec<N, int>> const &faces) {
+    std::ptrdiff_t count = faces.size();
+    std::vector<zeno::vec3f> res(count * N);
+    for (size_t j = 0; j < N; j++) {
+        auto const &uv = faces.template attr<zeno::vec3f>("uv" + std::to_string(j));
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < count; i++)
+            res[i * N + j] = uv[i];
+    }
+    return res;
+}
+
+template <size_t N>
+std::vector<zeno::vec<N, int>> sequentialFaces(size_t count) {
+    std::vector<zeno::vec<N, int>> res(count);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < N; j++)
+            res[i][j] = (int)(i * N + j);
+    }
+    return res;
+}
+
+template <size_t N>
+std::vector<zeno::vec3f> gatherCorners(std::vector<zeno::vec<N, int>> const &corners, std::vector<zeno::vec3f> const &src) {
+    std::ptrdiff_t count = corners.size();
+    std::vector<zeno::vec3f> res(count * N);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < N; j++)
+            res[i * N + j] = src[corners[i][j]];
+    }
+    return res;
+}
+
+// tangent of the uv mapping of each tri, repeated on its three corners
+std::vector<zeno::vec3f> triangleTangents(std::vector<zeno::vec3i> const &tris, std::vector<zeno::vec3f> const &uvs,
+                                          std::vector<zeno::vec3f> const &pos) {
+    std::ptrdiff_t count = tris.size();
+    std::vector<zeno::vec3f> res(count * 3);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < count; i++) {
+        auto edge0 = pos[tris[i][1]] - pos[tris[i][0]];
+        auto edge1 = pos[tris[i][2]] - pos[tris[i][0]];
+        auto deltaUV0 = uvs[i * 3 + 1] - uvs[i * 3 + 0];
+        auto deltaUV1 = uvs[i * 3 + 2] - uvs[i * 3 + 0];
+        float f = 1.0f / (deltaUV0[0] * deltaUV1[1] - deltaUV1[0] * deltaUV0[1] + 1e-5f);
+        zeno::vec3f tangent = f * (deltaUV1[1] * edge0 - deltaUV0[1] * edge1);
+        for (int j = 0; j < 3; j++)
+            res[i * 3 + j] = tangent;
+    }
+    return res;
+}
+
+std::shared_ptr<PrimRenderTopo const> buildTopology(zeno::PrimitiveObject const *prim) {
+    auto topo = std::make_shared<PrimRenderTopo>();
+    topo->numVerts = prim->verts.size();
+    topo->hasFaces = prim->tris.size() || prim->quads.size() || prim->polys.size();
+    preparePolyEdges(prim, *topo);
+
+    auto faces = renderCopy(prim, false);
+    if (topo->hasFaces) {
+        zeno::log_trace("demoting faces");
+        zeno::primTriangulateQuads(faces.get());
+        zeno::primTriangulate(faces.get());//will further loop.attr("uv") to tris.attr("uv0")...
+    }
+    auto &lines = faces->lines;
+    if (lines.size() && lines.attr_is<zeno::vec3f>("uv0") && lines.attr_is<zeno::vec3f>("uv1")) {
+        topo->lineUvs = makeArray(deindexUvs(lines));
+        topo->lines = makeArray(sequentialFaces<2>(lines.size()));
+        topo->lineCorners = makeArray(std::move(lines.values));
+    } else {
+        topo->lines = makeArray(std::move(lines.values));
+    }
+    auto &tris = faces->tris;
+    if (tris.size() && tris.attr_is<zeno::vec3f>("uv0") && tris.attr_is<zeno::vec3f>("uv1")
+        && tris.attr_is<zeno::vec3f>("uv2")) {
+        topo->triUvs = makeArray(deindexUvs(tris));
+        topo->tris = makeArray(sequentialFaces<3>(tris.size()));
+        topo->triCorners = makeArray(std::move(tris.values));
+    } else {
+        topo->tris = makeArray(std::move(tris.values));
+    }
+    topo->points = makeArray(std::move(faces->points.values));
+    return topo;
+}
+
+std::shared_ptr<PrimRenderTopo const> sharedTopology(RenderPrepCache *cache, uint64_t key, zeno::PrimitiveObject const *prim) {
+    if (!cache)
+        return buildTopology(prim);
+    if (auto topo = cache->find(cache->topos, key))
+        return topo;
+    return cache->insert(cache->topos, key, buildTopology(prim));
+}
+
+std::vector<zeno::vec3f> computeNormals(PrimRenderTopo const &topo, zeno::PrimitiveObject const *prim,
+                                        std::vector<zeno::vec3f> const &pos) {
+    std::lock_guard lck(topo.normalMtx);
+    if (!topo.normalPrim) {
+        auto faces = std::make_shared<zeno::PrimitiveObject>();
+        faces->tris.values = prim->tris.values;
+        faces->quads.values = prim->quads.values;
+        faces->polys.values = prim->polys.values;
+        faces->loops.values = prim->loops.values;
+        topo.normalPrim = faces;
+    }
+    topo.normalPrim->verts.values = pos;
+    zeno::log_trace("computing normal");
+    zeno::primCalcNormal(topo.normalPrim.get(), 1);
+    return topo.normalPrim->verts.attr<zeno::vec3f>("nrm");
+}
+
+// the per-vertex arrays of prim over an already prepared topology, arrays whose inputs did
+// not change since they were last prepared are taken over as they are
+std::shared_ptr<PrimRenderData> prepareAttributes(zeno::PrimitiveObject const *prim, SourceKeys const &keys,
+                                                  std::shared_ptr<PrimRenderTopo const> topo,
+                                                  RenderPrepCache *cache) {
+    using vec3f = zeno::vec3f;
+    auto data = std::make_shared<PrimRenderData>();
+    size_t n = topo->numVerts;
+    auto const &verts = prim->verts;
+    auto &out = data->verts;
+    std::array<uint64_t, PrimRenderData::NumVertAttrs> outKeys;
+    auto zeros = [&] {
+        return sharedArray<vec3f>(cache, combine(kZeros, n), [&] {
+            return std::vector<vec3f>(n, vec3f(0.0f));
+        });
+    };
+
+    outKeys[PrimRenderData::Pos] = combine(kPos, keys.pos);
+    out[PrimRenderData::Pos] = sharedArray<vec3f>(cache, outKeys[PrimRenderData::Pos], [&] {
+        return verts.values;
+    });
+
+    data->customColor = keys.clr != 0;
+    if (data->customColor) {
+        outKeys[PrimRenderData::Clr] = combine(kClr, keys.clr);
+        out[PrimRenderData::Clr] = sharedArray<vec3f>(cache, outKeys[PrimRenderData::Clr], [&] {
+            return verts.attr<vec3f>("clr");
+        });
+    } else {
+        vec3f clr0(1.0f);
+        if (!topo->hasFaces) {
+            if (topo->lines->size())
+                clr0 = {1.0f, 0.6f, 0.2f};
+            else
+                clr0 = {0.2f, 0.6f, 1.0f};
+        }
+        outKeys[PrimRenderData::Clr] = combine(combine(kDefaultClr, n), hashBytes(&clr0, sizeof(clr0), 0));
+        out[PrimRenderData::Clr] = sharedArray<vec3f>(cache, outKeys[PrimRenderData::Clr], [&] {
+            return std::vector<vec3f>(n, clr0);
+        });
+    }
+
+    if (topo->hasFaces) {
+        bool primNormalCorrect = keys.nrm && (!verts.attr<vec3f>("nrm").size() ||
+                                              length(verts.attr<vec3f>("nrm")[0]) > 1e-5);
+        if (primNormalCorrect) {
+            outKeys[PrimRenderData::Nrm] = combine(kNrm, keys.nrm);
+            out[PrimRenderData::Nrm] = sharedArray<vec3f>(cache, outKeys[PrimRenderData::Nrm], [&] {
+                return verts.attr<vec3f>("nrm");
+            });
+        } else {
+            outKeys[PrimRenderData::Nrm] = combine(combine(kCalcNrm, keys.topo), keys.pos);
+            out[PrimRenderData::Nrm] = sharedArray<vec3f>(cache, outKeys[PrimRenderData::Nrm], [&] {
+                return computeNormals(*topo, prim, *out[PrimRenderData::Pos]);
+            });
+        }
+    } else {
+        // points without faces pass radius and opacity to the shader through nrm
+        outKeys[PrimRenderData::Nrm] = combine(combine(combine(kRadOpa, n), keys.rad), keys.opa);
+        out[PrimRenderData::Nrm] = sharedArray<vec3f>(cache, outKeys[PrimRenderData::Nrm], [&] {
+            auto const *rad = keys.rad ? verts.attr<float>("rad").data() : nullptr;
+            auto const *opa = keys.opa ? verts.attr<float>("opa").data() : nullptr;
+            std::vector<vec3f> radopa(n);
+            for (size_t i = 0; i < n; i++) {
+                radopa[i] = vec3f(rad ? rad[i] : 1.0f, opa ? opa[i] : 0.0f, 0.0f);
+            }
+            return radopa;
+        });
+    }
+
+    outKeys[PrimRenderData::Uv] = keys.uv ? combine(kUv, keys.uv) : combine(kZeros, n);
+    out[PrimRenderData::Uv] = keys.uv ? sharedArray<vec3f>(cache, outKeys[PrimRenderData::Uv], [&] {
+        return verts.attr<vec3f>("uv");
+    }) : zeros();
+    outKeys[PrimRenderData::Tang] = keys.tang ? combine(kTang, keys.tang) : combine(kZeros, n);
+    out[PrimRenderData::Tang] = keys.tang ? sharedArray<vec3f>(cache, outKeys[PrimRenderData::Tang], [&] {
+        return verts.attr<vec3f>("tang");
+    }) : zeros();
+
+    if (topo->lineCorners) {
+        for (int a: {PrimRenderData::Pos, PrimRenderData::Clr, PrimRenderData::Nrm, PrimRenderData::Tang}) {
+            data->lineVerts[a] = sharedArray<vec3f>(cache, combine(combine(kLineGather, keys.topo), outKeys[a]), [&] {
+                return gatherCorners(*topo->lineCorners, *out[a]);
+            });
+        }
+        data->lineVerts[PrimRenderData::Uv] = topo->lineUvs;
+    }
+    if (topo->triCorners) {
+        for (int a: {PrimRenderData::Pos, PrimRenderData::Clr, PrimRenderData::Nrm}) {
+            data->triVerts[a] = sharedArray<vec3f>(cache, combine(combine(kTriGather, keys.topo), outKeys[a]), [&] {
+                return gatherCorners(*topo->triCorners, *out[a]);
+            });
+        }
+        data->triVerts[PrimRenderData::Tang] = sharedArray<vec3f>(cache, combine(combine(kTriTang, keys.topo), keys.pos), [&] {
+            return triangleTangents(*topo->triCorners, *topo->triUvs, *out[PrimRenderData::Pos]);
+        });
+        data->triVerts[PrimRenderData::Uv] = topo->triUvs;
+    }
+
+    data->points = topo->points;
+    data->lines = topo->lines;
+    data->tris = topo->tris;
+    data->polyEdges = topo->polyEdges;
+    data->polyEdgeVerts = topo->polyEdges ? out[PrimRenderData::Pos] : nullptr;
+    data->polyUvEdges = topo->polyUvEdges;
+    data->polyUvs = topo->polyUvs;
+    data->topo = std::move(topo);
+    return data;
+}
+
+// subdivision works on its own copy of the prim, the outline keeps showing the cage
+std::shared_ptr<PrimRenderData> prepareSubdivided(zeno::PrimitiveObject const *prim, int subdlevs,
+                                                  RenderPrepCache *cache) {
+    auto primUnique = renderCopy(prim, true);
+    PrimRenderTopo cage;
+    preparePolyEdges(primUnique.get(), cage);
+
+    bool thePrmHasFaces = prim->tris.size() || prim->quads.size() || prim->polys.size();
+    bool primNormalCorrect =
+        prim->verts.attr_is<zeno::vec3f>("nrm") &&
+        (!prim->verts.attr<zeno::vec3f>("nrm").size() ||
+         length(prim->verts.attr<zeno::vec3f>("nrm")[0]) > 1e-5);
+    if (thePrmHasFaces && !primNormalCorrect) {
+        zeno::log_trace("computing normal");
+        zeno::primCalcNormal(primUnique.get(), 1);
+    }
+    // todo: zhxx, should comp normal after subd or before?
+    zeno::log_trace("computing subdiv {}", subdlevs);
+    (void)zeno::TempNodeSimpleCaller("OSDPrimSubdiv")
+        .set("prim", primUnique)
+        .set2<int>("levels", subdlevs)
+        .set2<std::string>("edgeCreaseAttr", "")
+        .set2<bool>("triangulate", false)
+        .set2<bool>("asQuadFaces", true)
+        .set2<bool>("hasLoopUVs", true)
+        .set2<bool>("delayTillIpc", false)
+        .call();  // will inplace subdiv prim
+
+    auto keys = sourceKeys(primUnique.get(), 0);
+    auto data = prepareAttributes(primUnique.get(), keys, sharedTopology(cache, keys.topo, primUnique.get()), cache);
+    data->polyEdges = cage.polyEdges;
+    data->polyEdgeVerts = cage.polyEdges ? std::make_shared<std::vector<zeno::vec3f> const>(prim->verts.values) : nullptr;
+    data->polyUvEdges = cage.polyUvEdges;
+    data->polyUvs = cage.polyUvs;
+    return data;
+}
+
+template <class T>
+std::vector<T> gatherValues(std::vector<T> const &src, std::vector<int> const &revamp) {
+    std::ptrdiff_t n = revamp.size();
+    std::vector<T> res(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        res[i] = src[revamp[i]];
+    return res;
+}
+
+// faces that still have every vertex after remap, renumbered; loose faces like points of
+// a point cloud may lose some of their verts
+template <class Vec>
+void remapFaces(zeno::AttrVector<Vec> &faces, std::vector<int> const &remap, bool dropCollapsed,
+                zeno::RevampScratch &scratch) {
+    constexpr int N = sizeof(Vec) / sizeof(int);
+    std::ptrdiff_t n = faces.size();
+    std::vector<uint8_t> flags(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        auto ind = reinterpret_cast<int *>(&faces.values[i]);
+        bool ok = true;
+        for (int j = 0; j < N; j++) {
+            ind[j] = remap[ind[j]];
+            ok = ok && ind[j] != -1;
+            for (int k = 0; k < j && dropCollapsed; k++)
+                ok = ok && ind[j] != ind[k];
+        }
+        flags[i] = ok;
+    }
+    auto revamp = zeno::compactIndices(flags);
+    if (revamp.size() != faces.size())
+        zeno::revampAttrVector(faces, revamp, scratch);
+}
+
+size_t triangleCount(zeno::PrimitiveObject const *prim) {
+    std::ptrdiff_t npolys = prim->polys.size();
+    size_t polyTris = 0;
+#pragma omp parallel for reduction(+: polyTris)
+    for (std::ptrdiff_t i = 0; i < npolys; i++)
+        polyTris += std::max(prim->polys[i][1] - 2, 0);
+    return prim->tris.size() + prim->quads.size() * 2 + polyTris;
+}
+
+// Keeps about maxPoints of the verts of a point cloud. Vertex i stays when the hash of its
+// "id", or of i when there is none, falls under the budget's share, so the same particles
+// stay picked from frame to frame and the picks are spread evenly over the cloud.
+std::shared_ptr<zeno::PrimitiveObject> subsamplePoints(zeno::PrimitiveObject const *prim, size_t maxPoints) {
+    std::ptrdiff_t n = prim->verts.size();
+    auto ids = prim->verts.attr_is<int>("id") ? prim->verts.attr<int>("id").data() : nullptr;
+    auto threshold = (uint64_t)std::ldexp((double)maxPoints / n, 53);
+    std::vector<uint8_t> flags(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        flags[i] = mix64(ids ? (uint32_t)ids[i] : (uint64_t)i) >> 11 < threshold;
+    auto revamp = zeno::compactIndices(flags);
+
+    auto res = std::make_shared<zeno::PrimitiveObject>();
+    res->verts.values = gatherValues(prim->verts.values, revamp);
+    for (auto name: {"clr", "nrm", "uv", "tang"}) {
+        if (prim->verts.attr_is<zeno::vec3f>(name))
+            res->verts.add_attr<zeno::vec3f>(name) = gatherValues(prim->verts.attr<zeno::vec3f>(name), revamp);
+    }
+    for (auto name: {"rad", "opa"}) {
+        if (prim->verts.attr_is<float>(name))
+            res->verts.add_attr<float>(name) = gatherValues(prim->verts.attr<float>(name), revamp);
+    }
+    if (prim->points.size()) {
+        zeno::RevampScratch scratch;
+        res->points.values = prim->points.values;
+        remapFaces(res->points, zeno::inverseRevamp(revamp, n), false, scratch);
+    }
+    return res;
+}
+
+// Grid cells of the vertex clustering, found by an open addressing table that is filled
+// from all threads at once. Cells are numbered in key order afterwards so the result does
+// not depend on which thread got a slot first.
+struct ClusterGrid {
+    static constexpr uint64_t kEmpty = ~uint64_t(0);
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    uint64_t mask = 0;
+    std::atomic<size_t> count{0};
+
+    explicit ClusterGrid(size_t maxCells) {
+        size_t capacity = 1024;
+        while (capacity < maxCells * 2)
+            capacity *= 2;
+        slots.reset(new std::atomic<uint64_t>[capacity]);
+        mask = capacity - 1;
+        for (size_t i = 0; i < capacity; i++)
+            slots[i].store(kEmpty, std::memory_order_relaxed);
+    }
+
+    // slot of key, -1 once the table holds more cells than it was made for
+    int64_t insert(uint64_t key) {
+        for (uint64_t s = mix64(key) & mask;; s = (s + 1) & mask) {
+            uint64_t cur = slots[s].load(std::memory_order_relaxed);
+            if (cur == kEmpty) {
+                if (count.load(std::memory_order_relaxed) * 2 > mask)
+                    return -1;
+                if (slots[s].compare_exchange_strong(cur, key, std::memory_order_relaxed)) {
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    return (int64_t)s;
+                }
+            }
+            if (cur == key)
+                return (int64_t)s;
+        }
+    }
+
+    // cell number of every slot, in ascending key order
+    std::vector<int> numberCells(size_t &ncells) const {
+        std::ptrdiff_t capacity = mask + 1;
+        std::vector<uint8_t> flags(capacity);
+#pragma omp parallel for
+        for (std::ptrdiff_t s = 0; s < capacity; s++)
+            flags[s] = slots[s].load(std::memory_order_relaxed) != kEmpty;
+        auto used = zeno::compactIndices(flags);
+        std::sort(used.begin(), used.end(), [&] (int a, int b) {
+            return slots[a].load(std::memory_order_relaxed) < slots[b].load(std::memory_order_relaxed);
+        });
+        std::vector<int> res(capacity, -1);
+        for (size_t i = 0; i < used.size(); i++)
+            res[used[i]] = (int)i;
+        ncells = used.size();
+        return res;
+    }
+};
+
+// cluster of every vertex on a grid of cellSize, -1 for the verts no face uses; empty when
+// there are more occupied cells than maxCells
+std::vector<int> clusterOnGrid(std::vector<zeno::vec3f> const &pos, std::vector<uint8_t> const &used,
+                               zeno::vec3f const &origin, float cellSize, size_t maxCells, size_t &ncells) {
+    ClusterGrid grid(maxCells);
+    std::ptrdiff_t n = pos.size();
+    std::vector<int64_t> vertSlot(n);
+    bool overflow = false;
+#pragma omp parallel for reduction(||: overflow)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        if (!used[i]) {
+            vertSlot[i] = -1;
+            continue;
+        }
+        uint64_t key = 0;
+        for (int j = 0; j < 3; j++) {
+            auto c = (uint64_t)std::clamp((pos[i][j] - origin[j]) / cellSize, 0.0f, float((1 << 21) - 1));
+            key |= c << (21 * j);
+        }
+        vertSlot[i] = grid.insert(key);
+        if (vertSlot[i] == -1)
+            overflow = true;
+    }
+    if (overflow)
+        return {};
+    auto cellIds = grid.numberCells(ncells);
+    std::vector<int> res(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        res[i] = vertSlot[i] == -1 ? -1 : cellIds[vertSlot[i]];
+    return res;
+}
+
+// drops all but the first of the triangles on the same three verts, merged cells leave many
+// of them behind and they would pile up in the vertex fans
+void dropDuplicateTris(zeno::AttrVector<zeno::vec3i> &tris, zeno::RevampScratch &scratch) {
+    std::ptrdiff_t n = tris.size();
+    std::vector<std::array<int, 3>> sorted(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        auto t = tris[i];
+        sorted[i] = {t[0], t[1], t[2]};
+        std::sort(sorted[i].begin(), sorted[i].end());
+    }
+    std::vector<int> order(n);
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&] (int a, int b) {
+        return sorted[a] != sorted[b] ? sorted[a] < sorted[b] : a < b;
+    });
+    std::vector<uint8_t> flags(n);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        flags[order[i]] = i == 0 || sorted[order[i]] != sorted[order[i - 1]];
+    auto revamp = zeno::compactIndices(flags);
+    if (revamp.size() != tris.size())
+        zeno::revampAttrVector(tris, revamp, scratch);
+}
+
+// mean of the members of every cluster, summed in vertex order so the result is deterministic
+template <class T>
+std::vector<T> clusterMeans(std::vector<T> const &src, std::vector<int> const &start, std::vector<int> const &members) {
+    std::ptrdiff_t ncells = start.size() - 1;
+    std::vector<T> res(ncells);
+#pragma omp parallel for
+    for (std::ptrdiff_t c = 0; c < ncells; c++) {
+        T sum(0);
+        for (int i = start[c]; i < start[c + 1]; i++)
+            sum += src[members[i]];
+        res[c] = sum * (1.0f / std::max(start[c + 1] - start[c], 1));
+    }
+    return res;
+}
+
+// Decimates a mesh to about maxTris triangles by vertex clustering: verts are snapped to a
+// grid, the verts of each occupied cell merge into one at their mean, and triangles whose
+// corners merged are dropped. The cell size is estimated from the surface area so that the
+// surviving triangles fit the budget, and grown when they do not. Triangles left on the same
+// three verts are kept once.
+std::shared_ptr<zeno::PrimitiveObject> clusterVertices(zeno::PrimitiveObject const *prim, size_t maxTris) {
+    using vec3f = zeno::vec3f;
+    auto faces = renderCopy(prim, false);
+    zeno::primTriangulateQuads(faces.get());
+    zeno::primTriangulate(faces.get());
+    auto const &pos = prim->verts.values;
+    std::ptrdiff_t n = pos.size();
+    std::ptrdiff_t ntris = faces->tris.size();
+
+    std::unique_ptr<std::atomic<uint8_t>[]> usedFlags(new std::atomic<uint8_t>[n]);
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < n; i++)
+        usedFlags[i].store(0, std::memory_order_relaxed);
+    auto markUsed = [&] (auto const &arr) {
+        constexpr int N = sizeof(arr[0]) / sizeof(int);
+        std::ptrdiff_t count = arr.size();
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < count; i++) {
+            auto ind = reinterpret_cast<int const *>(&arr[i]);
+            for (int j = 0; j < N; j++)
+                usedFlags[ind[j]].store(1, std::memory_order_relaxed);
+        }
+    };
+    markUsed(faces->points.values);
+    markUsed(faces->lines.values);
+    markUsed(faces->tris.values);
+    std::vector<uint8_t> used(n);
+    float x0 = INFINITY, y0 = INFINITY, z0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY, z1 = -INFINITY;
+#pragma omp parallel for reduction(min: x0, y0, z0) reduction(max: x1, y1, z1)
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+        used[i] = usedFlags[i].load(std::memory_order_relaxed);
+        if (!used[i])
+            continue;
+        x0 = std::min(x0, pos[i][0]), y0 = std::min(y0, pos[i][1]), z0 = std::min(z0, pos[i][2]);
+        x1 = std::max(x1, pos[i][0]), y1 = std::max(y1, pos[i][1]), z1 = std::max(z1, pos[i][2]);
+    }
+    usedFlags.reset();
+    double area = 0;
+#pragma omp parallel for reduction(+: area)
+    for (std::ptrdiff_t i = 0; i < ntris; i++) {
+        auto const &t = faces->tris[i];
+        area += length(cross(pos[t[1]] - pos[t[0]], pos[t[2]] - pos[t[0]]));
+    }
+    area *= 0.5;
+
+    // a closed surface keeps about two triangles per cluster, and a cell of size h holds
+    // about h^2 / 1.5 of it
+    vec3f origin(x0, y0, z0);
+    float extent = std::max({x1 - x0, y1 - y0, z1 - z0, 1e-6f});
+    float cellSize = area > 0 ? (float)std::sqrt(1.5 * area / (0.45 * maxTris))
+                              : extent / std::cbrt((float)maxTris);
+    cellSize = std::max(cellSize, extent / float(1 << 20));
+
+    for (int attempt = 0;; attempt++) {
+        size_t ncells = 0;
+        auto cluster = clusterOnGrid(pos, used, origin, cellSize, maxTris, ncells);
+        if (cluster.empty()) {
+            cellSize *= 1.5f;
+            continue;
+        }
+        auto res = std::make_shared<zeno::PrimitiveObject>();
+        zeno::RevampScratch scratch;
+        res->tris = faces->tris;
+        remapFaces(res->tris, cluster, true, scratch);
+        dropDuplicateTris(res->tris, scratch);
+        if (res->tris.size() > maxTris && attempt < 8) {
+            cellSize *= 1.05f * (float)std::sqrt((double)res->tris.size() / maxTris);
+            continue;
+        }
+        res->lines = faces->lines;
+        remapFaces(res->lines, cluster, true, scratch);
+        res->points = faces->points;
+        remapFaces(res->points, cluster, false, scratch);
+
+        // members of each cluster, counted and scattered in vertex order
+        std::vector<int> start(ncells + 1);
+        for (std::ptrdiff_t i = 0; i < n; i++) {
+            if (cluster[i] != -1)
+                start[cluster[i]]++;
+        }
+        start.back() = 0;
+        int nmembers = zeno::countsToOffsets(start);
+        start.back() = nmembers;
+        std::vector<int> members(nmembers);
+        {
+            auto fill = start;
+            for (std::ptrdiff_t i = 0; i < n; i++) {
+                if (cluster[i] != -1)
+                    members[fill[cluster[i]]++] = (int)i;
+            }
+        }
+        res->verts.values = clusterMeans(pos, start, members);
+        for (auto name: {"clr", "uv"}) {
+            if (prim->verts.attr_is<vec3f>(name))
+                res->verts.add_attr<vec3f>(name) = clusterMeans(prim->verts.attr<vec3f>(name), start, members);
+        }
+        return res;
+    }
+}
+
+// the prim cut down to what budget allows, null when it fits
+std::shared_ptr<zeno::PrimitiveObject> reduceToBudget(zeno::PrimitiveObject const *prim, RenderBudget const &budget) {
+    bool pointCloud = !(prim->lines.size() || prim->tris.size() || prim->quads.size() || prim->polys.size());
+    if (pointCloud)
+        return budget.maxPoints && prim->verts.size() > budget.maxPoints ? subsamplePoints(prim, budget.maxPoints) : nullptr;
+    if (budget.maxTris && triangleCount(prim) > budget.maxTris)
+        return clusterVertices(prim, budget.maxTris);
+    return nullptr;
+}
+
+}
+
+std::shared_ptr<PrimRenderData const> prepareRenderData(zeno::PrimitiveObject const *prim, bool cached,
+                                                        RenderBudget const &budget) {
+    auto cache = cached ? &renderPrepCache() : nullptr;
+    auto &ud = prim->userData();
+    int subdlevs = ud.get2<int>("delayedSubdivLevels", 0);
+    bool invisible = ud.get2<bool>("invisible", 0);
+    bool isImage = ud.get2<int>("isImage", 0);
+    RenderBudget lod;
+    if (!subdlevs && !isImage) {
+        lod.maxPoints = std::max(ud.get2<int>("viewportMaxPoints", (int)std::min<size_t>(budget.maxPoints, INT_MAX)), 0);
+        lod.maxTris = std::max(ud.get2<int>("viewportMaxTris", (int)std::min<size_t>(budget.maxTris, INT_MAX)), 0);
+    }
+    zeno::log_trace("preparing primitive size {}", prim->size());
+
+    auto keys = sourceKeys(prim, subdlevs);
+    uint64_t fullKey = combine(combine(keys.full(invisible, isImage), lod.maxPoints), lod.maxTris);
+    if (cache) {
+        if (auto hit = cache->lookup(fullKey))
+            return hit;
+    }
+    std::shared_ptr<PrimRenderData> data;
+    if (subdlevs) {
+        data = prepareSubdivided(prim, subdlevs, cache);
+    } else if (auto reduced = reduceToBudget(prim, lod)) {
+        zeno::log_debug("viewport draws {} of {} verts", reduced->verts.size(), prim->verts.size());
+        auto lodKeys = sourceKeys(reduced.get(), 0);
+        data = prepareAttributes(reduced.get(), lodKeys, sharedTopology(cache, lodKeys.topo, reduced.get()), cache);
+        data->reduced = true;
+    } else {
+        data = prepareAttributes(prim, keys, sharedTopology(cache, keys.topo, prim), cache);
+    }
+    data->invisible = invisible;
+    data->drawAllPoints = data->points->empty() && data->lines->empty() && data->tris->empty() && !isImage;
+    if (cache)
+        cache->remember(fullKey, data);
+    return data;
+}
+
+std::vector<std::shared_ptr<PrimRenderData const>> prepareRenderDataBatch(
+    std::vector<zeno::PrimitiveObject const *> const &prims, bool cached, RenderBudget const &budget) {
+    std::vector<std::shared_ptr<PrimRenderData const>> res(prims.size());
+    std::vector<std::exception_ptr> errors(prims.size());
+    size_t ncores = std::max(1u, std::thread::hardware_concurrency());
+    size_t nworkers = std::min(prims.size(), ncores);
+    std::atomic<size_t> next{0};
+#ifdef _OPENMP
+    int ompThreads = omp_get_max_threads();
+#endif
+    auto worker = [&] {
+#ifdef _OPENMP
+        // the parallel loops inside share the cores with the other workers
+        omp_set_num_threads((int)std::max<size_t>(1, ncores / nworkers));
+#endif
+        for (size_t i; (i = next.fetch_add(1)) < prims.size();) {
+            try {
+                res[i] = prepareRenderData(prims[i], cached, budget);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < nworkers; t++)
+        pool.emplace_back(worker);
+    if (nworkers)
+        worker();
+    for (auto &thr: pool)
+        thr.join();
+#ifdef _OPENMP
+    omp_set_num_threads(ompThreads);
+#endif
+    for (auto const &err: errors) {
+        if (err)
+            std::rethrow_exception(err);
+    }
+    return res;
+}
+
+void setRenderPrepCacheBudget(size_t maxBytes) {
+    auto &cache = renderPrepCache();
+    std::lock_guard lck(cache.mtx);
+    cache.maxBytes = maxBytes;
+    cache.evict();
+}
+
+namespace {
+
+struct BenchmarkRenderPrep : zeno::INode {
+    virtual void apply() override {
+        auto prim = get_input<zeno::PrimitiveObject>("prim");
+        auto count = std::max(get_input2<int>("count"), 1);
+        std::vector<zeno::PrimitiveObject const *> prims(count, prim.get());
+        auto timed = [] (auto const &f) {
+            auto t0 = std::chrono::steady_clock::now();
+            f();
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+
+        double serialTime = timed([&] {
+            for (auto p: prims)
+                (void)prepareRenderData(p, false);
+        });
+        double batchTime = timed([&] {
+            (void)prepareRenderDataBatch(prims, false);
+        });
+        // a frame shown before, then the same faces with moved points
+        auto warm = prepareRenderData(prim.get());
+        double cachedTime = timed([&] {
+            (void)prepareRenderDataBatch(prims);
+        });
+        auto moved = std::make_shared<zeno::PrimitiveObject>(*prim);
+        for (auto &p: moved->verts)
+            p += zeno::vec3f(1e-3f);
+        double movedTime = timed([&] {
+            (void)prepareRenderData(moved.get());
+        });
+
+        double primsPerSec = count / std::max(batchTime, 1e-9);
+        zeno::log_info("BenchmarkRenderPrep: {} x {} verts, one by one {}s, worker pool {}s ({} prims/s), "
+                       "cached {}s, moved points {}s", count, prim->verts.size(), serialTime, batchTime,
+                       primsPerSec, cachedTime, movedTime);
+        set_output("serialTime", std::make_shared<zeno::NumericObject>((float)serialTime));
+        set_output("batchTime", std::make_shared<zeno::NumericObject>((float)batchTime));
+        set_output("primsPerSec", std::make_shared<zeno::NumericObject>((float)primsPerSec));
+        set_output("cachedTime", std::make_shared<zeno::NumericObject>((float)cachedTime));
+        set_output("movedTime", std::make_shared<zeno::NumericObject>((float)movedTime));
+    }
+};
+
+ZENDEFNODE(BenchmarkRenderPrep, {
+    {
+    {"PrimitiveObject", "prim"},
+    {"int", "count", "64"},
+    },
+    {
+    {"float", "serialTime"},
+    {"float", "batchTime"},
+    {"float", "primsPerSec"},
+    {"float", "cachedTime"},
+    {"float", "movedTime"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
+struct BenchmarkViewportLod : zeno::INode {
+    virtual void apply() override {
+        auto prim = get_input<zeno::PrimitiveObject>("prim");
+        RenderBudget budget;
+        budget.maxPoints = std::max(get_input2<int>("maxPoints"), 0);
+        budget.maxTris = std::max(get_input2<int>("maxTris"), 0);
+        auto timed = [] (auto const &f) {
+            auto t0 = std::chrono::steady_clock::now();
+            f();
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+
+        std::shared_ptr<PrimRenderData const> full, lod;
+        double fullTime = timed([&] {
+            full = prepareRenderData(prim.get(), false);
+        });
+        double lodTime = timed([&] {
+            lod = prepareRenderData(prim.get(), false, budget);
+        });
+        // what the viewport draws of each: tris of a mesh, verts of a point cloud
+        auto drawn = [] (PrimRenderData const &data) {
+            return data.tris->size() ? data.tris->size() : data.vertexCount();
+        };
+        double ratio = (double)drawn(*lod) / std::max<size_t>(drawn(*full), 1);
+        zeno::log_info("BenchmarkViewportLod: full {} in {}s ({} bytes), lod {} in {}s ({} bytes), kept {}",
+                       drawn(*full), fullTime, full->nbytes(), drawn(*lod), lodTime, lod->nbytes(), ratio);
+        set_output("fullTime", std::make_shared<zeno::NumericObject>((float)fullTime));
+        set_output("lodTime", std::make_shared<zeno::NumericObject>((float)lodTime));
+        set_output("lodCount", std::make_shared<zeno::NumericObject>((int)drawn(*lod)));
+        set_output("keptRatio", std::make_shared<zeno::NumericObject>((float)ratio));
+    }
+};
+
+ZENDEFNODE(BenchmarkViewportLod, {
+    {
+    {"PrimitiveObject", "prim"},
+    {"int", "maxPoints", "1000000"},
+    {"int", "maxTris", "1000000"},
+    },
+    {
+    {"float", "fullTime"},
+    {"float", "lodTime"},
+    {"int", "lodCount"},
+    {"float", "keptRatio"},
+    },
+    {
+    },
+    {"primitive"},
+});
+
+}
+
+} // namespace zenovis
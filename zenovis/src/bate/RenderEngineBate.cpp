@@ -1,4 +1,6 @@
+#include <chrono>
 #include <zenovis/RenderEngine.h>
+#include <zenovis/Camera.h>
 #include <zenovis/DrawOptions.h>
 #include <zenovis/bate/GraphicsManager.h>
 #include <zenovis/ObjectsManager.h>
@@ -18,6 +20,21 @@ struct RenderEngineBate : RenderEngine {
     Scene *scene;
     bool released = false;
 
+    // reduced objects are refined once neither the camera nor the objects changed for this long
+    static constexpr std::chrono::milliseconds kRestTime{300};
+    glm::mat4 lastView{0}, lastProj{0};
+    std::chrono::steady_clock::time_point lastChange;
+
+    bool atRest() {
+        auto now = std::chrono::steady_clock::now();
+        if (scene->camera->m_view != lastView || scene->camera->m_proj != lastProj) {
+            lastView = scene->camera->m_view;
+            lastProj = scene->camera->m_proj;
+            lastChange = now;
+        }
+        return now - lastChange >= kRestTime;
+    }
+
     auto setupState() {
         return std::tuple{
             opengl::scopeGLEnable(GL_BLEND), opengl::scopeGLEnable(GL_DEPTH_TEST),
@@ -41,7 +58,8 @@ struct RenderEngineBate : RenderEngine {
     }
 
     void update() override {
-        graphicsMan->load_objects(scene->objectsMan->pairsShared());
+        if (graphicsMan->load_objects(scene->objectsMan->pairsShared()))
+            lastChange = std::chrono::steady_clock::now();
     }
 
     void draw(bool record) override {
@@ -61,7 +79,14 @@ struct RenderEngineBate : RenderEngine {
         }
 
         auto bindVao = opengl::scopeGLBindVertexArray(vao->vao);
-        graphicsMan->draw();
+        // recorded frames wait for every object, the viewport draws what is prepared so far
+        if (graphicsMan->upload_prepared(record))
+            lastChange = std::chrono::steady_clock::now();
+        // recorded frames are always drawn at full resolution
+        bool refined = atRest() || record;
+        bool pending = refined ? graphicsMan->refine(record) : graphicsMan->has_reduced();
+        scene->drawOptions->viewportLodPending = pending || graphicsMan->has_preparing();
+        graphicsMan->draw(refined);
 //        for (auto const &[key, gra] : graphicsMan->graphics.pairs<IGraphicDraw>()) {
 //            gra->draw();
 //        }